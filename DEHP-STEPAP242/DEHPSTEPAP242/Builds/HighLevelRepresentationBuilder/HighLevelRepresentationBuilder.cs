@@ -43,45 +43,7 @@ namespace DEHPSTEPAP242.Builds.HighLevelRepresentationBuilder
     /// </summary>
     public class HighLevelRepresentationBuilder : IHighLevelRepresentationBuilder
     {
-        /// <summary>
-        /// List of geometric parts.
-        /// 
-        /// A part could be the container of parts.
-        /// </summary>
-        private STEP3D_Part[] parts;
-
-        /// <summary>
-        /// List of relations between geometric parts
-        /// </summary>
-        private STEP3D_PartRelation[] relations;
-
-        /// <summary>
-        /// Helper structure to speedup tree searches.
-        /// <seealso cref="FindPart(int)"/>
-        /// </summary>
-        private readonly Dictionary<int, STEP3D_Part> idToPartMap = new Dictionary<int, STEP3D_Part>();
-
         private readonly Dictionary<string, int> nameDict = new();
-        /// <summary>
-        /// Helper structure to speedup tree searches.
-        /// <seealso cref="InitializeAuxiliaryData"/>
-        private readonly Dictionary<int, STEP3D_PartRelation> idToRelationMap = new Dictionary<int, STEP3D_PartRelation>();
-
-        /// <summary>
-        /// Helper structure to speedup tree searches.
-        /// <seealso cref="FindChildren(int)"/>
-        /// </summary>
-        private readonly Dictionary<int, List<(STEP3D_Part, STEP3D_PartRelation)>> partChildren = new Dictionary<int, List<(STEP3D_Part, STEP3D_PartRelation)>>();
-
-        /// <summary>
-        /// Keep track of Parts used as parent of an Assembly.
-        /// </summary>
-        private readonly HashSet<int> relatedParts = new HashSet<int>();
-
-        /// <summary>
-        /// Keep track of Parts used as childs of an Assembly.
-        /// </summary>
-        private readonly HashSet<int> relatingParts = new HashSet<int>();
 
         /// <summary>
         /// The current class <see cref="NLog.Logger"/>
@@ -98,10 +60,11 @@ namespace DEHPSTEPAP242.Builds.HighLevelRepresentationBuilder
         /// * As used in an Assembly
         /// * As that Assembly is also used in other Assemblies
         ///
-        /// Assemblies (roots) trigger recursivity
-        /// Parts (leaves) are processed normally
         /// Parts not referenced as target of any Assembly belongs to the main Root
         ///
+        /// The tree is expanded by the adapter (<see cref="STEP3DFile.AssemblyTree"/>),
+        /// in linear time; a relation closing a cycle is not expanded.
+        ///
         /// Each ParentID is associated to a PartRelation which must be stored
         /// in some place to retrieve the information of the specific association.
         ///
@@ -115,138 +78,50 @@ namespace DEHPSTEPAP242.Builds.HighLevelRepresentationBuilder
             if (step3d is null)
             {
                 this.logger.Debug("Creating empty HLR for null STEP3DFile");
-                InitializeAuxiliaryData(new STEP3D_Part[0], new STEP3D_PartRelation[0]);
-            }
-            else
-            {
-                this.logger.Debug($"Creating HLR for {step3d.FileName}");
-                InitializeAuxiliaryData(step3d.Parts, step3d.Relations);
-            }
-
-            
-            int nextID = cntOffSet;
-
-            foreach (var p in this.parts)
-            {
-                if (IsIsolatedPart(p))
-                {
-                    // Orphan parts are added to the maint Root
-                    var node = new Step3DRowData(nameDict,p, null) { ID = nextID++ };
-                    entries.Add(node);
-
-                    // Process parts of children
-                    AddSubTree(entries, node, ref nextID);
-                }
+                return entries;
             }
-            return entries;
-        }
 
-        /// <summary>
-        /// Fill the auxiliary HasSet/Dictionary to speedup the tree construction.
-        /// </summary>
-        /// <param name="parts">List of geometric parts</param>
-        /// <param name="relations">List of part relations defining instances in the tree composition</param>
-        private void InitializeAuxiliaryData(STEP3D_Part[] parts, STEP3D_PartRelation[] relations)
-        {
-            this.parts = parts;
-            this.relations = relations;
+            this.logger.Debug($"Creating HLR for {step3d.FileName}");
 
-            idToPartMap.Clear();
-            idToRelationMap.Clear();
-            partChildren.Clear();  // Constructed at FindChildren() call
-            relatingParts.Clear();
-            relatedParts.Clear();
+            var parts = step3d.Parts;
+            var relations = step3d.Relations;
 
-            // Fill auxiliary helper structures
+            // Occurrences come depth first from each orphan part (main Root),
+            // so the parent row of an occurrence is always created before it
+            var tree = step3d.AssemblyTree;
+            var rows = new Step3DRowData[tree.occurrenceNode.Length];
 
-            foreach (var p in this.parts)
-            {
-                idToPartMap.Add(p.stepId, p);
-            }
+            int nextID = cntOffSet;
 
-            foreach (var r in this.relations)
+            for (int i = 0; i < rows.Length; i++)
             {
-                idToRelationMap.Add(r.stepId, r);
-
-                relatingParts.Add(r.relating_id);
-                relatedParts.Add(r.related_id);
-            }
-        }
-
-        /// <summary>
-        /// Verify if a Part does not belong to any other Part
-        /// </summary>
-        /// <param name="part">A <see cref="STEP3D_Part"/></param>
-        /// <returns>True is not used as related part</returns>
-        private bool IsIsolatedPart(STEP3D_Part part)
-        {
-            return !relatedParts.Contains(part.stepId);
-        }
+                var part = parts[tree.occurrenceNode[i]];
+                var parentIndex = tree.occurrenceParent[i];
 
-        /// <summary>
-        /// Gets Children of a Part.
-        /// </summary>
-        /// <param name="parentId">StepId of a relating Part (parent)</param>
-        /// <returns>List of child Part and PartRelation generating the instance</returns>
-        private List<(STEP3D_Part, STEP3D_PartRelation)> FindChildren(int parentId)
-        {
-            if (!partChildren.ContainsKey(parentId))
-            {
-                // Create cached list the first time is required
-                var childrenRelation = new List<(STEP3D_Part, STEP3D_PartRelation)>();
+                Step3DRowData node;
 
-                foreach (var r in relations)
+                if (parentIndex < 0)
                 {
-                    if (r.relating_id == parentId)
-                    {
-                        childrenRelation.Add((FindPart(r.related_id), r));
-                    }
+                    node = new Step3DRowData(nameDict, part, null) { ID = nextID++ };
                 }
+                else
+                {
+                    var parent = rows[parentIndex];
+                    var relation = relations[tree.occurrenceRelation[i]];
 
-                partChildren.Add(parentId, childrenRelation);
-            }
-
-            return partChildren[parentId];
-        }
-
-        /// <summary>
-        /// Finds the <see cref="STEP3D_Part"/> object from its StepId.
-        /// </summary>
-        /// <param name="partId">Step File Id</param>
-        /// <returns>The <see cref="STEP3D_Part"/> with requested Id</returns>
-        private STEP3D_Part FindPart(int partId)
-        {
-            return idToPartMap[partId];
-        }
+                    node = new Step3DRowData(nameDict, part, relation, parent.InstancePath)
+                    {
+                        ID = nextID++,
+                        Parent = parent,
+                        ParentID = parent.ID,
+                    };
+                }
 
-        /// <summary>
-        /// Adds children of a tree node.
-        /// </summary>
-        /// <param name="entries">Tree container to fill</param>
-        /// <param name="parent">Parent row node</param>
-        /// <param name="nextID">Global tree ID for next creation operation</param>
-        private void AddSubTree(ICollection<Step3DRowData> entries, Step3DRowData parent, ref int nextID)
-        {
-            var children = FindChildren(parent.StepId);
-          
-            foreach (var cr in children)
-            {
-                var child = cr.Item1;
-                var relation = cr.Item2;
-                
-                var node = new Step3DRowData(nameDict,child, relation, parent.InstancePath)
-                {
-                    ID = nextID++,
-                    Parent = parent,
-                    ParentID = parent.ID,
-                    
-                    
-                };            
+                rows[i] = node;
                 entries.Add(node);
-
-                AddSubTree(entries, node, ref nextID);
             }
-            
+
+            return entries;
         }
     }
 }
@@ -28,6 +28,8 @@ namespace STEP3DAdapter.Tests
     using NUnit.Framework;
     using System;
     using System.IO;
+    using System.Threading;
+    using System.Threading.Tasks;
     
 
     
@@ -106,6 +108,181 @@ namespace STEP3DAdapter.Tests
             Assert.AreEqual(MyParts_path, step3d.FileName);
         }
 
+        [TestCase]
+        public async Task LoadExistingFileAsync_Loaded()
+        {
+            var progress = new Progress<float>(p => Assert.That(p, Is.InRange(0, 100)));
+
+            var step3d = await STEP3DFile.LoadAsync(MyParts_path, progress, CancellationToken.None);
+
+            Assert.IsFalse(step3d.HasFailed);
+            Assert.AreEqual(MyParts_path, step3d.FileName);
+            Assert.AreEqual(5, step3d.Parts.Length);
+            Assert.AreEqual(4, step3d.Relations.Length);
+        }
+
+        /// <summary>
+        /// Keeps the reports in the calling thread, <see cref="Progress{T}"/> would post them.
+        /// </summary>
+        private class ProgressRecorder : IProgress<float>
+        {
+            public int Count;
+            public float Last = -1;
+
+            public void Report(float value)
+            {
+                Interlocked.Increment(ref Count);
+                Last = value;
+            }
+        }
+
+        [TestCase]
+        public async Task LoadExistingFileAsync_ProgressReachesTheEnd()
+        {
+            var progress = new ProgressRecorder();
+
+            var step3d = await STEP3DFile.LoadAsync(MyParts_path, progress, CancellationToken.None);
+
+            Assert.IsFalse(step3d.HasFailed);
+            Assert.That(progress.Count, Is.GreaterThan(1));
+            Assert.AreEqual(100, progress.Last);
+        }
+
+        [TestCase]
+        public void LoadExistingFile_PlacementsMatchParts()
+        {
+            var step3d = new STEP3DFile(MyParts_path);
+
+            var placements = step3d.Placements;
+            Assert.AreEqual(step3d.Parts.Length, placements.count);
+
+            for (int i = 0; i < placements.count; i++)
+            {
+                Assert.AreEqual(step3d.Parts[i].stepId, placements.stepId[i]);
+            }
+
+            var zz = placements.Column(STEP3D_PlacementColumn.ROTATION_ZZ);
+            Assert.AreEqual(placements.count, zz.Count);
+            Assert.That(zz, Is.All.EqualTo(1.0).Within(1e-12));
+        }
+
+        [TestCase]
+        public void LoadExistingFile_AssemblyTreeMatchesRelations()
+        {
+            var step3d = new STEP3DFile(MyParts_path);
+
+            var tree = step3d.AssemblyTree;
+            Assert.AreEqual(step3d.Parts.Length, tree.partCount);
+            Assert.AreEqual(step3d.Relations.Length, tree.children.Length);
+            Assert.AreEqual(tree.stepId.Length, tree.topologicalOrder.Length);
+
+            // Part #5 is the only root
+            Assert.AreEqual(new[] { 0 }, tree.roots);
+
+            for (int n = 0; n < tree.partCount; n++)
+            {
+                for (int e = tree.childBegin[n]; e < tree.childBegin[n + 1]; e++)
+                {
+                    var relation = step3d.Relations[tree.childRelation[e]];
+                    Assert.AreEqual(tree.stepId[n], relation.relating_id);
+                    Assert.AreEqual(tree.stepId[tree.children[e]], relation.related_id);
+                }
+            }
+
+            // Root, its 2 children and the 2 children of the sub-assembly
+            Assert.AreEqual(5, tree.occurrenceNode.Length);
+            Assert.AreEqual(-1, tree.occurrenceParent[0]);
+        }
+
+        [TestCase]
+        public void LoadCancelledFileAsync_IsCancelled()
+        {
+            var cancelled = new CancellationToken(true);
+
+            Assert.CatchAsync<OperationCanceledException>(async () => await STEP3DFile.LoadAsync(MyParts_path, null, cancelled));
+            Assert.Catch<OperationCanceledException>(() => new STEP3DFile(MyParts_path, null, cancelled));
+        }
+
+        [TestCase]
+        public void CheckMyPartsLoadStatistics_AreFilled()
+        {
+            var step3d = new STEP3DFile(MyParts_path);
+
+            Assert.IsFalse(step3d.HasFailed);
+
+            var stats = step3d.LoadStatistics;
+
+            Assert.AreEqual(new FileInfo(MyParts_path).Length, stats.file_size);
+            Assert.AreEqual(901, stats.instance_count);
+            Assert.AreEqual(0, stats.error_count);
+
+            // registry, header, data (one pass read), hlr
+            Assert.AreEqual(4, stats.phases.Length);
+            Assert.AreEqual("registry", stats.phases[0].name);
+            Assert.AreEqual("header", stats.phases[1].name);
+            Assert.AreEqual("data", stats.phases[2].name);
+            Assert.AreEqual("hlr", stats.phases[3].name);
+            Assert.AreEqual(stats.file_size, stats.phases[1].bytes + stats.phases[2].bytes, stats.file_size / 10.0);
+
+            long total = 0;
+            foreach (var ec in stats.entity_counts)
+            {
+                total += ec.count;
+            }
+            Assert.AreEqual(stats.instance_count, total);
+
+            string trace = Path.Combine(Path.GetTempPath(), "MyParts_trace.json");
+            Assert.IsTrue(step3d.WriteLoadTrace(trace));
+            StringAssert.StartsWith("{\"traceEvents\"", File.ReadAllText(trace));
+            File.Delete(trace);
+        }
+
+        [TestCase]
+        public void CheckMyPartsSnapshot_IsUsed()
+        {
+            string cacheDir = Path.Combine(Path.GetTempPath(), "STEP3DAdapter_HLRCache");
+            Directory.CreateDirectory(cacheDir);
+            foreach (var f in Directory.GetFiles(cacheDir))
+            {
+                File.Delete(f);
+            }
+
+            STEP3DFile.HLRCacheDirectory = cacheDir;
+            try
+            {
+                var first = new STEP3DFile(MyParts_path);
+                Assert.IsFalse(first.HasFailed);
+                Assert.IsFalse(first.IsLoadedFromCache);
+                Assert.AreEqual(1, Directory.GetFiles(cacheDir).Length);
+
+                var second = new STEP3DFile(MyParts_path);
+                Assert.IsFalse(second.HasFailed);
+                Assert.IsTrue(second.IsLoadedFromCache);
+
+                Assert.AreEqual(first.HeaderInfo.file_schema, second.HeaderInfo.file_schema);
+                Assert.AreEqual(first.Parts.Length, second.Parts.Length);
+                Assert.AreEqual(first.Relations.Length, second.Relations.Length);
+
+                for (int i = 0; i < first.Parts.Length; i++)
+                {
+                    Assert.AreEqual(first.Parts[i].stepId, second.Parts[i].stepId);
+                    Assert.AreEqual(first.Parts[i].name, second.Parts[i].name);
+                    Assert.AreEqual(first.Parts[i].representation_type, second.Parts[i].representation_type);
+                }
+
+                for (int i = 0; i < first.Relations.Length; i++)
+                {
+                    Assert.AreEqual(first.Relations[i].relating_id, second.Relations[i].relating_id);
+                    Assert.AreEqual(first.Relations[i].related_id, second.Relations[i].related_id);
+                }
+            }
+            finally
+            {
+                STEP3DFile.HLRCacheDirectory = null;
+                Directory.Delete(cacheDir, true);
+            }
+        }
+
         [TestCase]
         public void CheckMyPartsFileContent_IsCorrect()
         {
@@ -28,13 +28,48 @@
 
 #include "Tools/Tools.h"
 
+#include <msclr/lock.h>
+#include <string.h>
+
 using namespace STEP3DAdapter;
+using namespace System::Runtime::InteropServices;
+using namespace System::Threading;
+using namespace System::Threading::Tasks;
+
+
+namespace STEP3DAdapter
+{
+    /// <summary>
+    /// Progress callback of IStep3D_Wrapper::loadAsync(), called from its worker thread.
+    /// userData is a GCHandle to the <see cref="STEP3DFile"/> being loaded.
+    /// </summary>
+    static void onLoadProgress(const char* phase, float percent, void* userData)
+    {
+        GCHandle handle = GCHandle::FromIntPtr(IntPtr(userData));
+        STEP3DFile^ file = safe_cast<STEP3DFile^>(handle.Target);
+
+        file->reportLoadProgress(percent);
+
+        if (strcmp(phase, "done") == 0)
+        {
+            handle.Free();
+            file->completeLoad();
+        }
+    }
+}
+
+STEP3DFile::STEP3DFile()
+{
+    initializeEmpty();
+
+    createWrapper();
+}
 
 STEP3DFile::STEP3DFile(String^ fileName)
 {
     initializeEmpty();
 
-    m_wrapper = CreateIStep3D_Wrapper();
+    createWrapper();
 
     if (m_wrapper->load(STEP3DAdapter::Tools::toStdString(fileName)))
     {
@@ -44,6 +79,8 @@ STEP3DFile::STEP3DFile(String^ fileName)
             convertHeaderInfo();
             convertParts();
             convertPartRelations();
+            convertPlacements();
+            convertAssemblyTree();
         }
         else
         {
@@ -54,16 +91,130 @@ STEP3DFile::STEP3DFile(String^ fileName)
     {
         // TODO: exception? user checks HasFailed
     }
+
+    convertLoadStatistics();
+}
+
+STEP3DFile::STEP3DFile(String^ fileName, IProgress<float>^ progress, CancellationToken cancellationToken)
+{
+    initializeEmpty();
+
+    cancellationToken.ThrowIfCancellationRequested();
+
+    createWrapper();
+
+    try
+    {
+        startLoad(fileName, progress, cancellationToken)->GetAwaiter().GetResult();
+    }
+    catch (OperationCanceledException^)
+    {
+        m_wrapper->Release();
+        m_wrapper = nullptr;
+
+        throw;
+    }
+}
+
+Task<STEP3DFile^>^ STEP3DFile::LoadAsync(String^ fileName, IProgress<float>^ progress, CancellationToken cancellationToken)
+{
+    if (cancellationToken.IsCancellationRequested)
+    {
+        return Task::FromCanceled<STEP3DFile^>(cancellationToken);
+    }
+
+    STEP3DFile^ file = gcnew STEP3DFile();
+
+    return file->startLoad(fileName, progress, cancellationToken);
+}
+
+Task<STEP3DFile^>^ STEP3DFile::startLoad(String^ fileName, IProgress<float>^ progress, CancellationToken cancellationToken)
+{
+    // The callback completes the task on the worker thread of the wrapper,
+    // the continuations must not run there: they could release the wrapper
+    m_loadCompletion = gcnew TaskCompletionSource<STEP3DFile^>(TaskCreationOptions::RunContinuationsAsynchronously);
+    m_loadProgress = progress;
+    m_loadCancellationToken = cancellationToken;
+
+    // Keeps this file alive until the end of the load, freed by the callback
+    GCHandle handle = GCHandle::Alloc(this);
+
+    m_wrapper->loadAsync(STEP3DAdapter::Tools::toStdString(fileName), &onLoadProgress, GCHandle::ToIntPtr(handle).ToPointer());
+
+    // loadAsync() clears the cancel request of the wrapper, so the token is registered after it.
+    // A load that has already completed has nothing left to cancel.
+    msclr::lock guard(m_loadCompletion);
+    if (!m_loadCompletion->Task->IsCompleted)
+    {
+        m_loadCancellation = cancellationToken.Register(gcnew Action(this, &STEP3DFile::cancelLoad));
+    }
+
+    return m_loadCompletion->Task;
+}
+
+void STEP3DFile::cancelLoad()
+{
+    m_wrapper->cancel();
+}
+
+void STEP3DFile::reportLoadProgress(float percent)
+{
+    if (m_loadProgress != nullptr)
+    {
+        m_loadProgress->Report(percent);
+    }
+}
+
+void STEP3DFile::completeLoad()
+{
+    msclr::lock guard(m_loadCompletion);
+
+    // Waits for a running cancelLoad(), none starts afterwards
+    m_loadCancellation.Dispose();
+
+    // The load may end before the token was ever looked at by the wrapper
+    if (m_wrapper->getError() == WrapperErrorCode::CANCELLED || m_loadCancellationToken.IsCancellationRequested)
+    {
+        m_loadCompletion->TrySetCanceled(m_loadCancellationToken);
+        return;
+    }
+
+    try
+    {
+        if (!m_wrapper->hasFailed())
+        {
+            // Convert into managed objects
+            convertHeaderInfo();
+            convertParts();
+            convertPartRelations();
+            convertPlacements();
+            convertAssemblyTree();
+        }
+
+        convertLoadStatistics();
+    }
+    catch (Exception^ e)
+    {
+        m_loadCompletion->TrySetException(e);
+        return;
+    }
+
+    m_loadCompletion->TrySetResult(this);
 }
 
 STEP3DFile::~STEP3DFile() 
 {
-    m_wrapper->Release();
+    this->!STEP3DFile();
 }
 
 STEP3DFile::!STEP3DFile()
 {
-    m_wrapper->Release();
+    // Released already when the constructor was cancelled
+    if (m_wrapper != nullptr)
+    {
+        m_wrapper->Release();
+        m_wrapper = nullptr;
+    }
 }
 
 void STEP3DAdapter::STEP3DFile::initializeEmpty()
@@ -71,12 +222,27 @@ void STEP3DAdapter::STEP3DFile::initializeEmpty()
     m_headerInfo = gcnew STEP3D_HeaderInfo();
     m_parts = gcnew array<STEP3D_Part^>(0);
     m_relations = gcnew array<STEP3D_PartRelation^>(0);
+    m_placements = gcnew STEP3D_PlacementTable();
+    m_placements->stepId = gcnew array<int>(0);
+    m_placements->values = gcnew array<double>(0);
+    m_assemblyTree = createAssemblyTree(Step3D_AssemblyTree_Wrapper());
+    m_loadStatistics = gcnew STEP3D_LoadStatistics();
+    m_loadStatistics->phases = gcnew array<STEP3D_PhaseStatistics^>(0);
+    m_loadStatistics->entity_counts = gcnew array<STEP3D_EntityCount^>(0);
+}
+
+bool STEP3DAdapter::STEP3DFile::WriteLoadTrace(String^ fileName)
+{
+    return m_wrapper->writeLoadTrace(Tools::toStdString(fileName));
 }
 
 void STEP3DAdapter::STEP3DFile::convertHeaderInfo()
 {
-    auto hi = m_wrapper->getHeaderInfo();
+    m_headerInfo = createHeaderInfo(m_wrapper->getHeaderInfo());
+}
 
+STEP3D_HeaderInfo^ STEP3DAdapter::STEP3DFile::createHeaderInfo(const Step3D_HeaderInfo_Wrapper& hi)
+{
     STEP3D_HeaderInfo^ info = gcnew STEP3D_HeaderInfo();
 
     info->file_description = gcnew STEP3D_File_Description();
@@ -104,7 +270,51 @@ void STEP3DAdapter::STEP3DFile::convertHeaderInfo()
     
     info->file_schema = Tools::toCleanString(hi.file_schema);
 
-    m_headerInfo = info;
+    return info;
+}
+
+STEP3D_FileSummary^ STEP3DAdapter::STEP3DFile::createFileSummary(const Step3D_ProbeInfo_Wrapper& pi)
+{
+    STEP3D_FileSummary^ summary = gcnew STEP3D_FileSummary();
+
+    summary->path                     = Tools::toString(pi.filename);
+    summary->header_info              = createHeaderInfo(pi.header);
+    summary->file_size                = pi.file_size;
+    summary->estimated_instance_count = pi.estimated_instance_count;
+    summary->has_failed               = pi.error != WrapperErrorCode::NO_ERROR;
+    summary->error_message            = Tools::toString(pi.error_message);
+
+    return summary;
+}
+
+STEP3D_FileSummary^ STEP3DFile::Probe(String^ fileName)
+{
+    IStep3D_Probe_Wrapper* probe = CreateIStep3D_Probe_Wrapper();
+
+    probe->probe(Tools::toStdString(fileName));
+    STEP3D_FileSummary^ summary = createFileSummary(probe->getResults().front());
+
+    probe->Release();
+    return summary;
+}
+
+array<STEP3D_FileSummary^>^ STEP3DFile::ProbeDirectory(String^ directory)
+{
+    IStep3D_Probe_Wrapper* probe = CreateIStep3D_Probe_Wrapper();
+
+    probe->probeDirectory(Tools::toStdString(directory));
+    auto results = probe->getResults();
+    probe->Release();
+
+    array<STEP3D_FileSummary^>^ summaries = gcnew array<STEP3D_FileSummary^>((int)results.size());
+
+    int i = 0;
+    for (const auto& pi : results)
+    {
+        summaries[i++] = createFileSummary(pi);
+    }
+
+    return summaries;
 }
 
 void STEP3DAdapter::STEP3DFile::convertParts()
@@ -139,6 +349,122 @@ void STEP3DAdapter::STEP3DFile::convertPartRelations()
     m_relations = partRelations;
 }
 
+void STEP3DAdapter::STEP3DFile::convertPlacements()
+{
+    auto table = m_wrapper->getPlacementTable();
+
+    STEP3D_PlacementTable^ placements = gcnew STEP3D_PlacementTable();
+
+    placements->count = (int)table.count;
+    placements->stepId = gcnew array<int>((int)table.stepId.size());
+    placements->values = gcnew array<double>((int)table.values.size());
+
+    // Whole columns at once, no per row conversion
+    if (table.count > 0)
+    {
+        Marshal::Copy(IntPtr(table.stepId.data()), placements->stepId, 0, placements->stepId->Length);
+        Marshal::Copy(IntPtr(table.values.data()), placements->values, 0, placements->values->Length);
+    }
+
+    m_placements = placements;
+}
+
+void STEP3DAdapter::STEP3DFile::convertAssemblyTree()
+{
+    m_assemblyTree = createAssemblyTree(m_wrapper->getAssemblyTree());
+}
+
+void STEP3DAdapter::STEP3DFile::createWrapper()
+{
+    m_wrapper = CreateIStep3D_Wrapper();
+
+    String^ directory = s_hlrCacheDirectory;
+    if (directory != nullptr)
+    {
+        m_wrapper->setHLRCache(true, STEP3DAdapter::Tools::toStdString(directory));
+    }
+}
+
+void STEP3DAdapter::STEP3DFile::convertLoadStatistics()
+{
+    auto ls = m_wrapper->getLoadStatistics();
+
+    STEP3D_LoadStatistics^ stats = gcnew STEP3D_LoadStatistics();
+
+    stats->file_size      = ls.file_size;
+    stats->instance_count = ls.instance_count;
+    stats->peak_memory_kb = ls.peak_memory_kb;
+    stats->error_count    = ls.error_count;
+    stats->warning_count  = ls.warning_count;
+
+    stats->phases = gcnew array<STEP3D_PhaseStatistics^>((int)ls.phases.size());
+
+    int i = 0;
+    for (const Step3D_PhaseStats_Wrapper& ps : ls.phases)
+    {
+        STEP3D_PhaseStatistics^ phase = gcnew STEP3D_PhaseStatistics();
+
+        phase->name       = Tools::toString(ps.name);
+        phase->start      = ps.start;
+        phase->wall_time  = ps.wall_time;
+        phase->cpu_time   = ps.cpu_time;
+        phase->bytes      = ps.bytes;
+        phase->heap_delta = ps.heap_delta;
+        phase->memory_kb  = ps.memory_kb;
+
+        stats->phases[i++] = phase;
+    }
+
+    stats->entity_counts = gcnew array<STEP3D_EntityCount^>((int)ls.entity_counts.size());
+
+    i = 0;
+    for (const Step3D_EntityCount_Wrapper& ec : ls.entity_counts)
+    {
+        STEP3D_EntityCount^ entityCount = gcnew STEP3D_EntityCount();
+
+        entityCount->type  = Tools::toString(ec.type);
+        entityCount->count = ec.count;
+
+        stats->entity_counts[i++] = entityCount;
+    }
+
+    m_loadStatistics = stats;
+}
+
+/// <summary>
+/// Copy an index array in one block.
+/// </summary>
+static array<int>^ toArray(const std::vector<int>& v)
+{
+    array<int>^ a = gcnew array<int>((int)v.size());
+
+    if (!v.empty())
+    {
+        Marshal::Copy(IntPtr((void*)v.data()), a, 0, a->Length);
+    }
+
+    return a;
+}
+
+STEP3D_AssemblyTree^ STEP3DAdapter::STEP3DFile::createAssemblyTree(const Step3D_AssemblyTree_Wrapper& tree)
+{
+    STEP3D_AssemblyTree^ assemblyTree = gcnew STEP3D_AssemblyTree();
+
+    assemblyTree->partCount = (int)tree.partCount;
+    assemblyTree->stepId = toArray(tree.stepId);
+    assemblyTree->childBegin = toArray(tree.childBegin);
+    assemblyTree->children = toArray(tree.children);
+    assemblyTree->childRelation = toArray(tree.childRelation);
+    assemblyTree->parentCount = toArray(tree.parentCount);
+    assemblyTree->roots = toArray(tree.roots);
+    assemblyTree->topologicalOrder = toArray(tree.topologicalOrder);
+    assemblyTree->occurrenceNode = toArray(tree.occurrenceNode);
+    assemblyTree->occurrenceParent = toArray(tree.occurrenceParent);
+    assemblyTree->occurrenceRelation = toArray(tree.occurrenceRelation);
+
+    return assemblyTree;
+}
+
 STEP3D_Part^ STEP3DAdapter::STEP3DFile::createPart(const Part_Wrapper& pw)
 {
     STEP3D_Part^ part = gcnew STEP3D_Part();
@@ -147,7 +473,7 @@ STEP3D_Part^ STEP3DAdapter::STEP3DFile::createPart(const Part_Wrapper& pw)
     part->name = Tools::toUnquotedString(pw.name);
     part->type = Tools::toString(pw.type);
 
-    // TODO: add Placement
+    // Placement: see convertPlacements()
 
     part->representation_type = Tools::toString(pw.representation_type);
     
@@ -110,6 +110,118 @@ namespace STEP3DAdapter
 #endif
     };
 
+    /// <summary>
+    /// Managed version of <c>PlacementColumn</c> enum.
+    /// </summary>
+    public enum class STEP3D_PlacementColumn
+    {
+        LOCATION_X = 0, LOCATION_Y, LOCATION_Z,
+        AXIS_X, AXIS_Y, AXIS_Z,
+        REF_DIRECTION_X, REF_DIRECTION_Y, REF_DIRECTION_Z,
+        ROTATION_XX, ROTATION_XY, ROTATION_XZ,
+        ROTATION_YX, ROTATION_YY, ROTATION_YZ,
+        ROTATION_ZX, ROTATION_ZY, ROTATION_ZZ,
+        COUNT
+    };
+
+    /// <summary>
+    /// Managed version of <c>Step3D_PlacementTable_Wrapper</c> struct.
+    /// 
+    /// Row i is the placement of Parts[i]; the values are stored column
+    /// after column, see <see cref="Column"/>.
+    /// </summary>
+    public ref struct STEP3D_PlacementTable
+    {
+        int count;              //!< Number of rows (parts)
+        array<int>^ stepId;     //!< PD.stepId of each row
+        array<double>^ values;  //!< STEP3D_PlacementColumn::COUNT columns of count values
+
+        /// <summary>
+        /// Gets a column of the table, without copying it.
+        /// </summary>
+        /// <param name="c">the column</param>
+        /// <returns>
+        /// The count values of the column in <see cref="values"/>.
+        /// </returns>
+        ArraySegment<double> Column(STEP3D_PlacementColumn c)
+        {
+            return ArraySegment<double>(values, (int)c * count, count);
+        }
+    };
+
+    /// <summary>
+    /// Managed version of <c>Step3D_AssemblyTree_Wrapper</c> struct.
+    /// 
+    /// Node i &lt; partCount is Parts[i]; the children of node n are
+    /// children[childBegin[n] .. childBegin[n+1]). Occurrences are listed
+    /// depth first, a parent before its children.
+    /// </summary>
+    public ref struct STEP3D_AssemblyTree
+    {
+        int partCount;                      //!< Nodes which are parts, they come first
+        array<int>^ stepId;                 //!< PD.stepId of each node
+        array<int>^ childBegin;             //!< Node count + 1 offsets into children
+        array<int>^ children;               //!< Child node of each relation, grouped by parent
+        array<int>^ childRelation;          //!< Index in Relations of each children entry
+        array<int>^ parentCount;            //!< Relations with the node as child
+        array<int>^ roots;                  //!< Parts without parent, in node order
+        array<int>^ topologicalOrder;       //!< Parents before their children; without the nodes in or below a cycle
+        array<int>^ occurrenceNode;         //!< Part node of each occurrence
+        array<int>^ occurrenceParent;       //!< Occurrence of the parent, -1 for a root
+        array<int>^ occurrenceRelation;     //!< Index in Relations creating the occurrence, -1 for a root
+    };
+
+    /// <summary>
+    /// Managed version of <c>Step3D_PhaseStats_Wrapper</c> struct.
+    /// </summary>
+    public ref struct STEP3D_PhaseStatistics
+    {
+        String^ name;           //!< Phase name (registry, header, pass1, pass2, data, hlr)
+        double start;           //!< Start, in seconds from the beginning of the load
+        double wall_time;       //!< Elapsed time in seconds
+        double cpu_time;        //!< User and system CPU time in seconds
+        long long bytes;        //!< Bytes of the file read by the phase
+        long long heap_delta;   //!< Change of the heap in use, in bytes (-1 if not available)
+        long memory_kb;         //!< Process memory at the end of the phase, in KB
+    };
+
+    /// <summary>
+    /// Managed version of <c>Step3D_EntityCount_Wrapper</c> struct.
+    /// </summary>
+    public ref struct STEP3D_EntityCount
+    {
+        String^ type;           //!< ENTITY TYPE (STEP class name)
+        long count;             //!< Instances in the DATA section
+    };
+
+    /// <summary>
+    /// Managed version of <c>Step3D_LoadStats_Wrapper</c> struct.
+    /// </summary>
+    public ref struct STEP3D_LoadStatistics
+    {
+        array<STEP3D_PhaseStatistics^>^ phases;      //!< Phases done, in order
+        array<STEP3D_EntityCount^>^ entity_counts;   //!< Instances per entity type, most frequent first
+
+        long long file_size;    //!< Size of the loaded file
+        long instance_count;    //!< Instances in the DATA section
+        long peak_memory_kb;    //!< Highest memory_kb of the phases
+        int error_count;        //!< Errors reported by the STEP reader
+        int warning_count;      //!< Warnings reported by the STEP reader
+    };
+
+    /// <summary>
+    /// Managed version of <c>Step3D_ProbeInfo_Wrapper</c> struct.
+    /// </summary>
+    public ref struct STEP3D_FileSummary
+    {
+        String^ path;                       //!< Full path to the file
+        STEP3D_HeaderInfo^ header_info;     //!< Information from the HEADER section
+        long long file_size;                //!< Size of the file
+        long estimated_instance_count;      //!< Highest instance id at the end of the DATA section, 0 if none was found
+        bool has_failed;                    //!< The HEADER section could not be read
+        String^ error_message;              //!< Empty if the HEADER section was read
+    };
+
     /// <summary>
     /// The <see cref="STEP3DFile"/> class is a C++/.NET wrapper which provides
     /// access to the content of a STEP3D (Application Protocol 242) provided
@@ -131,6 +243,30 @@ namespace STEP3DAdapter
         /// <param name="fileName">full path to STEP3D file (.step|.stp)</param>
         STEP3DFile(String^ fileName);
 
+        /// <summary>
+        /// Initializes a new instance of the <see cref="STEP3DFile"/> class,
+        /// reporting the progress and honoring a cancellation request.
+        /// 
+        /// The file is read by a worker thread of step3d_wrapper.dll, this
+        /// constructor waits for it. Progress is reported from the worker thread.
+        /// </summary>
+        /// <param name="fileName">full path to STEP3D file (.step|.stp)</param>
+        /// <param name="progress">receives the overall progress (0 to 100), can be null</param>
+        /// <param name="cancellationToken">stops the reading or the parsing</param>
+        /// <exception cref="OperationCanceledException">when the token is cancelled before or during the load</exception>
+        STEP3DFile(String^ fileName, IProgress<float>^ progress, System::Threading::CancellationToken cancellationToken);
+
+        /// <summary>
+        /// Loads a STEP3D file on a background task.
+        /// </summary>
+        /// <param name="fileName">full path to STEP3D file (.step|.stp)</param>
+        /// <param name="progress">receives the overall progress (0 to 100), can be null</param>
+        /// <param name="cancellationToken">stops the reading or the parsing, the task is then cancelled</param>
+        /// <returns>
+        /// The task creating the <see cref="STEP3DFile"/>; check HasFailed on its result.
+        /// </returns>
+        static System::Threading::Tasks::Task<STEP3DFile^>^ LoadAsync(String^ fileName, IProgress<float>^ progress, System::Threading::CancellationToken cancellationToken);
+
         ~STEP3DFile();
 
         !STEP3DFile();
@@ -210,6 +346,112 @@ namespace STEP3DAdapter
             }
         }
 
+        /// <summary>
+        /// Returns the assembly structure of the parts: children of each part,
+        /// roots, topological order and the occurrences of the expanded tree.
+        /// </summary>
+        /// <returns>
+        /// An instance of <see cref="STEP3D_AssemblyTree"/> struct.
+        /// </returns>
+        property STEP3D_AssemblyTree^ AssemblyTree
+        {
+            STEP3D_AssemblyTree^ get()
+            {
+                return m_assemblyTree;
+            }
+        }
+
+        /// <summary>
+        /// Returns the placements of the parts, in the order of <see cref="Parts"/>,
+        /// with their rotation matrices.
+        /// </summary>
+        /// <returns>
+        /// An instance of <see cref="STEP3D_PlacementTable"/> struct.
+        /// </returns>
+        property STEP3D_PlacementTable^ Placements
+        {
+            STEP3D_PlacementTable^ get()
+            {
+                return m_placements;
+            }
+        }
+
+        /// <summary>
+        /// Gets the time and memory used by each phase of the load.
+        /// </summary>
+        /// <returns>
+        /// An instance of <see cref="STEP3D_LoadStatistics"/> struct.
+        /// </returns>
+        property STEP3D_LoadStatistics^ LoadStatistics
+        {
+            STEP3D_LoadStatistics^ get()
+            {
+                return m_loadStatistics;
+            }
+        }
+
+        /// <summary>
+        /// Writes the phases of the load as a Chrome trace (chrome://tracing).
+        /// 
+        /// Setting the STEP3D_TRACE environment variable to a file name
+        /// also writes it, when the instance is disposed.
+        /// </summary>
+        /// <param name="fileName">full path to the .json file to write</param>
+        /// <returns>
+        /// True if the file was written.
+        /// </returns>
+        bool WriteLoadTrace(String^ fileName);
+
+        /// <summary>
+        /// Gets a value indicating whether the HLR information was read
+        /// from its snapshot instead of the STEP file.
+        /// </summary>
+        property bool IsLoadedFromCache
+        {
+            bool get()
+            {
+                return m_wrapper != nullptr && m_wrapper->isLoadedFromCache();
+            }
+        }
+
+        /// <summary>
+        /// Gets or sets where the snapshots of the HLR information are stored,
+        /// used by the instances created afterwards.
+        /// 
+        /// Null disables the snapshots (default), an empty string stores them
+        /// next to the STEP files (file.step.hlr).
+        /// </summary>
+        static property String^ HLRCacheDirectory
+        {
+            String^ get()
+            {
+                return s_hlrCacheDirectory;
+            }
+            void set(String^ value)
+            {
+                s_hlrCacheDirectory = value;
+            }
+        }
+
+        /// <summary>
+        /// Reads the HEADER section of a STEP3D file, without loading it.
+        /// </summary>
+        /// <param name="fileName">full path to STEP3D file (.step|.stp)</param>
+        /// <returns>
+        /// An instance of <see cref="STEP3D_FileSummary"/> struct; check its has_failed.
+        /// </returns>
+        static STEP3D_FileSummary^ Probe(String^ fileName);
+
+        /// <summary>
+        /// Reads the HEADER section of the STEP3D files of a directory, in parallel.
+        /// </summary>
+        /// <param name="directory">full path to the directory, not searched recursively</param>
+        /// <returns>
+        /// An array of <see cref="STEP3D_FileSummary"/> struct sorted by file name,
+        /// empty if the directory cannot be read.
+        /// </returns>
+        static array<STEP3D_FileSummary^>^ ProbeDirectory(String^ directory);
+
         /// <summary>
         /// The step3d_wrapper.dll contains information about the version
         /// containing also the build datetime.
@@ -225,6 +467,19 @@ namespace STEP3DAdapter
             }
         }
 
+    internal:
+        /// <summary>
+        /// Reports the progress of the load to the <see cref="IProgress"/> given to it.
+        /// Called by the progress callback of the wrapper, from its worker thread.
+        /// </summary>
+        void reportLoadProgress(float percent);
+
+        /// <summary>
+        /// Completes the task of the load, with this file or as cancelled.
+        /// Called by the progress callback of the wrapper at the end of the load.
+        /// </summary>
+        void completeLoad();
+
     private:
         /// <summary>
         /// Unmanaged reference to <see cref="ISTEP3D_Wrapper"/> obtained from step3d_wrapper.dll.
@@ -248,16 +503,103 @@ namespace STEP3DAdapter
         /// </summary>
         array<STEP3D_PartRelation^>^ m_relations;
 
+        /// <summary>
+        /// Managed assembly structure of the parts.
+        /// </summary>
+        STEP3D_AssemblyTree^ m_assemblyTree;
+
+        /// <summary>
+        /// Managed table of the placements of the parts.
+        /// </summary>
+        STEP3D_PlacementTable^ m_placements;
+
+        /// <summary>
+        /// Managed struct of the load statistics.
+        /// </summary>
+        STEP3D_LoadStatistics^ m_loadStatistics;
+
+        /// <summary>
+        /// Snapshot directory given to the new wrappers. @see HLRCacheDirectory
+        /// </summary>
+        static String^ s_hlrCacheDirectory;
+
+        /// <summary>
+        /// Task of the load started by <see cref="startLoad"/>, completed by <see cref="completeLoad"/>.
+        /// Also locks the registration of the cancellation against the end of the load.
+        /// </summary>
+        System::Threading::Tasks::TaskCompletionSource<STEP3DFile^>^ m_loadCompletion;
+
+        /// <summary>
+        /// Receives the progress of the load, can be null.
+        /// </summary>
+        IProgress<float>^ m_loadProgress;
+
+        /// <summary>
+        /// Token of the load, and the registration of <see cref="cancelLoad"/> on it.
+        /// </summary>
+        System::Threading::CancellationToken m_loadCancellationToken;
+        System::Threading::CancellationTokenRegistration m_loadCancellation;
+
+        /// <summary>
+        /// Initializes an empty file, with its wrapper, for <see cref="LoadAsync"/>.
+        /// </summary>
+        STEP3DFile();
+
+        /// <summary>
+        /// Starts the load of the wrapper on its worker thread.
+        /// </summary>
+        /// <returns>
+        /// The task completed with this file at the end of the load, or cancelled.
+        /// </returns>
+        System::Threading::Tasks::Task<STEP3DFile^>^ startLoad(String^ fileName, IProgress<float>^ progress, System::Threading::CancellationToken cancellationToken);
+
+        /// <summary>
+        /// Asks the wrapper to stop the load, registered on the token.
+        /// </summary>
+        void cancelLoad();
+
         /// <summary>
         /// Initialize instance
         /// </summary>
         void initializeEmpty();
 
+        /// <summary>
+        /// Create the unmanaged wrapper with the current snapshot settings.
+        /// </summary>
+        void createWrapper();
+
         /// <summary>
         /// Convert from unmanaged to managed data.
         /// </summary>
         void convertHeaderInfo();
 
+        /// <summary>
+        /// Creates the managed struct for a Step3D_HeaderInfo_Wrapper.
+        /// </summary>
+        /// <param name="hi">Information from the HEADER section</param>
+        /// <returns>
+        /// An instance of <see cref="STEP3D_HeaderInfo"/> struct.
+        /// </returns>
+        static STEP3D_HeaderInfo^ createHeaderInfo(const Step3D_HeaderInfo_Wrapper& hi);
+
+        /// <summary>
+        /// Creates the managed struct for a Step3D_ProbeInfo_Wrapper.
+        /// </summary>
+        /// <param name="pi">Summary of a probed file</param>
+        /// <returns>
+        /// An instance of <see cref="STEP3D_FileSummary"/> struct.
+        /// </returns>
+        static STEP3D_FileSummary^ createFileSummary(const Step3D_ProbeInfo_Wrapper& pi);
+
+        /// <summary>
+        /// Creates the managed struct for a Step3D_AssemblyTree_Wrapper.
+        /// </summary>
+        /// <param name="tree">Assembly structure of the parts</param>
+        /// <returns>
+        /// An instance of <see cref="STEP3D_AssemblyTree"/> struct.
+        /// </returns>
+        static STEP3D_AssemblyTree^ createAssemblyTree(const Step3D_AssemblyTree_Wrapper& tree);
+
         /// <summary>
         /// Convert from unmanaged to managed data.
         /// </summary>
@@ -268,6 +610,21 @@ namespace STEP3DAdapter
         /// </summary>
         void convertPartRelations();
 
+        /// <summary>
+        /// Convert from unmanaged to managed data.
+        /// </summary>
+        void convertPlacements();
+
+        /// <summary>
+        /// Convert from unmanaged to managed data.
+        /// </summary>
+        void convertAssemblyTree();
+
+        /// <summary>
+        /// Convert from unmanaged to managed data.
+        /// </summary>
+        void convertLoadStatistics();
+
         /// <summary>
         /// Creates a managed struct for a Part_Wrapper.
         /// </summary>
@@ -78,11 +78,23 @@ macro(SCHEMA_TARGETS expFile schemaName sourceFiles)
   message(STATUS "Will generate ${${PROJECT_NAME}_file_count} C++ files for ${PROJECT_NAME}.")
 
   add_custom_target(generate_cpp_${PROJECT_NAME} DEPENDS exp2cxx ${expFile} ${sourceFiles} SOURCES ${sourceFiles})
+  if(SC_LAYOUT_TABLES AND SC_ATTR_READERS)
+    set(EXP2CXX_FLAGS "-tu")
+  elseif(SC_LAYOUT_TABLES)
+    set(EXP2CXX_FLAGS "-t")
+  else(SC_LAYOUT_TABLES AND SC_ATTR_READERS)
+    set(EXP2CXX_FLAGS "")
+  endif(SC_LAYOUT_TABLES AND SC_ATTR_READERS)
+  if(SC_EXPRESS_CACHE)
+    set(EXP2CXX_CACHE "${SC_BINARY_DIR}/express_cache")
+  else(SC_EXPRESS_CACHE)
+    set(EXP2CXX_CACHE "")
+  endif(SC_EXPRESS_CACHE)
   # this calls a cmake script because it doesn't seem to be possible
   # to divert stdout, stderr in cmake except via execute_process
   add_custom_command(OUTPUT ${sourceFiles}
-    COMMAND ${CMAKE_COMMAND} -DEXE=\"$<TARGET_FILE:exp2cxx>\"  -DEXP=\"${expFile}\"
-    -DONESHOT=\"${SC_GENERATE_CXX_ONESHOT}\" -DSDIR=\"${CMAKE_CURRENT_LIST_DIR}\"
+    COMMAND ${CMAKE_COMMAND} -DEXE=\"$<TARGET_FILE:exp2cxx>\"  -DEXP=\"${expFile}\" -DFLAGS=\"${EXP2CXX_FLAGS}\"
+    -DCACHE_DIR=\"${EXP2CXX_CACHE}\" -DONESHOT=\"${SC_GENERATE_CXX_ONESHOT}\" -DSDIR=\"${CMAKE_CURRENT_LIST_DIR}\"
     -P ${SC_CMAKE_DIR}/SC_Run_exp2cxx.cmake
     WORKING_DIRECTORY ${CMAKE_CURRENT_LIST_DIR}
     COMMENT "[exp2cxx] Generating ${${PROJECT_NAME}_file_count} C++ files for ${PROJECT_NAME}."
@@ -4,6 +4,7 @@ include(CheckLibraryExists)
 include(CheckIncludeFile)
 include(CheckSymbolExists)
 include(CheckTypeSize)
+include(CheckStructHasMember)
 include(CMakePushCheckState)
 include(CheckCSourceCompiles)
 include(CheckCXXSourceRuns)
@@ -29,6 +30,9 @@ CHECK_SYMBOL_EXISTS(vsnprintf "stdio.h" HAVE_VSNPRINTF)
 
 CHECK_TYPE_SIZE("ssize_t" SSIZE_T)
 
+# nanosecond modification times, for STEPfile::KeepSourceRecords(); C++, as -std=c11 hides st_mtim
+CHECK_STRUCT_HAS_MEMBER("struct stat" st_mtim "sys/stat.h" HAVE_STAT_ST_MTIM LANGUAGE CXX)
+
 if(SC_ENABLE_CXX11)
   set( TEST_STD_THREAD "
 #include <iostream>
@@ -4,7 +4,11 @@ if(ONESHOT AND EXISTS "${SDIR}/schema.cc")
   message("WARNING: SC_GENERATE_CXX_ONESHOT is enabled. If generated code has been modified, it will NOT be rewritten!")
   message("This is ONLY for debugging STEPcode internals!")
 else()
-  execute_process(COMMAND ${EXE} ${EXP}
+  # the schema scanner stores the resolved schema in CACHE_DIR, so exp2cxx needn't parse it again
+  if(CACHE_DIR)
+    set(FLAGS ${FLAGS} -C ${CACHE_DIR})
+  endif(CACHE_DIR)
+  execute_process(COMMAND ${EXE} ${FLAGS} ${EXP}
     WORKING_DIRECTORY ${SDIR}
     RESULT_VARIABLE _res
     OUTPUT_FILE exp2cxx_stdout.txt
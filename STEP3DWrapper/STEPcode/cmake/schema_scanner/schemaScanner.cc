@@ -17,6 +17,7 @@ extern "C" {
 #  include "expparse.h"
 #  include "expscan.h"
 #  include "express/scope.h"
+#  include "express/cache.h"
 #  include "genCxxFilenames.h"
 #  include "sc_mkdir.h"
 
@@ -301,29 +302,44 @@ int main( int argc, char ** argv ) {
     DictionaryEntry de;
     /* copied from fedex.c */
     Express model;
-    if( ( argc != 2 ) || ( strlen( argv[1] ) < 1 ) ) {
-        fprintf( stderr, "\nUsage: %s file.exp\nOutput: a CMakeLists.txt to build the schema,", argv[0] );
+    const char * cache_dir = 0;
+    if( ( argc < 2 ) || ( argc > 3 ) || ( strlen( argv[1] ) < 1 ) ) {
+        fprintf( stderr, "\nUsage: %s file.exp [cache_dir]\nOutput: a CMakeLists.txt to build the schema,", argv[0] );
         fprintf( stderr, " containing file names for entities, types, etc\n" );
         fprintf( stderr, "also prints (to stdout) the absolute path to the directory CMakeLists.txt was created in\n" );
+        fprintf( stderr, "if cache_dir is given, the resolved schema is stored there for exp2cxx -C\n" );
         exit( EXIT_FAILURE );
     }
     EXPRESSprogram_name = argv[0];
     input_filename = argv[1];
+    if( argc == 3 ) {
+        cache_dir = argv[2];
+    }
 
     EXPRESSinitialize();
 
-    model = EXPRESScreate();
-    EXPRESSparse( model, ( FILE * )0, input_filename );
-    if( ERRORoccurred ) {
-        EXPRESSdestroy( model );
-        exit( EXIT_FAILURE );
+    if( cache_dir ) {
+        model = CACHEload( cache_dir, input_filename );
+    } else {
+        model = 0;
     }
-    EXPRESSresolve( model );
-    if( ERRORoccurred ) {
-        int result = EXPRESS_fail( model );
-        EXPRESScleanup();
-        EXPRESSdestroy( model );
-        exit( result );
+    if( !model ) {
+        model = EXPRESScreate();
+        EXPRESSparse( model, ( FILE * )0, input_filename );
+        if( ERRORoccurred ) {
+            EXPRESSdestroy( model );
+            exit( EXIT_FAILURE );
+        }
+        EXPRESSresolve( model );
+        if( ERRORoccurred ) {
+            int result = EXPRESS_fail( model );
+            EXPRESScleanup();
+            EXPRESSdestroy( model );
+            exit( result );
+        }
+        if( cache_dir && !CACHEstore( cache_dir, input_filename, model ) ) {
+            fprintf( stderr, "%s: could not write the cache for %s to %s\n", EXPRESSprogram_name, input_filename, cache_dir );
+        }
     }
 
     DICTdo_type_init( model->symbol_table, &de, OBJ_SCHEMA );
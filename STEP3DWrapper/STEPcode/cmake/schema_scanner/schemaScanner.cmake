@@ -82,7 +82,12 @@ endif(WIN32)
 # SCHEMA_FILE - path to the schema
 # TODO should we have a result variable to return schema name(s) found?
 macro(SCHEMA_CMLIST SCHEMA_FILE)
-  execute_process(COMMAND ${SCANNER_OUT_DIR}/schema_scanner ${SCHEMA_FILE}
+  if(SC_EXPRESS_CACHE)
+    set(_ss_cache "${SC_BINARY_DIR}/express_cache")
+  else(SC_EXPRESS_CACHE)
+    set(_ss_cache "")
+  endif(SC_EXPRESS_CACHE)
+  execute_process(COMMAND ${SCANNER_OUT_DIR}/schema_scanner ${SCHEMA_FILE} ${_ss_cache}
                    WORKING_DIRECTORY ${SC_BINARY_DIR}/schemas
                    RESULT_VARIABLE _ss_stat
                    OUTPUT_VARIABLE _ss_out
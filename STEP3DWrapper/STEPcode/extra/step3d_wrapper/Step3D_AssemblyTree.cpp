@@ -0,0 +1,192 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="DstController.cs" company="Open Engineering S.A.">
+//    Copyright (c) 2020-2021 Open Engineering S.A.
+// 
+//    Author: Juan Pablo Hernandez Vogt
+//
+//    This file is part of DEHP STEP-AP242 (STEP 3D CAD) adapter project.
+// 
+//    The DEHP STEP-AP242 is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+// 
+//    The DEHP STEP-AP242 is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+// 
+//    You should have received a copy of the GNU Lesser General Public License
+//    along with this program; if not, write to the Free Software Foundation,
+//    Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+// </copyright>
+// --------------------------------------------------------------------------------------------------------------------
+
+
+#include "Step3D_AssemblyTree.h"
+
+#include <unordered_map>
+#include <utility>
+using namespace std;
+
+
+void Step3D_AssemblyTree::build(const list<Part_Wrapper>& nodes, const list<Relation_Wrapper>& relations, Step3D_AssemblyTree_Wrapper& tree)
+{
+    tree = Step3D_AssemblyTree_Wrapper();
+
+    // Node index of each stepId, the relation ends missing in the parts are appended
+    const size_t maxNodes = nodes.size() + relations.size() * 2;
+    unordered_map<int, int> index;
+    index.reserve(maxNodes);
+    tree.stepId.reserve(maxNodes);
+
+    auto nodeOf = [&tree, &index](int stepId) -> int
+    {
+        auto it = index.find(stepId);
+        if (it != index.end()) return it->second;
+
+        const int node = (int)tree.stepId.size();
+        index[stepId] = node;
+        tree.stepId.push_back(stepId);
+        return node;
+    };
+
+    for (const Part_Wrapper& n : nodes)
+    {
+        nodeOf(n.stepId);
+    }
+
+    tree.partCount = tree.stepId.size();
+
+    vector<int> parent;
+    vector<int> child;
+    parent.reserve(relations.size());
+    child.reserve(relations.size());
+
+    for (const Relation_Wrapper& r : relations)
+    {
+        parent.push_back(nodeOf(r.relating_id));
+        child.push_back(nodeOf(r.related_id));
+    }
+
+    // Counting sort of the relations by parent, stable so the children keep their order
+    const int nodeCount = (int)tree.nodeCount();
+
+    tree.childBegin.assign(nodeCount + 1, 0);
+    tree.parentCount.assign(nodeCount, 0);
+
+    for (size_t i = 0; i < parent.size(); i++)
+    {
+        tree.childBegin[parent[i] + 1]++;
+        tree.parentCount[child[i]]++;
+    }
+
+    for (int n = 0; n < nodeCount; n++)
+    {
+        tree.childBegin[n + 1] += tree.childBegin[n];
+    }
+
+    tree.children.resize(parent.size());
+    tree.childRelation.resize(parent.size());
+    vector<int> fill(tree.childBegin.begin(), tree.childBegin.end() - 1);
+
+    for (size_t i = 0; i < parent.size(); i++)
+    {
+        const int e = fill[parent[i]]++;
+        tree.children[e] = child[i];
+        tree.childRelation[e] = (int)i;
+    }
+
+    for (int n = 0; n < (int)tree.partCount; n++)
+    {
+        if (tree.parentCount[n] == 0)
+        {
+            tree.roots.push_back(n);
+        }
+    }
+
+    sortTopologically(tree);
+    expandOccurrences(tree);
+}
+
+void Step3D_AssemblyTree::sortTopologically(Step3D_AssemblyTree_Wrapper& tree)
+{
+    const int nodeCount = (int)tree.nodeCount();
+
+    // Parents not yet in the order, a node is added when it reaches zero
+    vector<int> pending(tree.parentCount);
+
+    vector<int>& order = tree.topologicalOrder;
+    order.reserve(nodeCount);
+
+    for (int n = 0; n < nodeCount; n++)
+    {
+        if (pending[n] == 0) order.push_back(n);
+    }
+
+    // The order is also the queue: nodes before next have had their children visited
+    for (size_t next = 0; next < order.size(); next++)
+    {
+        const int n = order[next];
+
+        for (int e = tree.childBegin[n]; e < tree.childBegin[n + 1]; e++)
+        {
+            if (--pending[tree.children[e]] == 0)
+            {
+                order.push_back(tree.children[e]);
+            }
+        }
+    }
+
+    // The nodes of a cycle, and the ones below it, never reach zero
+}
+
+void Step3D_AssemblyTree::expandOccurrences(Step3D_AssemblyTree_Wrapper& tree)
+{
+    const int partCount = (int)tree.partCount;
+
+    // Nodes of the current path, to stop at the relation closing a cycle
+    vector<char> onPath(partCount, 0);
+
+    // Occurrence being expanded and its next children entry
+    vector<pair<int, int>> stack;
+
+    auto addOccurrence = [&tree, &onPath, &stack](int node, int parent, int relation)
+    {
+        const int occurrence = (int)tree.occurrenceNode.size();
+
+        tree.occurrenceNode.push_back(node);
+        tree.occurrenceParent.push_back(parent);
+        tree.occurrenceRelation.push_back(relation);
+
+        onPath[node] = 1;
+        stack.push_back(make_pair(occurrence, tree.childBegin[node]));
+    };
+
+    for (int root : tree.roots)
+    {
+        addOccurrence(root, -1, -1);
+
+        while (!stack.empty())
+        {
+            const int occurrence = stack.back().first;
+            const int node = tree.occurrenceNode[occurrence];
+            const int e = stack.back().second;
+
+            if (e == tree.childBegin[node + 1])
+            {
+                onPath[node] = 0;
+                stack.pop_back();
+                continue;
+            }
+
+            stack.back().second++;
+
+            const int c = tree.children[e];
+            if (c < partCount && !onPath[c])
+            {
+                addOccurrence(c, occurrence, tree.childRelation[e]);
+            }
+        }
+    }
+}
@@ -0,0 +1,67 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="DstController.cs" company="Open Engineering S.A.">
+//    Copyright (c) 2020-2021 Open Engineering S.A.
+// 
+//    Author: Juan Pablo Hernandez Vogt
+//
+//    This file is part of DEHP STEP-AP242 (STEP 3D CAD) adapter project.
+// 
+//    The DEHP STEP-AP242 is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+// 
+//    The DEHP STEP-AP242 is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+// 
+//    You should have received a copy of the GNU Lesser General Public License
+//    along with this program; if not, write to the Free Software Foundation,
+//    Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+// </copyright>
+// --------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+/**
+* Builds the assembly structure of the HLR nodes
+* 
+* Not linked to Stepcode, only the wrapper structs are used.
+*/
+#include "step3d_wrapper.h"
+
+// STL headers
+#include <list>
+
+
+/**
+* @brief Fills a Step3D_AssemblyTree_Wrapper from the parts and relations
+* 
+* The stepIds are mapped to node indexes once, then the child lists are
+* laid out by a counting sort of the relations on their parent. Every
+* later step only walks these arrays, so the whole build is linear in
+* the number of parts, relations and occurrences.
+*/
+class Step3D_AssemblyTree
+{
+public:
+    /**
+    * @brief Fill the tree from the parts and their relations
+    * @param[in] nodes parts, in the order of the part nodes
+    * @param[in] relations parent/child relations between parts
+    * @param[out] tree assembly structure, previous content is discarded
+    */
+    static void build(const std::list<Part_Wrapper>& nodes, const std::list<Relation_Wrapper>& relations, Step3D_AssemblyTree_Wrapper& tree);
+
+private:
+    /**
+    * @brief Compute topologicalOrder from the child lists (Kahn's algorithm)
+    */
+    static void sortTopologically(Step3D_AssemblyTree_Wrapper& tree);
+
+    /**
+    * @brief Compute the occurrence arrays, depth first from each root
+    */
+    static void expandOccurrences(Step3D_AssemblyTree_Wrapper& tree);
+};
@@ -0,0 +1,926 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="DstController.cs" company="Open Engineering S.A.">
+//    Copyright (c) 2020-2021 Open Engineering S.A.
+// 
+//    Author: Juan Pablo Hernandez Vogt
+//
+//    This file is part of DEHP STEP-AP242 (STEP 3D CAD) adapter project.
+// 
+//    The DEHP STEP-AP242 is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+// 
+//    The DEHP STEP-AP242 is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+// 
+//    You should have received a copy of the GNU Lesser General Public License
+//    along with this program; if not, write to the Free Software Foundation,
+//    Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+// </copyright>
+// --------------------------------------------------------------------------------------------------------------------
+
+#include "Step3D_Diff_Imp.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <thread>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <set>
+using namespace std;
+
+
+// Initialize static members
+const char* Step3D_MerkleIndex::PD("PRODUCT_DEFINITION");
+const char* Step3D_MerkleIndex::PDF("PRODUCT_DEFINITION_FORMATION");
+const char* Step3D_MerkleIndex::P("PRODUCT");
+const char* Step3D_MerkleIndex::PDS("PRODUCT_DEFINITION_SHAPE");
+const char* Step3D_MerkleIndex::SDR("SHAPE_DEFINITION_REPRESENTATION");
+const char* Step3D_MerkleIndex::NAUO("NEXT_ASSEMBLY_USAGE_OCCURRENCE");
+const char* Step3D_MerkleIndex::CDSR("CONTEXT_DEPENDENT_SHAPE_REPRESENTATION");
+const char* Step3D_MerkleIndex::RR("REPRESENTATION_RELATIONSHIP");
+
+// FNV-1a offset basis, also used as seed for the combinations
+static const Step3D_MerkleIndex::Hash HashSeed = 14695981039346656037ULL;
+
+// Below this amount of nodes the threads cost more than they save
+static const size_t MinParallelCount = 512;
+
+
+Step3D_MerkleIndex::Step3D_MerkleIndex()
+{
+    m_errorCode = WrapperErrorCode::NO_ERROR;
+}
+
+bool Step3D_MerkleIndex::build(const std::string& fname, unsigned int threads)
+{
+    if (!readBuffer(fname)) return false;
+
+    // 1) Index the file: positions and forward references of all the instances
+    lazyInstMgr mgr;
+    mgr.openFile(fname);
+
+    if (mgr.countDataSections() == 0)
+    {
+        m_errorCode = WrapperErrorCode::FILE_READ;
+        m_errorMessage = "No DATA section found in " + fname;
+        return false;
+    }
+
+    // 2) Extract the compact graph (single threaded, the lazy index is not thread safe)
+    std::vector<int> pds, sdrs, nauos, cdsrs, rrs;
+    extractGraph(mgr, pds, sdrs, nauos, cdsrs, rrs);
+
+    parallelFor(m_nodes.size(), threads, [this](size_t i) { normalizeRecord(m_nodes[i]); });
+
+    // 3) Products are referenced by identity: name and order of appearance
+    std::map<int, std::string> pdKeys;
+    std::map<std::string, int> nameCount;
+
+    for (int pd : pds)
+    {
+        const std::string name = productName(pd);
+        std::ostringstream key;
+        key << name << "[" << nameCount[name]++ << "]";
+
+        pdKeys[pd] = key.str();
+        m_nodes[pd].anchored = true;
+        m_nodes[pd].anchorHash = hashBytes(key.str().data(), key.str().size(), hashBytes(PD, strlen(PD), HashSeed));
+    }
+
+    // Representations used by a product are also referenced by identity,
+    // so a CDSR only hashes the placement and not the geometry of both parts
+    static const char* REP = "REPRESENTATION";
+    std::map<int, std::vector<int> > pdRepresentations;
+    std::map<int, int> representationOwner;
+
+    for (int sdr : sdrs)
+    {
+        const int pds_node = findChild(sdr, PDS);
+        const int pd = pds_node < 0 ? -1 : findChild(pds_node, PD);
+        if (pd < 0 || pdKeys.find(pd) == pdKeys.end()) continue;
+
+        for (int child : m_nodes[sdr].children)
+        {
+            if (child < 0 || child == pds_node) continue;
+
+            Node& representation = m_nodes[child];
+            if (!representation.anchored)
+            {
+                const std::string& key = pdKeys[pd];
+                representation.anchored = true;
+                representation.anchorHash = hashBytes(key.data(), key.size(), hashBytes(REP, strlen(REP), HashSeed));
+                representationOwner[child] = pd;
+            }
+            pdRepresentations[pd].push_back(child);
+        }
+    }
+
+    // A representation relationship from a product representation brings the other
+    // representation (e.g. the B-rep of a SHAPE_REPRESENTATION) into the product.
+    // Those relationships are followed until no product gains a representation;
+    // the placements between the representations of two products belong to the CDSR.
+    std::set<int> placements;
+    for (int cdsr : cdsrs)
+    {
+        for (int child : m_nodes[cdsr].children)
+        {
+            if (child >= 0) placements.insert(child);
+        }
+    }
+
+    for (bool grown = true; grown; )
+    {
+        grown = false;
+        for (int rr : rrs)
+        {
+            // rep_1 and rep_2 are the first references of all the subtypes
+            const std::vector<int>& children = m_nodes[rr].children;
+            if (placements.count(rr) || children.size() < 2 || children[0] < 0 || children[1] < 0) continue;
+
+            const auto owner1 = representationOwner.find(children[0]);
+            const auto owner2 = representationOwner.find(children[1]);
+            if ((owner1 == representationOwner.end()) == (owner2 == representationOwner.end())) continue;
+
+            const bool firstOwned = owner1 != representationOwner.end();
+            const int pd = firstOwned ? owner1->second : owner2->second;
+            representationOwner[children[firstOwned ? 1 : 0]] = pd;
+            pdRepresentations[pd].push_back(rr);
+            grown = true;
+        }
+    }
+
+    // 4) Merkle hashes, from the leaves to the roots
+    const int maxLevel = computeLevels();
+    computeHashes(maxLevel, threads);
+
+    // 5) Summary per part
+    for (int pd : pds)
+    {
+        std::vector<Hash> representations;
+        for (int r : pdRepresentations[pd])
+        {
+            representations.push_back(m_nodes[r].hash);
+        }
+        std::sort(representations.begin(), representations.end());
+
+        PartHash part;
+        part.stepId = (int)m_nodes[pd].stepId;
+        part.name = productName(pd);
+        part.representation_hash = HashSeed;
+        for (Hash h : representations)
+        {
+            part.representation_hash = combine(part.representation_hash, h);
+        }
+        part.hash = combine(m_nodes[pd].hash, part.representation_hash);
+
+        m_parts[pdKeys[pd]] = part;
+    }
+
+    // 6) Summary per relation, with the placements of its CDSR
+    std::map<int, std::vector<Hash> > nauoPlacements;
+    for (int cdsr : cdsrs)
+    {
+        const int pds_node = findChild(cdsr, PDS);
+        const int nauo = pds_node < 0 ? -1 : findChild(pds_node, NAUO);
+        if (nauo < 0) continue;
+
+        nauoPlacements[nauo].push_back(m_nodes[cdsr].hash);
+    }
+
+    std::map<std::string, int> relationCount;
+    for (int nauo : nauos)
+    {
+        // relating and related PD, in attribute order; ignore other targets
+        std::vector<int> related_pds;
+        for (int child : m_nodes[nauo].children)
+        {
+            if (child >= 0 && m_nodes[child].type == PD) related_pds.push_back(child);
+        }
+        if (related_pds.size() < 2) continue;
+
+        std::vector<Hash>& placements = nauoPlacements[nauo];
+        std::sort(placements.begin(), placements.end());
+
+        RelationHash relation;
+        relation.stepId = (int)m_nodes[nauo].stepId;
+        relation.id = attributeValue(m_nodes[nauo].text, 0);
+        relation.relating_name = productName(related_pds[0]);
+        relation.related_name = productName(related_pds[1]);
+        relation.hash = m_nodes[nauo].hash;
+        for (Hash h : placements)
+        {
+            relation.hash = combine(relation.hash, h);
+        }
+
+        const std::string pairKey = pdKeys[related_pds[0]] + "->" + pdKeys[related_pds[1]];
+        std::ostringstream key;
+        key << pairKey << "[" << relationCount[pairKey]++ << "]";
+
+        m_relations[key.str()] = relation;
+    }
+
+    // the raw content is not needed anymore
+    std::string().swap(m_buffer);
+
+    return true;
+}
+
+std::string Step3D_MerkleIndex::toString(Hash hash)
+{
+    char buffer[17];
+    snprintf(buffer, sizeof(buffer), "%016llx", hash);
+    return buffer;
+}
+
+bool Step3D_MerkleIndex::readBuffer(const std::string& fname)
+{
+    ifstream ifile(fname, ios::in | ios::binary);
+    if (!ifile.is_open())
+    {
+        m_errorCode = WrapperErrorCode::FILE_NOT_FOUND;
+        m_errorMessage = "File does not exists: " + fname;
+        return false;
+    }
+
+    ifile.seekg(0, ios::end);
+    m_buffer.resize((size_t)ifile.tellg());
+    ifile.seekg(0, ios::beg);
+    ifile.read(&m_buffer[0], m_buffer.size());
+
+    // The lazy loader aborts on malformed content, check the magic string first
+    static const std::string magic("ISO-10303-21;");
+    size_t start = 0;
+    while (start < m_buffer.size() && isspace((unsigned char)m_buffer[start])) start++;
+
+    if (m_buffer.compare(start, magic.size(), magic) != 0)
+    {
+        m_errorCode = WrapperErrorCode::FILE_READ;
+        m_errorMessage = "Not a STEP file: " + fname;
+        return false;
+    }
+
+    return true;
+}
+
+void Step3D_MerkleIndex::extractGraph(lazyInstMgr& mgr, std::vector<int>& pds, std::vector<int>& sdrs,
+                                      std::vector<int>& nauos, std::vector<int>& cdsrs, std::vector<int>& rrs)
+{
+    auto addNode = [this, &mgr](instanceID id) -> int
+    {
+        auto it = m_index.find(id);
+        if (it != m_index.end()) return it->second;
+
+        const long int offset = mgr.streamPosFromFile(id);
+        if (offset < 0) return -1; // dangling reference
+
+        Node node;
+        node.stepId = id;
+        node.offset = offset;
+        node.level = 0;
+        node.cycle = -1;
+        node.anchored = false;
+        node.anchorHash = 0;
+        node.hash = 0;
+
+        const int index = (int)m_nodes.size();
+        m_nodes.push_back(node);
+        m_index[id] = index;
+        return index;
+    };
+
+    // Representation relationships are not referenced by the HLR entities,
+    // they are roots too (the mapped items are reached from the representation items)
+    const char* roots[] = { PD, SDR, NAUO, CDSR, RR, "SHAPE_REPRESENTATION_RELATIONSHIP",
+                            "REPRESENTATION_RELATIONSHIP_WITH_TRANSFORMATION",
+                            "DEFINITIONAL_REPRESENTATION_RELATIONSHIP" };
+    std::vector<int>* lists[] = { &pds, &sdrs, &nauos, &cdsrs, &rrs, &rrs, &rrs, &rrs };
+
+    for (int r = 0; r < 8; r++)
+    {
+        instanceTypes_t::cvector* ids = mgr.getInstances(roots[r], true);
+        if (!ids) continue;
+
+        const std::vector<instanceID> copy(ids->begin(), ids->end());
+        for (instanceID id : copy)
+        {
+            const int index = addNode(id);
+            if (index >= 0) lists[r]->push_back(index);
+        }
+    }
+
+    // Complex instances are indexed without a type: keep the relationships
+    instanceTypes_t::cvector* complexIds = mgr.getInstances("", true);
+    if (complexIds)
+    {
+        const std::string partial = std::string(RR) + "(";
+        const std::vector<instanceID> copy(complexIds->begin(), complexIds->end());
+        for (instanceID id : copy)
+        {
+            Node record;
+            record.offset = mgr.streamPosFromFile(id);
+            if (record.offset < 0) continue;
+
+            normalizeRecord(record);
+            if (record.text.find(partial) == std::string::npos) continue;
+
+            const int index = addNode(id);
+            if (index >= 0) rrs.push_back(index);
+        }
+    }
+
+    // m_nodes is the queue of the breadth-first traversal
+    instanceRefs_t* fwdRefs = mgr.getFwdRefs();
+
+    for (size_t i = 0; i < m_nodes.size(); i++)
+    {
+        instanceRefs_t::cvector* refs = fwdRefs->find(m_nodes[i].stepId);
+        if (!refs) continue;
+
+        const std::vector<instanceID> copy(refs->begin(), refs->end());
+        std::vector<int> children;
+        children.reserve(copy.size());
+
+        for (instanceID id : copy)
+        {
+            children.push_back(addNode(id));
+        }
+        m_nodes[i].children.swap(children);
+    }
+}
+
+void Step3D_MerkleIndex::normalizeRecord(Node& node) const
+{
+    const std::string& b = m_buffer;
+    const size_t n = b.size();
+    size_t pos = (size_t)node.offset;
+
+    // skip "#id =" (and any previous comment)
+    while (pos < n && b[pos] != '=')
+    {
+        if (b[pos] == '/' && pos + 1 < n && b[pos + 1] == '*')
+        {
+            pos = b.find("*/", pos + 2);
+            if (pos == std::string::npos) return;
+            pos++;
+        }
+        pos++;
+    }
+    pos++;
+
+    std::string& out = node.text;
+    int depth = 0;
+
+    while (pos < n)
+    {
+        const char c = b[pos];
+
+        if (c == '\'')
+        {
+            // copy string literal, including the escaped quotes ('')
+            out += c;
+            pos++;
+            while (pos < n)
+            {
+                const char s = b[pos++];
+                out += s;
+                if (s == '\'')
+                {
+                    if (pos < n && b[pos] == '\'')
+                    {
+                        out += '\'';
+                        pos++;
+                        continue;
+                    }
+                    break;
+                }
+            }
+            continue;
+        }
+
+        if (c == '/' && pos + 1 < n && b[pos + 1] == '*')
+        {
+            pos = b.find("*/", pos + 2);
+            if (pos == std::string::npos) break;
+            pos += 2;
+            continue;
+        }
+
+        if (isspace((unsigned char)c))
+        {
+            pos++;
+            continue;
+        }
+
+        if (c == '#')
+        {
+            // reference: the number is replaced by the child hash
+            out += '#';
+            pos++;
+            while (pos < n && isspace((unsigned char)b[pos])) pos++;
+            while (pos < n && isdigit((unsigned char)b[pos])) pos++;
+            continue;
+        }
+
+        if (c == '(') depth++;
+        if (c == ')') depth--;
+        if (c == ';' && depth <= 0) break;
+
+        out += c;
+        pos++;
+    }
+
+    const size_t paren = out.find('(');
+    node.type = out.substr(0, paren == std::string::npos ? out.size() : paren);
+}
+
+int Step3D_MerkleIndex::computeLevels()
+{
+    // Iterative Tarjan: the strongly connected components are completed
+    // from the leaves to the roots, so the level of a component only
+    // depends on components that already have one
+    const int count = (int)m_nodes.size();
+    std::vector<int> order(count, -1), low(count, 0), component(count, -1);
+    std::vector<int> members;
+    std::vector< std::pair<int, size_t> > stack;
+    int visited = 0;
+    int components = 0;
+    int maxLevel = 0;
+
+    m_cycles.clear();
+
+    for (int root = 0; root < count; root++)
+    {
+        if (order[root] >= 0) continue;
+
+        order[root] = low[root] = visited++;
+        members.push_back(root);
+        stack.push_back(std::make_pair(root, (size_t)0));
+
+        while (!stack.empty())
+        {
+            const int v = stack.back().first;
+            const std::vector<int>& children = m_nodes[v].children;
+
+            if (stack.back().second < children.size())
+            {
+                const int c = children[stack.back().second++];
+                if (c < 0) continue;
+
+                if (order[c] < 0)
+                {
+                    order[c] = low[c] = visited++;
+                    members.push_back(c);
+                    stack.push_back(std::make_pair(c, (size_t)0));
+                }
+                else if (component[c] < 0)
+                {
+                    low[v] = std::min(low[v], order[c]); // c is on the members stack
+                }
+                continue;
+            }
+
+            stack.pop_back();
+            if (!stack.empty())
+            {
+                const int parent = stack.back().first;
+                low[parent] = std::min(low[parent], low[v]);
+            }
+            if (low[v] != order[v]) continue;
+
+            // v is the root of a component: pop its members
+            size_t first = members.size();
+            while (members[--first] != v) {}
+            const std::vector<int> scc(members.begin() + first, members.end());
+            members.resize(first);
+
+            for (int m : scc)
+            {
+                component[m] = components;
+            }
+            components++;
+
+            bool cyclic = scc.size() > 1;
+            int level = 0;
+            for (int m : scc)
+            {
+                for (int c : m_nodes[m].children)
+                {
+                    if (c < 0) continue;
+                    if (component[c] == component[v]) cyclic = true;
+                    else level = std::max(level, m_nodes[c].level + 1);
+                }
+            }
+
+            const int cycle = cyclic ? (int)m_cycles.size() : -1;
+            if (cyclic) m_cycles.push_back(scc);
+
+            for (int m : scc)
+            {
+                m_nodes[m].level = level;
+                m_nodes[m].cycle = cycle;
+            }
+            maxLevel = std::max(maxLevel, level);
+        }
+    }
+
+    return maxLevel;
+}
+
+void Step3D_MerkleIndex::computeHashes(int maxLevel, unsigned int threads)
+{
+    std::vector< std::vector<int> > levels(maxLevel + 1);
+    for (size_t i = 0; i < m_nodes.size(); i++)
+    {
+        levels[m_nodes[i].level].push_back((int)i);
+    }
+
+    std::vector< std::vector<int> > cycleLevels(maxLevel + 1);
+    for (size_t i = 0; i < m_cycles.size(); i++)
+    {
+        cycleLevels[m_nodes[m_cycles[i].front()].level].push_back((int)i);
+    }
+
+    // all the children of a level are done before the level starts
+    for (int l = 0; l <= maxLevel; l++)
+    {
+        const std::vector<int>& level = levels[l];
+        parallelFor(level.size(), threads, [this, &level](size_t i) { hashNode(m_nodes[level[i]]); });
+
+        // the members of a cycle only have their content hash yet
+        for (int cycle : cycleLevels[l])
+        {
+            hashCycle(m_cycles[cycle]);
+        }
+    }
+}
+
+void Step3D_MerkleIndex::hashNode(Node& node) const
+{
+    static const Hash Unresolved = hashBytes("#?", 2, HashSeed);
+
+    Hash h = hashBytes(node.text.data(), node.text.size(), HashSeed);
+
+    for (int c : node.children)
+    {
+        if (c < 0)
+        {
+            h = combine(h, Unresolved);
+            continue;
+        }
+
+        const Node& child = m_nodes[c];
+        if (node.cycle >= 0 && child.cycle == node.cycle) continue; // see hashCycle()
+
+        h = combine(h, child.anchored ? child.anchorHash : child.hash);
+    }
+
+    node.hash = h;
+}
+
+void Step3D_MerkleIndex::hashCycle(const std::vector<int>& members)
+{
+    // The references inside the cycle are left out of the content hashes,
+    // the sorted content hashes do not depend on the instance numbering
+    std::vector<Hash> contents;
+    contents.reserve(members.size());
+    for (int m : members)
+    {
+        contents.push_back(m_nodes[m].hash);
+    }
+    std::sort(contents.begin(), contents.end());
+
+    Hash cycleHash = HashSeed;
+    for (Hash h : contents)
+    {
+        cycleHash = combine(cycleHash, h);
+    }
+
+    for (int m : members)
+    {
+        m_nodes[m].hash = combine(cycleHash, m_nodes[m].hash);
+    }
+}
+
+int Step3D_MerkleIndex::findChild(int node, const char* type) const
+{
+    for (int c : m_nodes[node].children)
+    {
+        if (c >= 0 && m_nodes[c].type == type) return c;
+    }
+    return -1;
+}
+
+std::string Step3D_MerkleIndex::productName(int pd) const
+{
+    const int pdf = findChild(pd, PDF);
+    const int p = pdf < 0 ? -1 : findChild(pdf, P);
+
+    return p < 0 ? std::string() : attributeValue(m_nodes[p].text, 1);
+}
+
+std::string Step3D_MerkleIndex::attributeValue(const std::string& text, int index)
+{
+    size_t pos = text.find('(');
+    if (pos == std::string::npos) return std::string();
+    pos++;
+
+    int depth = 1;
+    int current = 0;
+    bool inString = false;
+    size_t start = pos;
+
+    for (; pos < text.size() && depth > 0; pos++)
+    {
+        const char c = text[pos];
+
+        if (c == '\'')
+        {
+            inString = !inString; // an escaped quote toggles twice
+            continue;
+        }
+        if (inString) continue;
+
+        if (c == '(') depth++;
+        else if (c == ')') depth--;
+
+        if ((c == ',' && depth == 1) || depth == 0)
+        {
+            if (current == index) return text.substr(start, pos - start);
+            current++;
+            start = pos + 1;
+        }
+    }
+
+    return std::string();
+}
+
+Step3D_MerkleIndex::Hash Step3D_MerkleIndex::hashBytes(const char* data, size_t size, Hash seed)
+{
+    // FNV-1a
+    Hash h = seed;
+    for (size_t i = 0; i < size; i++)
+    {
+        h ^= (unsigned char)data[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+Step3D_MerkleIndex::Hash Step3D_MerkleIndex::combine(Hash seed, Hash value)
+{
+    // Order dependent combination, finalized with the splitmix64 mixer
+    Hash h = seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+template<typename Function>
+void Step3D_MerkleIndex::parallelFor(size_t count, unsigned int threads, Function function)
+{
+    if (threads <= 1 || count < MinParallelCount)
+    {
+        for (size_t i = 0; i < count; i++) function(i);
+        return;
+    }
+
+    const size_t chunk = (count + threads - 1) / threads;
+    std::vector<std::thread> workers;
+
+    for (size_t begin = 0; begin < count; begin += chunk)
+    {
+        const size_t end = std::min(count, begin + chunk);
+        workers.push_back(std::thread([begin, end, &function]()
+        {
+            for (size_t i = begin; i < end; i++) function(i);
+        }));
+    }
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+
+///////////////////////////////////
+// Diff
+///////////////////////////////////
+
+Step3D_Diff_Imp::Step3D_Diff_Imp()
+{
+    m_threads = 0;
+    m_errorCode = WrapperErrorCode::NO_ERROR;
+}
+
+Step3D_Diff_Imp::~Step3D_Diff_Imp()
+{
+}
+
+bool Step3D_Diff_Imp::compare(std::string oldFname, std::string newFname)
+{
+    clearError();
+    m_partDiffs.clear();
+    m_relationDiffs.clear();
+
+    unsigned int threads = m_threads ? m_threads : std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+
+    // NOTE: files are indexed one after the other, the lazy
+    // section readers share static buffers
+    Step3D_MerkleIndex oldIndex;
+    Step3D_MerkleIndex newIndex;
+
+    try
+    {
+        if (!oldIndex.build(oldFname, threads))
+        {
+            m_errorCode = oldIndex.getError();
+            m_errorMessage = oldIndex.getErrorMessage();
+            return false;
+        }
+
+        if (!newIndex.build(newFname, threads))
+        {
+            m_errorCode = newIndex.getError();
+            m_errorMessage = newIndex.getErrorMessage();
+            return false;
+        }
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+
+        m_errorCode = WrapperErrorCode::FILE_PROCESS;
+        m_errorMessage = string(e.what()) + " at Step3D_Diff_Imp::compare()";
+        return false;
+    }
+
+    compareParts(oldIndex, newIndex);
+    compareRelations(oldIndex, newIndex);
+
+    return true;
+}
+
+void Step3D_Diff_Imp::setThreadCount(unsigned int count)
+{
+    m_threads = count;
+}
+
+std::list<PartDiff_Wrapper> Step3D_Diff_Imp::getPartDiffs()
+{
+    return m_partDiffs;
+}
+
+std::list<RelationDiff_Wrapper> Step3D_Diff_Imp::getRelationDiffs()
+{
+    return m_relationDiffs;
+}
+
+bool Step3D_Diff_Imp::hasChanges() const
+{
+    for (const auto& d : m_partDiffs)
+    {
+        if (d.status != DiffStatus::UNCHANGED) return true;
+    }
+
+    for (const auto& d : m_relationDiffs)
+    {
+        if (d.status != DiffStatus::UNCHANGED) return true;
+    }
+
+    return false;
+}
+
+bool Step3D_Diff_Imp::hasFailed() const
+{
+    return m_errorCode != WrapperErrorCode::NO_ERROR;
+}
+
+WrapperErrorCode Step3D_Diff_Imp::getError() const
+{
+    return m_errorCode;
+}
+
+void Step3D_Diff_Imp::clearError()
+{
+    m_errorCode = WrapperErrorCode::NO_ERROR;
+    m_errorMessage.clear();
+}
+
+std::string Step3D_Diff_Imp::getErrorMessage()
+{
+    return m_errorMessage;
+}
+
+void Step3D_Diff_Imp::Release()
+{
+    delete this;
+}
+
+void Step3D_Diff_Imp::compareParts(const Step3D_MerkleIndex& oldIndex, const Step3D_MerkleIndex& newIndex)
+{
+    const auto& oldParts = oldIndex.getParts();
+    const auto& newParts = newIndex.getParts();
+
+    // Both maps are sorted by key: merge them
+    auto o = oldParts.begin();
+    auto n = newParts.begin();
+
+    while (o != oldParts.end() || n != newParts.end())
+    {
+        PartDiff_Wrapper diff;
+
+        const bool useOld = n == newParts.end() || (o != oldParts.end() && o->first <= n->first);
+        const bool useNew = o == oldParts.end() || (n != newParts.end() && n->first <= o->first);
+
+        if (useOld)
+        {
+            diff.name = o->second.name;
+            diff.old_stepId = o->second.stepId;
+            diff.old_hash = Step3D_MerkleIndex::toString(o->second.hash);
+            diff.old_representation_hash = Step3D_MerkleIndex::toString(o->second.representation_hash);
+        }
+
+        if (useNew)
+        {
+            diff.name = n->second.name;
+            diff.new_stepId = n->second.stepId;
+            diff.new_hash = Step3D_MerkleIndex::toString(n->second.hash);
+            diff.new_representation_hash = Step3D_MerkleIndex::toString(n->second.representation_hash);
+        }
+
+        if (useOld && useNew)
+        {
+            diff.status = o->second.hash == n->second.hash ? DiffStatus::UNCHANGED : DiffStatus::MODIFIED;
+        }
+        else
+        {
+            diff.status = useOld ? DiffStatus::REMOVED : DiffStatus::ADDED;
+        }
+
+        m_partDiffs.push_back(diff);
+
+        if (useOld) ++o;
+        if (useNew) ++n;
+    }
+}
+
+void Step3D_Diff_Imp::compareRelations(const Step3D_MerkleIndex& oldIndex, const Step3D_MerkleIndex& newIndex)
+{
+    const auto& oldRelations = oldIndex.getRelations();
+    const auto& newRelations = newIndex.getRelations();
+
+    auto o = oldRelations.begin();
+    auto n = newRelations.begin();
+
+    while (o != oldRelations.end() || n != newRelations.end())
+    {
+        RelationDiff_Wrapper diff;
+
+        const bool useOld = n == newRelations.end() || (o != oldRelations.end() && o->first <= n->first);
+        const bool useNew = o == oldRelations.end() || (n != newRelations.end() && n->first <= o->first);
+
+        if (useOld)
+        {
+            diff.id = o->second.id;
+            diff.relating_name = o->second.relating_name;
+            diff.related_name = o->second.related_name;
+            diff.old_stepId = o->second.stepId;
+            diff.old_hash = Step3D_MerkleIndex::toString(o->second.hash);
+        }
+
+        if (useNew)
+        {
+            diff.id = n->second.id;
+            diff.relating_name = n->second.relating_name;
+            diff.related_name = n->second.related_name;
+            diff.new_stepId = n->second.stepId;
+            diff.new_hash = Step3D_MerkleIndex::toString(n->second.hash);
+        }
+
+        if (useOld && useNew)
+        {
+            diff.status = o->second.hash == n->second.hash ? DiffStatus::UNCHANGED : DiffStatus::MODIFIED;
+        }
+        else
+        {
+            diff.status = useOld ? DiffStatus::REMOVED : DiffStatus::ADDED;
+        }
+
+        m_relationDiffs.push_back(diff);
+
+        if (useOld) ++o;
+        if (useNew) ++n;
+    }
+}
@@ -0,0 +1,236 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="DstController.cs" company="Open Engineering S.A.">
+//    Copyright (c) 2020-2021 Open Engineering S.A.
+// 
+//    Author: Juan Pablo Hernandez Vogt
+//
+//    This file is part of DEHP STEP-AP242 (STEP 3D CAD) adapter project.
+// 
+//    The DEHP STEP-AP242 is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+// 
+//    The DEHP STEP-AP242 is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+// 
+//    You should have received a copy of the GNU Lesser General Public License
+//    along with this program; if not, write to the Free Software Foundation,
+//    Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+// </copyright>
+// --------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+/**
+* Implement the structural comparison of two STEP-3D files
+* 
+* Linked to Stepcode shared libraries (lazy loader).
+*/
+#include "step3d_wrapper.h"
+
+// STEPcode headers
+#include "lazyInstMgr.h"
+
+// STL headers
+#include <map>
+#include <vector>
+
+
+/**
+* @brief Merkle-style hashes of the HLR entities of one STEP file
+* 
+* The file is indexed with the lazyInstMgr, which records the position
+* and the forward references of every instance without creating them.
+* Only the subgraphs reachable from the HLR entities (PD, SDR, NAUO, CDSR)
+* and from the representation relationships are extracted, as a compact graph:
+* - normalized record text (no whitespace or comments, references replaced by '#')
+* - index of the referenced instances, in attribute order
+* 
+* Each instance hash combines its text with the hashes of its children, so
+* the instance numbering does not take part in the result. References to a
+* Product_Definition (or to the representation of a product) contribute the
+* identity of the product instead of its subgraph, which keeps the change of
+* one part from propagating to its relations and assemblies.
+* 
+* The instances of a reference cycle share the hash of the cycle, made of
+* the sorted hashes of their content.
+* 
+* Extraction is single threaded (the lazy index is not thread safe), the
+* normalization and the hashing run in parallel, level by level.
+*/
+class Step3D_MerkleIndex
+{
+public:
+    typedef unsigned long long Hash;
+
+    /**
+    * @brief Hashes of one Product_Definition
+    */
+    struct PartHash
+    {
+        int stepId;
+        std::string name;                //!< PD.PDF.P.name
+        Hash hash;                       //!< PD subgraph and representations
+        Hash representation_hash;        //!< representations linked by SDR
+    };
+
+    /**
+    * @brief Hashes of one Next_Assembly_Usage_Occurrence
+    */
+    struct RelationHash
+    {
+        int stepId;
+        std::string id;                  //!< NAUO.id
+        std::string relating_name;
+        std::string related_name;
+        Hash hash;                       //!< NAUO attributes and CDSR placement
+    };
+
+    Step3D_MerkleIndex();
+
+    /**
+    * @brief Index and hash a STEP file
+    * @param[in] fname full path to .stp|.step file
+    * @param[in] threads number of threads (at least 1)
+    * @return true if the file was processed, see getErrorMessage() otherwise
+    */
+    bool build(const std::string& fname, unsigned int threads);
+
+    const std::string& getErrorMessage() const { return m_errorMessage; }
+    WrapperErrorCode getError() const { return m_errorCode; }
+
+    /** Parts by identity key (product name and order of appearance) */
+    const std::map<std::string, PartHash>& getParts() const { return m_parts; }
+
+    /** Relations by identity key (relating and related part keys, order of appearance) */
+    const std::map<std::string, RelationHash>& getRelations() const { return m_relations; }
+
+    /** Hexadecimal representation of a hash */
+    static std::string toString(Hash hash);
+
+protected:
+    /**
+    * @brief One instance of the compact graph
+    */
+    struct Node
+    {
+        instanceID stepId;
+        long int offset;                 //!< position of the record in m_buffer
+        std::string type;                //!< keyword, empty for complex instances
+        std::string text;                //!< normalized record
+        std::vector<int> children;       //!< index of referenced nodes, -1 for unresolved
+        int level;                       //!< 0 for leaves, 1 + max(children outside its cycle) otherwise
+        int cycle;                       //!< index in m_cycles, -1 if the node is not in a cycle
+        bool anchored;                   //!< referenced by its identity (anchorHash) instead of its hash
+        Hash anchorHash;
+        Hash hash;
+    };
+
+    std::string m_buffer;                //!< complete file content
+    std::vector<Node> m_nodes;
+    std::map<instanceID, int> m_index;   //!< stepId --> index in m_nodes
+    std::vector< std::vector<int> > m_cycles; //!< strongly connected components with a cycle
+
+    std::map<std::string, PartHash> m_parts;
+    std::map<std::string, RelationHash> m_relations;
+
+    WrapperErrorCode m_errorCode;
+    std::string m_errorMessage;
+
+    // Managed Entity Names (as written in the file)
+    static const char* PD;
+    static const char* PDF;
+    static const char* P;
+    static const char* PDS;
+    static const char* SDR;
+    static const char* NAUO;
+    static const char* CDSR;
+    static const char* RR;
+
+    bool readBuffer(const std::string& fname);
+
+    /**
+    * @brief Collect the subgraphs reachable from the HLR entities and the representation relationships
+    * 
+    * Uses the forward references of the lazy index.
+    */
+    void extractGraph(lazyInstMgr& mgr, std::vector<int>& pds, std::vector<int>& sdrs,
+                      std::vector<int>& nauos, std::vector<int>& cdsrs, std::vector<int>& rrs);
+
+    /**
+    * @brief Fill Node::type and Node::text from the raw record
+    */
+    void normalizeRecord(Node& node) const;
+
+    /**
+    * @brief Compute Node::level and Node::cycle over the strongly connected components
+    * @return highest level
+    */
+    int computeLevels();
+
+    /**
+    * @brief Compute Node::hash for all the nodes, level by level
+    */
+    void computeHashes(int maxLevel, unsigned int threads);
+
+    void hashNode(Node& node) const;
+
+    /** Replace the content hashes of the members of a cycle by their hash in the cycle */
+    void hashCycle(const std::vector<int>& members);
+
+    /** First child of a node with the given type, -1 if none */
+    int findChild(int node, const char* type) const;
+
+    /** Product name of a PD (PD.PDF.P.name) */
+    std::string productName(int pd) const;
+
+    /**
+    * @brief Get a top level attribute from a normalized simple record
+    * @param[in] text normalized record, e.g. "PRODUCT('id','name','',(#))"
+    * @param[in] index position of the attribute
+    */
+    static std::string attributeValue(const std::string& text, int index);
+
+    static Hash hashBytes(const char* data, size_t size, Hash seed);
+    static Hash combine(Hash seed, Hash value);
+
+    template<typename Function>
+    static void parallelFor(size_t count, unsigned int threads, Function function);
+};
+
+
+class Step3D_Diff_Imp: public IStep3D_Diff_Wrapper
+{
+public:
+    Step3D_Diff_Imp();
+    virtual ~Step3D_Diff_Imp();
+
+    bool compare(std::string oldFname, std::string newFname) override;
+    void setThreadCount(unsigned int count) override;
+
+    std::list<PartDiff_Wrapper> getPartDiffs() override;
+    std::list<RelationDiff_Wrapper> getRelationDiffs() override;
+    bool hasChanges() const override;
+
+    bool hasFailed() const override;
+    WrapperErrorCode getError() const override;
+    void clearError() override;
+    std::string getErrorMessage() override;
+
+    void Release() override;
+
+protected:
+    unsigned int m_threads;              //!< 0 to use the hardware concurrency
+
+    std::list<PartDiff_Wrapper> m_partDiffs;
+    std::list<RelationDiff_Wrapper> m_relationDiffs;
+
+    WrapperErrorCode m_errorCode;
+    std::string m_errorMessage;
+
+    void compareParts(const Step3D_MerkleIndex& oldIndex, const Step3D_MerkleIndex& newIndex);
+    void compareRelations(const Step3D_MerkleIndex& oldIndex, const Step3D_MerkleIndex& newIndex);
+};
@@ -0,0 +1,350 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="DstController.cs" company="Open Engineering S.A.">
+//    Copyright (c) 2020-2021 Open Engineering S.A.
+// 
+//    Author: Juan Pablo Hernandez Vogt
+//
+//    This file is part of DEHP STEP-AP242 (STEP 3D CAD) adapter project.
+// 
+//    The DEHP STEP-AP242 is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+// 
+//    The DEHP STEP-AP242 is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+// 
+//    You should have received a copy of the GNU Lesser General Public License
+//    along with this program; if not, write to the Free Software Foundation,
+//    Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+// </copyright>
+// --------------------------------------------------------------------------------------------------------------------
+
+
+#include "Step3D_HLRCache.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+using namespace std;
+
+
+const uint32_t Step3D_HLRCache::Version = 2;   // 2: axis of the placements was the ref_direction
+
+static const char Magic[6] = { 'S', '3', 'D', 'H', 'L', 'R' };
+static const uint32_t ByteOrderMark = 0x01020304;
+
+// Multipliers of the content hash (from xxHash64)
+static const uint64_t Prime1 = 11400714785074694791ULL;
+static const uint64_t Prime2 = 14029467366897019727ULL;
+
+static uint64_t rotateLeft(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static uint64_t mixWord(uint64_t h, uint64_t w)
+{
+    return rotateLeft(h ^ (w * Prime2), 31) * Prime1;
+}
+
+static uint64_t finalMix(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= Prime2;
+    h ^= h >> 29;
+    h *= Prime1;
+    h ^= h >> 32;
+    return h;
+}
+
+// Binary output helpers
+
+static void writeU32(ostream& out, uint32_t v) { out.write((const char*)&v, sizeof(v)); }
+static void writeU64(ostream& out, uint64_t v) { out.write((const char*)&v, sizeof(v)); }
+static void writeI32(ostream& out, int32_t v) { out.write((const char*)&v, sizeof(v)); }
+static void writeDouble(ostream& out, double v) { out.write((const char*)&v, sizeof(v)); }
+
+static void writeString(ostream& out, const string& s)
+{
+    writeU32(out, (uint32_t)s.size());
+    out.write(s.data(), s.size());
+}
+
+static void writeVector(ostream& out, const double v[3])
+{
+    for (int i = 0; i < 3; i++) writeDouble(out, v[i]);
+}
+
+// Binary input helpers, they leave the stream failed on a short read
+
+template <typename T>
+static T readValue(istream& in)
+{
+    T v = T();
+    in.read((char*)&v, sizeof(v));
+    return v;
+}
+
+static string readString(istream& in)
+{
+    uint32_t size = readValue<uint32_t>(in);
+
+    // A corrupted length must not allocate gigabytes
+    if (!in.good() || size > (64u << 20))
+    {
+        in.setstate(ios::failbit);
+        return string();
+    }
+
+    string s(size, '\0');
+    if (size > 0) in.read(&s[0], size);
+    return s;
+}
+
+static void readVector(istream& in, double v[3])
+{
+    for (int i = 0; i < 3; i++) v[i] = readValue<double>(in);
+}
+
+
+Step3D_HLRCache::Step3D_HLRCache(const std::string& directory)
+    : m_directory(directory)
+{
+}
+
+bool Step3D_HLRCache::statFile(const std::string& fname, Step3D_FileKey& key)
+{
+#ifdef _WIN32
+    struct _stat64 st;
+    if (_stat64(fname.c_str(), &st) != 0) return false;
+#else
+    struct stat st;
+    if (stat(fname.c_str(), &st) != 0) return false;
+#endif
+
+    key.size = (uint64_t)st.st_size;
+    key.mtime = (int64_t)st.st_mtime;
+    key.hash = 0;
+
+    return true;
+}
+
+bool Step3D_HLRCache::hashFile(const std::string& fname, uint64_t& hash)
+{
+    ifstream in(fname.c_str(), ios::binary);
+    if (!in.is_open()) return false;
+
+    // Words of 8 bytes, the tail is padded with zeros
+    vector<char> buffer(1 << 20);
+    uint64_t h = Prime1;
+    uint64_t total = 0;
+
+    while (in)
+    {
+        in.read(&buffer[0], buffer.size());
+        const size_t count = (size_t)in.gcount();
+        if (count == 0) break;
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            uint64_t w;
+            memcpy(&w, &buffer[i], 8);
+            h = mixWord(h, w);
+        }
+
+        if (i < count)
+        {
+            uint64_t w = 0;
+            memcpy(&w, &buffer[i], count - i);
+            h = mixWord(h, w);
+        }
+
+        total += count;
+    }
+
+    hash = finalMix(h ^ total);
+    return !in.bad();
+}
+
+std::string Step3D_HLRCache::snapshotName(const std::string& fname) const
+{
+    if (m_directory.empty())
+    {
+        return fname + ".hlr";
+    }
+
+    // Base name plus a hash of the full path, so files with the same
+    // name in different folders do not share a snapshot
+    const size_t slash = fname.find_last_of("/\\");
+    const string base = (slash == string::npos) ? fname : fname.substr(slash + 1);
+
+    uint64_t h = Prime1;
+    for (char c : fname)
+    {
+        h = mixWord(h, (unsigned char)c);
+    }
+
+    ostringstream name;
+    name << m_directory;
+    const char last = m_directory[m_directory.size() - 1];
+    if (last != '/' && last != '\\') name << '/';
+    name << base << '.' << hex << setw(16) << setfill('0') << finalMix(h) << ".hlr";
+
+    return name.str();
+}
+
+bool Step3D_HLRCache::read(const std::string& fname, Step3D_FileKey& key, Step3D_HLRSnapshot& snapshot) const
+{
+    ifstream in(snapshotName(fname).c_str(), ios::binary);
+    if (!in.is_open()) return false;
+
+    char magic[sizeof(Magic)];
+    in.read(magic, sizeof(magic));
+    if (!in.good() || memcmp(magic, Magic, sizeof(Magic)) != 0) return false;
+    if (readValue<uint32_t>(in) != Version) return false;
+    if (readValue<uint32_t>(in) != ByteOrderMark) return false;
+
+    Step3D_FileKey stored;
+    stored.size = readValue<uint64_t>(in);
+    stored.mtime = readValue<int64_t>(in);
+    stored.hash = readValue<uint64_t>(in);
+    if (!in.good()) return false;
+
+    // Cheap checks first, the content only when they match
+    if (stored.size != key.size || stored.mtime != key.mtime) return false;
+    if (key.hash == 0 && !hashFile(fname, key.hash)) return false;
+    if (stored.hash != key.hash) return false;
+
+    Step3D_HLRSnapshot result;
+    result.instanceCount = (long)readValue<uint64_t>(in);
+
+    Step3D_HeaderInfo_Wrapper& hi = result.headerInfo;
+    hi.file_description.description = readString(in);
+    hi.file_description.implementation_level = readString(in);
+    hi.file_name.name = readString(in);
+    hi.file_name.time_stamp = readString(in);
+    hi.file_name.author = readString(in);
+    hi.file_name.organization = readString(in);
+    hi.file_name.preprocessor_version = readString(in);
+    hi.file_name.originating_system = readString(in);
+    hi.file_name.authorisation = readString(in);
+    hi.file_schema = readString(in);
+
+    const uint32_t partCount = readValue<uint32_t>(in);
+    for (uint32_t i = 0; i < partCount && in.good(); i++)
+    {
+        Part_Wrapper part;
+        part.stepId = readValue<int32_t>(in);
+        part.type = readString(in);
+        part.name = readString(in);
+        part.placement.name = readString(in);
+        readVector(in, part.placement.location);
+        readVector(in, part.placement.axis);
+        readVector(in, part.placement.ref_direction);
+        part.representation_type = readString(in);
+        result.nodes.push_back(part);
+    }
+
+    const uint32_t relationCount = readValue<uint32_t>(in);
+    for (uint32_t i = 0; i < relationCount && in.good(); i++)
+    {
+        Relation_Wrapper relation;
+        relation.stepId = readValue<int32_t>(in);
+        relation.type = readString(in);
+        relation.id = readString(in);
+        relation.name = readString(in);
+        relation.relating_id = readValue<int32_t>(in);
+        relation.related_id = readValue<int32_t>(in);
+        result.relations.push_back(relation);
+    }
+
+    if (!in.good()) return false;
+
+    snapshot = result;
+    return true;
+}
+
+bool Step3D_HLRCache::write(const std::string& fname, Step3D_FileKey key, const Step3D_HLRSnapshot& snapshot) const
+{
+    if (key.hash == 0 && !hashFile(fname, key.hash)) return false;
+
+    const string name = snapshotName(fname);
+    const string tmpName = name + ".tmp";
+
+    {
+        ofstream out(tmpName.c_str(), ios::binary | ios::trunc);
+        if (!out.is_open()) return false;
+
+        out.write(Magic, sizeof(Magic));
+        writeU32(out, Version);
+        writeU32(out, ByteOrderMark);
+
+        writeU64(out, key.size);
+        writeU64(out, (uint64_t)key.mtime);
+        writeU64(out, key.hash);
+
+        writeU64(out, (uint64_t)snapshot.instanceCount);
+
+        const Step3D_HeaderInfo_Wrapper& hi = snapshot.headerInfo;
+        writeString(out, hi.file_description.description);
+        writeString(out, hi.file_description.implementation_level);
+        writeString(out, hi.file_name.name);
+        writeString(out, hi.file_name.time_stamp);
+        writeString(out, hi.file_name.author);
+        writeString(out, hi.file_name.organization);
+        writeString(out, hi.file_name.preprocessor_version);
+        writeString(out, hi.file_name.originating_system);
+        writeString(out, hi.file_name.authorisation);
+        writeString(out, hi.file_schema);
+
+        writeU32(out, (uint32_t)snapshot.nodes.size());
+        for (const Part_Wrapper& part : snapshot.nodes)
+        {
+            writeI32(out, part.stepId);
+            writeString(out, part.type);
+            writeString(out, part.name);
+            writeString(out, part.placement.name);
+            writeVector(out, part.placement.location);
+            writeVector(out, part.placement.axis);
+            writeVector(out, part.placement.ref_direction);
+            writeString(out, part.representation_type);
+        }
+
+        writeU32(out, (uint32_t)snapshot.relations.size());
+        for (const Relation_Wrapper& relation : snapshot.relations)
+        {
+            writeI32(out, relation.stepId);
+            writeString(out, relation.type);
+            writeString(out, relation.id);
+            writeString(out, relation.name);
+            writeI32(out, relation.relating_id);
+            writeI32(out, relation.related_id);
+        }
+
+        if (!out.good())
+        {
+            out.close();
+            remove(tmpName.c_str());
+            return false;
+        }
+    }
+
+    // rename() does not replace an existing file on Windows
+    remove(name.c_str());
+    if (rename(tmpName.c_str(), name.c_str()) != 0)
+    {
+        remove(tmpName.c_str());
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,126 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="DstController.cs" company="Open Engineering S.A.">
+//    Copyright (c) 2020-2021 Open Engineering S.A.
+// 
+//    Author: Juan Pablo Hernandez Vogt
+//
+//    This file is part of DEHP STEP-AP242 (STEP 3D CAD) adapter project.
+// 
+//    The DEHP STEP-AP242 is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+// 
+//    The DEHP STEP-AP242 is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+// 
+//    You should have received a copy of the GNU Lesser General Public License
+//    along with this program; if not, write to the Free Software Foundation,
+//    Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+// </copyright>
+// --------------------------------------------------------------------------------------------------------------------
+
+
+#pragma once
+
+/**
+* Binary snapshot of the HLR information of a STEP-3D file
+* 
+* Not linked to Stepcode, only the wrapper structs are stored.
+*/
+#include "step3d_wrapper.h"
+
+// STL headers
+#include <cstdint>
+#include <string>
+#include <list>
+
+
+/**
+* @brief Identity of the content of a STEP file
+* 
+* Size and modification time are checked first, the content hash only
+* when both match, so a changed file is detected without reading it.
+*/
+struct Step3D_FileKey
+{
+    uint64_t size;
+    int64_t mtime;      //!< Modification time, seconds since the epoch
+    uint64_t hash;      //!< Hash of the whole content, 0 when not computed yet
+
+    Step3D_FileKey() : size(0), mtime(0), hash(0) {}
+};
+
+/**
+* @brief HLR information stored in a snapshot
+*/
+struct Step3D_HLRSnapshot
+{
+    Step3D_HeaderInfo_Wrapper headerInfo;
+    std::list<Part_Wrapper> nodes;
+    std::list<Relation_Wrapper> relations;
+    long instanceCount;                     //!< Instances of the DATA section, for the statistics
+
+    Step3D_HLRSnapshot() : instanceCount(0) {}
+};
+
+/**
+* @brief Versioned binary cache of the HLR information
+* 
+* Layout (native byte order, checked by a byte order mark):
+* - magic "S3DHLR", version, byte order mark
+* - file key (size, mtime, hash)
+* - header info strings
+* - parts, relations (count, then the fields; strings as length + bytes)
+* 
+* A snapshot is written next to the STEP file (<file>.hlr) or in a cache
+* directory (<name>.<path hash>.hlr). It is written to a temporary file
+* and renamed, so a reader never sees a partial snapshot.
+*/
+class Step3D_HLRCache
+{
+public:
+    static const uint32_t Version;
+
+    /**
+    * @brief Set where the snapshots are stored
+    * @param[in] directory cache directory, empty to store them next to the STEP files
+    */
+    Step3D_HLRCache(const std::string& directory = "");
+
+    /**
+    * @brief Get the size and modification time of a file
+    * @return false if the file does not exist
+    */
+    static bool statFile(const std::string& fname, Step3D_FileKey& key);
+
+    /**
+    * @brief Hash the whole content of a file
+    * @return false if the file can not be read
+    */
+    static bool hashFile(const std::string& fname, uint64_t& hash);
+
+    /**
+    * @brief Name of the snapshot of a STEP file
+    */
+    std::string snapshotName(const std::string& fname) const;
+
+    /**
+    * @brief Read the snapshot of a STEP file if it matches its current content
+    * @param[in,out] key current size and modification time; the hash is filled when computed
+    * @return true on a hit
+    */
+    bool read(const std::string& fname, Step3D_FileKey& key, Step3D_HLRSnapshot& snapshot) const;
+
+    /**
+    * @brief Write the snapshot of a STEP file
+    * @param[in] key size, modification time and hash of the file (the hash is computed when 0)
+    * @return false if the snapshot can not be written
+    */
+    bool write(const std::string& fname, Step3D_FileKey key, const Step3D_HLRSnapshot& snapshot) const;
+
+private:
+    std::string m_directory;
+};
@@ -0,0 +1,171 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="DstController.cs" company="Open Engineering S.A.">
+//    Copyright (c) 2020-2021 Open Engineering S.A.
+// 
+//    Author: Juan Pablo Hernandez Vogt
+//
+//    This file is part of DEHP STEP-AP242 (STEP 3D CAD) adapter project.
+// 
+//    The DEHP STEP-AP242 is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+// 
+//    The DEHP STEP-AP242 is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+// 
+//    You should have received a copy of the GNU Lesser General Public License
+//    along with this program; if not, write to the Free Software Foundation,
+//    Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+// </copyright>
+// --------------------------------------------------------------------------------------------------------------------
+
+
+#include "Step3D_LoadRecorder.h"
+
+// STEPcode headers
+#include "sc_benchmark.h"
+
+#include <fstream>
+#include <iomanip>
+using namespace std;
+
+
+static long cpuMilliseconds(const benchVals& vals)
+{
+    return vals.userMilliseconds + vals.sysMilliseconds;
+}
+
+static string jsonString(const string& s)
+{
+    string out("\"");
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\') out += '\\';
+        if ((unsigned char)c < 0x20) c = ' ';
+        out += c;
+    }
+    return out + "\"";
+}
+
+Step3D_LoadRecorder::Step3D_LoadRecorder()
+{
+    reset(0);
+}
+
+void Step3D_LoadRecorder::reset(long long fileSize)
+{
+    m_origin = Clock::now();
+    m_fileSize = fileSize;
+    m_phases.clear();
+    m_open = false;
+}
+
+void Step3D_LoadRecorder::begin(const char* name, long position)
+{
+    if (m_open) end();
+
+    benchVals vals = getMemAndTime();
+
+    Phase phase;
+    phase.stats.name = name;
+    phase.stats.start = chrono::duration<double>(Clock::now() - m_origin).count();
+    phase.position = position;
+    phase.cpuMs = cpuMilliseconds(vals);
+    phase.heap = getHeapInUse();
+
+    m_phases.push_back(phase);
+    m_open = true;
+}
+
+void Step3D_LoadRecorder::end(long position)
+{
+    if (!m_open) return;
+
+    benchVals vals = getMemAndTime();
+    long long heap = getHeapInUse();
+
+    Phase& phase = m_phases.back();
+    Step3D_PhaseStats_Wrapper& stats = phase.stats;
+
+    stats.wall_time = chrono::duration<double>(Clock::now() - m_origin).count() - stats.start;
+    stats.cpu_time = (cpuMilliseconds(vals) - phase.cpuMs) / 1000.0;
+    stats.memory_kb = vals.physMemKB;
+    stats.heap_delta = (heap < 0 || phase.heap < 0) ? -1 : heap - phase.heap;
+
+    if (phase.position >= 0)
+    {
+        stats.bytes = (position >= 0 ? position : m_fileSize) - phase.position;
+    }
+
+    m_open = false;
+}
+
+void Step3D_LoadRecorder::PhaseBegin(const char* phase, long position)
+{
+    begin(phase, position);
+    if (m_listener) m_listener(phase, position);
+}
+
+void Step3D_LoadRecorder::PhaseEnd(const char* phase, long position)
+{
+    end(position);
+    if (m_listener) m_listener(phase, position < 0 ? (long)m_fileSize : position);
+}
+
+void Step3D_LoadRecorder::PhaseProgress(const char* phase, long position)
+{
+    if (m_listener) m_listener(phase, position);
+}
+
+void Step3D_LoadRecorder::fill(Step3D_LoadStats_Wrapper& stats) const
+{
+    stats.phases.clear();
+    stats.peak_memory_kb = 0;
+
+    for (const Phase& phase : m_phases)
+    {
+        stats.phases.push_back(phase.stats);
+        if (phase.stats.memory_kb > stats.peak_memory_kb)
+        {
+            stats.peak_memory_kb = phase.stats.memory_kb;
+        }
+    }
+}
+
+bool Step3D_LoadRecorder::writeTrace(const std::string& fname, const Step3D_LoadStats_Wrapper& stats) const
+{
+    ofstream out(fname.c_str());
+    if (!out.good()) return false;
+
+    // Complete events ("ph": "X"), times in microseconds
+    out << fixed << setprecision(0);
+    out << "{\"traceEvents\": [" << endl;
+
+    for (size_t i = 0; i < m_phases.size(); i++)
+    {
+        const Step3D_PhaseStats_Wrapper& p = m_phases[i].stats;
+
+        out << "  {\"name\": " << jsonString(p.name)
+            << ", \"cat\": \"step3d\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1"
+            << ", \"ts\": " << p.start * 1e6
+            << ", \"dur\": " << p.wall_time * 1e6
+            << ", \"args\": {\"cpu_ms\": " << p.cpu_time * 1e3
+            << ", \"bytes\": " << p.bytes
+            << ", \"heap_delta\": " << p.heap_delta
+            << ", \"memory_kb\": " << p.memory_kb
+            << "}}" << (i + 1 < m_phases.size() ? "," : "") << endl;
+    }
+
+    out << "], \"displayTimeUnit\": \"ms\", \"otherData\": {"
+        << "\"file_size\": " << stats.file_size
+        << ", \"instances\": " << stats.instance_count
+        << ", \"errors\": " << stats.error_count
+        << ", \"warnings\": " << stats.warning_count
+        << ", \"peak_memory_kb\": " << stats.peak_memory_kb
+        << "}}" << endl;
+
+    return out.good();
+}
@@ -0,0 +1,117 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="DstController.cs" company="Open Engineering S.A.">
+//    Copyright (c) 2020-2021 Open Engineering S.A.
+// 
+//    Author: Juan Pablo Hernandez Vogt
+//
+//    This file is part of DEHP STEP-AP242 (STEP 3D CAD) adapter project.
+// 
+//    The DEHP STEP-AP242 is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+// 
+//    The DEHP STEP-AP242 is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+// 
+//    You should have received a copy of the GNU Lesser General Public License
+//    along with this program; if not, write to the Free Software Foundation,
+//    Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+// </copyright>
+// --------------------------------------------------------------------------------------------------------------------
+
+
+#pragma once
+
+/**
+* Measures the phases of a Step3D_Wrapper_Imp load
+* 
+* Linked to Stepcode shared libraries (sc_benchmark, STEPfile).
+*/
+#include "step3d_wrapper.h"
+
+// STEPcode headers
+#include "STEPfile.h"
+
+// STL headers
+#include <chrono>
+#include <functional>
+#include <vector>
+
+
+/**
+* @brief Recorder of the load phases
+* 
+* Phases are measured with begin() and end(), or reported by the
+* STEPfile it observes (header, pass1, pass2 or data). Each phase
+* records the wall clock, the process CPU time and memory given by
+* getMemAndTime(), and the heap in use given by getHeapInUse().
+* 
+* The STEPfile notifications (begin, end and progress of its phases)
+* are forwarded to an optional listener, used to report the progress
+* of the load.
+*/
+class Step3D_LoadRecorder: public STEPfileReadObserver
+{
+public:
+    Step3D_LoadRecorder();
+
+    /**
+    * @brief Forget the phases and take the start of the time line
+    * @param[in] fileSize size of the file that is going to be read
+    */
+    void reset(long long fileSize);
+
+    /**
+    * @brief Start a phase
+    * @param[in] position stream position, -1 when the phase does not read the file
+    */
+    void begin(const char* name, long position = -1);
+
+    /**
+    * @brief Finish the phase started last
+    * @param[in] position stream position, -1 at the end of the file
+    */
+    void end(long position = -1);
+
+    void PhaseBegin(const char* phase, long position) override;
+    void PhaseEnd(const char* phase, long position) override;
+    void PhaseProgress(const char* phase, long position) override;
+
+    /**
+    * @brief Set the receiver of the STEPfile notifications
+    * 
+    * Called with the phase name and the stream position (-1 when not available).
+    */
+    void setListener(std::function<void(const char*, long)> listener) { m_listener = listener; }
+
+    /**
+    * @brief Fill the phases and the memory peak of the statistics
+    */
+    void fill(Step3D_LoadStats_Wrapper& stats) const;
+
+    /**
+    * @brief Write the phases as Chrome trace events (JSON object format)
+    */
+    bool writeTrace(const std::string& fname, const Step3D_LoadStats_Wrapper& stats) const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Phase
+    {
+        Step3D_PhaseStats_Wrapper stats;
+        long position;                  //!< Stream position at the start
+        long cpuMs;                     //!< Process CPU time at the start
+        long long heap;                 //!< Heap in use at the start
+    };
+
+    Clock::time_point m_origin;
+    long long m_fileSize;
+    std::vector<Phase> m_phases;
+    bool m_open;                        //!< The last phase is not finished
+
+    std::function<void(const char*, long)> m_listener;
+};
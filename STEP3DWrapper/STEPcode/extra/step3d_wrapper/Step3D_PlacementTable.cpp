@@ -0,0 +1,143 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="DstController.cs" company="Open Engineering S.A.">
+//    Copyright (c) 2020-2021 Open Engineering S.A.
+// 
+//    Author: Juan Pablo Hernandez Vogt
+//
+//    This file is part of DEHP STEP-AP242 (STEP 3D CAD) adapter project.
+// 
+//    The DEHP STEP-AP242 is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+// 
+//    The DEHP STEP-AP242 is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+// 
+//    You should have received a copy of the GNU Lesser General Public License
+//    along with this program; if not, write to the Free Software Foundation,
+//    Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+// </copyright>
+// --------------------------------------------------------------------------------------------------------------------
+
+
+#include "Step3D_PlacementTable.h"
+
+#include <cmath>
+using namespace std;
+
+
+// Rotations of n rows, see Step3D_PlacementTable::computeRotations
+//
+// The columns are separate parameters so they can be declared __restrict:
+// they all point into the same vector, and without it the compiler cannot
+// tell that the writes do not overlap the reads
+static void computeRotationRows(size_t n,
+    const double* __restrict ax, const double* __restrict ay, const double* __restrict az,
+    const double* __restrict rx, const double* __restrict ry, const double* __restrict rz,
+    double* __restrict xx, double* __restrict xy, double* __restrict xz,
+    double* __restrict yx, double* __restrict yy, double* __restrict yz,
+    double* __restrict zx, double* __restrict zy, double* __restrict zz)
+{
+    // Below this squared length a direction is taken as missing
+    const double epsilon = 1e-24;
+
+    // The defaults are blended in with 0/1 weights rather than selected, so
+    // every operation runs for every row and the loop has no branches; see
+    // CMakeLists.txt for the flags GCC needs to vectorise it
+    for (size_t i = 0; i < n; i++)
+    {
+        // Z: the axis, (0,0,1) by default
+        double z0 = ax[i], z1 = ay[i], z2 = az[i];
+        double len2 = z0 * z0 + z1 * z1 + z2 * z2;
+        double given = len2 < epsilon ? 0.0 : 1.0;
+        double inv = given / sqrt(len2 + (1.0 - given));
+        z0 *= inv;
+        z1 *= inv;
+        z2 = z2 * inv + (1.0 - given);
+
+        // X: the ref_direction, (1,0,0) by default, without its component along Z
+        double r0 = rx[i], r1 = ry[i], r2 = rz[i];
+        len2 = r0 * r0 + r1 * r1 + r2 * r2;
+        given = len2 < epsilon ? 0.0 : 1.0;
+        r0 = r0 * given + (1.0 - given);
+        r1 *= given;
+        r2 *= given;
+
+        double d = r0 * z0 + r1 * z1 + r2 * z2;
+        double x0 = r0 - d * z0, x1 = r1 - d * z1, x2 = r2 - d * z2;
+        len2 = x0 * x0 + x1 * x1 + x2 * x2;
+
+        // Parallel to Z: use the global axis least aligned with Z instead
+        double parallel = len2 < epsilon ? 1.0 : 0.0;
+        double e1 = fabs(z0) > 0.9 ? 1.0 : 0.0;
+        double e0 = 1.0 - e1;
+        d = e0 * z0 + e1 * z1;
+        x0 += parallel * (e0 - d * z0 - x0);
+        x1 += parallel * (e1 - d * z1 - x1);
+        x2 += parallel * (-d * z2 - x2);
+        len2 = x0 * x0 + x1 * x1 + x2 * x2;
+
+        inv = 1.0 / sqrt(len2);
+        x0 *= inv;
+        x1 *= inv;
+        x2 *= inv;
+
+        xx[i] = x0;
+        xy[i] = x1;
+        xz[i] = x2;
+
+        // Y = Z x X
+        yx[i] = z1 * x2 - z2 * x1;
+        yy[i] = z2 * x0 - z0 * x2;
+        yz[i] = z0 * x1 - z1 * x0;
+
+        zx[i] = z0;
+        zy[i] = z1;
+        zz[i] = z2;
+    }
+}
+
+void Step3D_PlacementTable::build(const list<Part_Wrapper>& nodes, Step3D_PlacementTable_Wrapper& table)
+{
+    const size_t n = nodes.size();
+
+    table.count = n;
+    table.stepId.assign(n, 0);
+    table.values.assign((size_t)PlacementColumn::COUNT * n, 0.0);
+
+    double* location[3] = { table.column(PlacementColumn::LOCATION_X), table.column(PlacementColumn::LOCATION_Y), table.column(PlacementColumn::LOCATION_Z) };
+    double* axis[3] = { table.column(PlacementColumn::AXIS_X), table.column(PlacementColumn::AXIS_Y), table.column(PlacementColumn::AXIS_Z) };
+    double* ref[3] = { table.column(PlacementColumn::REF_DIRECTION_X), table.column(PlacementColumn::REF_DIRECTION_Y), table.column(PlacementColumn::REF_DIRECTION_Z) };
+
+    size_t i = 0;
+    for (const Part_Wrapper& node : nodes)
+    {
+        table.stepId[i] = node.stepId;
+
+        for (int k = 0; k < 3; k++)
+        {
+            location[k][i] = node.placement.location[k];
+            axis[k][i] = node.placement.axis[k];
+            ref[k][i] = node.placement.ref_direction[k];
+        }
+
+        i++;
+    }
+
+    computeRotations(table);
+}
+
+void Step3D_PlacementTable::computeRotations(Step3D_PlacementTable_Wrapper& table)
+{
+    // Local X, Y and Z axes are the columns of the rotation: the y component
+    // of X is stored in ROTATION_YX
+    computeRotationRows(table.count,
+        table.column(PlacementColumn::AXIS_X), table.column(PlacementColumn::AXIS_Y), table.column(PlacementColumn::AXIS_Z),
+        table.column(PlacementColumn::REF_DIRECTION_X), table.column(PlacementColumn::REF_DIRECTION_Y), table.column(PlacementColumn::REF_DIRECTION_Z),
+        table.column(PlacementColumn::ROTATION_XX), table.column(PlacementColumn::ROTATION_YX), table.column(PlacementColumn::ROTATION_ZX),
+        table.column(PlacementColumn::ROTATION_XY), table.column(PlacementColumn::ROTATION_YY), table.column(PlacementColumn::ROTATION_ZY),
+        table.column(PlacementColumn::ROTATION_XZ), table.column(PlacementColumn::ROTATION_YZ), table.column(PlacementColumn::ROTATION_ZZ));
+}
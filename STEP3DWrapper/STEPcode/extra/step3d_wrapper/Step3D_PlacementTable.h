@@ -0,0 +1,62 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="DstController.cs" company="Open Engineering S.A.">
+//    Copyright (c) 2020-2021 Open Engineering S.A.
+// 
+//    Author: Juan Pablo Hernandez Vogt
+//
+//    This file is part of DEHP STEP-AP242 (STEP 3D CAD) adapter project.
+// 
+//    The DEHP STEP-AP242 is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+// 
+//    The DEHP STEP-AP242 is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+// 
+//    You should have received a copy of the GNU Lesser General Public License
+//    along with this program; if not, write to the Free Software Foundation,
+//    Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+// </copyright>
+// --------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+/**
+* Builds the placement table of the HLR nodes
+* 
+* Not linked to Stepcode, only the wrapper structs are used.
+*/
+#include "step3d_wrapper.h"
+
+// STL headers
+#include <list>
+
+
+/**
+* @brief Fills a Step3D_PlacementTable_Wrapper from the parts
+* 
+* The placements are first copied into the columns, then all the rotations
+* are computed in one pass over the columns. That loop only reads and
+* writes contiguous arrays, without branches, so the compiler vectorises it.
+*/
+class Step3D_PlacementTable
+{
+public:
+    /**
+    * @brief Fill the table from the placements of the parts
+    * @param[in] nodes parts, in the order of the rows
+    * @param[out] table placement table, previous content is discarded
+    */
+    static void build(const std::list<Part_Wrapper>& nodes, Step3D_PlacementTable_Wrapper& table);
+
+    /**
+    * @brief Compute the ROTATION_* columns from the AXIS_* and REF_DIRECTION_* columns
+    * 
+    * Directions of zero length are replaced by the AP242 defaults, and a
+    * ref_direction parallel to the axis by another direction normal to it.
+    */
+    static void computeRotations(Step3D_PlacementTable_Wrapper& table);
+};
@@ -0,0 +1,285 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="DstController.cs" company="Open Engineering S.A.">
+//    Copyright (c) 2020-2021 Open Engineering S.A.
+// 
+//    Author: Juan Pablo Hernandez Vogt
+//
+//    This file is part of DEHP STEP-AP242 (STEP 3D CAD) adapter project.
+// 
+//    The DEHP STEP-AP242 is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+// 
+//    The DEHP STEP-AP242 is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+// 
+//    You should have received a copy of the GNU Lesser General Public License
+//    along with this program; if not, write to the Free Software Foundation,
+//    Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+// </copyright>
+// --------------------------------------------------------------------------------------------------------------------
+
+#include "Step3D_Probe_Imp.h"
+#include "Step3D_Wrapper_Imp.h"
+
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <cctype>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+using namespace std;
+
+
+// The instance ids are looked for in this last part of the file
+static const long long TailSize = 64 * 1024;
+
+/** The DATA section is not read, the schema has no entity to register */
+static void NoSchemaInit(Registry&)
+{
+}
+
+
+Step3D_Probe_Imp::Step3D_Probe_Imp()
+{
+    m_threads = 0;
+    m_errorCode = WrapperErrorCode::NO_ERROR;
+}
+
+Step3D_Probe_Imp::~Step3D_Probe_Imp()
+{
+}
+
+bool Step3D_Probe_Imp::probe(std::string fname)
+{
+    clearError();
+    m_results.clear();
+
+    m_results.push_back(probeFile(fname));
+
+    const Step3D_ProbeInfo_Wrapper& info = m_results.back();
+    m_errorCode = info.error;
+    m_errorMessage = info.error_message;
+
+    return !hasFailed();
+}
+
+bool Step3D_Probe_Imp::probeDirectory(std::string directory)
+{
+    clearError();
+    m_results.clear();
+
+    std::vector<std::string> files;
+    if (!listStepFiles(directory, files))
+    {
+        m_errorCode = WrapperErrorCode::FILE_NOT_FOUND;
+        m_errorMessage = "Directory cannot be read: " + directory;
+        return false;
+    }
+
+    unsigned int threads = m_threads ? m_threads : std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+    threads = (unsigned int)std::min<size_t>(threads, files.size());
+
+    // Each worker takes the next file, the headers are small and of similar size
+    std::vector<Step3D_ProbeInfo_Wrapper> results(files.size());
+    std::atomic<size_t> next(0);
+    auto worker = [&files, &results, &next]()
+    {
+        for (size_t i = next++; i < files.size(); i = next++)
+        {
+            results[i] = probeFile(files[i]);
+        }
+    };
+
+    if (threads <= 1)
+    {
+        worker();
+    }
+    else
+    {
+        std::vector<std::thread> workers;
+        for (unsigned int t = 0; t < threads; t++)
+        {
+            workers.push_back(std::thread(worker));
+        }
+
+        for (auto& w : workers)
+        {
+            w.join();
+        }
+    }
+
+    m_results.assign(results.begin(), results.end());
+    return true;
+}
+
+void Step3D_Probe_Imp::setThreadCount(unsigned int count)
+{
+    m_threads = count;
+}
+
+std::list<Step3D_ProbeInfo_Wrapper> Step3D_Probe_Imp::getResults()
+{
+    return m_results;
+}
+
+bool Step3D_Probe_Imp::hasFailed() const
+{
+    return m_errorCode != WrapperErrorCode::NO_ERROR;
+}
+
+WrapperErrorCode Step3D_Probe_Imp::getError() const
+{
+    return m_errorCode;
+}
+
+void Step3D_Probe_Imp::clearError()
+{
+    m_errorCode = WrapperErrorCode::NO_ERROR;
+    m_errorMessage.clear();
+}
+
+std::string Step3D_Probe_Imp::getErrorMessage()
+{
+    return m_errorMessage;
+}
+
+void Step3D_Probe_Imp::Release()
+{
+    delete this;
+}
+
+Step3D_ProbeInfo_Wrapper Step3D_Probe_Imp::probeFile(const std::string& fname)
+{
+    Step3D_ProbeInfo_Wrapper info;
+    info.filename = fname;
+
+    ifstream file(fname.c_str(), ios::binary);
+    if (!file.is_open())
+    {
+        info.error = WrapperErrorCode::FILE_NOT_FOUND;
+        info.error_message = "File does not exists: " + fname;
+        return info;
+    }
+
+    file.seekg(0, ios::end);
+    info.file_size = (long long)file.tellg();
+    info.estimated_instance_count = estimateInstanceCount(file, info.file_size);
+    file.close();
+
+    try
+    {
+        Registry registry(NoSchemaInit);
+        InstMgr instances;
+        STEPfile stepfile(registry, instances, "", false);
+
+        if (stepfile.ReadExchangeHeader(fname) < SEVERITY_WARNING)
+        {
+            info.error = WrapperErrorCode::FILE_READ;
+            info.error_message = "HEADER section cannot be read: " + fname;
+            return info;
+        }
+
+        Step3D_Wrapper_Imp::readHeaderInfo(stepfile.HeaderInstances(), info.header);
+    }
+    catch (std::exception& e)
+    {
+        info.error = WrapperErrorCode::FILE_PROCESS;
+        info.error_message = string(e.what()) + " at Step3D_Probe_Imp::probeFile()";
+    }
+
+    return info;
+}
+
+long Step3D_Probe_Imp::estimateInstanceCount(std::ifstream& file, long long size)
+{
+    const long long start = std::max(0LL, size - TailSize);
+
+    std::string tail((size_t)(size - start), '\0');
+    file.seekg(start);
+    file.read(&tail[0], tail.size());
+    tail.resize((size_t)file.gcount());
+
+    // An instance starts with "#<id>=", a reference to it is not followed by '='
+    long highest = 0;
+    size_t pos = 0;
+    while ((pos = tail.find('#', pos)) != std::string::npos)
+    {
+        long id = 0;
+        size_t end = ++pos;
+        while (end < tail.size() && isdigit((unsigned char)tail[end]))
+        {
+            id = id * 10 + (tail[end++] - '0');
+        }
+        if (end == pos) continue;
+
+        while (end < tail.size() && isspace((unsigned char)tail[end])) end++;
+        if (end < tail.size() && tail[end] == '=' && id > highest)
+        {
+            highest = id;
+        }
+        pos = end;
+    }
+
+    return highest;
+}
+
+bool Step3D_Probe_Imp::listStepFiles(const std::string& directory, std::vector<std::string>& files)
+{
+    std::string prefix = directory;
+    if (!prefix.empty() && prefix[prefix.size() - 1] != '/' && prefix[prefix.size() - 1] != '\\')
+    {
+        prefix += '/';
+    }
+
+#ifdef _WIN32
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileA((prefix + "*").c_str(), &data);
+    if (find == INVALID_HANDLE_VALUE) return false;
+
+    do
+    {
+        if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) && isStepFile(data.cFileName))
+        {
+            files.push_back(prefix + data.cFileName);
+        }
+    } while (FindNextFileA(find, &data));
+    FindClose(find);
+#else
+    DIR* dir = opendir(directory.c_str());
+    if (!dir) return false;
+
+    for (struct dirent* entry = readdir(dir); entry != NULL; entry = readdir(dir))
+    {
+        if (isStepFile(entry->d_name) && !DirObj::IsADirectory((prefix + entry->d_name).c_str()))
+        {
+            files.push_back(prefix + entry->d_name);
+        }
+    }
+    closedir(dir);
+#endif
+
+    std::sort(files.begin(), files.end());
+    return true;
+}
+
+bool Step3D_Probe_Imp::isStepFile(const std::string& name)
+{
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return (char)tolower(c); });
+
+    auto endsWith = [&lower](const std::string& suffix)
+    {
+        return lower.size() >= suffix.size() && 0 == lower.compare(lower.size() - suffix.size(), suffix.size(), suffix);
+    };
+    return endsWith(".stp") || endsWith(".step");
+}
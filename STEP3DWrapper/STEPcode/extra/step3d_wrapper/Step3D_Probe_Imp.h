@@ -0,0 +1,88 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="DstController.cs" company="Open Engineering S.A.">
+//    Copyright (c) 2020-2021 Open Engineering S.A.
+// 
+//    Author: Juan Pablo Hernandez Vogt
+//
+//    This file is part of DEHP STEP-AP242 (STEP 3D CAD) adapter project.
+// 
+//    The DEHP STEP-AP242 is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+// 
+//    The DEHP STEP-AP242 is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+// 
+//    You should have received a copy of the GNU Lesser General Public License
+//    along with this program; if not, write to the Free Software Foundation,
+//    Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+// </copyright>
+// --------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+/**
+* Implement the quick listing of STEP files
+*
+* Linked to Stepcode shared libraries (HEADER section only).
+*/
+#include "step3d_wrapper.h"
+
+// STL headers
+#include <fstream>
+#include <vector>
+
+
+class Step3D_Probe_Imp: public IStep3D_Probe_Wrapper
+{
+public:
+    Step3D_Probe_Imp();
+    virtual ~Step3D_Probe_Imp();
+
+    bool probe(std::string fname) override;
+    bool probeDirectory(std::string directory) override;
+    void setThreadCount(unsigned int count) override;
+
+    std::list<Step3D_ProbeInfo_Wrapper> getResults() override;
+
+    bool hasFailed() const override;
+    WrapperErrorCode getError() const override;
+    void clearError() override;
+    std::string getErrorMessage() override;
+
+    void Release() override;
+
+    /**
+    * @brief Read the summary of one file
+    * @param[in] fname full path to .stp|.step file
+    *
+    * Reads the HEADER section with STEPfile::ReadExchangeHeader(), and
+    * the last block of the file for the instance ids. Thread safe.
+    */
+    static Step3D_ProbeInfo_Wrapper probeFile(const std::string& fname);
+
+protected:
+    unsigned int m_threads;              //!< 0 to use the hardware concurrency
+
+    std::list<Step3D_ProbeInfo_Wrapper> m_results;
+
+    WrapperErrorCode m_errorCode;
+    std::string m_errorMessage;
+
+    /**
+    * @brief Get the highest instance id in the last block of a file
+    * @return 0 if the block has no instance
+    */
+    static long estimateInstanceCount(std::ifstream& file, long long size);
+
+    /**
+    * @brief Get the .stp|.step files of a directory, sorted by name
+    * @return false if the directory cannot be read
+    */
+    static bool listStepFiles(const std::string& directory, std::vector<std::string>& files);
+
+    static bool isStepFile(const std::string& name);
+};
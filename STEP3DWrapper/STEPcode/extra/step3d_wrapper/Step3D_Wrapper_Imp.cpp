@@ -25,12 +25,17 @@
 #pragma once
 
 #include "Step3D_Wrapper_Imp.h"
+#include "Step3D_AssemblyTree.h"
+#include "Step3D_PlacementTable.h"
 
 #include "SdaiHeaderSchema.h"
 
 
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 using namespace std;
 
 
@@ -46,6 +51,47 @@ const string Step3D_Wrapper_Imp::NAUO("Next_Assembly_Usage_Occurrence");
 const string Step3D_Wrapper_Imp::SDR("Shape_Definition_Representation");
 
 
+namespace ap242 = ap242_managed_model_based_3d_engineering_mim_lf;
+
+/**
+* @brief The instance as the generated class of an entity, without RTTI
+* @param[in] instance instance, may be null
+* @param[in] desc descriptor of the entity of class T
+* @return null if the instance is complex or its class does not derive from T
+*
+* Replaces dynamic_cast with the interval test of the generated type ids.
+*/
+template <class T>
+static T* entityCast(SDAI_Application_instance* instance, const EntityDescriptor* desc)
+{
+    if (instance == nullptr || instance->IsComplex() || instance->eDesc == nullptr || !instance->eDesc->DerivesFrom(desc))
+    {
+        return nullptr;
+    }
+    return static_cast<T*>(instance);
+}
+
+/**
+* @brief Sends the managed entities of the DATA section to the wrapper
+*
+* The subtypes of a managed entity reach the Visit() of the entity.
+*/
+class Step3D_Wrapper_Imp::ContentVisitor : public SdaiVisitor_ap242_managed_model_based_3d_engineering_mim_lf
+{
+public:
+    explicit ContentVisitor(Step3D_Wrapper_Imp& wrapper) : m_wrapper(wrapper) {}
+
+    void Visit(SdaiProduct_definition* instance) override { m_wrapper.processPD(instance); }
+    void Visit(SdaiNext_assembly_usage_occurrence* instance) override { m_wrapper.processNAUO(instance); }
+    void Visit(SdaiShape_definition_representation* instance) override { m_wrapper.processSDR(instance); }
+
+    using SdaiVisitor_ap242_managed_model_based_3d_engineering_mim_lf::Visit;
+
+private:
+    Step3D_Wrapper_Imp& m_wrapper;
+};
+
+
 class WrapperException
 {
 public:
@@ -150,19 +196,146 @@ Step3D_Wrapper_Imp::Step3D_Wrapper_Imp()
     m_stepfile = nullptr;
 
     m_errorCode = WrapperErrorCode::NO_ERROR;
+
+    m_running = false;
+    m_cancel = false;
+    m_progress = 0;
+    m_callback = nullptr;
+    m_userData = nullptr;
+
+    m_useCache = false;
+    m_fromCache = false;
+
+    m_recorder.setListener([this](const char* phase, long position) { reportReadProgress(phase, position); });
 }
 
 Step3D_Wrapper_Imp::~Step3D_Wrapper_Imp()
 {
     cout << "~Step3D_Wrapper_Imp" << endl;
 
+    if (m_worker.joinable())
+    {
+        cancel();
+        m_worker.join();
+    }
+
+    // Optional trace of the load, teardown included
+    const char* traceName = getenv("STEP3D_TRACE");
+    const bool trace = traceName && *traceName && (m_stepfile || m_fromCache);
+    if (trace && m_stepfile)
+    {
+        m_recorder.begin("teardown");
+    }
+
     delete m_instancelist;
     delete m_stepfile;
-    delete m_registry;
+
+    if (trace)
+    {
+        if (m_stepfile) m_recorder.end();
+        writeLoadTrace(traceName);
+    }
 }
 
 bool Step3D_Wrapper_Imp::load(std::string fname)
 {
+    m_cancel = false;
+    m_callback = nullptr;
+
+    return loadFile(fname);
+}
+
+bool Step3D_Wrapper_Imp::loadAsync(std::string fname, Step3D_ProgressCallback callback, void* userData)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_asyncMutex);
+        if (m_running) return false;
+        m_running = true;
+    }
+
+    if (m_worker.joinable()) m_worker.join();
+
+    m_cancel = false;
+    m_progress = 0;
+    m_callback = callback;
+    m_userData = userData;
+
+    m_worker = std::thread([this, fname]()
+    {
+        if (loadFile(fname))
+        {
+            parseHLRInformation();
+        }
+
+        reportProgress("done", 100);
+
+        std::lock_guard<std::mutex> lock(m_asyncMutex);
+        m_running = false;
+        m_asyncDone.notify_all();
+    });
+
+    return true;
+}
+
+bool Step3D_Wrapper_Imp::wait(unsigned int milliseconds)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_asyncMutex);
+        auto finished = [this]() { return !m_running; };
+
+        if (milliseconds == 0)
+        {
+            m_asyncDone.wait(lock, finished);
+        }
+        else if (!m_asyncDone.wait_for(lock, std::chrono::milliseconds(milliseconds), finished))
+        {
+            return false;
+        }
+    }
+
+    if (m_worker.joinable()) m_worker.join();
+
+    return true;
+}
+
+void Step3D_Wrapper_Imp::cancel()
+{
+    std::lock_guard<std::mutex> lock(m_asyncMutex);
+
+    m_cancel = true;
+    if (m_stepfile) m_stepfile->CancelRead();
+}
+
+float Step3D_Wrapper_Imp::getProgress() const
+{
+    return m_progress;
+}
+
+void Step3D_Wrapper_Imp::unloadFile()
+{
+    STEPfile* stepfile = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_asyncMutex);
+        stepfile = m_stepfile;
+        m_stepfile = nullptr;
+    }
+
+    delete m_instancelist;
+    delete stepfile;
+    m_instancelist = nullptr;
+
+    m_headerInfo = Step3D_HeaderInfo_Wrapper();
+    m_nodes.clear();
+    m_relations.clear();
+    m_PD2SDR_map.clear();
+    m_fileKey = Step3D_FileKey();
+    m_fromCache = false;
+}
+
+bool Step3D_Wrapper_Imp::loadFile(const std::string& fname)
+{
+    unloadFile();
+
     m_filename = fname;
 
     clearError();
@@ -173,15 +346,48 @@ bool Step3D_Wrapper_Imp::load(std::string fname)
 #ifdef __demo_wrapper__
     return true;
 #else
+    m_loadStats = Step3D_LoadStats_Wrapper();
+    {
+        ifstream ifile(m_filename, ios::binary | ios::ate);
+        m_loadStats.file_size = ifile.good() ? (long long)ifile.tellg() : 0;
+    }
+    m_recorder.reset(m_loadStats.file_size);
+
+    if (m_useCache && loadFromCache())
+    {
+        return true;
+    }
+
     int ownsInstanceMemory = 1;
     m_instancelist = new InstMgr(ownsInstanceMemory);
-    m_registry = new Registry(SchemaInit);
-    m_stepfile = new STEPfile(*m_registry, *m_instancelist);
+
+    reportProgress("registry", 0);
+    m_recorder.begin("registry");
+    m_registry = sharedRegistry();
+    m_recorder.end();
+
+    STEPfile* stepfile = new STEPfile(*m_registry, *m_instancelist);
+    stepfile->OnePassRead(true);
+    stepfile->ReadObserver(&m_recorder);
+    {
+        std::lock_guard<std::mutex> lock(m_asyncMutex);
+        m_stepfile = stepfile;
+        if (m_cancel) m_stepfile->CancelRead();
+    }
 
     try
     {
         Severity sev = m_stepfile->ReadExchangeFile(m_filename.c_str());
 
+        processLoadStatistics();
+
+        if (m_cancel)
+        {
+            m_errorCode = WrapperErrorCode::CANCELLED;
+            m_errorMessage = "Load cancelled: " + m_filename;
+            return false;
+        }
+
 #ifndef NDEBUG
         cout << "Severity: " << sev << endl;
         ErrorDescriptor errorDesc = m_stepfile->Error();
@@ -225,6 +431,13 @@ bool Step3D_Wrapper_Imp::parseHLRInformation()
 
     if (hasFailed()) return false; // avoid parsing when the current state has errors (from load)
 
+    if (m_fromCache)
+    {
+        cout << "HLR information read from the snapshot" << endl;
+        reportProgress("hlr", 100);
+        return true;
+    }
+
     if (m_stepfile == nullptr)
     {
         m_errorCode = WrapperErrorCode::FILE_NOT_FOUND;
@@ -232,6 +445,9 @@ bool Step3D_Wrapper_Imp::parseHLRInformation()
         return false;
     }
 
+    m_recorder.begin("hlr");
+    reportProgress("hlr", 90);
+
     try
     {
         processHeader();
@@ -241,6 +457,11 @@ bool Step3D_Wrapper_Imp::parseHLRInformation()
         processGeometricInformation();
 
         cout << "Parsing content finished!" << endl;
+
+        if (m_useCache)
+        {
+            writeCache();
+        }
     }
     catch (WrapperException& e)
     {
@@ -249,6 +470,8 @@ bool Step3D_Wrapper_Imp::parseHLRInformation()
         cout << "Parsing content finished with errors!" << endl;
     }
 
+    m_recorder.end();
+
     return !hasFailed();
 }
 
@@ -267,6 +490,140 @@ std::list<Relation_Wrapper> Step3D_Wrapper_Imp::getRelations()
     return m_relations;
 }
 
+Step3D_PlacementTable_Wrapper Step3D_Wrapper_Imp::getPlacementTable()
+{
+    Step3D_PlacementTable_Wrapper table;
+    Step3D_PlacementTable::build(m_nodes, table);
+
+    return table;
+}
+
+Step3D_AssemblyTree_Wrapper Step3D_Wrapper_Imp::getAssemblyTree()
+{
+    Step3D_AssemblyTree_Wrapper tree;
+    Step3D_AssemblyTree::build(m_nodes, m_relations, tree);
+
+    return tree;
+}
+
+Step3D_LoadStats_Wrapper Step3D_Wrapper_Imp::getLoadStatistics()
+{
+    Step3D_LoadStats_Wrapper stats = m_loadStats;
+    m_recorder.fill(stats);
+
+    return stats;
+}
+
+void Step3D_Wrapper_Imp::setHLRCache(bool enabled, std::string directory)
+{
+    m_useCache = enabled;
+    m_cacheDirectory = directory;
+}
+
+bool Step3D_Wrapper_Imp::isLoadedFromCache() const
+{
+    return m_fromCache;
+}
+
+bool Step3D_Wrapper_Imp::loadFromCache()
+{
+    Step3D_HLRCache cache(m_cacheDirectory);
+
+    m_fileKey = Step3D_FileKey();
+    if (!Step3D_HLRCache::statFile(m_filename, m_fileKey)) return false;
+
+    m_recorder.begin("cache");
+
+    Step3D_HLRSnapshot snapshot;
+    m_fromCache = cache.read(m_filename, m_fileKey, snapshot);
+
+    m_recorder.end();
+
+    if (!m_fromCache)
+    {
+        cout << "HLR snapshot not found or outdated: " << cache.snapshotName(m_filename) << endl;
+        return false;
+    }
+
+    cout << "HLR snapshot used: " << cache.snapshotName(m_filename) << endl;
+
+    m_headerInfo = snapshot.headerInfo;
+    m_nodes.swap(snapshot.nodes);
+    m_relations.swap(snapshot.relations);
+    m_loadStats.instance_count = snapshot.instanceCount;
+
+    reportProgress("cache", 90);
+
+    return true;
+}
+
+void Step3D_Wrapper_Imp::writeCache()
+{
+    Step3D_HLRCache cache(m_cacheDirectory);
+
+    // The key was taken before reading; a file changed since then
+    // gets a snapshot that will never match, which is harmless
+    if (m_fileKey.size == 0 && !Step3D_HLRCache::statFile(m_filename, m_fileKey)) return;
+
+    Step3D_HLRSnapshot snapshot;
+    snapshot.headerInfo = m_headerInfo;
+    snapshot.nodes = m_nodes;
+    snapshot.relations = m_relations;
+    snapshot.instanceCount = m_loadStats.instance_count;
+
+    if (!cache.write(m_filename, m_fileKey, snapshot))
+    {
+        cerr << "Step3D_Wrapper_Imp::writeCache(): can not write " << cache.snapshotName(m_filename) << endl;
+    }
+}
+
+bool Step3D_Wrapper_Imp::writeLoadTrace(std::string fname)
+{
+    if (!m_recorder.writeTrace(fname, getLoadStatistics()))
+    {
+        cerr << "Step3D_Wrapper_Imp::writeLoadTrace(): can not write " << fname << endl;
+        return false;
+    }
+
+    return true;
+}
+
+void Step3D_Wrapper_Imp::reportProgress(const char* phase, float percent)
+{
+    m_progress = percent;
+
+    if (m_callback)
+    {
+        m_callback(phase, percent, m_userData);
+    }
+}
+
+void Step3D_Wrapper_Imp::reportReadProgress(const char* phase, long position)
+{
+    // registry 0-2%, reading 2-90% (the two passes share it), HLR 90-100%
+    const float first = 2;
+    const float range = 88;
+
+    float ratio = 0;
+    if (m_loadStats.file_size > 0 && position >= 0)
+    {
+        ratio = (float)((double)position / m_loadStats.file_size);
+    }
+
+    if (strcmp(phase, "pass1") == 0) ratio = ratio / 2;
+    else if (strcmp(phase, "pass2") == 0) ratio = 0.5f + ratio / 2;
+
+    reportProgress(phase, first + range * std::min(ratio, 1.0f));
+}
+
+void Step3D_Wrapper_Imp::checkCancel()
+{
+    if (m_cancel)
+    {
+        throw WrapperException(WrapperErrorCode::CANCELLED, "Load cancelled: " + m_filename);
+    }
+}
+
 bool Step3D_Wrapper_Imp::hasFailed() const
 {
     return m_errorCode != WrapperErrorCode::NO_ERROR;
@@ -298,77 +655,45 @@ void Step3D_Wrapper_Imp::Release()
 // STEP-3D methods
 ///////////////////////////////////
 
-void Step3D_Wrapper_Imp::processHeader()
+void Step3D_Wrapper_Imp::processLoadStatistics()
 {
-    cout << "Parsing header..." << endl;
+    m_loadStats.error_count = m_stepfile->ErrorCount();
+    m_loadStats.warning_count = m_stepfile->WarningCount();
 
-    try
-    {
-        auto headerMgr = m_stepfile->HeaderInstances();
-
-        const int count = headerMgr->InstanceCount();
-
-        for (int i = 0; i < count; i++)
-        {
-            MgrNode* node = headerMgr->GetMgrNode(i);
-            SDAI_Application_instance* instance = node->GetApplication_instance();
-
-            const string eName(instance->EntityName());
-
-            // EntityName: File_Description #1
-            // EntityName: File_Name #2
-            // EntityName: File_Schema #3
-            //PrintInstanceShort(instance);
+    const int count = m_instancelist->InstanceCount();
+    m_loadStats.instance_count = count;
 
-            //if (applicationInstance->IsInstanceOf("File_Description"))
-            //{
-            //    cout << "instance " << applicationInstance->EntityName() << " isOf File_Description" << endl;
-            //}
-            //instance->getEDesc()
-
-            SdaiFile_description* fdesc = dynamic_cast<SdaiFile_description*>(instance);
-            SdaiFile_name* fname = dynamic_cast<SdaiFile_name*>(instance);
-            SdaiFile_schema* fschema = dynamic_cast<SdaiFile_schema*>(instance);
-
-            if (fdesc)
-            {
-                auto desc = fdesc->description_();
-                auto implevel = fdesc->implementation_level_();
+    std::map<std::string, long> counts;
+    for (int i = 0; i < count; i++)
+    {
+        SDAI_Application_instance* instance = m_instancelist->GetMgrNode(i)->GetApplication_instance();
+        counts[instance->EntityName()]++;
+    }
 
-                desc->asStr(m_headerInfo.file_description.description);
-                m_headerInfo.file_description.implementation_level = implevel.c_str();
-            }
+    std::vector<Step3D_EntityCount_Wrapper> sorted;
+    sorted.reserve(counts.size());
+    for (const auto& item : counts)
+    {
+        Step3D_EntityCount_Wrapper entityCount;
+        entityCount.type = item.first;
+        entityCount.count = item.second;
+        sorted.push_back(entityCount);
+    }
 
-            if (fname)
-            {
-                m_headerInfo.file_name.name = fname->name_().c_str();
-                m_headerInfo.file_name.time_stamp = fname->time_stamp_().c_str();
-                fname->author_()->asStr(m_headerInfo.file_name.author);
-                fname->organization_()->asStr(m_headerInfo.file_name.organization);
-                m_headerInfo.file_name.preprocessor_version = fname->preprocessor_version_().c_str();
-                m_headerInfo.file_name.originating_system = fname->originating_system_().c_str();
-                m_headerInfo.file_name.authorisation = fname->authorization_().c_str();
-            }
+    // Most frequent first, by name for the same count
+    std::stable_sort(sorted.begin(), sorted.end(),
+        [](const Step3D_EntityCount_Wrapper& a, const Step3D_EntityCount_Wrapper& b) { return a.count > b.count; });
 
-            if (fschema)
-            {
-                fschema->schema_identifiers_()->asStr(m_headerInfo.file_schema);
-            }
+    m_loadStats.entity_counts.assign(sorted.begin(), sorted.end());
+}
 
-            // Two different ways to compare the type
-            // SdaiFile_description* fd = dynamic_cast<SdaiFile_description*>(instance);
-            //if (fd)
-            //{
-            //    cout << "is fd" << endl;
-            //}
-            //
-            //if (eName == HdrFD)
-            //{
-            //    cout << "is HdrFN" << endl;
-            //}
+void Step3D_Wrapper_Imp::processHeader()
+{
+    cout << "Parsing header..." << endl;
 
-            //if (applicationInstance->EntityName() == "D:\dev\DEHP\DEHP-Stepcode\stepcode\src\clstepcore\entityDescriptor.h")
-        }
+    try
+    {
+        readHeaderInfo(m_stepfile->HeaderInstances(), m_headerInfo);
     }
     catch (std::exception &e)
     {
@@ -386,6 +711,73 @@ void Step3D_Wrapper_Imp::processHeader()
     }
 }
 
+void Step3D_Wrapper_Imp::readHeaderInfo(InstMgr* headerMgr, Step3D_HeaderInfo_Wrapper& headerInfo)
+{
+    const int count = headerMgr->InstanceCount();
+
+    for (int i = 0; i < count; i++)
+    {
+        MgrNode* node = headerMgr->GetMgrNode(i);
+        SDAI_Application_instance* instance = node->GetApplication_instance();
+
+        const string eName(instance->EntityName());
+
+        // EntityName: File_Description #1
+        // EntityName: File_Name #2
+        // EntityName: File_Schema #3
+        //PrintInstanceShort(instance);
+
+        //if (applicationInstance->IsInstanceOf("File_Description"))
+        //{
+        //    cout << "instance " << applicationInstance->EntityName() << " isOf File_Description" << endl;
+        //}
+        //instance->getEDesc()
+
+        SdaiFile_description* fdesc = dynamic_cast<SdaiFile_description*>(instance);
+        SdaiFile_name* fname = dynamic_cast<SdaiFile_name*>(instance);
+        SdaiFile_schema* fschema = dynamic_cast<SdaiFile_schema*>(instance);
+
+        if (fdesc)
+        {
+            auto desc = fdesc->description_();
+            auto implevel = fdesc->implementation_level_();
+
+            desc->asStr(headerInfo.file_description.description);
+            headerInfo.file_description.implementation_level = implevel.c_str();
+        }
+
+        if (fname)
+        {
+            headerInfo.file_name.name = fname->name_().c_str();
+            headerInfo.file_name.time_stamp = fname->time_stamp_().c_str();
+            fname->author_()->asStr(headerInfo.file_name.author);
+            fname->organization_()->asStr(headerInfo.file_name.organization);
+            headerInfo.file_name.preprocessor_version = fname->preprocessor_version_().c_str();
+            headerInfo.file_name.originating_system = fname->originating_system_().c_str();
+            headerInfo.file_name.authorisation = fname->authorization_().c_str();
+        }
+
+        if (fschema)
+        {
+            fschema->schema_identifiers_()->asStr(headerInfo.file_schema);
+        }
+
+        // Two different ways to compare the type
+        // SdaiFile_description* fd = dynamic_cast<SdaiFile_description*>(instance);
+        //if (fd)
+        //{
+        //    cout << "is fd" << endl;
+        //}
+        //
+        //if (eName == HdrFD)
+        //{
+        //    cout << "is HdrFN" << endl;
+        //}
+
+        //if (applicationInstance->EntityName() == "D:\dev\DEHP\DEHP-Stepcode\stepcode\src\clstepcore\entityDescriptor.h")
+    }
+}
+
 void Step3D_Wrapper_Imp::processContent()
 {
     cout << "Parsing content..." << endl;
@@ -395,36 +787,25 @@ void Step3D_Wrapper_Imp::processContent()
         MgrNode* node = nullptr;
         SDAI_Application_instance* applicationInstance = nullptr;
 
-        for (int i = 0; i < m_instancelist->InstanceCount(); i++)
+        // Switches on the type id of each instance
+        ContentVisitor visitor(*this);
+
+        const int count = m_instancelist->InstanceCount();
+        for (int i = 0; i < count; i++)
         {
+            if (i % READ_PROGRESS_INTERVAL == 0)
+            {
+                checkCancel();
+                reportProgress("hlr", 90 + 8.0f * i / count);
+            }
+
             node = m_instancelist->GetMgrNode(i);
             applicationInstance = node->GetApplication_instance();
 
             //PrintInstance(applicationInstance);
 
-            string eName(applicationInstance->EntityName());
-
-            if (eName == PD)
-            {
-                processPD(applicationInstance);
+            visitor.Dispatch(applicationInstance);
 
-                //PrintPD(applicationInstance);
-                // 
-                // getShapeRepresentationFromPD(static_cast<SdaiProduct_definition*>(applicationInstance));
-                // std::cout << std::endl;
-            }
-            else if (eName == NAUO)
-            {
-                //PrintNAUO(applicationInstance);
-                processNAUO(applicationInstance);
-                //std::cout << std::endl;
-            }
-            else if (eName == SDR)
-            {
-                //PrintNAUO(applicationInstance);
-                processSDR(applicationInstance);
-                //std::cout << std::endl;
-            }
             //else if (eName == ABSR)
             //{
             //    PrintInstance(applicationInstance);
@@ -456,11 +837,13 @@ void Step3D_Wrapper_Imp::processGeometricInformation()
     // 1) Nodes position
     for (auto& node : m_nodes)
     {
+        checkCancel();
+
         auto mgrnode = m_instancelist->FindFileId(node.stepId);
         auto instance = mgrnode->GetApplication_instance();
         //PrintInstanceShort(instance);
 
-        SdaiProduct_definition* pd = dynamic_cast<SdaiProduct_definition*>(instance);
+        SdaiProduct_definition* pd = entityCast<SdaiProduct_definition>(instance, ap242::e_product_definition);
         //PrintInstanceShort(pd);
 
         // 1) Get the SDP
@@ -482,8 +865,8 @@ void Step3D_Wrapper_Imp::processGeometricInformation()
         
         if (!ur) continue;
 
-        SdaiShape_representation* sr = dynamic_cast<SdaiShape_representation*>(ur);
-        SdaiAdvanced_brep_shape_representation* absr = dynamic_cast<SdaiAdvanced_brep_shape_representation*>(ur);
+        SdaiShape_representation* sr = entityCast<SdaiShape_representation>(ur, ap242::e_shape_representation);
+        SdaiAdvanced_brep_shape_representation* absr = entityCast<SdaiAdvanced_brep_shape_representation>(ur, ap242::e_advanced_brep_shape_representation);
 
         if (absr)
         {
@@ -640,7 +1023,7 @@ void Step3D_Wrapper_Imp::processNAUO(SDAI_Application_instance* instance)
 
 void Step3D_Wrapper_Imp::processSDR(SDAI_Application_instance* instance)
 {
-    SdaiShape_definition_representation* sdr = dynamic_cast<SdaiShape_definition_representation*>(instance);
+    SdaiShape_definition_representation* sdr = static_cast<SdaiShape_definition_representation*>(instance);
 
     cout << "processSDR SDR" << endl;
     PrintInstanceShort(instance);
@@ -648,7 +1031,7 @@ void Step3D_Wrapper_Imp::processSDR(SDAI_Application_instance* instance)
     auto sdr_rep_definition = sdr->property_definition_representation_definition_();
     PrintInstanceShort(sdr_rep_definition);
 
-    SdaiProduct_definition_shape* pds = dynamic_cast<SdaiProduct_definition_shape*>(sdr_rep_definition);
+    SdaiProduct_definition_shape* pds = entityCast<SdaiProduct_definition_shape>(sdr_rep_definition, ap242::e_product_definition_shape);
     if (pds)
     {
         auto pds_def = pds->definition_();
@@ -674,7 +1057,7 @@ void Step3D_Wrapper_Imp::processSDR(SDAI_Application_instance* instance)
 
 void Step3D_Wrapper_Imp::processAxis2PLacement3D(SDAI_Application_instance* instance, Axis2_Placement_3d_Wrapper& placement)
 {
-    SdaiAxis2_placement_3d* pos = dynamic_cast<SdaiAxis2_placement_3d*>(instance);
+    SdaiAxis2_placement_3d* pos = entityCast<SdaiAxis2_placement_3d>(instance, ap242::e_axis2_placement_3d);
 
     if (pos == nullptr)
     {
@@ -686,17 +1069,34 @@ void Step3D_Wrapper_Imp::processAxis2PLacement3D(SDAI_Application_instance* inst
         return;
     }
 
+    // axis and ref_direction are OPTIONAL: the const getters do not create
+    // an empty Direction when they are not set
+    const SdaiAxis2_placement_3d* cpos = pos;
     auto location = pos->location_();
-    auto axis = pos->axis_();
-    auto ref_direction = pos->ref_direction_();
+    auto axis = const_cast<SdaiDirection*>(cpos->axis_());
+    auto ref_direction = const_cast<SdaiDirection*>(cpos->ref_direction_());
 
     placement.name = pos->name_().c_str();  // generally is empty for internal positions
 
     processCartesianPoint(location, placement.location);
-   
-    processDirection(ref_direction, placement.axis);
 
-    processDirection(ref_direction, placement.ref_direction);
+    // Default directions of AP242 when not given
+    placement.axis[0] = 0;
+    placement.axis[1] = 0;
+    placement.axis[2] = 1;
+    placement.ref_direction[0] = 1;
+    placement.ref_direction[1] = 0;
+    placement.ref_direction[2] = 0;
+
+    if (axis != nullptr && axis != S_ENTITY_NULL)
+    {
+        processDirection(axis, placement.axis);
+    }
+
+    if (ref_direction != nullptr && ref_direction != S_ENTITY_NULL)
+    {
+        processDirection(ref_direction, placement.ref_direction);
+    }
 }
 
 void Step3D_Wrapper_Imp::processCartesianPoint(SdaiCartesian_point* instance, CartesianPoint_Wrapper& point)
@@ -707,9 +1107,10 @@ void Step3D_Wrapper_Imp::processCartesianPoint(SdaiCartesian_point* instance, Ca
 
     SingleLinkNode* link = coord->GetHead();
 
-    for (int i = 0; i < 3; i++)
+    // A 2D point leaves z unchanged
+    for (int i = 0; i < 3 && link != nullptr; i++)
     {
-        auto eNode = dynamic_cast<RealNode*>(link);
+        auto eNode = static_cast<RealNode*>(link);
         point[i] = eNode->value;
         link = link->NextNode();
     }
@@ -723,9 +1124,9 @@ void Step3D_Wrapper_Imp::processDirection(SdaiDirection* instance, Direction_Wra
 
     SingleLinkNode* link = ratios->GetHead();
 
-    for (int i = 0; i < 3; i++)
+    for (int i = 0; i < 3 && link != nullptr; i++)
     {
-        auto eNode = dynamic_cast<RealNode*>(link);
+        auto eNode = static_cast<RealNode*>(link);
         direction[i] = eNode->value;
         link = link->NextNode();
     }
@@ -800,7 +1201,7 @@ SdaiShape_representation* Step3D_Wrapper_Imp::getShapeRepresentationFromPD(SdaiP
 
         //PrintInstance(applicationInstance);
 
-        SdaiShape_definition_representation* sdr = dynamic_cast<SdaiShape_definition_representation*>(instance);
+        SdaiShape_definition_representation* sdr = entityCast<SdaiShape_definition_representation>(instance, ap242::e_shape_definition_representation);
 
         if (sdr)
         {
@@ -811,7 +1212,7 @@ SdaiShape_representation* Step3D_Wrapper_Imp::getShapeRepresentationFromPD(SdaiP
             PrintInstanceShort(sdr_rep_definition);
 
             //pdrd->IsSDAIKindOf("");
-            SdaiProduct_definition_shape* pds = dynamic_cast<SdaiProduct_definition_shape*>(sdr_rep_definition);
+            SdaiProduct_definition_shape* pds = entityCast<SdaiProduct_definition_shape>(sdr_rep_definition, ap242::e_product_definition_shape);
             if (pds)
             {
                 auto pds_def = pds->definition_();
@@ -893,6 +1294,12 @@ SdaiShape_representation* Step3D_Wrapper_Imp::getShapeRepresentationFromPD(SdaiP
 ///////////////////////////////////
 // Helpers
 ///////////////////////////////////
+Registry* Step3D_Wrapper_Imp::sharedRegistry()
+{
+    // Same registry as any other reader of the process using SharedRegistry()
+    return SharedRegistry(SchemaInit);
+}
+
 bool Step3D_Wrapper_Imp::endsWith(const std::string& str, const std::string& suffix)
 {
     return str.size() >= suffix.size() && 0 == str.compare(str.size()-suffix.size(), suffix.size(), suffix);
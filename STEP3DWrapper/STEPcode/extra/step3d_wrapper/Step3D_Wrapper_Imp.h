@@ -30,10 +30,13 @@
 * Linked to Stepcode shared libraries.
 */
 #include "step3d_wrapper.h"
+#include "Step3D_LoadRecorder.h"
+#include "Step3D_HLRCache.h"
 
 // STEPcode headers
 #include "Registry.h"
 #include "STEPfile.h"
+#include "SdaiSchemaInit.h"
 #include "sdai.h"
 #include "errordesc.h"
 
@@ -44,6 +47,10 @@
 #include <sstream>
 #include <set>
 #include <utility>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 
 class Step3D_Wrapper_Imp: public IStep3D_Wrapper
@@ -53,6 +60,10 @@ public:
     virtual ~Step3D_Wrapper_Imp();
 
     bool load(std::string fname) override;
+    bool loadAsync(std::string fname, Step3D_ProgressCallback callback, void* userData) override;
+    bool wait(unsigned int milliseconds) override;
+    void cancel() override;
+    float getProgress() const override;
     std::string getFilename() override;
 
     bool parseHLRInformation() override;
@@ -63,6 +74,14 @@ public:
 #endif
     std::list<Part_Wrapper> getNodes() override;
     std::list<Relation_Wrapper> getRelations() override;
+    Step3D_PlacementTable_Wrapper getPlacementTable() override;
+    Step3D_AssemblyTree_Wrapper getAssemblyTree() override;
+
+    Step3D_LoadStats_Wrapper getLoadStatistics() override;
+    bool writeLoadTrace(std::string fname) override;
+
+    void setHLRCache(bool enabled, std::string directory) override;
+    bool isLoadedFromCache() const override;
 
     bool hasFailed() const override;
     WrapperErrorCode getError() const override;
@@ -71,11 +90,22 @@ public:
 
     void Release() override;
 
+    /**
+    * @brief Fill the header information from the instances of the HEADER section
+    * @param[in] headerMgr header instances of a STEPfile
+    * @param[out] headerInfo header information
+    *
+    * Shared by processHeader() and Step3D_Probe_Imp.
+    */
+    static void readHeaderInfo(InstMgr* headerMgr, Step3D_HeaderInfo_Wrapper& headerInfo);
+
 protected:
+    class ContentVisitor;   //!< Dispatches the instances of processContent()
+
     std::string m_filename; //!< Full path to the working file. @sa load()
 
     InstMgr* m_instancelist;
-    Registry* m_registry;
+    Registry* m_registry; //!< Not owned. @sa sharedRegistry()
     STEPfile* m_stepfile;
 
     Step3D_HeaderInfo_Wrapper m_headerInfo;
@@ -89,6 +119,25 @@ protected:
     WrapperErrorCode m_errorCode;
     std::string m_errorMessage;
 
+    Step3D_LoadRecorder m_recorder;         //!< Phases of load() and parseHLRInformation()
+    Step3D_LoadStats_Wrapper m_loadStats;   //!< Figures of the last load(), without the phases
+
+    // Asynchronous load
+    std::thread m_worker;                   //!< Runs loadAsync()
+    std::mutex m_asyncMutex;                //!< Guards m_running, and m_stepfile against cancel()
+    std::condition_variable m_asyncDone;    //!< Notified when m_running becomes false
+    bool m_running;                         //!< loadAsync() has not finished
+    std::atomic<bool> m_cancel;             //!< Set by cancel(), checked while reading and parsing
+    std::atomic<float> m_progress;          //!< Overall progress, 0 to 100
+    Step3D_ProgressCallback m_callback;     //!< Progress notification of loadAsync(), may be null
+    void* m_userData;                       //!< Given back to m_callback
+
+    // HLR snapshot
+    bool m_useCache;                        //!< Read and write snapshots. @sa setHLRCache()
+    std::string m_cacheDirectory;           //!< Empty to store the snapshot next to the file
+    bool m_fromCache;                       //!< The HLR information comes from the snapshot
+    Step3D_FileKey m_fileKey;               //!< Identity of the loaded file, for the snapshot
+
     // Managed Entity Names
     static const std::string HdrFD;
     static const std::string HdrFN;
@@ -108,6 +157,54 @@ protected:
     */
     void processHeader();
 
+    /**
+    * @brief Body of load(), also run by the loadAsync() worker
+    * 
+    * Does not clear the cancel request, so a cancel() done before
+    * the worker starts is honored.
+    */
+    bool loadFile(const std::string& fname);
+
+    /**
+    * @brief Free the instances of the previous load and forget its HLR information
+    */
+    void unloadFile();
+
+    /**
+    * @brief Fill the HLR information from the snapshot of the file
+    * @return true on a hit
+    */
+    bool loadFromCache();
+
+    /**
+    * @brief Write the snapshot of the parsed HLR information
+    */
+    void writeCache();
+
+    /**
+    * @brief Store the overall progress and notify the loadAsync() callback
+    */
+    void reportProgress(const char* phase, float percent);
+
+    /**
+    * @brief Convert a STEPfile notification into the overall progress
+    * @param[in] phase STEPfile phase (header, pass1, pass2, data)
+    * @param[in] position stream position, -1 when not available
+    */
+    void reportReadProgress(const char* phase, long position);
+
+    /**
+    * @brief Throw the cancel exception if cancel() was called
+    */
+    void checkCancel();
+
+    /**
+    * @brief Collect the figures of the loaded file
+    * 
+    * Fills m_loadStats from the STEPfile counters and the instance list.
+    */
+    void processLoadStatistics();
+
     /**
     * @brief Get representatives of the STEP file
     * 
@@ -185,6 +282,15 @@ protected:
     SdaiShape_representation* getShapeRepresentationFromPD(SdaiProduct_definition* pd);
 
     // Helpers
+    /**
+    * @brief Registry of the AP242 schema shared by all the wrappers of the process
+    *
+    * The schema initialisation assigns the global entity descriptors, so it runs
+    * once. Reading only looks the registry up, which lets several wrappers load
+    * files at the same time. The registry lives until the process ends, and is
+    * the one SharedRegistry() gives to the other readers of the schema.
+    */
+    static Registry* sharedRegistry();
     static bool endsWith(const std::string& str, const std::string& suffix);
     void checkFileToLoad();
     void fillDemoData();
@@ -22,21 +22,118 @@
 // </copyright>
 // --------------------------------------------------------------------------------------------------------------------
 
+
 #pragma once
 
 #include "TreeGraphGenerator_Imp.h"
+#include "Step3D_AssemblyTree.h"
 
+#include <cstdlib>
 #include <iostream>
 #include <sstream>
 #include <fstream>
-#include <map>
-#include <set>
+#include <memory>
+#include <thread>
 using namespace std;
 
 
+// Output buffer of each graph file, the lines are never flushed one by one
+static const size_t OutputBufferSize = 1 << 20;
+
+/**
+* @brief Stream to a graph file with a large buffer
+*/
+class GraphFile
+{
+public:
+    GraphFile(const string& fname) : m_buffer(new char[OutputBufferSize])
+    {
+        // The buffer must be set before opening
+        m_stream.rdbuf()->pubsetbuf(m_buffer.get(), OutputBufferSize);
+        m_stream.open(fname, ios::binary);
+    }
+
+    ofstream& stream() { return m_stream; }
+
+    bool close()
+    {
+        m_stream.close();
+        return !m_stream.fail();
+    }
+
+private:
+    unique_ptr<char[]> m_buffer;
+    ofstream m_stream;
+};
+
+/**
+* @brief Write a string, escaping the characters of a DOT quoted string
+*/
+static void writeDOTString(ostream& f, const string& s)
+{
+    for (char c : s)
+    {
+        if (c == '"') f << '\\';
+        f << c;
+    }
+}
+
+/**
+* @brief Write a string, escaping the characters of a XML text
+*/
+static void writeXMLString(ostream& f, const string& s)
+{
+    for (char c : s)
+    {
+        switch (c)
+        {
+        case '&': f << "&amp;"; break;
+        case '<': f << "&lt;"; break;
+        case '>': f << "&gt;"; break;
+        case '"': f << "&quot;"; break;
+        default: f << c;
+        }
+    }
+}
+
+/**
+* @brief Write a quoted JSON string
+*/
+static void writeJSONString(ostream& f, const string& s)
+{
+    static const char* hex = "0123456789abcdef";
+
+    f << '"';
+    for (char c : s)
+    {
+        switch (c)
+        {
+        case '"': f << "\\\""; break;
+        case '\\': f << "\\\\"; break;
+        case '\n': f << "\\n"; break;
+        case '\r': f << "\\r"; break;
+        case '\t': f << "\\t"; break;
+        default:
+            if ((unsigned char)c < 0x20)
+            {
+                f << "\\u00" << hex[(c >> 4) & 0xF] << hex[c & 0xF];
+            }
+            else
+            {
+                f << c;
+            }
+        }
+    }
+    f << '"';
+}
+
+
 TreeGraphGenerator_Wrapper_Imp::TreeGraphGenerator_Wrapper_Imp()
 {
     m_dot_relation_labeled = false;
+    m_collapse = false;
+    m_render = true;
+    m_format = TreeGraphFormat::DOT;
 };
 
 TreeGraphGenerator_Wrapper_Imp::~TreeGraphGenerator_Wrapper_Imp()
@@ -49,161 +146,487 @@ bool TreeGraphGenerator_Wrapper_Imp::generate(IStep3D_Wrapper* wrapper, TreeGrap
     cout << "Generating Step3D graph..." << endl;
 
     m_filename = wrapper->getFilename();
-    m_nodes = wrapper->getNodes();
-    m_relations = wrapper->getRelations();
     m_dot_relation_labeled = mode == TreeGraphStyle::All_Graphs_LabelRelations; // activate labeling, for visual debugging
 
+    {
+        std::list<Part_Wrapper> nodes = wrapper->getNodes();
+        std::list<Relation_Wrapper> relations = wrapper->getRelations();
+        buildGraph(nodes, relations);
+    }
+
+    if (m_format == TreeGraphFormat::GraphML)
+    {
+        return buildGraphML();
+    }
+
+    if (m_format == TreeGraphFormat::JSON)
+    {
+        return buildJSON();
+    }
+
     if ((int)mode > 0)
     {
-        buildDOT(mode);
+        return buildDOT(mode);
     }
-    else
+
+    // The styles only read the graph, each one writes its own file.
+    // Each thread keeps its messages, Graphviz then runs on one style at a time.
+    const TreeGraphStyle styles[] = {
+        TreeGraphStyle::Normal_DirGraph,
+        TreeGraphStyle::RankdirLR_DirGraph,
+        TreeGraphStyle::FolderSyle_DirGraph
+    };
+    const int styleCount = sizeof(styles) / sizeof(styles[0]);
+
+    bool written[styleCount];
+    ostringstream messages[styleCount];
+    std::vector<std::thread> workers;
+
+    for (int i = 1; i < styleCount; i++)
     {
-        buildDOT(TreeGraphStyle::Normal_DirGraph);
-        buildDOT(TreeGraphStyle::RankdirLR_DirGraph);
-        buildDOT(TreeGraphStyle::FolderSyle_DirGraph);
+        workers.push_back(std::thread([this, &styles, &written, &messages, i]() { written[i] = writeDOT(styles[i], messages[i]); }));
     }
 
-    return true;
+    written[0] = writeDOT(styles[0], messages[0]);
+
+    for (int i = 1; i < styleCount; i++)
+    {
+        workers[i - 1].join();
+    }
+
+    bool result = true;
+    for (int i = 0; i < styleCount; i++)
+    {
+        cerr << messages[i].str();
+
+        if (written[i])
+        {
+            renderDOT(styles[i]);
+        }
+
+        result = result && written[i];
+    }
+
+    return result;
 }
 
-bool TreeGraphGenerator_Wrapper_Imp::buildDOT(TreeGraphStyle dottype)
+void TreeGraphGenerator_Wrapper_Imp::setFormat(TreeGraphFormat format)
+{
+    m_format = format;
+}
+
+void TreeGraphGenerator_Wrapper_Imp::setCollapseInstances(bool collapse)
+{
+    m_collapse = collapse;
+}
+
+void TreeGraphGenerator_Wrapper_Imp::setRenderImage(bool render)
+{
+    m_render = render;
+}
+
+void TreeGraphGenerator_Wrapper_Imp::buildGraph(std::list<Part_Wrapper>& nodes, std::list<Relation_Wrapper>& relations)
+{
+    Graph& g = m_graph;
+    g = Graph();
+
+    Step3D_AssemblyTree_Wrapper tree;
+    Step3D_AssemblyTree::build(nodes, relations, tree);
+
+    // The part nodes come first, so a node index is also its index in parts
+    g.parts.reserve(tree.partCount);
+    for (auto& n : nodes)
+    {
+        // A repeated stepId is a single node, kept at its first appearance
+        if (g.parts.size() < tree.partCount && tree.stepId[g.parts.size()] == n.stepId)
+        {
+            g.parts.push_back(std::move(n));
+        }
+    }
+
+    g.relations.reserve(relations.size());
+    for (auto& r : relations)
+    {
+        g.relations.push_back(std::move(r));
+    }
+
+    const int nodeCount = (int)tree.nodeCount();
+
+    g.stepIds = std::move(tree.stepId);
+    g.edgeBegin = std::move(tree.childBegin);
+    g.isPart.assign(nodeCount, 0);
+    g.isRelated.assign(nodeCount, 0);
+
+    for (int n = 0; n < nodeCount; n++)
+    {
+        g.isPart[n] = n < (int)tree.partCount;
+        g.isRelated[n] = tree.parentCount[n] > 0;
+    }
+
+    g.edges.resize(tree.children.size());
+    for (size_t i = 0; i < tree.children.size(); i++)
+    {
+        Graph::Edge& e = g.edges[i];
+        e.child = tree.children[i];
+        e.relation = tree.childRelation[i];
+        e.count = 1;
+    }
+
+    if (!m_collapse) return;
+
+    // Merge the edges to the same child of each parent, keeping the first one
+    std::vector<int> seen(nodeCount, -1);
+    int out = 0;
+
+    for (int n = 0; n < nodeCount; n++)
+    {
+        const int begin = g.edgeBegin[n];
+        const int end = g.edgeBegin[n + 1];
+        const int first = out;
+
+        g.edgeBegin[n] = out;
+
+        for (int i = begin; i < end; i++)
+        {
+            const Graph::Edge e = g.edges[i];
+
+            if (seen[e.child] >= first)
+            {
+                g.edges[seen[e.child]].count++;
+            }
+            else
+            {
+                seen[e.child] = out;
+                g.edges[out++] = e;
+            }
+        }
+    }
+
+    g.edgeBegin[nodeCount] = out;
+    g.edges.resize(out);
+}
+
+void TreeGraphGenerator_Wrapper_Imp::writeNodeLabel(std::ostream& f, int node) const
+{
+    const Part_Wrapper& n = m_graph.parts[node];
+
+    f << "\"";
+    writeDOTString(f, n.type);
+    f << "#" << n.stepId << " ";
+    writeDOTString(f, n.name);
+    f << "\"";
+}
+
+void TreeGraphGenerator_Wrapper_Imp::writeEdgeLabel(std::ostream& f, const Graph::Edge& edge) const
+{
+    const Relation_Wrapper& r = m_graph.relations[edge.relation];
+
+    if (m_dot_relation_labeled)
+    {
+        f << " [label=\"";
+        writeDOTString(f, r.type);
+        f << "#" << r.stepId << " ";
+        writeDOTString(f, r.id);
+        if (edge.count > 1) f << " x" << edge.count;
+        f << "\"]";
+    }
+    else if (edge.count > 1)
+    {
+        f << " [label=\"x" << edge.count << "\"]";
+    }
+}
+
+string TreeGraphGenerator_Wrapper_Imp::dotFilename(TreeGraphStyle dottype) const
 {
     // Compose graph using the selected DOT type in the name
     ostringstream ss;
     ss << m_filename << "_" << (int)dottype << ".dot";
+    return ss.str();
+}
 
-    string fname(ss.str());
-    ofstream f(fname);
+bool TreeGraphGenerator_Wrapper_Imp::buildDOT(TreeGraphStyle dottype)
+{
+    if (!writeDOT(dottype, cerr))
+    {
+        return false;
+    }
 
-    if (dottype == TreeGraphStyle::Normal_DirGraph)
+    renderDOT(dottype);
+    return true;
+}
+
+void TreeGraphGenerator_Wrapper_Imp::renderDOT(TreeGraphStyle dottype) const
+{
+    string fname(dotFilename(dottype));
+
+    if (m_render && !renderImage(fname))
     {
-        f << "digraph G {" << endl;
-        f << "node [fontname=\"Courier New\", fontsize=10];" << endl;
-        //f << "node [shape=ellipse];" << endl;
-        f << "node [shape=box, style=\"filled, rounded\", fillcolor=\"#E5E5E5\"];" << endl;
+        cerr << "TreeGraphGenerator_Wrapper_Imp::buildDOT(): Graphviz failed on " << fname << endl;
+    }
+}
+
+bool TreeGraphGenerator_Wrapper_Imp::writeDOT(TreeGraphStyle dottype, ostream& log) const
+{
+    string fname(dotFilename(dottype));
+    GraphFile file(fname);
+    ostream& f = file.stream();
+
+    const Graph& g = m_graph;
+    const int nodeCount = g.nodeCount();
 
-        for (const auto& n : m_nodes)
+    if (dottype == TreeGraphStyle::Normal_DirGraph || dottype == TreeGraphStyle::RankdirLR_DirGraph)
+    {
+        f << "digraph G {\n";
+
+        if (dottype == TreeGraphStyle::Normal_DirGraph)
         {
-            f << "I" << n.stepId << " [label=\"" << n.type << "#" << n.stepId << " " << n.name << "\"];" << endl;
-            //f << "I" << n.stepId << " [label=\"" << n.type << "#" << n.stepId << " (" << n.name << ")\"];" << endl;
+            f << "node [fontname=\"Courier New\", fontsize=10];\n";
+            f << "node [shape=box, style=\"filled, rounded\", fillcolor=\"#E5E5E5\"];\n";
         }
-
-        for (const auto& r : m_relations)
+        else
         {
-            if (m_dot_relation_labeled)
-                f << "I" << r.relating_id << " -> I" << r.related_id << " [label=\"" << r.type << "#" << r.stepId << " " << r.id <<"\"];" << endl;
-            else
-                f << "I" << r.relating_id << " -> I" << r.related_id << ";" << endl;
+            f << "rankdir=LR;\n";
+            f << "fixedsize=true;\n";
+            f << "node [style=\"rounded,filled\", width=0, height=0, shape=box, fillcolor=\"#E5E5E5\", concentrate=true];\n";
+            f << "\n";
         }
 
-        // Convert all relating nodes in a BOX shape
-        for (const auto& r : m_relations)
+        for (int n = 0; n < nodeCount && g.isPart[n]; n++)
         {
-            f << "I" << r.relating_id << " [shape=box, style=\"\"];" << endl;
+            f << "I" << g.stepIds[n] << " [label=";
+            writeNodeLabel(f, n);
+            f << "];\n";
         }
-    }
-    else if (dottype == TreeGraphStyle::RankdirLR_DirGraph)
-    {
-        f << "digraph G {" << endl;
-        f << "rankdir=LR;" << endl;
-        f << "fixedsize=true;" << endl;
-        f << "node [style=\"rounded,filled\", width=0, height=0, shape=box, fillcolor=\"#E5E5E5\", concentrate=true];" << endl;
-        f << endl;
 
-        for (const auto& n : m_nodes)
+        if (dottype == TreeGraphStyle::RankdirLR_DirGraph)
         {
-            f << "I" << n.stepId << " [label=\"" << n.type << "#" << n.stepId << " " << n.name << "\"];" << endl;
+            f << "\n";
         }
 
-        f << endl;
-
-        for (const auto& r : m_relations)
+        for (int n = 0; n < nodeCount; n++)
         {
-            if (m_dot_relation_labeled)
-                f << "I" << r.relating_id << " -> I" << r.related_id << " [label=\"" << r.type << "#" << r.stepId << " " << r.id << "\"];" << endl;
-            else
-                f << "I" << r.relating_id << " -> I" << r.related_id << ";" << endl;
+            for (int i = g.edgeBegin[n]; i < g.edgeBegin[n + 1]; i++)
+            {
+                f << "I" << g.stepIds[n] << " -> I" << g.stepIds[g.edges[i].child];
+                writeEdgeLabel(f, g.edges[i]);
+                f << ";\n";
+            }
         }
 
         // Convert all relating nodes in a BOX shape
-        for (const auto& r : m_relations)
+        for (int n = 0; n < nodeCount; n++)
         {
-            f << "I" << r.relating_id << " [shape=box, style=\"\"];" << endl;
+            if (g.isAssembly(n))
+            {
+                f << "I" << g.stepIds[n] << " [shape=box, style=\"\"];\n";
+            }
         }
     }
     else if (dottype == TreeGraphStyle::FolderSyle_DirGraph)
     {
-        // construct list of relating and all its related items to construct the sequential associations
-        std::map< int, std::list<int> > assemblies;
-        std::set< int > relateds;
-
-        for (const auto& r : m_relations)
-        {
-            assemblies[r.relating_id].push_back(r.related_id);
-            relateds.insert(r.related_id);
-        }
+        f << "digraph tree\n";
+        f << "{\n";
 
-        f << "digraph tree" << endl;
-        f << "{" << endl;
+        f << "fixedsize=true;\n";
+        f << "node [style=\"rounded,filled\", width=0, height=0, shape=box, fillcolor=\"#E5E5E5\"]\n";
 
-        f << "fixedsize=true;" << endl;
-        f << "node [style=\"rounded,filled\", width=0, height=0, shape=box, fillcolor=\"#E5E5E5\"]" << endl;
-
-        for (const auto& n : m_nodes)
+        for (int n = 0; n < nodeCount && g.isPart[n]; n++)
         {
-            if (relateds.find(n.stepId) == relateds.end())
+            const int stepId = g.stepIds[n];
+
+            if (!g.isRelated[n])
             {
-                f << "i_dir_" << n.stepId << " [label=\"" << n.type << "#" << n.stepId << " " << n.name << "\", width=2]" << endl;
+                f << "i_dir_" << stepId << " [label=";
+                writeNodeLabel(f, n);
+                f << ", width=2]\n";
             }
             else
             {
-                f << "{rank=same" << endl;
-                f << "  i_point_" << n.stepId << " [shape=point]" << endl;
-                f << "  i_dir_" << n.stepId << " [label=\"" << n.type << "#" << n.stepId << " " << n.name << "\", width=2]" << endl;
-                f << "}" << endl;
-                f << "i_point_" << n.stepId << " -> " << "i_dir_" << n.stepId << endl;
+                f << "{rank=same\n";
+                f << "  i_point_" << stepId << " [shape=point]\n";
+                f << "  i_dir_" << stepId << " [label=";
+                writeNodeLabel(f, n);
+                f << ", width=2]\n";
+                f << "}\n";
+                f << "i_point_" << stepId << " -> " << "i_dir_" << stepId << "\n";
             }
         }
 
-        f << endl;
-        f << endl;
+        f << "\n";
+        f << "\n";
 
-        for (const auto& r : assemblies)
+        // Each assembly is a vertical line through the points of its children
+        for (int n = 0; n < nodeCount; n++)
         {
-            f << "i_dir_" << r.first;
+            if (!g.isAssembly(n)) continue;
+
+            f << "i_dir_" << g.stepIds[n];
 
-            for (const auto& i : r.second)
+            for (int i = g.edgeBegin[n]; i < g.edgeBegin[n + 1]; i++)
             {
-                f << " -> " << "i_point_" << i;
+                f << " -> " << "i_point_" << g.stepIds[g.edges[i].child];
             }
 
-            f << " [arrowhead=none]" << endl;
+            f << " [arrowhead=none]\n";
         }
-
-        //for (const auto& r : m_relations)
-        //{
-        //    f << "i_dir_" << r.relating_id;
-        //
-        //    for (const auto& related_id : assemblies[r.relating_id])
-        //    {
-        //        f << " -> " << "i_point_" << related_id << " [arrowhead=none]" << endl;
-        //
-        //        assemblies[r.relating_id].push_back(r.related_id);
-        //    }
-        //    //f << "i_dir_" << r.relating_id << " -> " << "i_point_" << r.related_id << " [arrowhead=none]" << endl;
-        //}
     }
     else
     {
-        cerr << "DOT graph type not expected: " << (int)dottype << endl;
+        log << "DOT graph type not expected: " << (int)dottype << endl;
         return false;
     }
 
-    f << "}" << endl;
+    f << "}\n";
 
-    f.close();
+    if (!file.close())
+    {
+        log << "TreeGraphGenerator_Wrapper_Imp::buildDOT(): can not write " << fname << endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool TreeGraphGenerator_Wrapper_Imp::buildGraphML()
+{
+    string fname = m_filename + ".graphml";
+    GraphFile file(fname);
+    ostream& f = file.stream();
+
+    const Graph& g = m_graph;
+    const int nodeCount = g.nodeCount();
+
+    f << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+    f << "<graphml xmlns=\"http://graphml.graphdrawing.org/xmlns\">\n";
+    f << "  <key id=\"type\" for=\"node\" attr.name=\"type\" attr.type=\"string\"/>\n";
+    f << "  <key id=\"name\" for=\"node\" attr.name=\"name\" attr.type=\"string\"/>\n";
+    f << "  <key id=\"representation\" for=\"node\" attr.name=\"representation_type\" attr.type=\"string\"/>\n";
+    f << "  <key id=\"relation\" for=\"edge\" attr.name=\"stepId\" attr.type=\"int\"/>\n";
+    f << "  <key id=\"rid\" for=\"edge\" attr.name=\"id\" attr.type=\"string\"/>\n";
+    f << "  <key id=\"rname\" for=\"edge\" attr.name=\"name\" attr.type=\"string\"/>\n";
+    f << "  <key id=\"count\" for=\"edge\" attr.name=\"count\" attr.type=\"int\"/>\n";
+    f << "  <graph id=\"";
+    writeXMLString(f, m_filename);
+    f << "\" edgedefault=\"directed\">\n";
+
+    for (int n = 0; n < nodeCount; n++)
+    {
+        f << "    <node id=\"I" << g.stepIds[n] << "\"";
+
+        if (!g.isPart[n])
+        {
+            f << "/>\n";
+            continue;
+        }
+
+        const Part_Wrapper& p = g.parts[n];
+
+        f << ">\n      <data key=\"type\">";
+        writeXMLString(f, p.type);
+        f << "</data>\n      <data key=\"name\">";
+        writeXMLString(f, p.name);
+        f << "</data>\n      <data key=\"representation\">";
+        writeXMLString(f, p.representation_type);
+        f << "</data>\n    </node>\n";
+    }
+
+    for (int n = 0; n < nodeCount; n++)
+    {
+        for (int i = g.edgeBegin[n]; i < g.edgeBegin[n + 1]; i++)
+        {
+            const Graph::Edge& e = g.edges[i];
+            const Relation_Wrapper& r = g.relations[e.relation];
+
+            f << "    <edge source=\"I" << g.stepIds[n] << "\" target=\"I" << g.stepIds[e.child] << "\">\n";
+            f << "      <data key=\"relation\">" << r.stepId << "</data>\n";
+            f << "      <data key=\"rid\">";
+            writeXMLString(f, r.id);
+            f << "</data>\n      <data key=\"rname\">";
+            writeXMLString(f, r.name);
+            f << "</data>\n      <data key=\"count\">" << e.count << "</data>\n";
+            f << "    </edge>\n";
+        }
+    }
+
+    f << "  </graph>\n";
+    f << "</graphml>\n";
+
+    if (!file.close())
+    {
+        cerr << "TreeGraphGenerator_Wrapper_Imp::buildGraphML(): can not write " << fname << endl;
+        return false;
+    }
+
+    return true;
+}
 
+bool TreeGraphGenerator_Wrapper_Imp::buildJSON()
+{
+    string fname = m_filename + ".json";
+    GraphFile file(fname);
+    ostream& f = file.stream();
+
+    const Graph& g = m_graph;
+    const int nodeCount = g.nodeCount();
+
+    f << "{\n\"file\": ";
+    writeJSONString(f, m_filename);
+    f << ",\n\"nodes\": [";
+
+    for (int n = 0; n < nodeCount; n++)
+    {
+        f << (n == 0 ? "\n" : ",\n") << "{\"stepId\": " << g.stepIds[n];
+
+        if (g.isPart[n])
+        {
+            const Part_Wrapper& p = g.parts[n];
+
+            f << ", \"type\": ";
+            writeJSONString(f, p.type);
+            f << ", \"name\": ";
+            writeJSONString(f, p.name);
+            f << ", \"representation_type\": ";
+            writeJSONString(f, p.representation_type);
+        }
+
+        f << "}";
+    }
+
+    f << "\n],\n\"edges\": [";
+
+    bool first = true;
+    for (int n = 0; n < nodeCount; n++)
+    {
+        for (int i = g.edgeBegin[n]; i < g.edgeBegin[n + 1]; i++)
+        {
+            const Graph::Edge& e = g.edges[i];
+            const Relation_Wrapper& r = g.relations[e.relation];
+
+            f << (first ? "\n" : ",\n");
+            f << "{\"source\": " << g.stepIds[n] << ", \"target\": " << g.stepIds[e.child]
+              << ", \"stepId\": " << r.stepId << ", \"id\": ";
+            writeJSONString(f, r.id);
+            f << ", \"name\": ";
+            writeJSONString(f, r.name);
+            f << ", \"count\": " << e.count << "}";
+
+            first = false;
+        }
+    }
+
+    f << "\n]\n}\n";
+
+    if (!file.close())
+    {
+        cerr << "TreeGraphGenerator_Wrapper_Imp::buildJSON(): can not write " << fname << endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool TreeGraphGenerator_Wrapper_Imp::renderImage(const std::string& fname) const
+{
     ostringstream oss;
 
     oss << "\"\"C:\\Program Files (x86)\\Graphviz2.38\\bin\\dot.exe\" -Tpng \"" << fname << "\" -o \"" << fname << ".png\"\"";
@@ -31,6 +31,11 @@
 */
 #include "step3d_wrapper.h"
 
+// STL headers
+#include <ostream>
+#include <string>
+#include <vector>
+
 
 class TreeGraphGenerator_Wrapper_Imp: public ITreeGraphGenerator_Wrapper
 {
@@ -70,13 +75,79 @@ public:
     */
     virtual bool generate(IStep3D_Wrapper* wrapper, TreeGraphStyle mode) override;
 
+    void setFormat(TreeGraphFormat format) override;
+    void setCollapseInstances(bool collapse) override;
+    void setRenderImage(bool render) override;
+
     virtual void Release() override;
 
 protected:
+    /**
+    * @brief Assembly graph in compressed sparse row form
+    * 
+    * Nodes are indexed in order of appearance: the parts, then the ends
+    * of relations which are not parts (written as edge ends only).
+    * The children of node i are edges[edgeBegin[i] .. edgeBegin[i+1]),
+    * in the order of the relations.
+    */
+    struct Graph
+    {
+        struct Edge
+        {
+            int child;      //!< Node index
+            int relation;   //!< Index in relations (the first one when collapsed)
+            int count;      //!< Occurrences written as this edge
+        };
+
+        std::vector<Part_Wrapper> parts;
+        std::vector<Relation_Wrapper> relations;
+
+        std::vector<int> stepIds;           //!< PD.stepId of each node
+        std::vector<char> isPart;           //!< Node is in parts (same index)
+        std::vector<char> isRelated;        //!< Node is the child of a relation
+        std::vector<int> edgeBegin;         //!< Node count + 1 offsets into edges
+        std::vector<Edge> edges;
+
+        int nodeCount() const { return (int)stepIds.size(); }
+        bool isAssembly(int node) const { return edgeBegin[node + 1] > edgeBegin[node]; }
+    };
+
     bool m_dot_relation_labeled;
+    bool m_collapse;
+    bool m_render;
+    TreeGraphFormat m_format;
     std::string m_filename;
-    std::list<Part_Wrapper> m_nodes;
-    std::list<Relation_Wrapper> m_relations;
+    Graph m_graph;
+
+    /**
+    * @brief Fill m_graph from the wrapper nodes and relations
+    */
+    void buildGraph(std::list<Part_Wrapper>& nodes, std::list<Relation_Wrapper>& relations);
 
+    /**
+    * @brief Write the DOT file of a style, then render it if requested
+    */
     bool buildDOT(TreeGraphStyle dottype);
+
+    /**
+    * @brief Write the DOT file of a style, reporting errors to log; safe to run for several styles at once
+    */
+    bool writeDOT(TreeGraphStyle dottype, std::ostream& log) const;
+
+    /**
+    * @brief Render the DOT file of a style, if image rendering is on
+    */
+    void renderDOT(TreeGraphStyle dottype) const;
+
+    std::string dotFilename(TreeGraphStyle dottype) const;
+    bool buildGraphML();
+    bool buildJSON();
+
+    void writeNodeLabel(std::ostream& f, int node) const;
+    void writeEdgeLabel(std::ostream& f, const Graph::Edge& edge) const;
+
+    /**
+    * @brief Convert a DOT file into a PNG image with Graphviz
+    */
+    bool renderImage(const std::string& fname) const;
 };
\ No newline at end of file
@@ -42,6 +42,8 @@ char* getStepcodeVersion()
 // Implementations
 #include "Step3D_Wrapper_Imp.h";
 #include "TreeGraphGenerator_Imp.h"
+#include "Step3D_Diff_Imp.h"
+#include "Step3D_Probe_Imp.h"
 
 
 IStep3D_Wrapper* CreateIStep3D_Wrapper()
@@ -53,3 +55,13 @@ ITreeGraphGenerator_Wrapper* CreateITreeGraphGenerator_Wrapper()
 {
     return new TreeGraphGenerator_Wrapper_Imp();
 }
+
+IStep3D_Diff_Wrapper* CreateIStep3D_Diff_Wrapper()
+{
+    return new Step3D_Diff_Imp();
+}
+
+IStep3D_Probe_Wrapper* CreateIStep3D_Probe_Wrapper()
+{
+    return new Step3D_Probe_Imp();
+}
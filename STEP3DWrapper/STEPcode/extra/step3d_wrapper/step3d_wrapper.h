@@ -38,6 +38,7 @@
 
 #include <string>
 #include <list>
+#include <vector>
 
 
 /**
@@ -200,6 +201,151 @@ struct STEP3D_DLLAPI Relation_Wrapper
     // - RRWT.IDT.transform_item_2 of type Axis2_Placement_3d (ignore others targets)
 };
 
+/**
+* @brief Columns of a Step3D_PlacementTable_Wrapper
+* 
+* ROTATION_<row><column> are the terms of the orthonormal rotation of the
+* placement: its columns are the local X, Y and Z axes.
+*/
+enum class PlacementColumn
+{
+    LOCATION_X = 0, LOCATION_Y, LOCATION_Z,
+    AXIS_X, AXIS_Y, AXIS_Z,
+    REF_DIRECTION_X, REF_DIRECTION_Y, REF_DIRECTION_Z,
+    ROTATION_XX, ROTATION_XY, ROTATION_XZ,
+    ROTATION_YX, ROTATION_YY, ROTATION_YZ,
+    ROTATION_ZX, ROTATION_ZY, ROTATION_ZZ,
+    COUNT   //!< Number of columns
+};
+
+/**
+* @brief Placements of the parts, one column per coordinate
+* 
+* Row i is the Part_Wrapper::placement of the i-th node of
+* IStep3D_Wrapper::getNodes(). The values are stored column after column
+* in one buffer, so a column is a contiguous array of count doubles.
+* 
+* The rotation follows the AP242 rules for Axis2_Placement_3d:
+* - Z is the normalised axis, (0,0,1) when not given
+* - X is the ref_direction projected on the plane normal to Z, (1,0,0) when not given
+* - Y = Z x X
+* 
+* A part without placement gets the identity.
+*/
+struct STEP3D_DLLAPI Step3D_PlacementTable_Wrapper
+{
+    size_t count;               //!< Number of rows (parts)
+    std::vector<int> stepId;    //!< PD.stepId of each row (as in Part_Wrapper::stepId)
+    std::vector<double> values; //!< PlacementColumn::COUNT columns of count values
+
+    Step3D_PlacementTable_Wrapper() : count(0) {}
+
+    /**
+    * @brief Get the first value of a column
+    */
+    const double* column(PlacementColumn c) const
+    {
+        return values.data() + (size_t)c * count;
+    }
+
+    double* column(PlacementColumn c)
+    {
+        return values.data() + (size_t)c * count;
+    }
+};
+
+/**
+* @brief Assembly structure of the HLR tree, as index arrays
+* 
+* Nodes are indexed from 0: first the parts, in the order of
+* IStep3D_Wrapper::getNodes() (a repeated stepId is kept once), then the
+* ends of relations which are not parts.
+* 
+* The children of node n are children[childBegin[n] .. childBegin[n+1]),
+* in the order of IStep3D_Wrapper::getRelations(); one entry per relation,
+* so a part used twice by the same assembly appears twice.
+* 
+* The occurrences are the instances of the parts in the expanded tree,
+* depth first from each root: the path of an occurrence is found by
+* following occurrenceParent. A relation closing a cycle is not expanded,
+* and neither are relations to nodes which are not parts.
+*/
+struct STEP3D_DLLAPI Step3D_AssemblyTree_Wrapper
+{
+    size_t partCount;                       //!< Nodes which are parts, they come first
+    std::vector<int> stepId;                //!< PD.stepId of each node
+    std::vector<int> childBegin;            //!< Node count + 1 offsets into children
+    std::vector<int> children;              //!< Child node of each relation, grouped by parent
+    std::vector<int> childRelation;         //!< Index in getRelations() of each children entry
+    std::vector<int> parentCount;           //!< Relations with the node as child
+    std::vector<int> roots;                 //!< Parts without parent, in node order
+    std::vector<int> topologicalOrder;      //!< Parents before their children; without the nodes in or below a cycle
+    std::vector<int> occurrenceNode;        //!< Part node of each occurrence
+    std::vector<int> occurrenceParent;      //!< Occurrence of the parent, -1 for a root
+    std::vector<int> occurrenceRelation;    //!< Index in getRelations() creating the occurrence, -1 for a root
+
+    Step3D_AssemblyTree_Wrapper() : partCount(0) {}
+
+    size_t nodeCount() const { return stepId.size(); }
+    int childCount(int node) const { return childBegin[node + 1] - childBegin[node]; }
+    bool hasCycles() const { return topologicalOrder.size() < stepId.size(); }
+};
+
+/**
+* @brief Measures of one phase of IStep3D_Wrapper::load() or parseHLRInformation()
+* 
+* Phases, in order:
+* - registry: construction of the AP242 schema registry
+* - header: HEADER section
+* - pass1, pass2: creation and reading of the instances (two-pass read)
+* - data: creation and reading of the instances (one-pass read, replaces pass1 and pass2)
+* - hlr: parseHLRInformation()
+* - cache: read of the HLR snapshot, replaces all the others on a hit
+* 
+* Memory figures come from the operating system: resident set on Linux,
+* peak working set on Windows. Times are in seconds.
+*/
+struct STEP3D_DLLAPI Step3D_PhaseStats_Wrapper
+{
+    std::string name;      //!< Phase name
+    double start;          //!< Start, from the beginning of load()
+    double wall_time;      //!< Elapsed time
+    double cpu_time;       //!< User and system CPU time of the process
+    long long bytes;       //!< Bytes of the file read by the phase
+    long long heap_delta;  //!< Change of the heap in use, in bytes (-1 if not available)
+    long memory_kb;        //!< Process memory at the end of the phase, in KB
+
+    Step3D_PhaseStats_Wrapper() : start(0), wall_time(0), cpu_time(0), bytes(0), heap_delta(-1), memory_kb(0) {}
+};
+
+/**
+* @brief Number of instances of an entity type
+*/
+struct STEP3D_DLLAPI Step3D_EntityCount_Wrapper
+{
+    std::string type;      //!< ENTITY TYPE (STEP class name)
+    long count;            //!< Instances in the DATA section
+
+    Step3D_EntityCount_Wrapper() : count(0) {}
+};
+
+/**
+* @brief Statistics of the last load of a IStep3D_Wrapper
+*/
+struct STEP3D_DLLAPI Step3D_LoadStats_Wrapper
+{
+    std::list<Step3D_PhaseStats_Wrapper> phases;            //!< Phases done, in order
+    std::list<Step3D_EntityCount_Wrapper> entity_counts;    //!< Instances per entity type, most frequent first
+
+    long long file_size;   //!< Size of the loaded file
+    long instance_count;   //!< Instances in the DATA section
+    long peak_memory_kb;   //!< Highest memory_kb of the phases
+    int error_count;       //!< Errors reported by the STEP reader
+    int warning_count;     //!< Warnings reported by the STEP reader
+
+    Step3D_LoadStats_Wrapper() : file_size(0), instance_count(0), peak_memory_kb(0), error_count(0), warning_count(0) {}
+};
+
 enum class WrapperErrorCode
 {
     NO_ERROR = 0,
@@ -207,9 +353,20 @@ enum class WrapperErrorCode
     FILE_READ,
     FILE_PROCESS,
     NOT_IMPLEMENTED,
+    CANCELLED,
     UNKNOWN_ERROR = 1000,
 };
 
+/**
+* @brief Progress notification of IStep3D_Wrapper::loadAsync()
+* @param[in] phase current phase (see Step3D_PhaseStats_Wrapper), "done" at the end
+* @param[in] percent overall progress, from 0 to 100
+* @param[in] userData pointer given to loadAsync()
+* 
+* @note Called from the worker thread.
+*/
+typedef void (*Step3D_ProgressCallback)(const char* phase, float percent, void* userData);
+
 /**
 * @brief Interface to a STEP3D manager
 * 
@@ -236,6 +393,45 @@ public:
     */
     virtual bool load(std::string fname) = 0;
 
+    /**
+    * @brief Load STEP-3D file and parse its HLR information on a worker thread
+    * @param[in] fname full path to .stp|.step file
+    * @param[in] callback optional progress notification, called from the worker thread
+    * @param[in] userData pointer given back to the callback
+    * @return false if a load is already running
+    * 
+    * Runs load() then parseHLRInformation(). Use wait() to know when it is
+    * finished, then hasFailed() and the getters as after a synchronous load.
+    * 
+    * @sa cancel()
+    * @sa getProgress()
+    */
+    virtual bool loadAsync(std::string fname, Step3D_ProgressCallback callback = nullptr, void* userData = nullptr) = 0;
+
+    /**
+    * @brief Wait for the end of loadAsync()
+    * @param[in] milliseconds maximum time to wait, 0 to wait until the end
+    * @return true if no load is running anymore
+    */
+    virtual bool wait(unsigned int milliseconds = 0) = 0;
+
+    /**
+    * @brief Stop a running load
+    * 
+    * The reading stops at the next instance, the HLR extraction at the next
+    * entity; the load then fails with WrapperErrorCode::CANCELLED.
+    * Can be called from any thread, also during a synchronous load().
+    */
+    virtual void cancel() = 0;
+
+    /**
+    * @brief Get the overall progress of the running load, from 0 to 100
+    * 
+    * Reading the file counts for 90, the HLR extraction for the last 10.
+    * Can be called from any thread.
+    */
+    virtual float getProgress() const = 0;
+
     /**
     * @brief Get file name of loaded file
     * @return file name used in the Load() method
@@ -282,6 +478,61 @@ public:
     */
     virtual std::list<Relation_Wrapper> getRelations() = 0;
 
+    /**
+    * @brief Get the placements of the HLR tree's nodes as columns
+    * 
+    * Same information as Part_Wrapper::placement, in the order of getNodes(),
+    * with the rotation of each placement. Suited to numeric processing,
+    * each column can be copied or mapped as one array.
+    */
+    virtual Step3D_PlacementTable_Wrapper getPlacementTable() = 0;
+
+    /**
+    * @brief Get the assembly structure of the HLR tree's nodes
+    * 
+    * Children, roots, topological order and occurrences are computed
+    * once, in linear time, from getNodes() and getRelations().
+    */
+    virtual Step3D_AssemblyTree_Wrapper getAssemblyTree() = 0;
+
+    /**
+    * @brief Get statistics of the last load
+    * 
+    * Includes the parseHLRInformation() phase once it is done.
+    */
+    virtual Step3D_LoadStats_Wrapper getLoadStatistics() = 0;
+
+    /**
+    * @brief Write the load phases as a Chrome trace
+    * @param[in] fname full path to the .json file to write
+    * @return true if the file was written
+    * 
+    * The file can be opened with chrome://tracing or https://ui.perfetto.dev.
+    * 
+    * @note When the STEP3D_TRACE environment variable is set to a file name,
+    * the trace is written there on Release(), including the teardown of
+    * the instances.
+    */
+    virtual bool writeLoadTrace(std::string fname) = 0;
+
+    /**
+    * @brief Enable the binary snapshot of the HLR information
+    * @param[in] enabled use and write snapshots (disabled by default)
+    * @param[in] directory cache directory, empty to store the snapshot next to the file
+    *
+    * A snapshot is checked against the size, modification time and content
+    * hash of the file. On a hit, load() and parseHLRInformation() only read
+    * the snapshot, the STEP model is not instantiated.
+    *
+    * @note Call it before load().
+    */
+    virtual void setHLRCache(bool enabled, std::string directory = "") = 0;
+
+    /**
+    * @brief Check if the last load used the HLR snapshot
+    */
+    virtual bool isLoadedFromCache() const = 0;
+
     /**
     * @brief Check if the last action finished with errors
     * 
@@ -328,6 +579,19 @@ enum class TreeGraphStyle
     FolderSyle_DirGraph = 3,
 };
 
+/**
+* @brief File format of the exported graph
+* 
+* The styles only apply to DOT, GraphML and JSON are written once
+* whatever the style.
+*/
+enum class TreeGraphFormat
+{
+    DOT = 0,        //!< <file>_<style>.dot, rendered to .png with Graphviz
+    GraphML = 1,    //!< <file>.graphml
+    JSON = 2,       //!< <file>.json, {"nodes": [...], "edges": [...]}
+};
+
 
 /**
 * @brief Helper class to create graphical representation of a IStep3D wrapper
@@ -342,10 +606,28 @@ public:
     * @param[in] wrapper Step3D wrapper instance
     * @param[in] mode style of graph to create
     * 
-    * Uses the current nodes and relations to construct the 
+    * Uses the current nodes and relations to construct the graph files,
+    * written next to the STEP file.
     */
     virtual bool generate(IStep3D_Wrapper* wrapper, TreeGraphStyle mode) = 0;
 
+    /**
+    * @brief Select the file format (DOT by default)
+    */
+    virtual void setFormat(TreeGraphFormat format) = 0;
+
+    /**
+    * @brief Write the occurrences of a part under the same parent as one edge
+    * 
+    * The edge is labelled with the number of occurrences (x3). Disabled by default.
+    */
+    virtual void setCollapseInstances(bool collapse) = 0;
+
+    /**
+    * @brief Run Graphviz on the DOT files (enabled by default)
+    */
+    virtual void setRenderImage(bool render) = 0;
+
     /**
     * @brief Release memory allocation
     * 
@@ -357,6 +639,238 @@ public:
 };
 
 
+/**
+* @brief Change status of a part or relation between two files
+*/
+enum class DiffStatus
+{
+    UNCHANGED = 0,
+    ADDED,
+    REMOVED,
+    MODIFIED,
+};
+
+/**
+* @brief Change of a part between two versions of a STEP file
+*
+* Parts are matched by the PRODUCT name (and by order of appearance
+* when several products share the same name), never by the instance
+* number, which is not stable between two exports.
+*
+* Hashes are hexadecimal strings of Merkle-style hashes:
+* - product hash: Product_Definition subgraph plus its representations
+* - representation hash: representations linked by Shape_Definition_Representation
+*
+* Hashes are empty on the side where the part does not exist.
+*/
+struct STEP3D_DLLAPI PartDiff_Wrapper
+{
+    DiffStatus status;       //!< Change status
+    std::string name;        //!< PD.PDF.P.name (as in Part_Wrapper::name)
+
+    int old_stepId;          //!< PD.stepId in the old file (0 when ADDED)
+    int new_stepId;          //!< PD.stepId in the new file (0 when REMOVED)
+
+    std::string old_hash;    //!< Product hash in the old file
+    std::string new_hash;    //!< Product hash in the new file
+
+    std::string old_representation_hash;   //!< Representation hash in the old file
+    std::string new_representation_hash;   //!< Representation hash in the new file
+
+    PartDiff_Wrapper() : status(DiffStatus::UNCHANGED), old_stepId(0), new_stepId(0) {}
+};
+
+/**
+* @brief Change of a relation between two versions of a STEP file
+*
+* Relations (NAUO) are matched by the names of the relating and
+* related parts. The hash covers the NAUO attributes and the
+* placement of the Context_Dependent_Shape_Representation that
+* positions the related part.
+*/
+struct STEP3D_DLLAPI RelationDiff_Wrapper
+{
+    DiffStatus status;           //!< Change status
+    std::string id;              //!< NAUO.id (from the new file, from the old one when REMOVED)
+    std::string relating_name;   //!< Name of the parent part
+    std::string related_name;    //!< Name of the child part
+
+    int old_stepId;              //!< NAUO.stepId in the old file (0 when ADDED)
+    int new_stepId;              //!< NAUO.stepId in the new file (0 when REMOVED)
+
+    std::string old_hash;        //!< Relation hash in the old file
+    std::string new_hash;        //!< Relation hash in the new file
+
+    RelationDiff_Wrapper() : status(DiffStatus::UNCHANGED), old_stepId(0), new_stepId(0) {}
+};
+
+/**
+* @brief Structural comparison of two STEP-3D files
+*
+* Computes a stable hash per product and per representation subgraph,
+* independent of the instance numbering, and compares two files to
+* report which parts and relations were added, removed or modified.
+*
+* Files are indexed with the Stepcode lazy loader (no schema is
+* instantiated), and the hashing runs in parallel.
+*/
+class STEP3D_DLLAPI IStep3D_Diff_Wrapper
+{
+public:
+    /**
+    * @brief Compare two STEP-3D files
+    * @param[in] oldFname full path to the reference .stp|.step file
+    * @param[in] newFname full path to the modified .stp|.step file
+    * @return true if both files were processed
+    *
+    * Previous results are discarded.
+    */
+    virtual bool compare(std::string oldFname, std::string newFname) = 0;
+
+    /**
+    * @brief Set the number of threads used for hashing
+    * @param[in] count number of threads, 0 to use the hardware concurrency
+    */
+    virtual void setThreadCount(unsigned int count) = 0;
+
+    /**
+    * @brief Get the status of all the parts found in any of the files
+    */
+    virtual std::list<PartDiff_Wrapper> getPartDiffs() = 0;
+
+    /**
+    * @brief Get the status of all the relations found in any of the files
+    */
+    virtual std::list<RelationDiff_Wrapper> getRelationDiffs() = 0;
+
+    /**
+    * @brief Check if any part or relation is not UNCHANGED
+    */
+    virtual bool hasChanges() const = 0;
+
+    /**
+    * @brief Check if the last action finished with errors
+    */
+    virtual bool hasFailed() const = 0;
+
+    /**
+    * @brief Get last error code
+    */
+    virtual WrapperErrorCode getError() const = 0;
+
+    /**
+    * @brief Get last error message
+    */
+    virtual std::string getErrorMessage() = 0;
+
+    /**
+    * @brief Clear error status
+    */
+    virtual void clearError() = 0;
+
+    /**
+    * @brief Release memory allocation
+    *
+    * User of this API should not call delete for objects,
+    * instead call this method to perform the deallocation
+    * from inside the library.
+    */
+    virtual void Release() = 0;
+};
+
+
+/**
+* @brief Summary of a STEP file, read from its HEADER section only
+*/
+struct STEP3D_DLLAPI Step3D_ProbeInfo_Wrapper
+{
+    std::string filename;                 //!< Full path to the file
+    Step3D_HeaderInfo_Wrapper header;     //!< Same content as IStep3D_Wrapper::getHeaderInfo()
+    long long file_size;                  //!< Size of the file
+    long estimated_instance_count;        //!< Highest instance id at the end of the DATA section, 0 if none was found
+
+    WrapperErrorCode error;               //!< NO_ERROR if the HEADER section was read
+    std::string error_message;            //!< Empty if the HEADER section was read
+
+    Step3D_ProbeInfo_Wrapper() : file_size(0), estimated_instance_count(0), error(WrapperErrorCode::NO_ERROR) {}
+};
+
+/**
+* @brief Quick listing of STEP files
+*
+* Reads the HEADER section of the files, without the DATA section
+* and without the schema, so the time does not depend on the size
+* of the files. Intended for a file browser, before a load().
+*
+* The instance count is estimated from the instance ids written
+* at the end of the file: exporters usually number the instances
+* from 1 without gaps.
+*/
+class STEP3D_DLLAPI IStep3D_Probe_Wrapper
+{
+public:
+    /**
+    * @brief Probe one STEP file
+    * @param[in] fname full path to .stp|.step file
+    * @return true if the HEADER section was read
+    *
+    * Previous results are discarded.
+    */
+    virtual bool probe(std::string fname) = 0;
+
+    /**
+    * @brief Probe the STEP files of a directory, in parallel
+    * @param[in] directory full path to the directory
+    * @return true if the directory was listed
+    *
+    * The .stp and .step files (any case) are probed, not the sub-directories.
+    * The result of each file tells if its HEADER section was read.
+    * Previous results are discarded.
+    */
+    virtual bool probeDirectory(std::string directory) = 0;
+
+    /**
+    * @brief Set the number of threads used by probeDirectory()
+    * @param[in] count number of threads, 0 to use the hardware concurrency
+    */
+    virtual void setThreadCount(unsigned int count) = 0;
+
+    /**
+    * @brief Get the summary of the probed files, sorted by file name
+    */
+    virtual std::list<Step3D_ProbeInfo_Wrapper> getResults() = 0;
+
+    /**
+    * @brief Check if the last action finished with errors
+    */
+    virtual bool hasFailed() const = 0;
+
+    /**
+    * @brief Get last error code
+    */
+    virtual WrapperErrorCode getError() const = 0;
+
+    /**
+    * @brief Get last error message
+    */
+    virtual std::string getErrorMessage() = 0;
+
+    /**
+    * @brief Clear error status
+    */
+    virtual void clearError() = 0;
+
+    /**
+    * @brief Release memory allocation
+    *
+    * User of this API should not call delete for objects,
+    * instead call this method to perform the deallocation
+    * from inside the library.
+    */
+    virtual void Release() = 0;
+};
+
+
 /////////////////////////////////////////////////////////////
 // Object creation
 //
@@ -377,3 +891,17 @@ STEP3D_DLLAPI IStep3D_Wrapper* CreateIStep3D_Wrapper();
 * call the ITreeGraphGenerator_Wrapper::Release() method.
 */
 STEP3D_DLLAPI ITreeGraphGenerator_Wrapper* CreateITreeGraphGenerator_Wrapper();
+
+/**
+* @brief Create instance of IStep3D_Diff_Wrapper
+* @note Do not make a delete on this object, instead
+* call the IStep3D_Diff_Wrapper::Release() method.
+*/
+STEP3D_DLLAPI IStep3D_Diff_Wrapper* CreateIStep3D_Diff_Wrapper();
+
+/**
+* @brief Create instance of IStep3D_Probe_Wrapper
+* @note Do not make a delete on this object, instead
+* call the IStep3D_Probe_Wrapper::Release() method.
+*/
+STEP3D_DLLAPI IStep3D_Probe_Wrapper* CreateIStep3D_Probe_Wrapper();
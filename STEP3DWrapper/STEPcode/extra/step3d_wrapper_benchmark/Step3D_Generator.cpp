@@ -0,0 +1,453 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="DstController.cs" company="Open Engineering S.A.">
+//    Copyright (c) 2020-2021 Open Engineering S.A.
+// 
+//    Author: Juan Pablo Hernandez Vogt
+//
+//    This file is part of DEHP STEP-AP242 (STEP 3D CAD) adapter project.
+// 
+//    The DEHP STEP-AP242 is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+// 
+//    The DEHP STEP-AP242 is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+// 
+//    You should have received a copy of the GNU Lesser General Public License
+//    along with this program; if not, write to the Free Software Foundation,
+//    Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+// </copyright>
+// --------------------------------------------------------------------------------------------------------------------
+
+#include "Step3D_Generator.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+    const double PI = 3.14159265358979323846;
+
+    /**
+    * @brief Format a REAL the way Part 21 requires it (always with a decimal point)
+    */
+    string realToStr(double v)
+    {
+        if (fabs(v) < 1e-12) v = 0.0; // avoid "-0."
+
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.10G", v);
+
+        string s(buf);
+        if (s.find('.') == string::npos)
+        {
+            size_t e = s.find('E');
+            s.insert(e == string::npos ? s.size() : e, ".");
+        }
+        return s;
+    }
+}
+
+Step3D_Generator::Step3D_Generator(const Step3D_GeneratorOptions& options) :
+    m_options(options),
+    m_out(nullptr),
+    m_lastId(0),
+    m_random(options.seed),
+    m_parts(nullptr)
+{
+    if (m_options.parts < 1) m_options.parts = 1;
+    if (m_options.depth < 1) m_options.depth = 1;
+    if (m_options.instancing < 1.0) m_options.instancing = 1.0;
+    if (m_options.faces < 5) m_options.faces = 5;
+}
+
+Step3D_Generator::~Step3D_Generator()
+{
+    delete[] m_parts;
+}
+
+bool Step3D_Generator::generate(const std::string& fname)
+{
+    ofstream f(fname.c_str(), ios::out | ios::binary);
+    if (!f)
+    {
+        return false;
+    }
+
+    generate(f, fname);
+    f.close();
+
+    return !f.fail();
+}
+
+void Step3D_Generator::generate(std::ostream& out, const std::string& name)
+{
+    m_out = &out;
+    m_lastId = 0;
+    m_random = m_options.seed;
+    m_stats = Step3D_GeneratorStats();
+
+    delete[] m_parts;
+    m_parts = new ProductIds[m_options.parts];
+    memset(m_parts, 0, sizeof(ProductIds) * m_options.parts);
+
+    ostream::pos_type start = out.tellp();
+
+    writeHeader(name);
+
+    out << "DATA;\n";
+    writeContext();
+
+    // Every part is placed at least once, the extra occurrences reuse the parts round-robin
+    long leaves = (long)ceil(m_options.parts * m_options.instancing);
+    writeAssembly("Root", 1, 0, leaves);
+
+    out << "ENDSEC;\n";
+    out << "END-ISO-10303-21;\n";
+
+    m_stats.instances = m_lastId;
+    m_stats.bytes = (long)(out.tellp() - start);
+    m_out = nullptr;
+}
+
+void Step3D_Generator::writeHeader(const std::string& name)
+{
+    // Fixed time stamp: the same options must give byte-identical files
+    *m_out << "ISO-10303-21;\n"
+           << "HEADER;\n"
+           << "FILE_DESCRIPTION(('Synthetic assembly: " << m_options.parts << " parts, depth " << m_options.depth
+           << ", instancing " << realToStr(m_options.instancing) << ", " << m_options.faces << " faces'),'2;1');\n"
+           << "FILE_NAME('" << name << "','2021-01-01T00:00:00',(''),(''),'step3d_generator','step3d_generator','');\n"
+           << "FILE_SCHEMA(('AP242_MANAGED_MODEL_BASED_3D_ENGINEERING_MIM_LF { 1 0 10303 442 1 1 4 }'));\n"
+           << "ENDSEC;\n";
+}
+
+void Step3D_Generator::writeContext()
+{
+    ostream& out = *m_out;
+
+    long ac = newId();
+    out << "#" << ac << "=APPLICATION_CONTEXT('managed model based 3d engineering');\n";
+    long apd = newId();
+    out << "#" << apd << "=APPLICATION_PROTOCOL_DEFINITION('international standard','ap242_managed_model_based_3d_engineering',2014,#" << ac << ");\n";
+
+    m_context.productContext = newId();
+    out << "#" << m_context.productContext << "=PRODUCT_CONTEXT('',#" << ac << ",'mechanical');\n";
+    m_context.definitionContext = newId();
+    out << "#" << m_context.definitionContext << "=PRODUCT_DEFINITION_CONTEXT('part definition',#" << ac << ",'design');\n";
+
+    long length = newId();
+    out << "#" << length << "=(LENGTH_UNIT()NAMED_UNIT(*)SI_UNIT(.MILLI.,.METRE.));\n";
+    long angle = newId();
+    out << "#" << angle << "=(NAMED_UNIT(*)PLANE_ANGLE_UNIT()SI_UNIT($,.RADIAN.));\n";
+    long solidAngle = newId();
+    out << "#" << solidAngle << "=(NAMED_UNIT(*)SI_UNIT($,.STERADIAN.)SOLID_ANGLE_UNIT());\n";
+    long uncertainty = newId();
+    out << "#" << uncertainty << "=UNCERTAINTY_MEASURE_WITH_UNIT(LENGTH_MEASURE(1.E-07),#" << length
+        << ",'distance_accuracy_value','confusion accuracy');\n";
+
+    m_context.geometricContext = newId();
+    out << "#" << m_context.geometricContext << "=(GEOMETRIC_REPRESENTATION_CONTEXT(3)"
+        << "GLOBAL_UNCERTAINTY_ASSIGNED_CONTEXT((#" << uncertainty << "))"
+        << "GLOBAL_UNIT_ASSIGNED_CONTEXT((#" << length << ",#" << angle << ",#" << solidAngle << "))"
+        << "REPRESENTATION_CONTEXT('Context #1','3D Context with UNIT and UNCERTAINTY'));\n";
+
+    m_context.origin = writePlacement(0.0, 0.0, 0.0);
+}
+
+long Step3D_Generator::writePoint(double x, double y, double z)
+{
+    long id = newId();
+    *m_out << "#" << id << "=CARTESIAN_POINT('',(" << realToStr(x) << "," << realToStr(y) << "," << realToStr(z) << "));\n";
+    return id;
+}
+
+long Step3D_Generator::writeDirection(double x, double y, double z)
+{
+    long id = newId();
+    *m_out << "#" << id << "=DIRECTION('',(" << realToStr(x) << "," << realToStr(y) << "," << realToStr(z) << "));\n";
+    return id;
+}
+
+long Step3D_Generator::writePlacement(double x, double y, double z)
+{
+    long location = writePoint(x, y, z);
+    long axis = writeDirection(0.0, 0.0, 1.0);
+    long refDirection = writeDirection(1.0, 0.0, 0.0);
+
+    long id = newId();
+    *m_out << "#" << id << "=AXIS2_PLACEMENT_3D('',#" << location << ",#" << axis << ",#" << refDirection << ");\n";
+    return id;
+}
+
+Step3D_Generator::ProductIds Step3D_Generator::writeProduct(const std::string& name, long rep)
+{
+    ostream& out = *m_out;
+
+    long product = newId();
+    out << "#" << product << "=PRODUCT('" << name << "','" << name << "','',(#" << m_context.productContext << "));\n";
+    long pdf = newId();
+    out << "#" << pdf << "=PRODUCT_DEFINITION_FORMATION('','',#" << product << ");\n";
+
+    ProductIds ids;
+    ids.pd = newId();
+    ids.rep = rep;
+    out << "#" << ids.pd << "=PRODUCT_DEFINITION('design','',#" << pdf << ",#" << m_context.definitionContext << ");\n";
+
+    long pds = newId();
+    out << "#" << pds << "=PRODUCT_DEFINITION_SHAPE('','',#" << ids.pd << ");\n";
+    long sdr = newId();
+    out << "#" << sdr << "=SHAPE_DEFINITION_REPRESENTATION(#" << pds << ",#" << rep << ");\n";
+    long category = newId();
+    out << "#" << category << "=PRODUCT_RELATED_PRODUCT_CATEGORY('part',$,(#" << product << "));\n";
+
+    m_stats.products++;
+    return ids;
+}
+
+Step3D_Generator::ProductIds Step3D_Generator::writePart(int index)
+{
+    ProductIds& part = m_parts[index];
+    if (part.pd == 0)
+    {
+        ostringstream name;
+        name << "Part" << index;
+        part = writeProduct(name.str(), writeBrep(index));
+    }
+    return part;
+}
+
+Step3D_Generator::ProductIds Step3D_Generator::writeAssembly(const std::string& name, int level, long leafBegin, long leafEnd)
+{
+    const long count = leafEnd - leafBegin;
+
+    // Children: the leaf parts at the last level, sub-assemblies splitting the leaves evenly otherwise
+    vector<ProductIds> children;
+    if (level >= m_options.depth)
+    {
+        for (long leaf = leafBegin; leaf < leafEnd; leaf++)
+        {
+            children.push_back(writePart((int)(leaf % m_options.parts)));
+        }
+    }
+    else
+    {
+        long branches = (long)ceil(pow((double)count, 1.0 / (m_options.depth - level + 1)));
+        if (branches < 1) branches = 1;
+        if (branches > count) branches = count;
+
+        for (long b = 0; b < branches; b++)
+        {
+            ostringstream subName;
+            subName << name << "_" << b;
+            children.push_back(writeAssembly(subName.str(), level + 1,
+                leafBegin + count * b / branches, leafBegin + count * (b + 1) / branches));
+        }
+    }
+
+    // Placements of the children, laid out on a grid with some jitter
+    const int columns = (int)ceil(sqrt((double)children.size()));
+    vector<long> placements;
+    for (size_t i = 0; i < children.size(); i++)
+    {
+        double x = 30.0 * (i % columns) + random();
+        double y = 30.0 * (i / columns) + random();
+        placements.push_back(writePlacement(x, y, 5.0 * random()));
+    }
+
+    long rep = newId();
+    *m_out << "#" << rep << "=SHAPE_REPRESENTATION('" << name << "',(#" << m_context.origin;
+    for (size_t i = 0; i < placements.size(); i++)
+    {
+        *m_out << ",#" << placements[i];
+    }
+    *m_out << "),#" << m_context.geometricContext << ");\n";
+
+    ProductIds assembly = writeProduct(name, rep);
+
+    for (size_t i = 0; i < children.size(); i++)
+    {
+        writeOccurrence(assembly, children[i], placements[i]);
+    }
+
+    return assembly;
+}
+
+long Step3D_Generator::writeBrep(int index)
+{
+    ostream& out = *m_out;
+
+    // Prism with a regular polygon as base: n side faces plus bottom and top
+    const int n = m_options.faces - 2;
+    const double radius = 5.0 + index % 10;
+    const double height = 10.0 + index % 7;
+
+    vector<long> bottom(n), top(n);
+    for (int i = 0; i < n; i++)
+    {
+        double a = 2.0 * PI * i / n;
+        long p = writePoint(radius * cos(a), radius * sin(a), 0.0);
+        bottom[i] = newId();
+        out << "#" << bottom[i] << "=VERTEX_POINT('',#" << p << ");\n";
+    }
+    for (int i = 0; i < n; i++)
+    {
+        double a = 2.0 * PI * i / n;
+        long p = writePoint(radius * cos(a), radius * sin(a), height);
+        top[i] = newId();
+        out << "#" << top[i] << "=VERTEX_POINT('',#" << p << ");\n";
+    }
+
+    // Straight edge between two vertices
+    auto writeEdge = [&](long v1, long v2, double x1, double y1, double z1, double x2, double y2, double z2)
+    {
+        double dx = x2 - x1, dy = y2 - y1, dz = z2 - z1;
+        double len = sqrt(dx * dx + dy * dy + dz * dz);
+
+        long p = writePoint(x1, y1, z1);
+        long d = writeDirection(dx / len, dy / len, dz / len);
+        long vector = newId();
+        out << "#" << vector << "=VECTOR('',#" << d << "," << realToStr(len) << ");\n";
+        long line = newId();
+        out << "#" << line << "=LINE('',#" << p << ",#" << vector << ");\n";
+        long edge = newId();
+        out << "#" << edge << "=EDGE_CURVE('',#" << v1 << ",#" << v2 << ",#" << line << ",.T.);\n";
+        return edge;
+    };
+
+    vector<long> bottomEdges(n), topEdges(n), sideEdges(n);
+    for (int i = 0; i < n; i++)
+    {
+        int j = (i + 1) % n;
+        double a1 = 2.0 * PI * i / n, a2 = 2.0 * PI * j / n;
+        double x1 = radius * cos(a1), y1 = radius * sin(a1);
+        double x2 = radius * cos(a2), y2 = radius * sin(a2);
+
+        bottomEdges[i] = writeEdge(bottom[i], bottom[j], x1, y1, 0.0, x2, y2, 0.0);
+        topEdges[i] = writeEdge(top[i], top[j], x1, y1, height, x2, y2, height);
+        sideEdges[i] = writeEdge(bottom[i], top[i], x1, y1, 0.0, x1, y1, height);
+    }
+
+    // Planar face bounded by a loop of oriented edges
+    auto writeFace = [&](const vector<pair<long, bool> >& edges, double px, double py, double pz,
+                         double nx, double ny, double nz, double rx, double ry, double rz)
+    {
+        vector<long> oriented;
+        for (size_t k = 0; k < edges.size(); k++)
+        {
+            long oe = newId();
+            out << "#" << oe << "=ORIENTED_EDGE('',*,*,#" << edges[k].first << "," << (edges[k].second ? ".T." : ".F.") << ");\n";
+            oriented.push_back(oe);
+        }
+
+        long loop = newId();
+        out << "#" << loop << "=EDGE_LOOP('',(";
+        for (size_t k = 0; k < oriented.size(); k++)
+        {
+            out << (k ? ",#" : "#") << oriented[k];
+        }
+        out << "));\n";
+
+        long bound = newId();
+        out << "#" << bound << "=FACE_OUTER_BOUND('',#" << loop << ",.T.);\n";
+
+        long location = writePoint(px, py, pz);
+        long axis = writeDirection(nx, ny, nz);
+        long refDirection = writeDirection(rx, ry, rz);
+        long placement = newId();
+        out << "#" << placement << "=AXIS2_PLACEMENT_3D('',#" << location << ",#" << axis << ",#" << refDirection << ");\n";
+        long plane = newId();
+        out << "#" << plane << "=PLANE('',#" << placement << ");\n";
+
+        long face = newId();
+        out << "#" << face << "=ADVANCED_FACE('',(#" << bound << "),#" << plane << ",.T.);\n";
+        return face;
+    };
+
+    vector<long> faces;
+    for (int i = 0; i < n; i++)
+    {
+        int j = (i + 1) % n;
+        double a1 = 2.0 * PI * i / n, a2 = 2.0 * PI * j / n, am = (a1 + a2) / 2.0;
+        if (j == 0) am += PI;
+
+        vector<pair<long, bool> > loop;
+        loop.push_back(make_pair(bottomEdges[i], true));
+        loop.push_back(make_pair(sideEdges[j], true));
+        loop.push_back(make_pair(topEdges[i], false));
+        loop.push_back(make_pair(sideEdges[i], false));
+
+        double rx = cos(a2) - cos(a1), ry = sin(a2) - sin(a1);
+        double rl = sqrt(rx * rx + ry * ry);
+        faces.push_back(writeFace(loop, radius * cos(a1), radius * sin(a1), 0.0,
+                                  cos(am), sin(am), 0.0, rx / rl, ry / rl, 0.0));
+    }
+
+    vector<pair<long, bool> > bottomLoop, topLoop;
+    for (int i = n - 1; i >= 0; i--)
+    {
+        bottomLoop.push_back(make_pair(bottomEdges[i], false));
+    }
+    for (int i = 0; i < n; i++)
+    {
+        topLoop.push_back(make_pair(topEdges[i], true));
+    }
+    faces.push_back(writeFace(bottomLoop, 0.0, 0.0, 0.0, 0.0, 0.0, -1.0, 1.0, 0.0, 0.0));
+    faces.push_back(writeFace(topLoop, 0.0, 0.0, height, 0.0, 0.0, 1.0, 1.0, 0.0, 0.0));
+
+    long shell = newId();
+    out << "#" << shell << "=CLOSED_SHELL('',(";
+    for (size_t k = 0; k < faces.size(); k++)
+    {
+        out << (k ? ",#" : "#") << faces[k];
+    }
+    out << "));\n";
+
+    long solid = newId();
+    out << "#" << solid << "=MANIFOLD_SOLID_BREP('Solid" << index << "',#" << shell << ");\n";
+
+    long rep = newId();
+    out << "#" << rep << "=ADVANCED_BREP_SHAPE_REPRESENTATION('',(#" << m_context.origin << ",#" << solid << "),#"
+        << m_context.geometricContext << ");\n";
+    return rep;
+}
+
+void Step3D_Generator::writeOccurrence(const ProductIds& parent, const ProductIds& child, long placement)
+{
+    ostream& out = *m_out;
+
+    long nauo = newId();
+    m_stats.occurrences++;
+    out << "#" << nauo << "=NEXT_ASSEMBLY_USAGE_OCCURRENCE('" << m_stats.occurrences << "','Occurrence" << m_stats.occurrences
+        << "','',#" << parent.pd << ",#" << child.pd << ",$);\n";
+
+    long pds = newId();
+    out << "#" << pds << "=PRODUCT_DEFINITION_SHAPE('Placement','Placement of an item',#" << nauo << ");\n";
+
+    long transformation = newId();
+    out << "#" << transformation << "=ITEM_DEFINED_TRANSFORMATION('','',#" << m_context.origin << ",#" << placement << ");\n";
+
+    long relationship = newId();
+    out << "#" << relationship << "=(REPRESENTATION_RELATIONSHIP('','',#" << child.rep << ",#" << parent.rep << ")"
+        << "REPRESENTATION_RELATIONSHIP_WITH_TRANSFORMATION(#" << transformation << ")"
+        << "SHAPE_REPRESENTATION_RELATIONSHIP());\n";
+
+    long cdsr = newId();
+    out << "#" << cdsr << "=CONTEXT_DEPENDENT_SHAPE_REPRESENTATION(#" << relationship << ",#" << pds << ");\n";
+}
+
+double Step3D_Generator::random()
+{
+    // Small LCG: portable and reproducible across platforms, unlike std::rand()
+    m_random = m_random * 1103515245u + 12345u;
+    return ((m_random >> 16) & 0x7FFF) / 32768.0;
+}
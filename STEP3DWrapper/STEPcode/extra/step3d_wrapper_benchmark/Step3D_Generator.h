@@ -0,0 +1,139 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="DstController.cs" company="Open Engineering S.A.">
+//    Copyright (c) 2020-2021 Open Engineering S.A.
+// 
+//    Author: Juan Pablo Hernandez Vogt
+//
+//    This file is part of DEHP STEP-AP242 (STEP 3D CAD) adapter project.
+// 
+//    The DEHP STEP-AP242 is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+// 
+//    The DEHP STEP-AP242 is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+// 
+//    You should have received a copy of the GNU Lesser General Public License
+//    along with this program; if not, write to the Free Software Foundation,
+//    Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+// </copyright>
+// --------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+/**
+* Generator of synthetic STEP AP242 assemblies
+*
+* Writes a valid exchange file (ISO 10303-21) with a product structure
+* (PRODUCT, PRODUCT_DEFINITION, NEXT_ASSEMBLY_USAGE_OCCURRENCE with placed
+* CONTEXT_DEPENDENT_SHAPE_REPRESENTATION) and one prismatic B-rep solid per
+* part, sized so that the readers can be benchmarked on large inputs.
+*
+* Not linked to Stepcode, the file is written directly.
+*/
+
+// STL headers
+#include <string>
+#include <ostream>
+
+/**
+* @brief Shape of the generated assembly
+*/
+struct Step3D_GeneratorOptions
+{
+    int parts;          //!< Number of distinct leaf parts (each one has its own B-rep)
+    int depth;          //!< Number of assembly levels above the leaf parts (0 = parts directly under the root)
+    double instancing;  //!< Average number of occurrences of each part (1.0 = every part used once)
+    int faces;          //!< Faces of each B-rep solid (a prism, minimum 5)
+    unsigned int seed;  //!< Seed for the placement offsets, the same options give the same file
+
+    Step3D_GeneratorOptions() : parts(100), depth(3), instancing(2.0), faces(8), seed(1) {}
+};
+
+/**
+* @brief Figures of a generated file
+*/
+struct Step3D_GeneratorStats
+{
+    long instances;     //!< Entity instances written in the DATA section
+    long products;      //!< Products (parts and sub-assemblies, root included)
+    long occurrences;   //!< NEXT_ASSEMBLY_USAGE_OCCURRENCE written
+    long bytes;         //!< Size of the file
+
+    Step3D_GeneratorStats() : instances(0), products(0), occurrences(0), bytes(0) {}
+};
+
+class Step3D_Generator
+{
+public:
+    Step3D_Generator(const Step3D_GeneratorOptions& options);
+    ~Step3D_Generator();
+
+    /**
+    * @brief Write the assembly to a file
+    *
+    * @return false when the file can not be written
+    */
+    bool generate(const std::string& fname);
+
+    /**
+    * @brief Write the assembly to a stream
+    */
+    void generate(std::ostream& out, const std::string& name);
+
+    /**
+    * @brief Figures of the last generated file
+    */
+    const Step3D_GeneratorStats& getStats() const { return m_stats; }
+
+private:
+    /**
+    * @brief Ids of the instances shared by every product
+    */
+    struct Context
+    {
+        long productContext;
+        long definitionContext;
+        long geometricContext;
+        long origin;
+    };
+
+    /**
+    * @brief Ids of a generated product
+    */
+    struct ProductIds
+    {
+        long pd;            //!< PRODUCT_DEFINITION
+        long rep;           //!< Shape representation used by the SDR
+    };
+
+    long newId() { return ++m_lastId; }
+
+    void writeHeader(const std::string& name);
+    void writeContext();
+
+    long writePoint(double x, double y, double z);
+    long writeDirection(double x, double y, double z);
+    long writePlacement(double x, double y, double z);
+
+    ProductIds writeProduct(const std::string& name, long rep);
+    ProductIds writePart(int index);
+    ProductIds writeAssembly(const std::string& name, int level, long leafBegin, long leafEnd);
+    long writeBrep(int index);
+    void writeOccurrence(const ProductIds& parent, const ProductIds& child, long placement);
+
+    double random();
+
+    Step3D_GeneratorOptions m_options;
+    Step3D_GeneratorStats m_stats;
+    Context m_context;
+
+    std::ostream* m_out;
+    long m_lastId;
+    unsigned int m_random;
+
+    ProductIds* m_parts;        //!< Leaf parts, written on first use
+};
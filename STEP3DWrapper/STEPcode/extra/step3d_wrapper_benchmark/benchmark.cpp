@@ -0,0 +1,558 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="DstController.cs" company="Open Engineering S.A.">
+//    Copyright (c) 2020-2021 Open Engineering S.A.
+// 
+//    Author: Juan Pablo Hernandez Vogt
+//
+//    This file is part of DEHP STEP-AP242 (STEP 3D CAD) adapter project.
+// 
+//    The DEHP STEP-AP242 is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+// 
+//    The DEHP STEP-AP242 is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+// 
+//    You should have received a copy of the GNU Lesser General Public License
+//    along with this program; if not, write to the Free Software Foundation,
+//    Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+// </copyright>
+// --------------------------------------------------------------------------------------------------------------------
+
+/**
+* End-to-end benchmark of the STEP 3D readers
+*
+* Times each step of the chain on one or more files, or on a synthetic
+* assembly made by Step3D_Generator, and reports the figures as JSON:
+*
+*   registry  Registry construction from the AP242 schema (instances are the entity types)
+*   read      STEPfile::ReadExchangeFile
+*   write     STEPfile::WriteExchangeFile of the file just read
+*   read1     STEPfile::ReadExchangeFile in one pass (STEPfile::OnePassRead)
+*   read0     STEPfile::ReadExchangeFile without the attribute readers of the schema (exp2cxx -u),
+*             every instance read by the loop of SDAI_Application_instance::STEPread
+*   readp     STEPfile::ReadExchangeFile with the second pass on several threads (STEPfile::ParallelRead)
+*   lazy      lazyInstMgr::openFile (indexing only, no instance loaded)
+*   load      IStep3D_Wrapper::load
+*   hlr       IStep3D_Wrapper::parseHLRInformation
+*   dot       ITreeGraphGenerator_Wrapper::generate (Normal_DirGraph)
+*
+* For every stage: wall and CPU time, MB/s and instances/s, peak resident
+* memory and the number and size of the heap allocations, in total and per
+* instance.
+*
+* Allocations are counted by replacing the global operator new. On Linux it
+* covers the whole process, on Windows only the allocations done in this
+* executable (each DLL resolves its own operator new).
+* Peak RSS is per stage on Linux (the high water mark is reset before each
+* stage), and the peak of the whole process on other systems.
+*/
+
+#include "Step3D_Generator.h"
+#include "step3d_wrapper.h"
+
+// STEPcode headers
+#include "Registry.h"
+#include "STEPfile.h"
+#include "sdai.h"
+#include "lazyInstMgr.h"
+#include "schema.h"
+#include "SdaiSchemaInit.h"
+#include "sc_benchmark.h"
+
+// STL headers
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+// --------------------------------------------------------------------------------------------------------------------
+// Allocation counting
+
+static std::atomic<unsigned long long> g_allocCount(0);
+static std::atomic<unsigned long long> g_allocBytes(0);
+
+static void* countedAlloc(size_t size)
+{
+    g_allocCount++;
+    g_allocBytes += size;
+    return malloc(size ? size : 1);
+}
+
+void* operator new(size_t size)
+{
+    void* p = countedAlloc(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size)
+{
+    void* p = countedAlloc(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAlloc(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    free(p);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Measurements
+
+/**
+* @brief Reset the peak resident memory, when the system allows it
+*/
+static void resetPeakRss()
+{
+#ifdef __linux__
+    // Writing 5 to clear_refs resets VmHWM (Linux 4.0 and later)
+    ofstream f("/proc/self/clear_refs");
+    f << "5";
+#endif
+}
+
+/**
+* @brief Peak resident memory in KB
+*/
+static long peakRssKB()
+{
+#if defined(__linux__)
+    ifstream f("/proc/self/status");
+    string line;
+    while (getline(f, line))
+    {
+        if (line.compare(0, 6, "VmHWM:") == 0)
+        {
+            return atol(line.c_str() + 6);
+        }
+    }
+    return 0;
+#elif defined(_WIN32)
+    return getMemAndTime().physMemKB; // peak working set
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024; // bytes on OSX
+#endif
+}
+
+static long long fileSize(const string& fname)
+{
+    ifstream f(fname.c_str(), ios::in | ios::binary | ios::ate);
+    return f ? (long long)f.tellg() : 0;
+}
+
+/**
+* @brief Figures of one stage
+*/
+struct StageResult
+{
+    string name;
+    bool ok;
+    double seconds;
+    double cpuSeconds;
+    long long bytes;            //!< Bytes processed (read or written)
+    long instances;             //!< Instances processed
+    long peakRssKB;
+    unsigned long long allocations;
+    unsigned long long allocatedBytes;
+
+    StageResult() : ok(false), seconds(0), cpuSeconds(0), bytes(0), instances(0), peakRssKB(0), allocations(0), allocatedBytes(0) {}
+};
+
+/**
+* @brief Measure a stage between start() and stop()
+*/
+class StageTimer
+{
+public:
+
+    void start(const string& name)
+    {
+        m_result = StageResult();
+        m_result.name = name;
+
+        resetPeakRss();
+
+        m_allocCount = g_allocCount;
+        m_allocBytes = g_allocBytes;
+        m_cpu = getMemAndTime();
+        m_wall = chrono::steady_clock::now();
+    }
+
+    StageResult& stop(bool ok, long long bytes, long instances)
+    {
+        auto wall = chrono::steady_clock::now();
+        benchVals cpu = getMemAndTime();
+
+        m_result.allocations = g_allocCount - m_allocCount;
+        m_result.allocatedBytes = g_allocBytes - m_allocBytes;
+
+        m_result.ok = ok;
+        m_result.seconds = chrono::duration<double>(wall - m_wall).count();
+        m_result.cpuSeconds = ((cpu.userMilliseconds + cpu.sysMilliseconds) - (m_cpu.userMilliseconds + m_cpu.sysMilliseconds)) / 1000.0;
+        m_result.bytes = bytes;
+        m_result.instances = instances;
+        m_result.peakRssKB = peakRssKB();
+
+        return m_result;
+    }
+
+private:
+    StageResult m_result;
+    unsigned long long m_allocCount;
+    unsigned long long m_allocBytes;
+    benchVals m_cpu;
+    chrono::steady_clock::time_point m_wall;
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+// Stages
+
+/**
+* @brief Run every stage once on a file
+*/
+static vector<StageResult> runStages(const string& fname, bool keep, unsigned int threads)
+{
+    vector<StageResult> results;
+    StageTimer timer;
+    long instanceCount = 0;
+    const long long size = fileSize(fname);
+
+    // The wrapper reads with the registry shared by the process: building and deleting another one
+    // would leave the global descriptors dangling. It is built once, so every run reports the first
+    static StageResult registryStage;
+    static Registry* registry = nullptr;
+    if (!registry)
+    {
+        timer.start("registry");
+        registry = SharedRegistry(SchemaInit);
+        registryStage = timer.stop(true, 0, registry->GetEntityCnt());
+    }
+    results.push_back(registryStage);
+
+    // read, write, read1, read0, readp
+    {
+        InstMgr instances(1);
+        STEPfile sfile(*registry, instances);
+
+        timer.start("read");
+        Severity sev = sfile.ReadExchangeFile(fname.c_str());
+        instanceCount = instances.InstanceCount();
+        results.push_back(timer.stop(sev >= SEVERITY_WARNING, size, instanceCount));
+
+        const string written = fname + ".benchmark.stp";
+        timer.start("write");
+        sev = sfile.WriteExchangeFile(written, 0);
+        results.push_back(timer.stop(sev >= SEVERITY_WARNING, fileSize(written), instances.InstanceCount()));
+
+        if (!keep)
+        {
+            remove(written.c_str());
+        }
+
+        instances.DeleteInstances();
+
+        InstMgr onePassInstances(1);
+        STEPfile onePassFile(*registry, onePassInstances);
+        onePassFile.OnePassRead(true);
+
+        timer.start("read1");
+        sev = onePassFile.ReadExchangeFile(fname.c_str());
+        results.push_back(timer.stop(sev >= SEVERITY_WARNING, size, onePassInstances.InstanceCount()));
+
+        onePassInstances.DeleteInstances();
+
+        InstMgr loopInstances(1);
+        STEPfile loopFile(*registry, loopInstances);
+        SDAI_Application_instance::UseAttrReaders(false);
+
+        timer.start("read0");
+        sev = loopFile.ReadExchangeFile(fname.c_str());
+        results.push_back(timer.stop(sev >= SEVERITY_WARNING, size, loopInstances.InstanceCount()));
+
+        SDAI_Application_instance::UseAttrReaders(true);
+        loopInstances.DeleteInstances();
+
+        InstMgr parallelInstances(1);
+        STEPfile parallelFile(*registry, parallelInstances);
+        parallelFile.ParallelRead(threads);
+
+        timer.start("readp");
+        sev = parallelFile.ReadExchangeFile(fname.c_str());
+        results.push_back(timer.stop(sev >= SEVERITY_WARNING, size, parallelInstances.InstanceCount()));
+
+        parallelInstances.DeleteInstances();
+    }
+
+    // lazy indexing
+    {
+        lazyInstMgr mgr;
+        mgr.setRegistry(registry);
+
+        timer.start("lazy");
+        mgr.openFile(fname);
+        results.push_back(timer.stop(mgr.totalInstanceCount() > 0, size, mgr.totalInstanceCount()));
+    }
+
+    // wrapper: load, HLR information, DOT export
+    {
+        auto wrapper = CreateIStep3D_Wrapper();
+
+        timer.start("load");
+        bool ok = wrapper->load(fname);
+        results.push_back(timer.stop(ok, size, instanceCount));
+
+        timer.start("hlr");
+        ok = ok && wrapper->parseHLRInformation();
+        long parsed = (long)(wrapper->getNodes().size() + wrapper->getRelations().size());
+        results.push_back(timer.stop(ok, 0, parsed));
+
+        // The generator names the graph after the file and the style
+        ostringstream dotName;
+        dotName << fname << "_" << (int)TreeGraphStyle::Normal_DirGraph << ".dot";
+
+        auto generator = CreateITreeGraphGenerator_Wrapper();
+        timer.start("dot");
+        generator->generate(wrapper, TreeGraphStyle::Normal_DirGraph);
+        results.push_back(timer.stop(ok, fileSize(dotName.str()), parsed));
+        generator->Release();
+
+        if (!keep)
+        {
+            remove(dotName.str().c_str());
+        }
+
+        wrapper->Release();
+    }
+
+    return results;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Report
+
+static string jsonString(const string& s)
+{
+    string out("\"");
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+static void writeStage(ostream& out, const StageResult& r)
+{
+    const double mb = r.bytes / (1024.0 * 1024.0);
+
+    out << "        {\"name\": " << jsonString(r.name)
+        << ", \"ok\": " << (r.ok ? "true" : "false")
+        << ", \"seconds\": " << r.seconds
+        << ", \"cpu_seconds\": " << r.cpuSeconds
+        << ", \"bytes\": " << r.bytes
+        << ", \"mb_per_s\": " << (r.seconds > 0 ? mb / r.seconds : 0)
+        << ", \"instances\": " << r.instances
+        << ", \"instances_per_s\": " << (r.seconds > 0 ? r.instances / r.seconds : 0)
+        << ", \"peak_rss_kb\": " << r.peakRssKB
+        << ", \"allocations\": " << r.allocations
+        << ", \"allocated_bytes\": " << r.allocatedBytes
+        << ", \"allocations_per_instance\": " << (r.instances > 0 ? (double)r.allocations / r.instances : 0)
+        << ", \"allocated_bytes_per_instance\": " << (r.instances > 0 ? (double)r.allocatedBytes / r.instances : 0)
+        << "}";
+}
+
+static void usage(const char* app)
+{
+    cerr << "Usage: " << app << " [options] [file ...]" << endl
+         << endl
+         << "Benchmark the STEP 3D readers on the given files and write the results as JSON." << endl
+         << endl
+         << "  --parts N        benchmark a synthetic assembly with N parts (see step3d_generator)" << endl
+         << "  --depth N        assembly levels of the synthetic assembly" << endl
+         << "  --instancing R   occurrences per part of the synthetic assembly" << endl
+         << "  --faces N        faces per B-rep solid of the synthetic assembly" << endl
+         << "  --seed N         seed of the synthetic assembly" << endl
+         << "  --repeat N       run every file N times and keep the fastest run of each stage" << endl
+         << "  --threads N      threads of the second pass of the readp stage (default: the number of cores)" << endl
+         << "  --json FILE      write the results to FILE instead of the standard output" << endl
+         << "  --keep           keep the generated, written and DOT files" << endl
+         << "  --verbose        show the console output of the readers" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+    Step3D_GeneratorOptions options;
+    bool generate = false;
+    int repeat = 1;
+    unsigned int threads = 0;
+    bool keep = false;
+    bool verbose = false;
+    string jsonName;
+    vector<string> files;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg(argv[i]);
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--parts" && hasValue) { options.parts = atoi(argv[++i]); generate = true; }
+        else if (arg == "--depth" && hasValue) { options.depth = atoi(argv[++i]); generate = true; }
+        else if (arg == "--instancing" && hasValue) { options.instancing = atof(argv[++i]); generate = true; }
+        else if (arg == "--faces" && hasValue) { options.faces = atoi(argv[++i]); generate = true; }
+        else if (arg == "--seed" && hasValue) { options.seed = (unsigned int)atol(argv[++i]); generate = true; }
+        else if (arg == "--repeat" && hasValue) { repeat = atoi(argv[++i]); }
+        else if (arg == "--threads" && hasValue) { threads = (unsigned int)atoi(argv[++i]); }
+        else if (arg == "--json" && hasValue) { jsonName = argv[++i]; }
+        else if (arg == "--keep") { keep = true; }
+        else if (arg == "--verbose") { verbose = true; }
+        else if (arg.compare(0, 2, "--") == 0) { usage(argv[0]); return EXIT_FAILURE; }
+        else files.push_back(arg);
+    }
+
+    if (repeat < 1) repeat = 1;
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+
+    Step3D_GeneratorStats generated;
+    string generatedName;
+    if (generate)
+    {
+        ostringstream name;
+        name << "synthetic_" << options.parts << "_" << options.depth << "_" << options.instancing << "_" << options.faces << ".stp";
+        generatedName = name.str();
+
+        Step3D_Generator generator(options);
+        if (!generator.generate(generatedName))
+        {
+            cerr << "ERROR: can not write " << generatedName << endl;
+            return EXIT_FAILURE;
+        }
+        generated = generator.getStats();
+        files.push_back(generatedName);
+    }
+
+    if (files.empty())
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    ofstream jsonFile;
+    if (!jsonName.empty())
+    {
+        jsonFile.open(jsonName.c_str());
+        if (!jsonFile)
+        {
+            cerr << "ERROR: can not write " << jsonName << endl;
+            return EXIT_FAILURE;
+        }
+    }
+    streambuf* console = cout.rdbuf();
+    ostream out(jsonName.empty() ? console : jsonFile.rdbuf());
+
+    // The wrapper writes a few lines for every instance it visits, keep them out of the measures and the report
+    if (!verbose)
+    {
+        cout.rdbuf(nullptr);
+    }
+
+    bool allOk = true;
+
+    out << "{" << endl;
+    if (generate)
+    {
+        out << "  \"generator\": {\"parts\": " << options.parts
+            << ", \"depth\": " << options.depth
+            << ", \"instancing\": " << options.instancing
+            << ", \"faces\": " << options.faces
+            << ", \"seed\": " << options.seed
+            << ", \"instances\": " << generated.instances
+            << ", \"products\": " << generated.products
+            << ", \"occurrences\": " << generated.occurrences
+            << ", \"bytes\": " << generated.bytes << "}," << endl;
+    }
+    out << "  \"repeat\": " << repeat << "," << endl;
+    out << "  \"threads\": " << threads << "," << endl;
+    out << "  \"runs\": [" << endl;
+
+    for (size_t f = 0; f < files.size(); f++)
+    {
+        vector<StageResult> best;
+        for (int r = 0; r < repeat; r++)
+        {
+            vector<StageResult> results = runStages(files[f], keep, threads);
+            for (size_t s = 0; s < results.size(); s++)
+            {
+                if (best.size() <= s) best.push_back(results[s]);
+                else if (results[s].seconds < best[s].seconds) best[s] = results[s];
+            }
+        }
+
+        out << "    {\"file\": " << jsonString(files[f]) << ", \"bytes\": " << fileSize(files[f]) << ", \"stages\": [" << endl;
+        for (size_t s = 0; s < best.size(); s++)
+        {
+            writeStage(out, best[s]);
+            out << (s + 1 < best.size() ? "," : "") << endl;
+            allOk = allOk && best[s].ok;
+        }
+        out << "    ]}" << (f + 1 < files.size() ? "," : "") << endl;
+    }
+
+    out << "  ]" << endl;
+    out << "}" << endl;
+
+    cout.rdbuf(console);
+
+    if (generate && !keep)
+    {
+        remove(generatedName.c_str());
+    }
+
+    return allOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
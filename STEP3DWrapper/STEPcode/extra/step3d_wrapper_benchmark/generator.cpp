@@ -0,0 +1,92 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="DstController.cs" company="Open Engineering S.A.">
+//    Copyright (c) 2020-2021 Open Engineering S.A.
+// 
+//    Author: Juan Pablo Hernandez Vogt
+//
+//    This file is part of DEHP STEP-AP242 (STEP 3D CAD) adapter project.
+// 
+//    The DEHP STEP-AP242 is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+// 
+//    The DEHP STEP-AP242 is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+// 
+//    You should have received a copy of the GNU Lesser General Public License
+//    along with this program; if not, write to the Free Software Foundation,
+//    Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+// </copyright>
+// --------------------------------------------------------------------------------------------------------------------
+
+/**
+* Command line front-end of Step3D_Generator
+*/
+
+#include "Step3D_Generator.h"
+
+// STL headers
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+static void usage(const char* app)
+{
+    Step3D_GeneratorOptions defaults;
+
+    cerr << "Usage: " << app << " [options] output.stp" << endl
+         << endl
+         << "Write a synthetic STEP AP242 assembly." << endl
+         << endl
+         << "  --parts N        distinct parts (default " << defaults.parts << ")" << endl
+         << "  --depth N        assembly levels, root included (default " << defaults.depth << ")" << endl
+         << "  --instancing R   average occurrences of each part (default " << defaults.instancing << ")" << endl
+         << "  --faces N        faces of each B-rep solid, minimum 5 (default " << defaults.faces << ")" << endl
+         << "  --seed N         seed of the placements (default " << defaults.seed << ")" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+    Step3D_GeneratorOptions options;
+    string fname;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg(argv[i]);
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--parts" && hasValue) options.parts = atoi(argv[++i]);
+        else if (arg == "--depth" && hasValue) options.depth = atoi(argv[++i]);
+        else if (arg == "--instancing" && hasValue) options.instancing = atof(argv[++i]);
+        else if (arg == "--faces" && hasValue) options.faces = atoi(argv[++i]);
+        else if (arg == "--seed" && hasValue) options.seed = (unsigned int)atol(argv[++i]);
+        else if (arg.compare(0, 2, "--") == 0 || !fname.empty()) { usage(argv[0]); return EXIT_FAILURE; }
+        else fname = arg;
+    }
+
+    if (fname.empty())
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    Step3D_Generator generator(options);
+    if (!generator.generate(fname))
+    {
+        cerr << "ERROR: can not write " << fname << endl;
+        return EXIT_FAILURE;
+    }
+
+    const Step3D_GeneratorStats& stats = generator.getStats();
+    cout << fname << ": " << stats.instances << " instances, "
+         << stats.products << " products, "
+         << stats.occurrences << " occurrences, "
+         << stats.bytes << " bytes" << endl;
+
+    return EXIT_SUCCESS;
+}
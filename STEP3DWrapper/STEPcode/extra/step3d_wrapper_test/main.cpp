@@ -117,6 +117,42 @@ void processStep3DFile(std::string fname, bool drawGraph)
     wrapper->Release();
 }
 
+/**
+* @brief Show the structural differences between two STEP-3D files
+*/
+void diffStep3DFiles(std::string oldFname, std::string newFname)
+{
+    static const char* statusNames[] = { "UNCHANGED", "ADDED", "REMOVED", "MODIFIED" };
+
+    auto diff = CreateIStep3D_Diff_Wrapper();
+
+    if (!diff->compare(oldFname, newFname))
+    {
+        cout << "ERROR " << (int)diff->getError() << ": " << diff->getErrorMessage();
+        diff->Release();
+        return;
+    }
+
+    cout << endl;
+    cout << "PARTS ---------------------------------" << endl;
+
+    for (const auto& p : diff->getPartDiffs())
+    {
+        cout << statusNames[(int)p.status] << " " << p.name << " #" << p.old_stepId << " --> #" << p.new_stepId << endl;
+    }
+
+    cout << endl;
+    cout << "RELATIONS -----------------------------" << endl;
+
+    for (const auto& r : diff->getRelationDiffs())
+    {
+        cout << statusNames[(int)r.status] << " " << r.id << " " << r.relating_name << " --> " << r.related_name
+            << " #" << r.old_stepId << " --> #" << r.new_stepId << endl;
+    }
+
+    diff->Release();
+}
+
 int main(int argc, char* argv[]) 
 {
     // Examples of arguments:
@@ -125,6 +161,7 @@ int main(int argc, char* argv[])
     // "D:\dev\DEHP\DEHP-Stepcode\stepcode\extra\step3d_wrapper_test\examples\MyParts.step"
     // "D:\dev\DEHP\SharePoint\Project Documents\XIPE_STEP_3D_Samples\MyParts.step"
     // "D:\dev\DEHP\SharePoint\Project Documents\XIPE_STEP_3D_Samples\XIPE_all_v1.stp"
+    // --diff "D:\dev\DEHP\DEHP-Stepcode\stepcode\extra\step3d_wrapper_test\examples\SimpleCAD.step" "D:\dev\DEHP\DEHP-Stepcode\stepcode\extra\step3d_wrapper_test\examples\ModifiedSimpleCAD.step"
 
     cout << "Stepcode version: " << getStepcodeVersion() << endl;
 
@@ -140,6 +177,13 @@ int main(int argc, char* argv[])
             continue;
         }
 
+        if (option == "--diff" && i + 2 < argc)
+        {
+            diffStep3DFiles(argv[i + 1], argv[i + 2]);
+            i += 2;
+            continue;
+        }
+
         processStep3DFile(option, drawGraph);
     }
 
@@ -32,6 +32,9 @@ using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 #include <filesystem>
 namespace fs = std::filesystem;
 
+#include <fstream>
+#include <iterator>
+
 
 // To test the auxiliary feature of creating an image from the 
 // IStep3D_Wrapper's information it is required to have the
@@ -45,6 +48,10 @@ namespace Step3D_Wrapper_Tests
     // Paths to example files
     std::filesystem::path MyParts_path;
     std::filesystem::path NotStep3DFile_path;
+    std::filesystem::path SimpleCAD_path;
+    std::filesystem::path ModifiedSimpleCAD_path;
+    std::filesystem::path MyPartsSRR_path;
+    std::filesystem::path ModifiedMyPartsSRR_path;
 
     TEST_MODULE_INITIALIZE(IStep3D_Wrapper_Test)
     {
@@ -57,10 +64,18 @@ namespace Step3D_Wrapper_Tests
         std::filesystem::path cwd = fs::current_path();
         MyParts_path = std::filesystem::absolute(cwd / "../../../STEPcode/extra/step3d_wrapper_test/examples/MyParts.step");
         NotStep3DFile_path = std::filesystem::absolute(cwd / "../../../STEPcode/extra/step3d_wrapper_test/examples/NotStepFileFormat.step");
+        SimpleCAD_path = std::filesystem::absolute(cwd / "../../../STEPcode/extra/step3d_wrapper_test/examples/SimpleCAD.step");
+        ModifiedSimpleCAD_path = std::filesystem::absolute(cwd / "../../../STEPcode/extra/step3d_wrapper_test/examples/ModifiedSimpleCAD.step");
+        MyPartsSRR_path = std::filesystem::absolute(cwd / "../../../STEPcode/extra/step3d_wrapper_test/examples/MyPartsSRR.step");
+        ModifiedMyPartsSRR_path = std::filesystem::absolute(cwd / "../../../STEPcode/extra/step3d_wrapper_test/examples/ModifiedMyPartsSRR.step");
 
         // Show composed paths
         Logger::WriteMessage(std::string("MyParts.step: ").append(MyParts_path.string()).append("\n").c_str());
         Logger::WriteMessage(std::string("NotStepFileFormat.step: ").append(NotStep3DFile_path.string()).append("\n").c_str());
+        Logger::WriteMessage(std::string("SimpleCAD.step: ").append(SimpleCAD_path.string()).append("\n").c_str());
+        Logger::WriteMessage(std::string("ModifiedSimpleCAD.step: ").append(ModifiedSimpleCAD_path.string()).append("\n").c_str());
+        Logger::WriteMessage(std::string("MyPartsSRR.step: ").append(MyPartsSRR_path.string()).append("\n").c_str());
+        Logger::WriteMessage(std::string("ModifiedMyPartsSRR.step: ").append(ModifiedMyPartsSRR_path.string()).append("\n").c_str());
     }
 
     /*
@@ -131,6 +146,29 @@ namespace Step3D_Wrapper_Tests
             wrapper->Release();
         }
 
+        TEST_METHOD(IStep3D_Wrapper_LoadTwice_ContentReplaced)
+        {
+            IStep3D_Wrapper* wrapper = CreateIStep3D_Wrapper();
+
+            Assert::IsTrue(wrapper->load(SimpleCAD_path.string()));
+            Assert::IsTrue(wrapper->parseHLRInformation());
+            Assert::IsTrue(wrapper->getNodes().size() > 0);
+
+            // The second load drops the parts and relations of the first one
+            for (int i = 0; i < 2; i++)
+            {
+                Assert::IsTrue(wrapper->load(MyParts_path.string()));
+                Assert::IsTrue(wrapper->parseHLRInformation());
+                Assert::IsFalse(wrapper->hasFailed());
+
+                Assert::AreEqual((size_t)5, wrapper->getNodes().size());
+                Assert::AreEqual((size_t)4, wrapper->getRelations().size());
+                Assert::AreEqual("'2020-09-01T18:50:05'", wrapper->getHeaderInfo().file_name.time_stamp.c_str());
+            }
+
+            wrapper->Release();
+        }
+
         TEST_METHOD(IStep3D_Wrapper_ReadContentFromUnloadedFile_shouldFail)
         {
             IStep3D_Wrapper* wrapper = CreateIStep3D_Wrapper();
@@ -231,6 +269,314 @@ namespace Step3D_Wrapper_Tests
 
             wrapper->Release();
         }
+
+        TEST_METHOD(IStep3D_Wrapper_MyPartsPlacementTable_isOK)
+        {
+            IStep3D_Wrapper* wrapper = CreateIStep3D_Wrapper();
+
+            Assert::IsTrue(wrapper->load(MyParts_path.string()));
+            Assert::IsTrue(wrapper->parseHLRInformation());
+
+            auto table = wrapper->getPlacementTable();
+            Assert::AreEqual((size_t)5, table.count);
+            Assert::AreEqual((size_t)PlacementColumn::COUNT * 5, table.values.size());
+
+            // Same rows as getNodes()
+            const int stepIds[] = { 5, 367, 380, 737, 854 };
+            for (size_t i = 0; i < table.count; i++)
+            {
+                Assert::AreEqual(stepIds[i], table.stepId[i]);
+            }
+
+            // MyParts places every part at the origin without rotation
+            for (size_t i = 0; i < table.count; i++)
+            {
+                Assert::AreEqual(0.0, table.column(PlacementColumn::LOCATION_X)[i], 1e-12);
+                Assert::AreEqual(1.0, table.column(PlacementColumn::AXIS_Z)[i], 1e-12);
+                Assert::AreEqual(1.0, table.column(PlacementColumn::REF_DIRECTION_X)[i], 1e-12);
+
+                for (int c = (int)PlacementColumn::ROTATION_XX; c <= (int)PlacementColumn::ROTATION_ZZ; c++)
+                {
+                    // XX, YY and ZZ are 4 columns apart
+                    bool isDiagonal = (c - (int)PlacementColumn::ROTATION_XX) % 4 == 0;
+                    Assert::AreEqual(isDiagonal ? 1.0 : 0.0, table.column((PlacementColumn)c)[i], 1e-12);
+                }
+            }
+
+            wrapper->Release();
+        }
+
+        TEST_METHOD(IStep3D_Wrapper_MyPartsAssemblyTree_isOK)
+        {
+            IStep3D_Wrapper* wrapper = CreateIStep3D_Wrapper();
+
+            Assert::IsTrue(wrapper->load(MyParts_path.string()));
+            Assert::IsTrue(wrapper->parseHLRInformation());
+
+            auto tree = wrapper->getAssemblyTree();
+            Assert::AreEqual((size_t)5, tree.partCount);
+            Assert::AreEqual((size_t)5, tree.nodeCount());
+            Assert::IsFalse(tree.hasCycles());
+
+            // #5 -> #367, #380 and #380 -> #737, #854
+            Assert::AreEqual((size_t)1, tree.roots.size());
+            Assert::AreEqual(5, tree.stepId[tree.roots[0]]);
+            Assert::AreEqual(2, tree.childCount(0));
+            Assert::AreEqual(2, tree.childCount(2));
+            Assert::AreEqual(380, tree.stepId[tree.children[tree.childBegin[0] + 1]]);
+
+            // Depth first, in the order of the relations
+            const int occurrences[] = { 5, 367, 380, 737, 854 };
+            const int parents[] = { -1, 0, 0, 2, 2 };
+            Assert::AreEqual((size_t)5, tree.occurrenceNode.size());
+            for (size_t i = 0; i < tree.occurrenceNode.size(); i++)
+            {
+                Assert::AreEqual(occurrences[i], tree.stepId[tree.occurrenceNode[i]]);
+                Assert::AreEqual(parents[i], tree.occurrenceParent[i]);
+            }
+
+            wrapper->Release();
+        }
+    };
+
+
+    /*
+    * @brief Unit tests for IStep3D_Diff_Wrapper included in the step3d_wrapper.dll
+    */
+    TEST_CLASS(IStep3D_Diff_Wrapper_Tests)
+    {
+    public:
+
+        TEST_METHOD(IStep3D_Diff_Wrapper_CompareNotExistingFile_Failed)
+        {
+            IStep3D_Diff_Wrapper* diff = CreateIStep3D_Diff_Wrapper();
+
+            Assert::IsFalse(diff->compare("not-file-found.step", SimpleCAD_path.string()));
+            Assert::IsTrue(diff->hasFailed());
+            Assert::AreEqual("File does not exists: not-file-found.step", diff->getErrorMessage().c_str());
+
+            diff->Release();
+        }
+
+        TEST_METHOD(IStep3D_Diff_Wrapper_CompareBadFormatFile_Failed)
+        {
+            IStep3D_Diff_Wrapper* diff = CreateIStep3D_Diff_Wrapper();
+
+            Assert::IsFalse(diff->compare(NotStep3DFile_path.string(), SimpleCAD_path.string()));
+            Assert::IsTrue(diff->getError() == WrapperErrorCode::FILE_READ);
+
+            diff->Release();
+        }
+
+        TEST_METHOD(IStep3D_Diff_Wrapper_CompareSameFile_NoChanges)
+        {
+            IStep3D_Diff_Wrapper* diff = CreateIStep3D_Diff_Wrapper();
+
+            Assert::IsTrue(diff->compare(SimpleCAD_path.string(), SimpleCAD_path.string()));
+            Assert::IsFalse(diff->hasChanges());
+
+            auto parts = diff->getPartDiffs();
+            Assert::AreEqual((size_t)5, parts.size());
+
+            for (const auto& p : parts)
+            {
+                Assert::IsTrue(p.status == DiffStatus::UNCHANGED);
+                Assert::AreEqual(p.old_stepId, p.new_stepId);
+                Assert::AreEqual(p.old_hash, p.new_hash);
+            }
+
+            Assert::AreEqual((size_t)4, diff->getRelationDiffs().size());
+
+            diff->Release();
+        }
+
+        TEST_METHOD(IStep3D_Diff_Wrapper_SingleThread_SameHashes)
+        {
+            IStep3D_Diff_Wrapper* diff = CreateIStep3D_Diff_Wrapper();
+
+            Assert::IsTrue(diff->compare(SimpleCAD_path.string(), ModifiedSimpleCAD_path.string()));
+            auto parallelParts = diff->getPartDiffs();
+
+            diff->setThreadCount(1);
+            Assert::IsTrue(diff->compare(SimpleCAD_path.string(), ModifiedSimpleCAD_path.string()));
+            auto sequentialParts = diff->getPartDiffs();
+
+            Assert::AreEqual(parallelParts.size(), sequentialParts.size());
+
+            auto itParallel = parallelParts.begin();
+            for (const auto& p : sequentialParts)
+            {
+                Assert::AreEqual(p.old_hash, itParallel->old_hash);
+                Assert::AreEqual(p.new_hash, itParallel->new_hash);
+                itParallel++;
+            }
+
+            diff->Release();
+        }
+
+        TEST_METHOD(IStep3D_Diff_Wrapper_SimpleCADModified_ChangesFound)
+        {
+            IStep3D_Diff_Wrapper* diff = CreateIStep3D_Diff_Wrapper();
+
+            Assert::IsTrue(diff->compare(SimpleCAD_path.string(), ModifiedSimpleCAD_path.string()));
+            Assert::IsFalse(diff->hasFailed());
+            Assert::IsTrue(diff->hasChanges());
+
+            // Parts are sorted by name; instance numbers differ between the files
+            auto parts = diff->getPartDiffs();
+            Assert::AreEqual((size_t)5, parts.size());
+
+            auto itPart = parts.begin();
+            Assert::AreEqual("'Box'", itPart->name.c_str());
+            Assert::IsTrue(itPart->status == DiffStatus::UNCHANGED);
+            Assert::AreEqual(367, itPart->old_stepId);
+            Assert::AreEqual(737, itPart->new_stepId);
+
+            itPart++;
+            Assert::AreEqual("'Cube'", itPart->name.c_str());
+            Assert::IsTrue(itPart->status == DiffStatus::UNCHANGED);
+            Assert::AreEqual(737, itPart->old_stepId);
+            Assert::AreEqual(388, itPart->new_stepId);
+
+            itPart++;
+            Assert::AreEqual("'Cylinder'", itPart->name.c_str());
+            Assert::IsTrue(itPart->status == DiffStatus::UNCHANGED);
+
+            itPart++;
+            Assert::AreEqual("'Part'", itPart->name.c_str());
+            Assert::IsTrue(itPart->status == DiffStatus::MODIFIED);
+            Assert::AreNotEqual(itPart->old_representation_hash, itPart->new_representation_hash);
+
+            itPart++;
+            Assert::AreEqual("'SubPart'", itPart->name.c_str());
+            Assert::IsTrue(itPart->status == DiffStatus::MODIFIED);
+
+            // Box moved from Part to SubPart, Cylinder from SubPart to Part
+            auto relations = diff->getRelationDiffs();
+            Assert::AreEqual((size_t)6, relations.size());
+
+            auto itRel = relations.begin();
+            Assert::IsTrue(itRel->status == DiffStatus::REMOVED);
+            Assert::AreEqual("'Part'", itRel->relating_name.c_str());
+            Assert::AreEqual("'Box'", itRel->related_name.c_str());
+            Assert::AreEqual(376, itRel->old_stepId);
+            Assert::AreEqual(0, itRel->new_stepId);
+
+            itRel++;
+            Assert::IsTrue(itRel->status == DiffStatus::ADDED);
+            Assert::AreEqual("'Part'", itRel->relating_name.c_str());
+            Assert::AreEqual("'Cylinder'", itRel->related_name.c_str());
+            Assert::AreEqual(0, itRel->old_stepId);
+            Assert::AreEqual(869, itRel->new_stepId);
+
+            itRel++;
+            Assert::IsTrue(itRel->status == DiffStatus::MODIFIED);
+            Assert::AreEqual("'Part'", itRel->relating_name.c_str());
+            Assert::AreEqual("'SubPart'", itRel->related_name.c_str());
+
+            itRel++;
+            Assert::IsTrue(itRel->status == DiffStatus::ADDED);
+            Assert::AreEqual("'SubPart'", itRel->relating_name.c_str());
+            Assert::AreEqual("'Box'", itRel->related_name.c_str());
+
+            itRel++;
+            Assert::IsTrue(itRel->status == DiffStatus::MODIFIED);
+            Assert::AreEqual("'SubPart'", itRel->relating_name.c_str());
+            Assert::AreEqual("'Cube'", itRel->related_name.c_str());
+
+            itRel++;
+            Assert::IsTrue(itRel->status == DiffStatus::REMOVED);
+            Assert::AreEqual("'SubPart'", itRel->relating_name.c_str());
+            Assert::AreEqual("'Cylinder'", itRel->related_name.c_str());
+
+            diff->Release();
+        }
+
+        TEST_METHOD(IStep3D_Diff_Wrapper_SRRLinkedBrepModified_PartChanged)
+        {
+            IStep3D_Diff_Wrapper* diff = CreateIStep3D_Diff_Wrapper();
+
+            // The SDR of 'Caja' points to a SHAPE_REPRESENTATION, linked to the
+            // B-rep by a SHAPE_REPRESENTATION_RELATIONSHIP; a CARTESIAN_POINT moved
+            Assert::IsTrue(diff->compare(MyPartsSRR_path.string(), ModifiedMyPartsSRR_path.string()));
+            Assert::IsFalse(diff->hasFailed());
+            Assert::IsTrue(diff->hasChanges());
+
+            auto parts = diff->getPartDiffs();
+            Assert::AreEqual((size_t)5, parts.size());
+
+            for (const auto& p : parts)
+            {
+                const bool caja = p.name == "'Caja'";
+                Assert::IsTrue(p.status == (caja ? DiffStatus::MODIFIED : DiffStatus::UNCHANGED));
+                Assert::AreEqual(caja, p.old_representation_hash != p.new_representation_hash);
+            }
+
+            for (const auto& r : diff->getRelationDiffs())
+            {
+                Assert::IsTrue(r.status == DiffStatus::UNCHANGED);
+            }
+
+            diff->Release();
+        }
+    };
+
+
+    /*
+    * @brief Unit tests for IStep3D_Probe_Wrapper included in the step3d_wrapper.dll
+    */
+    TEST_CLASS(IStep3D_Probe_Wrapper_Tests)
+    {
+    public:
+
+        TEST_METHOD(IStep3D_Probe_Wrapper_ProbeNotExistingFile_Failed)
+        {
+            IStep3D_Probe_Wrapper* probe = CreateIStep3D_Probe_Wrapper();
+
+            Assert::IsFalse(probe->probe("not-file-found.step"));
+            Assert::IsTrue(probe->getError() == WrapperErrorCode::FILE_NOT_FOUND);
+            Assert::AreEqual("File does not exists: not-file-found.step", probe->getErrorMessage().c_str());
+
+            probe->Release();
+        }
+
+        TEST_METHOD(IStep3D_Probe_Wrapper_ProbeMyParts_HeaderRead)
+        {
+            IStep3D_Probe_Wrapper* probe = CreateIStep3D_Probe_Wrapper();
+
+            Assert::IsTrue(probe->probe(MyParts_path.string()));
+
+            auto results = probe->getResults();
+            Assert::AreEqual((size_t)1, results.size());
+
+            const Step3D_ProbeInfo_Wrapper& info = results.front();
+            Assert::AreEqual((long long)fs::file_size(MyParts_path), info.file_size);
+            Assert::AreEqual(901L, info.estimated_instance_count);
+            Assert::AreEqual("('AUTOMOTIVE_DESIGN { 1 0 10303 214 1 1 1 1 }')", info.header.file_schema.c_str());
+            Assert::AreEqual("'2020-09-01T18:50:05'", info.header.file_name.time_stamp.c_str());
+            Assert::AreEqual("'FreeCAD'", info.header.file_name.originating_system.c_str());
+
+            probe->Release();
+        }
+
+        TEST_METHOD(IStep3D_Probe_Wrapper_ProbeExamples_AllListed)
+        {
+            IStep3D_Probe_Wrapper* probe = CreateIStep3D_Probe_Wrapper();
+
+            Assert::IsTrue(probe->probeDirectory(MyParts_path.parent_path().string()));
+
+            // The .FCStd file is not listed, the bad format file fails on its own
+            auto results = probe->getResults();
+            Assert::AreEqual((size_t)6, results.size());
+
+            for (const auto& info : results)
+            {
+                const bool notStep = fs::path(info.filename).filename() == NotStep3DFile_path.filename();
+                Assert::AreEqual(notStep, info.error != WrapperErrorCode::NO_ERROR);
+            }
+
+            probe->Release();
+        }
     };
 
 
@@ -267,4 +613,46 @@ namespace Step3D_Wrapper_Tests
 
 #endif // ENABLE_DOT_GRAPH_GENERATION
 
+    /*
+    * @brief Unit tests for the GraphML and JSON exports, which do not need GraphViz
+    */
+    TEST_CLASS(ITreeGraphGenerator_Wrapper_Export_Tests)
+    {
+    public:
+
+        TEST_METHOD(ITreeGraphGenerator_Wrapper_ExportMyPartsJSON_Generated)
+        {
+            IStep3D_Wrapper* wrapper = CreateIStep3D_Wrapper();
+            ITreeGraphGenerator_Wrapper* graphGenerator = CreateITreeGraphGenerator_Wrapper();
+
+            Assert::IsTrue(wrapper->load(MyParts_path.string()));
+            Assert::IsTrue(wrapper->parseHLRInformation());
+
+            graphGenerator->setFormat(TreeGraphFormat::JSON);
+            Assert::IsTrue(graphGenerator->generate(wrapper, TreeGraphStyle::All_Graphs));
+
+            fs::path jsonPath = MyParts_path.string() + ".json";
+            Assert::IsTrue(fs::exists(jsonPath));
+
+            std::ifstream json(jsonPath);
+            std::string content((std::istreambuf_iterator<char>(json)), std::istreambuf_iterator<char>());
+            json.close();
+
+            Assert::IsTrue(content.find("\"source\": 5, \"target\": 367") != std::string::npos);
+            Assert::IsTrue(content.find("\"source\": 380, \"target\": 854") != std::string::npos);
+
+            fs::remove(jsonPath);
+
+            graphGenerator->setFormat(TreeGraphFormat::GraphML);
+            Assert::IsTrue(graphGenerator->generate(wrapper, TreeGraphStyle::All_Graphs));
+
+            fs::path graphmlPath = MyParts_path.string() + ".graphml";
+            Assert::IsTrue(fs::exists(graphmlPath));
+            fs::remove(graphmlPath);
+
+            graphGenerator->Release();
+            wrapper->Release();
+        }
+    };
+
 }
@@ -0,0 +1,36 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <sc_export.h>
+#include "express.h"
+
+/** \file cache.h
+ * binary cache of a resolved model, so that exp2cxx, exppp, etc don't need to parse and resolve
+ * an unchanged schema on every run.
+ *
+ * The cache holds a copy of each object of the model, with its pointers replaced by object numbers.
+ * Objects created by EXPRESSinitialize() (Type_*, LITERAL_*, the builtin functions and procedures)
+ * are numbered in the order they are reached from those globals, which is the same in every run of
+ * the same program. They are not created again by CACHEload(), but overwritten with their state
+ * after parsing, since the parser changes some of them.
+ *
+ * A cache file is only valid for one build of the express library, since the objects are stored in
+ * their in-memory layout. The layout, the version of the format and the size and hash of each source
+ * file are checked by CACHEload(); anything that differs makes it ignore the file.
+ */
+
+/** load the resolved model of an express file from a cache written by CACHEstore()
+ * must be called after EXPRESSinitialize(), and before anything is parsed
+ * \param dir the cache directory
+ * \param filename the express file, as given to EXPRESSparse()
+ * \return the model, or 0 if there is no valid cache for this file
+ */
+extern SC_EXPRESS_EXPORT Express CACHEload(const char *dir, const char *filename);
+
+/** write a resolved model to the cache directory, which is created if needed
+ * CACHEload() must have been called before the model was parsed
+ * \return false if the model couldn't be stored; this is not an error for the caller
+ */
+extern SC_EXPRESS_EXPORT bool CACHEstore(const char *dir, const char *filename, Express model);
+
+#endif /* CACHE_H */
@@ -5,13 +5,14 @@
 * \file judyL2Array.h C++ wrapper for judyL2 array implementation
 *
 * A judyL2 array maps JudyKey's to multiple JudyValue's, similar to
-* std::multimap. Internally, this is a judyL array of std::vector< JudyValue >.
+* std::multimap. Internally, this is a judyL array of judySmallVector< JudyValue >.
 *
 *    Author: Mark Pictor. Public domain.
 *
 ********************************************************************************/
 
 #include "judy.h"
+#include "judySmallVector.h"
 #include "assert.h"
 #include <iterator>
 #include <vector>
@@ -23,7 +24,8 @@ struct judyl2KVpair {
 };
 
 /** A judyL2 array maps JudyKey's to multiple JudyValue's, similar to std::multimap.
- * Internally, this is a judyL array of std::vector< JudyValue >.
+ * Internally, this is a judyL array of judySmallVector< JudyValue >, allocated from a pool
+ * owned by the array. One or two values per key are stored without any allocation.
  * The first template parameter must be the same size as a void*
  *  \param JudyKey the type of the key, i.e. uint64_t, etc
  *  \param JudyValue the type of the value, i.e. int, pointer-to-object, etc. With judyL2Array, the size of this value can vary.
@@ -32,7 +34,7 @@ template< typename JudyKey, typename JudyValue >
 class judyL2Array
 {
     public:
-        typedef std::vector< JudyValue > vector;
+        typedef judySmallVector< JudyValue > vector;
         typedef const vector cvector;
         typedef judyl2KVpair< JudyKey, vector * > pair;
         typedef judyl2KVpair< JudyKey, cvector * > cpair;
@@ -42,9 +44,26 @@ class judyL2Array
         vector **_lastSlot;
         JudyKey _buff[1];
         bool _success;
+        bool _ownsValues; ///< false for a clone, whose values belong to the original array
         cpair kv;
+        judySmallVectorPool< vector > _values;
+
+        /// returns the vector for key, creating an empty one if needed
+        vector *cell(JudyKey key)
+        {
+            _lastSlot = (vector **) judy_cell(_judyarray, (const unsigned char *) &key, _depth * JUDY_key_size);
+            if(_lastSlot) {
+                if(!(* _lastSlot)) {
+                    * _lastSlot = _values.get();
+                }
+                _success = true;
+                return * _lastSlot;
+            }
+            _success = false;
+            return 0;
+        }
     public:
-        judyL2Array(): _maxLevels(sizeof(JudyKey)), _depth(1), _lastSlot(0), _success(true)
+        judyL2Array(): _maxLevels(sizeof(JudyKey)), _depth(1), _lastSlot(0), _success(true), _ownsValues(true)
         {
             assert(sizeof(JudyKey) == JUDY_key_size && "JudyKey *must* be the same size as a pointer!");
             _judyarray = judy_open(_maxLevels, _depth);
@@ -52,7 +71,7 @@ class judyL2Array
         }
 
         explicit judyL2Array(const judyL2Array< JudyKey, JudyValue > &other): _maxLevels(other._maxLevels),
-            _depth(other._depth), _success(other._success)
+            _depth(other._depth), _success(other._success), _ownsValues(false)
         {
             _judyarray = judy_clone(other._judyarray);
             _buff[0] = other._buff[0];
@@ -66,15 +85,23 @@ class judyL2Array
             judy_close(_judyarray);
         }
 
-        /// delete all vectors and empty the array
+        /// delete all vectors and empty the array. Does nothing for a clone.
         void clear()
         {
+            if(!_ownsValues) {
+                return;
+            }
             JudyKey key = 0;
             while(0 != (_lastSlot = (vector **) judy_strt(_judyarray, (const unsigned char *) &key, 0))) {
-                //( * _lastSlot )->~vector(); //TODO: placement new
-                delete(* _lastSlot);
                 judy_del(_judyarray);
             }
+            _values.clear();
+        }
+
+        /// bytes used by the values, not counting the judy nodes
+        size_t valueMemoryUsage() const
+        {
+            return _values.memoryUsage();
         }
 
         vector *getLastValue()
@@ -94,62 +121,61 @@ class judyL2Array
             return _success;
         }
 
-        /** TODO
-         * test for std::vector::shrink_to_fit (C++11), use it once the array is as full as it will be
-         * void freeUnused() {...}
-         */
-
-        //TODO
-        // allocate data memory within judy array for external use.
-        // void *judy_data (Judy *judy, unsigned int amt);
-
         /// insert value into the vector for key.
         bool insert(JudyKey key, JudyValue value)
         {
-            _lastSlot = (vector **) judy_cell(_judyarray, (const unsigned char *) &key, _depth * JUDY_key_size);
-            if(_lastSlot) {
-                if(!(* _lastSlot)) {
-                    * _lastSlot = new vector;
-                    /* TODO store vectors inside judy with placement new
-                    * vector * n = judy_data( _judyarray, sizeof( std::vector < JudyValue > ) );
-                    * new(n) vector;
-                    * *_lastSlot = n;
-                    * NOTE - memory alloc'd via judy_data will not be freed until the array is freed (judy_close)
-                    * also use placement new in the other insert function, below
-                    */
-                }
-                (* _lastSlot)->push_back(value);
-                _success = true;
-            } else {
-                _success = false;
+            vector *v = cell(key);
+            if(v) {
+                v->push_back(value);
             }
             return _success;
         }
 
         /** for a given key, append to or overwrite the vector
-         * this never simply re-uses the pointer to the given vector because
-         * that would mean that two keys could have the same value (pointer).
+         * the values are copied, so the caller keeps ownership of the given vector.
          */
-        bool insert(JudyKey key, const vector &values, bool overwrite = false)
+        bool insert(JudyKey key, const std::vector< JudyValue > &values, bool overwrite = false)
         {
-            _lastSlot = (vector **) judy_cell(_judyarray, (const unsigned char *) &key, _depth * JUDY_key_size);
-            if(_lastSlot) {
-                if(!(* _lastSlot)) {
-                    * _lastSlot = new vector;
-                    /* TODO store vectors inside judy with placement new
-                     * (see other insert(), above)
-                     */
-                } else if(overwrite) {
-                    (* _lastSlot)->clear();
+            vector *v = cell(key);
+            if(v) {
+                if(overwrite) {
+                    v->clear();
+                }
+                v->reserve(v->size() + values.size());
+                typename std::vector< JudyValue >::const_iterator it = values.begin();
+                for(; it != values.end(); ++it) {
+                    v->push_back(*it);
                 }
-                std::copy(values.begin(), values.end(), std::back_inserter< vector >((** _lastSlot)));
-                _success = true;
-            } else {
-                _success = false;
             }
             return _success;
         }
 
+        /** bulk insert of key-value pairs sorted by key, i.e. the content of a sorted std::multimap
+         * or a sorted std::vector< std::pair< JudyKey, JudyValue > >. The values of each key are
+         * counted first, so a key that spills gets one heap buffer of the exact size.
+         * \returns false if a judy cell could not be allocated
+         */
+        template< typename Iter >
+        bool insertSorted(Iter first, Iter last)
+        {
+            while(first != last) {
+                Iter run = first;
+                unsigned int n = 0;
+                for(; run != last && run->first == first->first; ++run) {
+                    n++;
+                }
+                vector *v = cell(first->first);
+                if(!v) {
+                    return false;
+                }
+                v->reserve(v->size() + n);
+                for(; first != run; ++first) {
+                    v->push_back(first->second);
+                }
+            }
+            return true;
+        }
+
         /// retrieve the cell pointer greater than or equal to given key
         /// NOTE what about an atOrBefore function?
         const cpair atOrAfter(JudyKey key)
@@ -222,8 +248,9 @@ class judyL2Array
         bool removeEntry(JudyKey key)
         {
             if(0 != (_lastSlot = (vector **) judy_slot(_judyarray, (const unsigned char *) &key, _depth * JUDY_key_size))) {
-                // _lastSlot->~vector(); //for use with placement new
-                delete _lastSlot;
+                if(_ownsValues && * _lastSlot) {
+                    _values.release(* _lastSlot);
+                }
                 _lastSlot = (vector **) judy_del(_judyarray);
                 return true;
             } else {
@@ -175,9 +175,9 @@ class judyLArray
          * getLastValue() will return the entry before the one that was deleted
          * \sa isEmpty()
          */
-        bool removeEntry(JudyKey *key)
+        bool removeEntry(JudyKey key)
         {
-            if(judy_slot(_judyarray, key, _depth * JUDY_key_size)) {
+            if(judy_slot(_judyarray, (const unsigned char *) &key, _depth * JUDY_key_size)) {
                 _lastSlot = (JudyValue *) judy_del(_judyarray);
                 return true;
             } else {
@@ -5,16 +5,18 @@
 * \file judyS2Array.h C++ wrapper for judy array implementation
 *
 *  A judyS2 array maps strings to multiple JudyValue's, similar to
-* std::multimap. Internally, this is a judyL array of std::vector< JudyValue >.
+* std::multimap. Internally, this is a judyS array of judySmallVector< JudyValue >.
 *
 *    Author: Mark Pictor. Public domain.
 *
 ********************************************************************************/
 
 #include "judy.h"
+#include "judySmallVector.h"
 #include "assert.h"
 #include <string.h>
 #include <iterator>
+#include <string>
 #include <vector>
 
 template< typename JudyValue >
@@ -24,14 +26,15 @@ struct judys2KVpair {
 };
 
 /** A judyS2 array maps a set of strings to multiple JudyValue's, similar to std::multimap.
- * Internally, this is a judyS array of std::vector< JudyValue >.
+ * Internally, this is a judyS array of judySmallVector< JudyValue >, allocated from a pool
+ * owned by the array. One or two values per key are stored without any allocation.
  *  \param JudyValue the type of the value, i.e. int, pointer-to-object, etc.
  */
 template< typename JudyValue >
 class judyS2Array
 {
     public:
-        typedef std::vector< JudyValue > vector;
+        typedef judySmallVector< JudyValue > vector;
         typedef const vector cvector;
         typedef judys2KVpair< vector * > pair;
         typedef judys2KVpair< cvector * > cpair;
@@ -41,16 +44,49 @@ class judyS2Array
         vector **_lastSlot;
         unsigned char *_buff;
         bool _success;
+        bool _ownsValues; ///< false for a clone, whose values belong to the original array
         cpair kv;
+        judySmallVectorPool< vector > _values;
+
+        /// returns the vector for key, creating an empty one if needed
+        vector *cell(const char *key, unsigned int keyLen)
+        {
+            if(keyLen == 0) {
+                keyLen = strlen(key);
+            } else {
+                assert(keyLen == strlen(key));
+            }
+            assert(keyLen <= _maxKeyLen);
+            _lastSlot = (vector **) judy_cell(_judyarray, (const unsigned char *)key, keyLen);
+            if(_lastSlot) {
+                if(!(* _lastSlot)) {
+                    * _lastSlot = _values.get();
+                }
+                _success = true;
+                return * _lastSlot;
+            }
+            _success = false;
+            return 0;
+        }
+
+        static const char *keyString(const char *key)
+        {
+            return key;
+        }
+        static const char *keyString(const std::string &key)
+        {
+            return key.c_str();
+        }
     public:
-        judyS2Array(unsigned int maxKeyLen): _maxKeyLen(maxKeyLen), _lastSlot(0), _success(true)
+        judyS2Array(unsigned int maxKeyLen): _maxKeyLen(maxKeyLen), _lastSlot(0), _success(true), _ownsValues(true)
         {
             _judyarray = judy_open(_maxKeyLen, 0);
             _buff = new unsigned char[_maxKeyLen];
             assert(sizeof(JudyValue) == sizeof(this) && "JudyValue *must* be the same size as a pointer!");
         }
 
-        explicit judyS2Array(const judyS2Array< JudyValue > &other): _maxKeyLen(other._maxKeyLen), _success(other._success)
+        explicit judyS2Array(const judyS2Array< JudyValue > &other): _maxKeyLen(other._maxKeyLen), _success(other._success),
+            _ownsValues(false)
         {
             _judyarray = judy_clone(other._judyarray);
             _buff = new unsigned char[_maxKeyLen];
@@ -67,15 +103,23 @@ class judyS2Array
             delete[] _buff;
         }
 
-        /// delete all vectors and empty the array
+        /// delete all vectors and empty the array. Does nothing for a clone.
         void clear()
         {
+            if(!_ownsValues) {
+                return;
+            }
             _buff[0] = '\0';
             while(0 != (_lastSlot = (vector **) judy_strt(_judyarray, (const unsigned char *) _buff, 0))) {
-                //( * _lastSlot )->~vector(); //TODO: placement new
-                delete(* _lastSlot);
                 judy_del(_judyarray);
             }
+            _values.clear();
+        }
+
+        /// bytes used by the values, not counting the judy nodes
+        size_t valueMemoryUsage() const
+        {
+            return _values.memoryUsage();
         }
 
         vector *getLastValue()
@@ -95,74 +139,62 @@ class judyS2Array
             return _success;
         }
 
-        /** TODO
-         * test for std::vector::shrink_to_fit (C++11), use it once the array is as full as it will be
-         * void freeUnused() {...}
-         */
-
-        //TODO
-        // allocate data memory within judy array for external use.
-        // void *judy_data (Judy *judy, unsigned int amt);
-
         /// insert value into the vector for key.
         bool insert(const char *key, JudyValue value, unsigned int keyLen = 0)
         {
-            if(keyLen == 0) {
-                keyLen = strlen(key);
-            } else {
-                assert(keyLen == strlen(key));
-            }
-            assert(keyLen <= _maxKeyLen);
-            _lastSlot = (vector **) judy_cell(_judyarray, (const unsigned char *)key, keyLen);
-            if(_lastSlot) {
-                if(!(* _lastSlot)) {
-                    * _lastSlot = new vector;
-                    /* TODO store vectors inside judy with placement new
-                    * vector * n = judy_data( _judyarray, sizeof( std::vector < JudyValue > ) );
-                    * new(n) vector;
-                    * *_lastSlot = n;
-                    * NOTE - memory alloc'd via judy_data will not be freed until the array is freed (judy_close)
-                    * also use placement new in the other insert function, below
-                    */
-                }
-                (* _lastSlot)->push_back(value);
-                _success = true;
-            } else {
-                _success = false;
+            vector *v = cell(key, keyLen);
+            if(v) {
+                v->push_back(value);
             }
             return _success;
         }
 
         /** for a given key, append to or overwrite the vector
-         * this never simply re-uses the pointer to the given vector because
-         * that would mean that two keys could have the same value (pointer).
+         * the values are copied, so the caller keeps ownership of the given vector.
          */
-        bool insert(const char *key, const vector &values, unsigned int keyLen = 0, bool overwrite = false)
+        bool insert(const char *key, const std::vector< JudyValue > &values, unsigned int keyLen = 0, bool overwrite = false)
         {
-            if(keyLen == 0) {
-                keyLen = strlen(key);
-            } else {
-                assert(keyLen == strlen(key));
-            }
-            assert(keyLen <= _maxKeyLen);
-            _lastSlot = (vector **) judy_cell(_judyarray, (const unsigned char *)key, keyLen);
-            if(_lastSlot) {
-                if(!(* _lastSlot)) {
-                    * _lastSlot = new vector;
-                    /* TODO store vectors inside judy with placement new
-                     * (see other insert(), above)
-                     */
-                } else if(overwrite) {
-                    (* _lastSlot)->clear();
+            vector *v = cell(key, keyLen);
+            if(v) {
+                if(overwrite) {
+                    v->clear();
+                }
+                v->reserve(v->size() + values.size());
+                typename std::vector< JudyValue >::const_iterator it = values.begin();
+                for(; it != values.end(); ++it) {
+                    v->push_back(*it);
                 }
-                std::copy(values.begin(), values.end(), std::back_inserter< vector >((** _lastSlot)));
-                _success = true;
-            } else {
-                _success = false;
             }
             return _success;
         }
 
+        /** bulk insert of key-value pairs sorted by key, i.e. the content of a sorted std::multimap
+         * or a sorted std::vector< std::pair< std::string, JudyValue > >. The values of each key are
+         * counted first, so a key that spills gets one heap buffer of the exact size.
+         * \returns false if a judy cell could not be allocated
+         */
+        template< typename Iter >
+        bool insertSorted(Iter first, Iter last)
+        {
+            while(first != last) {
+                const char *key = keyString(first->first);
+                Iter run = first;
+                unsigned int n = 0;
+                for(; run != last && !strcmp(keyString(run->first), key); ++run) {
+                    n++;
+                }
+                vector *v = cell(key, 0);
+                if(!v) {
+                    return false;
+                }
+                v->reserve(v->size() + n);
+                for(; first != run; ++first) {
+                    v->push_back(first->second);
+                }
+            }
+            return true;
+        }
+
         /// retrieve the cell pointer greater than or equal to given key
         /// NOTE what about an atOrBefore function?
         const cpair atOrAfter(const char *key, unsigned int keyLen = 0)
@@ -246,9 +278,10 @@ class judyS2Array
          */
         bool removeEntry(const char *key)
         {
-            if(0 != (judy_slot(_judyarray, (const unsigned char *)key, strlen(key)))) {
-                // _lastSlot->~vector(); //for use with placement new
-                delete _lastSlot;
+            if(0 != (_lastSlot = (vector **) judy_slot(_judyarray, (const unsigned char *)key, strlen(key)))) {
+                if(_ownsValues && * _lastSlot) {
+                    _values.release(* _lastSlot);
+                }
                 _lastSlot = (vector **) judy_del(_judyarray);
                 return true;
             } else {
@@ -0,0 +1,229 @@
+#ifndef JUDYSMALLVECTOR_H
+#define JUDYSMALLVECTOR_H
+
+/****************************************************************************//**
+* \file judySmallVector.h value storage for judyL2Array and judyS2Array
+*
+* Most keys of a judy2 array hold one or two values. judySmallVector keeps up to
+* N values inline and only allocates a heap buffer when a key gets more than that.
+* judySmallVectorPool hands out the vectors from large blocks, so a key costs
+* sizeof( judySmallVector ) bytes and no allocation of its own.
+*
+*    Public domain.
+*
+********************************************************************************/
+
+#include "assert.h"
+#include <stdexcept>
+#include <vector>
+
+/** A vector that stores up to N values inline, spilling to a heap buffer beyond that.
+ * Provides the subset of the std::vector interface used with judy2 arrays.
+ *  \param JudyValue the type of the values; must be a plain type (integer, pointer, ...) as it is kept in a union
+ *  \param N the number of values stored without allocating
+ */
+template< typename JudyValue, unsigned int N = 2 >
+class judySmallVector
+{
+    public:
+        typedef JudyValue value_type;
+        typedef unsigned int size_type;
+        typedef JudyValue *iterator;
+        typedef const JudyValue *const_iterator;
+    protected:
+        size_type _size, _capacity;
+        union {
+            JudyValue *_heap;
+            JudyValue _inline[ N ];
+        };
+        JudyValue *data()
+        {
+            return (_capacity > N) ? _heap : _inline;
+        }
+        const JudyValue *data() const
+        {
+            return (_capacity > N) ? _heap : _inline;
+        }
+    private:
+        // the pool owns the vectors, and keys never share them
+        judySmallVector(const judySmallVector &);
+        judySmallVector &operator=(const judySmallVector &);
+    public:
+        judySmallVector(): _size(0), _capacity(N)
+        {
+        }
+        ~judySmallVector()
+        {
+            if(_capacity > N) {
+                delete[] _heap;
+            }
+        }
+
+        size_type size() const
+        {
+            return _size;
+        }
+        size_type capacity() const
+        {
+            return _capacity;
+        }
+        bool empty() const
+        {
+            return _size == 0;
+        }
+        /// true if the values are stored in a heap buffer
+        bool spilled() const
+        {
+            return _capacity > N;
+        }
+
+        const_iterator begin() const
+        {
+            return data();
+        }
+        const_iterator end() const
+        {
+            return data() + _size;
+        }
+        iterator begin()
+        {
+            return data();
+        }
+        iterator end()
+        {
+            return data() + _size;
+        }
+
+        const JudyValue &operator[](size_type i) const
+        {
+            assert(i < _size);
+            return data()[i];
+        }
+        const JudyValue &at(size_type i) const
+        {
+            if(i >= _size) {
+                throw std::out_of_range("judySmallVector::at");
+            }
+            return data()[i];
+        }
+        const JudyValue &front() const
+        {
+            return at(0);
+        }
+        const JudyValue &back() const
+        {
+            return at(_size - 1);
+        }
+
+        /// make room for n values without further allocation
+        void reserve(size_type n)
+        {
+            if(n <= _capacity) {
+                return;
+            }
+            JudyValue *buf = new JudyValue[n];
+            const JudyValue *old = data();
+            for(size_type i = 0; i < _size; i++) {
+                buf[i] = old[i];
+            }
+            if(_capacity > N) {
+                delete[] _heap;
+            }
+            _heap = buf;
+            _capacity = n;
+        }
+
+        void push_back(const JudyValue &value)
+        {
+            if(_size == _capacity) {
+                reserve(2 * _capacity);
+            }
+            data()[_size++] = value;
+        }
+
+        /// remove all values and free the heap buffer, if any
+        void clear()
+        {
+            if(_capacity > N) {
+                delete[] _heap;
+                _capacity = N;
+            }
+            _size = 0;
+        }
+};
+
+/** Allocates judySmallVector's in blocks. Vectors stay at the same address until the pool is cleared.
+ * Released vectors are kept on a free list and handed out again.
+ */
+template< typename vector >
+class judySmallVectorPool
+{
+    protected:
+        enum { BlockSize = 1024 };
+        std::vector< vector * > _blocks;
+        std::vector< vector * > _free;
+        unsigned int _used; ///< vectors handed out from the last block
+    private:
+        judySmallVectorPool(const judySmallVectorPool &);
+        judySmallVectorPool &operator=(const judySmallVectorPool &);
+    public:
+        judySmallVectorPool(): _used(BlockSize)
+        {
+        }
+        ~judySmallVectorPool()
+        {
+            clear();
+        }
+
+        /// returns an empty vector
+        vector *get()
+        {
+            if(!_free.empty()) {
+                vector *v = _free.back();
+                _free.pop_back();
+                return v;
+            }
+            if(_used == BlockSize) {
+                _blocks.push_back(new vector[ BlockSize ]);
+                _used = 0;
+            }
+            return &(_blocks.back()[ _used++ ]);
+        }
+
+        /// empty v and make it available to get()
+        void release(vector *v)
+        {
+            v->clear();
+            _free.push_back(v);
+        }
+
+        /// free every vector handed out by this pool
+        void clear()
+        {
+            typename std::vector< vector * >::iterator it = _blocks.begin();
+            for(; it != _blocks.end(); ++it) {
+                delete[] *it;
+            }
+            _blocks.clear();
+            _free.clear();
+            _used = BlockSize;
+        }
+
+        /// bytes held by the pool, including heap buffers of spilled vectors
+        size_t memoryUsage() const
+        {
+            size_t bytes = _blocks.size() * BlockSize * sizeof(vector);
+            typename std::vector< vector * >::const_iterator it = _blocks.begin();
+            for(; it != _blocks.end(); ++it) {
+                unsigned int n = (*it == _blocks.back()) ? _used : (unsigned int) BlockSize;
+                for(unsigned int i = 0; i < n; i++) {
+                    if((*it)[i].spilled()) {
+                        bytes += (*it)[i].capacity() * sizeof(typename vector::value_type);
+                    }
+                }
+            }
+            return bytes;
+        }
+};
+
+#endif //JUDYSMALLVECTOR_H
@@ -3,6 +3,7 @@
 #include <stdlib.h>
 
 #include "judyL2Array.h"
+#include <map>
 typedef judyL2Array< uint64_t, uint64_t > jl2a;
 
 bool testFind(jl2a &j, uint64_t key, unsigned int count)
@@ -61,6 +62,31 @@ int main()
     pass &= testFind(jl, 11, 1);
     pass &= testFind(jl, 7,  2);
 
+    // more values than fit inline
+    for(uint64_t i = 0; i < 10; i++) {
+        jl.insert(20, i);
+    }
+    pass &= testFind(jl, 20, 10);
+    if(jl.find(20)->at(9) != 9) {
+        std::cout << "spilled values not preserved" << std::endl;
+        pass = false;
+    }
+
+    jl.removeEntry(11);
+    pass &= testFind(jl, 11, 0);
+
+    jl.clear();
+
+    std::multimap< uint64_t, uint64_t > sorted;
+    sorted.insert(std::make_pair(3, 30));
+    sorted.insert(std::make_pair(3, 31));
+    sorted.insert(std::make_pair(3, 32));
+    sorted.insert(std::make_pair(9, 90));
+    std::cout << "insertSorted test ..." << std::endl;
+    pass &= jl.insertSorted(sorted.begin(), sorted.end());
+    pass &= testFind(jl, 3, 3);
+    pass &= testFind(jl, 9, 1);
+
     jl.clear();
 
     //TODO test all of judyL2Array
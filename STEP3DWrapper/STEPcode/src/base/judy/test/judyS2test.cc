@@ -3,6 +3,8 @@
 #include <stdlib.h>
 
 #include "judyS2Array.h"
+#include <map>
+#include <string>
 
 typedef judyS2Array< uint64_t > js2a;
 
@@ -64,6 +66,23 @@ int main()
     pass &= testFind(js, "bah",  1);
     pass &= testFind(js, "blh",  2);
 
+    // more values than fit inline
+    for(uint64_t i = 0; i < 10; i++) {
+        js.insert("many", i);
+    }
+    pass &= testFind(js, "many", 10);
+
+    js.clear();
+
+    std::multimap< std::string, uint64_t > sorted;
+    sorted.insert(std::make_pair(std::string("ab"), 1));
+    sorted.insert(std::make_pair(std::string("ab"), 2));
+    sorted.insert(std::make_pair(std::string("abc"), 3));
+    std::cout << "insertSorted test ..." << std::endl;
+    pass &= js.insertSorted(sorted.begin(), sorted.end());
+    pass &= testFind(js, "ab", 2);
+    pass &= testFind(js, "abc", 1);
+
     js.clear();
 
     //TODO test all of judyS2Array
@@ -12,6 +12,10 @@
 #include <unistd.h>
 #endif
 
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
 #include <assert.h>
 #include <stdio.h>
 #include <iostream>
@@ -70,8 +74,9 @@ benchVals getMemAndTime()
         assert(sizeof(FILETIME) == sizeof(ULARGE_INTEGER));
         memcpy(&kTime, &KernelTime, sizeof(FILETIME));
         memcpy(&uTime, &UserTime, sizeof(FILETIME));
-        vals.userMilliseconds = (long)(uTime.QuadPart / 100000L);
-        vals.sysMilliseconds = (long)(kTime.QuadPart / 100000L);
+        // FILETIME is in 100 ns units
+        vals.userMilliseconds = (long)(uTime.QuadPart / 10000L);
+        vals.sysMilliseconds = (long)(kTime.QuadPart / 10000L);
     } else {
         vals.userMilliseconds = 0;
         vals.sysMilliseconds = 0;
@@ -82,6 +87,27 @@ benchVals getMemAndTime()
     return vals;
 }
 
+long long getHeapInUse()
+{
+#ifdef __GLIBC__
+#if __GLIBC_PREREQ(2, 33)
+    struct mallinfo2 mi = mallinfo2();
+    return (long long)(mi.uordblks + mi.hblkhd);
+#else
+    struct mallinfo mi = mallinfo();
+    return (long long)(unsigned int) mi.uordblks + (unsigned int) mi.hblkhd;
+#endif // __GLIBC_PREREQ
+#elif defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS_EX MemoryCntrs;
+    if(GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS *) &MemoryCntrs, sizeof(MemoryCntrs))) {
+        return (long long) MemoryCntrs.PrivateUsage;
+    }
+    return -1;
+#else
+    return -1;
+#endif
+}
+
 // ---------------------   benchmark class   ---------------------
 
 benchmark::benchmark(bool debugMessages): debug(debugMessages), stopped(false)
@@ -23,6 +23,14 @@ typedef struct {
  */
 SC_BASE_EXPORT benchVals getMemAndTime();
 
+/** return the number of bytes of heap memory currently allocated by this process,
+ * or -1 if not available.
+ *
+ * on Windows this is the private commit charge, which also counts memory
+ * that is not from the heap.
+ */
+SC_BASE_EXPORT long long getHeapInUse();
+
 #ifdef __cplusplus
 }
 
@@ -135,13 +135,8 @@ int SDAI_LOGICAL::set_value(const char *n)
         return asInt();
     }
 
-    int i = 0;
-    std::string tmp;
-    while((i < (no_elements() + 1))  &&
-            (strcmp((char *)StrToUpper(n, tmp),  element_at(i)) != 0)) {
-        ++i;
-    }
-    if((no_elements() + 1) == i) {     //  exhausted all the possible values
+    int i = element_index(n, strlen(n));
+    if(i < 0) {     //  exhausted all the possible values
         nullify();
         return v;
     }
@@ -149,123 +144,13 @@ int SDAI_LOGICAL::set_value(const char *n)
     return v;
 }
 
-Severity SDAI_LOGICAL::ReadEnum(istream &in, ErrorDescriptor *err, int AssignVal,
-                                int needDelims)
+int SDAI_LOGICAL::element_index(const char *token, size_t len) const
 {
-    if(AssignVal) {
-        set_null();
-    }
-
-    std::string str;
-    char messageBuf[512];
-    messageBuf[0] = '\0';
-
-    in >> ws; // skip white space
-
-    if(in.good()) {
-        char c;
-        in.get(c);
-        if(c == '.' || isalpha(c)) {
-            int validDelimiters = 1;
-            if(c == '.') {
-                in.get(c);   // push past the delimiter
-                // since found a valid delimiter it is now invalid until the
-                //   matching ending delim is found
-                validDelimiters = 0;
-            }
-
-            // look for UPPER
-            if(in.good() && (isalpha(c) || c == '_')) {
-                str += c;
-                in.get(c);
-            }
-
-            // look for UPPER or DIGIT
-            while(in.good() && (isalnum(c) || c == '_')) {
-                str += c;
-                in.get(c);
-            }
-            // if character is not the delimiter unread it
-            if(in.good() && (c != '.')) {
-                in.putback(c);
-            }
-
-            // a value was read
-            if(str.length() > 0) {
-                int i = 0;
-                const char *strval = str.c_str();
-                std::string tmp;
-                while((i < (no_elements() + 1))  &&
-                        (strcmp((char *)StrToUpper(strval, tmp),
-                                element_at(i)) != 0)) {
-                    ++i;
-                }
-                if((no_elements() + 1) == i) {
-                    //  exhausted all the possible values
-                    err->GreaterSeverity(SEVERITY_WARNING);
-                    err->AppendToDetailMsg("Invalid Enumeration value.\n");
-                    err->AppendToUserMsg("Invalid Enumeration value.\n");
-                } else {
-                    if(AssignVal) {
-                        v = i;
-                    }
-                }
-
-                // now also check the delimiter situation
-                if(c == '.') {   // if found ending delimiter
-                    // if expecting delim (i.e. validDelimiter == 0)
-                    if(!validDelimiters) {
-                        validDelimiters = 1; // everything is fine
-                    } else { // found ending delimiter but no initial delimiter
-                        validDelimiters = 0;
-                    }
-                }
-                // didn't find any delimiters at all and need them.
-                else if(needDelims) {
-                    validDelimiters = 0;
-                }
-
-                if(!validDelimiters) {
-                    err->GreaterSeverity(SEVERITY_WARNING);
-                    if(needDelims)
-                        sprintf(messageBuf,
-                                "Enumerated value has invalid period delimiters.\n");
-                    else
-                        sprintf(messageBuf,
-                                "Mismatched period delimiters for enumeration.\n");
-                    err->AppendToDetailMsg(messageBuf);
-                    err->AppendToUserMsg(messageBuf);
-                }
-                return err->severity();
-            }
-            // found valid or invalid delimiters with no associated value
-            else if((c == '.') || !validDelimiters) {
-                err->GreaterSeverity(SEVERITY_WARNING);
-                err->AppendToDetailMsg(
-                    "Enumerated has valid or invalid period delimiters with no value.\n"
-                );
-                err->AppendToUserMsg(
-                    "Enumerated has valid or invalid period delimiters with no value.\n"
-                );
-                return err->severity();
-            } else { // no delims and no value
-                err->GreaterSeverity(SEVERITY_INCOMPLETE);
-            }
-
-        } else if((c == ',') || (c == ')')) {
-            in.putback(c);
-            err->GreaterSeverity(SEVERITY_INCOMPLETE);
-        } else {
-            in.putback(c);
-            err->GreaterSeverity(SEVERITY_WARNING);
-            sprintf(messageBuf, "Invalid enumeration value.\n");
-            err->AppendToDetailMsg(messageBuf);
-            err->AppendToUserMsg(messageBuf);
-        }
-    } else { // hit eof (assuming there was no error state for istream passed in)
-        err->GreaterSeverity(SEVERITY_INCOMPLETE);
+    // LUnknown is the only element after no_elements()
+    if(len == 1 && ToUpper(token[0]) == 'U') {
+        return LUnknown;
     }
-    return err->severity();
+    return SDAI_Enum::element_index(token, len);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -433,6 +318,25 @@ void SDAI_Enum::DebugDisplay(ostream &out) const
     out << "\n";
 }
 
+/**
+ * index of the element spelled token, or -1
+ * compares token with each element_at(), the element strings are upper case
+ */
+int SDAI_Enum::element_index(const char *token, size_t len) const
+{
+    for(int i = 0; i < no_elements(); i++) {
+        const char *e = element_at(i);
+        size_t k = 0;
+        while(k < len && e[k] == ToUpper(token[k])) {
+            ++k;
+        }
+        if(k == len && e[len] == '\0') {
+            return i;
+        }
+    }
+    return -1;
+}
+
 /**
 ** Read an Enumeration value
 ** ENUMERATION = "." UPPER { UPPER | DIGIT } "."
@@ -491,15 +395,8 @@ Severity SDAI_Enum::ReadEnum(istream &in, ErrorDescriptor *err, int AssignVal,
 
             // a value was read
             if(str.length() > 0) {
-                int i = 0;
-                const char *strval = str.c_str();
-                std::string tmp;
-                while((i < no_elements())  &&
-                        (strcmp((char *)StrToUpper(strval, tmp),
-                                element_at(i)) != 0)) {
-                    ++i;
-                }
-                if(no_elements() == i) {
+                int i = element_index(str.c_str(), str.size());
+                if(i < 0) {
                     //  exhausted all the possible values
                     err->GreaterSeverity(SEVERITY_WARNING);
                     err->AppendToDetailMsg("Invalid Enumeration value.\n");
@@ -612,9 +509,10 @@ void SDAI_Enum::STEPwrite(ostream &out)  const
 {
     if(is_null()) {
         out << '$';
+    } else if(const char *literal = element_literal(v)) {
+        out << literal;
     } else {
-        std::string tmp;
-        out << "." <<  asStr(tmp) << ".";
+        out << "." <<  element_at(v) << ".";
     }
 }
 
@@ -622,10 +520,11 @@ const char *SDAI_Enum::STEPwrite(std::string &s) const
 {
     if(is_null()) {
         s.clear();
+    } else if(const char *literal = element_literal(v)) {
+        s = literal;
     } else {
-        std::string tmp;
         s = ".";
-        s.append(asStr(tmp));
+        s.append(element_at(v));
         s.append(".");
     }
     return const_cast<char *>(s.c_str());
@@ -696,13 +595,8 @@ int SDAI_Enum::set_value(const char *n)
         return asInt();
     }
 
-    int i = 0;
-    std::string tmp;
-    while((i < no_elements())  &&
-            (strcmp((char *)StrToUpper(n, tmp),  element_at(i)) != 0)) {
-        ++i;
-    }
-    if(no_elements() == i)  {     //  exhausted all the possible values
+    int i = element_index(n, strlen(n));
+    if(i < 0)  {     //  exhausted all the possible values
         return v = no_elements() + 1; // defined as UNSET
     }
     v = i;
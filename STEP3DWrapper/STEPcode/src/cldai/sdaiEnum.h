@@ -42,6 +42,17 @@ class SC_DAI_EXPORT SDAI_Enum
         }
         virtual const char *element_at(int n) const = 0;
 
+        /// index of the element spelled token, compared without case, or -1
+        /// the default compares token with each element_at(); exp2cxx overrides it with a DecodingTable
+        virtual int element_index(const char *token, size_t len) const;
+
+        /// element n between periods, as written in a STEP file, or 0 if the class has no such strings
+        virtual const char *element_literal(int n) const
+        {
+            (void) n;
+            return 0;
+        }
+
         Severity EnumValidLevel(const char *value, ErrorDescriptor *err,
                                 int optional, char *tokenList,
                                 int needDelims = 0, int clearError = 1);
@@ -120,11 +131,12 @@ class SC_DAI_EXPORT SDAI_LOGICAL :
         int exists() const; // return 0 if unset otherwise return 1
         void nullify(); // change the receiver to an unset status
 
+        /// also finds "U", i.e. LUnknown, which is past no_elements()
+        virtual int element_index(const char *token, size_t len) const;
+
     protected:
         virtual int set_value(const int n);
         virtual int set_value(const char *n);
-        virtual Severity ReadEnum(istream &in, ErrorDescriptor *err,
-                                  int AssignVal = 1, int needDelims = 1);
 
 };
 
@@ -13,6 +13,47 @@
 #include <sstream>
 #include "sc_memmgr.h"
 
+/// true if s is stored in the small string buffer of std::string, i.e. copying it does not allocate
+static bool FitsInline(const std::string &s)
+{
+    static const size_t localCapacity = std::string().capacity();
+    return s.size() <= localCapacity;
+}
+
+SDAI_String_Pool::SDAI_String_Pool()
+    : _internCount(0), _requestedBytes(0), _storedBytes(0)
+{
+}
+
+SDAI_String_Pool::~SDAI_String_Pool()
+{
+}
+
+SDAI_String_Pool::Handle SDAI_String_Pool::Intern(const std::string &s)
+{
+    if(FitsInline(s)) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    _internCount++;
+    _requestedBytes += s.size() + 1;
+
+    std::pair<std::unordered_set<std::string>::iterator, bool> res = _strings.insert(s);
+    if(res.second) {
+        // the set node holds the string object, its buffer, the next pointer and the bucket pointer
+        _storedBytes += s.size() + 1 + sizeof(std::string) + 2 * sizeof(void *);
+    }
+    return &(*res.first);
+}
+
+void SDAI_String_Pool::Clear()
+{
+    _strings.clear();
+    _internCount = 0;
+    _requestedBytes = 0;
+    _storedBytes = 0;
+}
+
 SDAI_String::SDAI_String(const char *str, size_t max)
 {
     if(!str) {
@@ -32,7 +73,7 @@ SDAI_String::SDAI_String(const std::string &s)
 }
 
 SDAI_String::SDAI_String(const SDAI_String &s)
-    : content(std::string(s.c_str()))
+    : content(s.content)
 {
 }
 
@@ -57,6 +98,11 @@ bool SDAI_String::operator== (const char *s) const
     return (content == s);
 }
 
+bool SDAI_String::operator== (const SDAI_String &s) const
+{
+    return (content == s.content);
+}
+
 void SDAI_String::clear(void)
 {
     content.clear();
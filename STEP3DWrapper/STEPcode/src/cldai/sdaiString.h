@@ -14,7 +14,74 @@
 #include <sc_export.h>
 #include <string>
 #include <limits>
+#include <mutex>
+#include <unordered_set>
 
+/**
+ * Pool of interned strings. AP242 files repeat the same string values
+ * (descriptions, product and context names, ...) many times; code that copies
+ * such values out of the instances can keep a handle to a single shared copy
+ * instead, and compare two handles of one pool instead of the strings.
+ * Strings that fit in the small string buffer of std::string ('', 'NONE', ...)
+ * are cheaper to copy than to share and are not interned.
+ *
+ * SDAI_String does not use the pool: it keeps its own copy, because a handle
+ * in every string attribute costs more than sharing the long values saves.
+ *
+ * Handles remain valid until the pool is cleared or destroyed.
+ * Intern() may be called from several threads; Clear() must not be called
+ * while the pool is in use.
+ * \sa InstMgr::UseStringPool()
+ */
+class SC_DAI_EXPORT SDAI_String_Pool
+{
+    public:
+        typedef const std::string *Handle;
+
+        SDAI_String_Pool();
+        ~SDAI_String_Pool();
+
+        /// returns the shared copy of s, adding it if needed; null if s is too short to be worth sharing
+        Handle Intern(const std::string &s);
+
+        void Clear();
+
+        /// number of strings interned (calls to Intern() that returned a handle)
+        size_t InternCount() const
+        {
+            return _internCount;
+        }
+        /// number of distinct strings stored
+        size_t UniqueCount() const
+        {
+            return _strings.size();
+        }
+        /** heap bytes that the interned strings would have used as separate copies,
+         * minus the bytes used by the pool. Negative when the strings are not
+         * repeated enough to pay for it.
+         */
+        long long BytesSaved() const
+        {
+            return (long long) _requestedBytes - (long long) _storedBytes;
+        }
+
+    private:
+#ifdef _MSC_VER
+#pragma warning( push )
+#pragma warning( disable: 4251 )
+#endif
+        std::unordered_set<std::string> _strings;
+        std::mutex _mutex;  ///< taken by Intern()
+#ifdef _MSC_VER
+#pragma warning( pop )
+#endif
+        size_t _internCount;
+        size_t _requestedBytes; ///< heap bytes of one copy per Intern()
+        size_t _storedBytes;    ///< heap bytes of the pool entries
+
+        SDAI_String_Pool(const SDAI_String_Pool &);
+        SDAI_String_Pool &operator= (const SDAI_String_Pool &);
+};
 
 class SC_DAI_EXPORT SDAI_String
 {
@@ -40,6 +107,7 @@ class SC_DAI_EXPORT SDAI_String
         SDAI_String &operator= (const char *s);
         SDAI_String &operator= (const SDAI_String &s);
         bool operator== (const char *s) const;
+        bool operator== (const SDAI_String &s) const;
 
         void clear(void);
         bool empty(void) const;
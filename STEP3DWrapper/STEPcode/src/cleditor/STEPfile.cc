@@ -23,6 +23,12 @@
 #include <iterator>
 #include <algorithm>
 #include <vector>
+#include <sstream>
+#include <thread>
+#include <cstdio>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sc_cf.h>
 
 #include <STEPfile.h>
 #include <sdai.h>
@@ -57,6 +63,31 @@ std::string STEPfile::SetFileName(const std::string newName)
     return _fileName;
 }
 
+/**
+ * size and modification time of a file; false if it can't be found. The time is in
+ * nanoseconds where stat() has them, so that a rewrite of the same size within the
+ * second of the read is seen; elsewhere it is in seconds.
+ */
+static bool FileStamp(const std::string &name, long long &size, long long &time)
+{
+    struct stat st;
+    if(stat(name.c_str(), &st) != 0) {
+        return false;
+    }
+    size = (long long) st.st_size;
+#ifdef HAVE_STAT_ST_MTIM
+    time = (long long) st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+#else
+    time = (long long) st.st_mtime;
+#endif
+    return true;
+}
+
+static bool SourceRecordLess(const STEPfileSourceRecord &a, const STEPfileSourceRecord &b)
+{
+    return a.fileId < b.fileId;
+}
+
 /** Returns read progress,scaled 0-100. Will return a value < 0 if
  * called *immediately* after read operation starts, if no file has
  * been specified, or if file has been closed. If result < 50,
@@ -70,6 +101,10 @@ float STEPfile::GetReadProgress() const
         return -1;
     }
     //the file is read once by ReadData1(), and again by ReadData2. Each gets 50%.
+    //a one pass read (ReadDataOnePass()) or a deferred read gets the whole 100%.
+    if(((_onePass && _parallelRead < 2) || _deferredRead) && (_fileType != WORKING_SESSION)) {
+        return (static_cast<float>(_iFileCurrentPosition) / _iFileSize) * 100.0;
+    }
     float percent = (static_cast<float>(_iFileCurrentPosition) / _iFileSize) * 50.0;
     if(_iFileStage1Done) {
         percent += 50;
@@ -153,7 +188,7 @@ Severity STEPfile::ReadHeader(istream &in)
         }
 
         //get the entity keyword
-        keywd = GetKeyword(in, ";( /\\", _error);
+        GetKeyword(in, ";( /\\", _error, keywd);
         ReadTokenSeparator(in, &cmtStr);
 
         //check for "ENDSEC"
@@ -462,11 +497,19 @@ int STEPfile::ReadData1(istream &in)
 
     ErrorDescriptor e;
 
+    // a deferred read keeps the comments, which aren't read again
+    std::string cmtStr;
+    std::string *comments = _deferredReader ? &cmtStr : 0;
+    std::string currSch;
+    if(_deferredReader) {
+        currSch = schemaName();
+    }
+
     //  PASS 1:  create instances
     endsec = FoundEndSecKywd(in);
     while(in.good() && !endsec) {
         e.ClearErrorMsg();
-        ReadTokenSeparator(in);   // also skips white space
+        ReadTokenSeparator(in, comments);   // also skips white space
         in >> c;
 
         if(_fileType == WORKING_SESSION) {
@@ -497,9 +540,15 @@ int STEPfile::ReadData1(istream &in)
         }
 
         if(!endsec) {
+            // the '#' was just read
+            std::streamoff begin = _noteRecords ? (std::streamoff) in.tellg() - 1 : 0;
             obj = ENTITY_NULL;
             if((_fileType == WORKING_SESSION) && (inst_state == deleteSE)) {
                 SkipInstance(in, tmpbuf);
+            } else if(_deferredReader) {
+                obj = CreateInstanceDeferred(in, cout, cmtStr, currSch);
+                cmtStr.clear();
+                _iFileCurrentPosition = in.tellg();
             } else {
                 obj =  CreateInstance(in, cout);
                 _iFileCurrentPosition = in.tellg();
@@ -518,6 +567,9 @@ int STEPfile::ReadData1(istream &in)
                 } else {
                     instances().Append(obj, newSE);
                 }
+                if(_noteRecords) {
+                    NoteSourceRecord(obj, begin, _iFileCurrentPosition);
+                }
 
                 ++instance_count;
             } else {
@@ -535,6 +587,10 @@ int STEPfile::ReadData1(istream &in)
                 return instance_count;
             }
 
+            if(ReadInterrupted((_deferredReader && _deferredRead) ? "data" : "pass1", instance_count)) {
+                return instance_count;
+            }
+
             endsec = FoundEndSecKywd(in);
 
         }
@@ -657,6 +713,10 @@ int STEPfile::ReadData2(istream &in, bool useTechCor)
                 return valid_insts;
             }
 
+            if(ReadInterrupted("pass2", total_instances)) {
+                return valid_insts;
+            }
+
             endsec = FoundEndSecKywd(in);
         }
     } // end while loop
@@ -684,6 +744,311 @@ int STEPfile::ReadWorkingData2(istream &in, bool useTechCor)
     return ReadData2(in, useTechCor);
 }
 
+/**
+ * PASS 2 of a parallel read: reads the attributes of the records kept by
+ * ReadData1() on ParallelRead() threads. The threads only read the records;
+ * the calling thread, one of them, also reports the progress. Once they are
+ * done, the instances are reported, given their state and counted in the order
+ * of the file, as ReadInstance() and ReadData2() do.
+ * \returns number of valid instances read
+ */
+int STEPfile::ReadData2Parallel(STEPfileDeferredReader &reader, long begin, long end, bool useTechCor)
+{
+    _entsInvalid = 0;
+    _entsIncomplete = 0;
+    _entsWarning = 0;
+
+    int total_instances = 0;
+    int valid_insts = 0;
+
+    _errorCount = 0;  // reset error count
+    _warningCount = 0;  // reset error count
+
+    char buf[BUFSIZ];
+    buf[0] = '\0';
+
+    const size_t count = reader.RecordCount();
+    std::vector<Severity> severities(count, SEVERITY_NULL);
+    std::atomic<size_t> next(0);
+    std::atomic<size_t> done(0);
+
+    // each thread takes the next range of records until there is none left
+    auto readRanges = [&](bool report) {
+        for(size_t first = next.fetch_add(PARALLEL_READ_RANGE); first < count && !_cancelRead;
+                first = next.fetch_add(PARALLEL_READ_RANGE)) {
+            size_t last = std::min(count, first + PARALLEL_READ_RANGE);
+            for(size_t i = first; i < last; ++i) {
+                severities[i] = reader.ReadRecord(i);
+            }
+            size_t read = done.fetch_add(last - first) + last - first;
+            if(report && begin >= 0 && end > begin) {
+                _iFileCurrentPosition = begin + (long)((double)(end - begin) * read / count);
+                if(_readObserver) {
+                    _readObserver->PhaseProgress("pass2", (long) _iFileCurrentPosition);
+                }
+            }
+        }
+    };
+
+    unsigned int threads = (unsigned int) std::min<size_t>(_parallelRead, (count + PARALLEL_READ_RANGE - 1) / PARALLEL_READ_RANGE);
+    std::vector<std::thread> workers;
+    for(unsigned int t = 1; t < threads; t++) {
+        workers.push_back(std::thread(readRanges, false));
+    }
+    readRanges(true);
+    for(size_t t = 0; t < workers.size(); t++) {
+        workers[t].join();
+    }
+
+    if(_cancelRead) {
+        ReadInterrupted("pass2", total_instances);
+        reader.Discard();
+        _wholeRecords.clear();
+        return valid_insts;
+    }
+
+    for(size_t i = 0; i < count; ++i) {
+        SDAI_Application_instance *obj = reader.RecordInstance(i);
+        AppendEntityErrorMsg(&(obj->Error()));
+        MgrNode *node = instances().FindFileId(obj->STEPfile_id);
+        if(node) {
+            SetInstanceState(node, obj, severities[i]);
+        }
+
+        if(obj->Error().severity() < SEVERITY_INCOMPLETE) {
+            ++_entsInvalid;
+            // old
+            ++_errorCount;
+        } else if(obj->Error().severity() == SEVERITY_INCOMPLETE) {
+            ++_entsIncomplete;
+            ++_entsInvalid;
+        } else if(obj->Error().severity() == SEVERITY_USERMSG) {
+            ++_entsWarning;
+        } else { // i.e. if severity == SEVERITY_NULL
+            ++valid_insts;
+        }
+
+        obj->Error().ClearErrorMsg();
+
+        ++total_instances;
+
+        if(_entsInvalid > _maxErrorCount) {
+            _error.AppendToUserMsg("Warning: Too Many Errors in File. Read function aborted.\n");
+            cerr << Error().UserMsg();
+            cerr << Error().DetailMsg();
+            Error().ClearErrorMsg();
+            Error().severity(SEVERITY_EXIT);
+            _wholeRecords.clear();
+            return valid_insts;
+        }
+    }
+
+    total_instances += static_cast<int>(_wholeRecords.size());
+    valid_insts += ReadDeferredRecords(useTechCor);
+
+    if(_entsInvalid) {
+        sprintf(buf,
+                "%s \n\tTotal instances: %d \n\tInvalid instances: %d \n\tIncomplete instances (includes invalid instances): %d \n\t%s: %d.\n",
+                "Second pass complete - instance summary:", total_instances,
+                _entsInvalid, _entsIncomplete, "Warnings",
+                _entsWarning);
+        cout << buf << endl;
+        _error.AppendToUserMsg(buf);
+        _error.AppendToDetailMsg(buf);
+        _error.GreaterSeverity(SEVERITY_WARNING);
+    }
+
+    return valid_insts;
+}
+
+/**
+ * ONE PASS:  create and read instances
+ * starts at the data section. References to instances further in the file are
+ * collected by the InstMgr, and stored by ResolveForwardRefs() at the end of the section.
+ * Instances are counted as in ReadData2(): one whose references can't be stored is
+ * reported and made incomplete, but still counted as valid.
+ * \param total set to the number of instances created
+ * \returns number of valid instances read
+ */
+int STEPfile::ReadDataOnePass(istream &in, int &total, bool useTechCor)
+{
+    _entsNotCreated = 0;
+    _entsInvalid = 0;
+    _entsIncomplete = 0;
+    _entsWarning = 0;
+
+    total = 0;
+    int valid_insts = 0;
+
+    _errorCount = 0;  // reset error count
+    _warningCount = 0;  // reset error count
+
+    char c;
+    char buf[BUFSIZ];
+    buf[0] = '\0';
+    std::string tmpbuf;
+
+    SDAI_Application_instance *obj = ENTITY_NULL;
+    std::string cmtStr;
+    const std::string currSch = schemaName();
+
+    int endsec = FoundEndSecKywd(in);
+
+    while(in.good() && !endsec) {
+        ReadTokenSeparator(in, &cmtStr);
+        in >> c;
+
+        if(c != ENTITY_NAME_DELIM) {
+            in.putback(c);
+            while(c != ENTITY_NAME_DELIM && in.good() &&
+                    !(endsec = FoundEndSecKywd(in))) {
+
+                tmpbuf.clear();
+                FindStartOfInstance(in, tmpbuf);
+                cout << "ERROR: trying to recover from invalid data. skipping: "
+                     << tmpbuf << endl;
+                in >> c;
+                ReadTokenSeparator(in, &cmtStr);
+            }
+        }
+
+        if(!endsec) {
+            // the '#' was just read
+            std::streamoff begin = _noteRecords ? (std::streamoff) in.tellg() - 1 : 0;
+            obj = ReadInstanceOnePass(in, cout, cmtStr, currSch, useTechCor);
+            _iFileCurrentPosition = in.tellg();
+
+            cmtStr.clear();
+            if(obj != ENTITY_NULL) {
+                if(_noteRecords) {
+                    NoteSourceRecord(obj, begin, _iFileCurrentPosition);
+                }
+                if(obj->Error().severity() < SEVERITY_INCOMPLETE) {
+                    ++_entsInvalid;
+                    // old
+                    ++_errorCount;
+                } else if(obj->Error().severity() == SEVERITY_INCOMPLETE) {
+                    ++_entsIncomplete;
+                    ++_entsInvalid;
+                } else if(obj->Error().severity() == SEVERITY_USERMSG) {
+                    ++_entsWarning;
+                } else { // i.e. if severity == SEVERITY_NULL
+                    ++valid_insts;
+                }
+
+                obj->Error().ClearErrorMsg();
+
+                ++total;
+            } else {
+                ++_entsNotCreated;
+                ++_entsInvalid;
+                // old
+                ++_errorCount;
+            }
+
+            if(_entsInvalid > _maxErrorCount) {
+                instances().CollectForwardRefs(0);
+                instances().ClearForwardRefs();
+                _error.AppendToUserMsg("Warning: Too Many Errors in File. Read function aborted.\n");
+                cerr << Error().UserMsg();
+                cerr << Error().DetailMsg();
+                Error().ClearErrorMsg();
+                Error().severity(SEVERITY_EXIT);
+                return valid_insts;
+            }
+
+            if(ReadInterrupted("data", total)) {
+                instances().CollectForwardRefs(0);
+                instances().ClearForwardRefs();
+                return valid_insts;
+            }
+
+            endsec = FoundEndSecKywd(in);
+        }
+    } // end while loop
+
+    instances().CollectForwardRefs(0);
+    ResolveForwardRefs();
+
+    if(_entsNotCreated) {
+        sprintf(buf,
+                "STEPfile Reading File: Unable to create %d instances.\n\tCheck for invalid entity types.\n",
+                _entsNotCreated);
+        _error.AppendToUserMsg(buf);
+        _error.GreaterSeverity(SEVERITY_WARNING);
+    }
+    if(_entsInvalid) {
+        sprintf(buf,
+                "%s \n\tTotal instances: %d \n\tInvalid instances: %d \n\tIncomplete instances (includes invalid instances): %d \n\t%s: %d.\n",
+                "Reading complete - instance summary:", total,
+                _entsInvalid, _entsIncomplete, "Warnings",
+                _entsWarning);
+        cout << buf << endl;
+        _error.AppendToUserMsg(buf);
+        _error.AppendToDetailMsg(buf);
+        _error.GreaterSeverity(SEVERITY_WARNING);
+    }
+    if(!in.good()) {
+        _error.AppendToUserMsg("Error in input file.\n");
+    }
+
+    _iFileStage1Done = true;
+    return valid_insts;
+}
+
+/**
+ * Stores the references collected by the InstMgr during ReadDataOnePass(), now that
+ * all instances exist. An instance with a reference that can't be stored is reported
+ * and made incomplete, as it would be by ReadInstance() in the second pass of a
+ * two-pass read. The references of an instance are consecutive in the table.
+ */
+void STEPfile::ResolveForwardRefs()
+{
+    char errbuf[BUFSIZ];
+
+    std::vector<ForwardRef> &refs = instances().ForwardRefs();
+    std::vector<ForwardRef>::iterator it = refs.begin();
+    while(it != refs.end()) {
+        SDAI_Application_instance *owner = it->owner;
+        ErrorDescriptor &err = owner->Error();
+
+        for(; it != refs.end() && it->owner == owner; ++it) {
+            MgrNode *mn = instances().FindFileId(it->fileId);
+            SDAI_Application_instance *se = mn ? mn->GetApplication_instance() : ENTITY_NULL;
+
+            if(se == ENTITY_NULL) {
+                sprintf(errbuf, "  Reference to non-existent ENTITY #%d.\n", it->fileId);
+                err.AppendToDetailMsg(errbuf);
+                err.GreaterSeverity(SEVERITY_WARNING);
+            } else if(it->slot) {
+                if(EntityValidLevel(se, it->type, &err) == SEVERITY_NULL) {
+                    *(it->slot) = se;
+                }
+            } else if(!it->select->AssignForwardRef(se)) {
+                err.AppendToDetailMsg("  Reference to entity that is not a valid type for SELECT.\n");
+                err.GreaterSeverity(SEVERITY_WARNING);
+            }
+        }
+
+        if(err.severity() != SEVERITY_NULL) {
+            sprintf(errbuf, "\nERROR:  ENTITY #%d %s\n", owner->GetFileId(), owner->EntityName());
+            std::string msg(errbuf);
+            msg.append(err.DetailMsg());
+            err.ClearErrorMsg();
+            err.AppendToDetailMsg(msg);
+            err.GreaterSeverity(SEVERITY_WARNING);
+            AppendEntityErrorMsg(&err);
+
+            MgrNode *node = instances().FindFileId(owner->STEPfile_id);
+            if(node) {
+                SetInstanceState(node, owner, SEVERITY_WARNING);
+            }
+        }
+    }
+
+    instances().ClearForwardRefs();
+}
+
 /** Looks for the word DATA followed by optional whitespace
  * followed by a semicolon.  When it is looking for the word
  * DATA it skips over strings and comments.
@@ -811,103 +1176,478 @@ SDAI_Application_instance *STEPfile::CreateInstance(istream &in, ostream &out)
         return ENTITY_NULL;
     }
 
-    ReadTokenSeparator(in);
-    in.get(c);   // read equal sign
-    if(c != '=') {
-        // ERROR: '=' expected
-        SkipInstance(in, tmpbuf);
-        out << "ERROR: instance #" << fileid
-            << " \'=\' expected.\n\tData lost: " << tmpbuf << endl;
-        return ENTITY_NULL;
+    ReadTokenSeparator(in);
+    in.get(c);   // read equal sign
+    if(c != '=') {
+        // ERROR: '=' expected
+        SkipInstance(in, tmpbuf);
+        out << "ERROR: instance #" << fileid
+            << " \'=\' expected.\n\tData lost: " << tmpbuf << endl;
+        return ENTITY_NULL;
+    }
+
+    ReadTokenSeparator(in);
+    c = in.peek(); // peek at the next character on the istream
+
+    //check for optional "&SCOPE" construct
+    if(c == '&') {   // TODO check this out
+        Severity s = CreateScopeInstances(in, &scopelist);
+        if(s < SEVERITY_WARNING) {
+            return ENTITY_NULL;
+        }
+        ReadTokenSeparator(in);
+        c = in.peek(); // peek at next char on istream again
+    }
+
+    //check for subtype/supertype record
+    if(c == '(') {
+        //  TODO:  implement complex inheritance
+
+        obj = CreateSubSuperInstance(in, fileid, result);
+        if(obj == ENTITY_NULL) {
+            SkipInstance(in, tmpbuf);
+            out << "ERROR: instance #" << fileid
+                << " Illegal complex entity.\n"
+                << result.UserMsg() << ".\n\n";
+            return ENTITY_NULL;
+        }
+    } else { // not a complex entity
+        // check for User Defined Entity
+        int userDefined = 0;
+        if(c == '!') {
+            userDefined = 1;
+            in.get(c);
+        }
+
+        ReadStdKeyword(in, objnm, 1);   // read the type name
+        if(!in.good()) {
+            out << "ERROR: instance #" << fileid
+                << " Unexpected file problem in "
+                << "STEPfile::CreateInstance.\n";
+        }
+
+        //create the instance using the Registry object
+        if(userDefined) {
+            SkipInstance(in, tmpbuf);
+            out << "WARNING: instance #" << fileid
+                << " User Defined Entity in DATA section ignored.\n"
+                << "\tData lost: \'!" << objnm << "\': " << tmpbuf
+                << endl;
+            return ENTITY_NULL;
+        } else {
+            schnm = schemaName();
+            obj = CreateEntity(objnm, schnm, result);
+        }
+    }
+
+    if(obj == ENTITY_NULL) {
+        SkipInstance(in, tmpbuf);
+        out << "ERROR: instance #" << fileid << " \'" << objnm
+            << "\': " << result.UserMsg()
+            << ".\n\tData lost: " << tmpbuf << "\n\n";
+        return ENTITY_NULL;
+    }
+    obj -> STEPfile_id = fileid;
+
+    //  scan values
+    SkipInstance(in, tmpbuf);
+    return obj;
+}
+
+
+/// append the characters of in to record, up to and including the ';' that ends it, skipping over strings
+static void CopyRecord(istream &in, std::string &record)
+{
+    bool inString = false;
+    char c;
+    while(in.get(c)) {
+        record += c;
+        if(c == '\'') {
+            inString = !inString;
+        } else if(c == ';' && !inString) {
+            break;
+        }
+    }
+}
+
+/**
+ This function creates an instance and populates it with the values read
+ from the istream, as CreateInstance() and ReadInstance() would in two
+ passes. References to instances that are not created yet are collected
+ by the InstMgr. Used by ReadDataOnePass().
+
+ Complex and scoped records are copied and read by CreateInstance() and
+ ReadInstance(); they are few in a file.
+
+ The '#' is read from the istream before ReadInstanceOnePass is called.
+ */
+SDAI_Application_instance *STEPfile::ReadInstanceOnePass(istream &in, ostream &out, std::string &cmtStr,
+        const std::string &currSch, bool useTechCor)
+{
+    std::string tmpbuf;
+    std::string objnm;
+    char c;
+
+    int idInFile = -1;
+    ReadTokenSeparator(in, &cmtStr);
+    in >> idInFile;
+    int fileid = IncrementFileId(idInFile);
+    if(instances().FindFileId(fileid)) {
+        SkipInstance(in, tmpbuf);
+        out <<  "ERROR: instance #" << fileid
+            << " already exists.\n\tData lost: " << tmpbuf << endl;
+        return ENTITY_NULL;
+    }
+
+    ReadTokenSeparator(in, &cmtStr);
+    in.get(c);   // read equal sign
+    if(c != '=') {
+        // ERROR: '=' expected
+        SkipInstance(in, tmpbuf);
+        out << "ERROR: instance #" << fileid
+            << " \'=\' expected.\n\tData lost: " << tmpbuf << endl;
+        return ENTITY_NULL;
+    }
+
+    ReadTokenSeparator(in, &cmtStr);
+    c = in.peek();
+
+    if(c == '&' || c == '(') {
+        std::ostringstream id;
+        id << idInFile << "=";
+        std::string record = id.str();
+        CopyRecord(in, record);
+
+        std::istringstream in1(record);
+        SDAI_Application_instance *obj = CreateInstance(in1, out);
+        if(obj == ENTITY_NULL) {
+            return ENTITY_NULL;
+        }
+        instances().Append(obj, newSE);
+        instances().CollectForwardRefs(obj);
+
+        std::istringstream in2(record);
+        return ReadInstance(in2, out, cmtStr, useTechCor);
+    }
+
+    // check for User Defined Entity
+    int userDefined = 0;
+    if(c == '!') {
+        userDefined = 1;
+        in.get(c);
+    }
+
+    ReadStdKeyword(in, objnm, 1);   // read the type name
+    if(!in.good()) {
+        out << "ERROR: instance #" << fileid
+            << " Unexpected file problem in "
+            << "STEPfile::ReadInstanceOnePass.\n";
+    }
+
+    if(userDefined) {
+        SkipInstance(in, tmpbuf);
+        out << "WARNING: instance #" << fileid
+            << " User Defined Entity in DATA section ignored.\n"
+            << "\tData lost: \'!" << objnm << "\': " << tmpbuf
+            << endl;
+        return ENTITY_NULL;
+    }
+
+    ErrorDescriptor result;
+    SDAI_Application_instance *obj = CreateEntity(objnm, currSch, result);
+    if(obj == ENTITY_NULL) {
+        SkipInstance(in, tmpbuf);
+        out << "ERROR: instance #" << fileid << " \'" << objnm
+            << "\': " << result.UserMsg()
+            << ".\n\tData lost: " << tmpbuf << "\n\n";
+        return ENTITY_NULL;
+    }
+    obj -> STEPfile_id = fileid;
+
+    MgrNode *node = instances().Append(obj, newSE);
+    instances().CollectForwardRefs(obj);
+
+    //  read values
+    ReadTokenSeparator(in, &cmtStr);
+    Severity sev = obj->STEPread(fileid, FileIdIncr(), &instances(), in, currSch.c_str(),
+                                 useTechCor, _strict);
+
+    ReadTokenSeparator(in, &cmtStr);
+
+    if(!cmtStr.empty()) {
+        obj->AddP21Comment(cmtStr);
+    }
+
+    c = in.peek(); // check for semicolon or keyword 'ENDSEC'
+    if(c != 'E') {
+        in >> c;    // read the semicolon
+    }
+
+    AppendEntityErrorMsg(&(obj->Error()));
+
+    SetInstanceState(node, obj, sev);
+    return obj;
+}
+
+/**
+ This function creates an instance, as CreateInstance() would, and gives the
+ rest of its record to the STEPfileDeferredReader, which reads the values the
+ first time the attributes are used. Complex and scoped records are created by
+ CreateInstance() and kept whole, to be read by ReadDeferredRecords(). Used by
+ ReadData1() for a deferred read.
+
+ The '#' is read from the istream before CreateInstanceDeferred is called.
+ */
+SDAI_Application_instance *STEPfile::CreateInstanceDeferred(istream &in, ostream &out, std::string &cmtStr,
+        const std::string &currSch)
+{
+    std::string tmpbuf;
+    std::string objnm;
+    char c;
+
+    int idInFile = -1;
+    ReadTokenSeparator(in, &cmtStr);
+    in >> idInFile;
+    int fileid = IncrementFileId(idInFile);
+    if(instances().FindFileId(fileid)) {
+        SkipInstance(in, tmpbuf);
+        out <<  "ERROR: instance #" << fileid
+            << " already exists.\n\tData lost: " << tmpbuf << endl;
+        return ENTITY_NULL;
+    }
+
+    ReadTokenSeparator(in, &cmtStr);
+    in.get(c);   // read equal sign
+    if(c != '=') {
+        // ERROR: '=' expected
+        SkipInstance(in, tmpbuf);
+        out << "ERROR: instance #" << fileid
+            << " \'=\' expected.\n\tData lost: " << tmpbuf << endl;
+        return ENTITY_NULL;
+    }
+
+    ReadTokenSeparator(in, &cmtStr);
+    c = in.peek();
+
+    if(c == '&' || c == '(') {
+        std::ostringstream id;
+        id << idInFile << "=";
+        std::string record = id.str();
+        CopyRecord(in, record);
+
+        std::istringstream in1(record);
+        SDAI_Application_instance *obj = CreateInstance(in1, out);
+        if(obj != ENTITY_NULL) {
+            _wholeRecords.push_back(record);
+        }
+        return obj;
+    }
+
+    // check for User Defined Entity
+    int userDefined = 0;
+    if(c == '!') {
+        userDefined = 1;
+        in.get(c);
+    }
+
+    ReadStdKeyword(in, objnm, 1);   // read the type name
+    if(!in.good()) {
+        out << "ERROR: instance #" << fileid
+            << " Unexpected file problem in "
+            << "STEPfile::CreateInstanceDeferred.\n";
+    }
+
+    if(userDefined) {
+        SkipInstance(in, tmpbuf);
+        out << "WARNING: instance #" << fileid
+            << " User Defined Entity in DATA section ignored.\n"
+            << "\tData lost: \'!" << objnm << "\': " << tmpbuf
+            << endl;
+        return ENTITY_NULL;
+    }
+
+    ErrorDescriptor result;
+    SDAI_Application_instance *obj = CreateEntity(objnm, currSch, result);
+    if(obj == ENTITY_NULL) {
+        SkipInstance(in, tmpbuf);
+        out << "ERROR: instance #" << fileid << " \'" << objnm
+            << "\': " << result.UserMsg()
+            << ".\n\tData lost: " << tmpbuf << "\n\n";
+        return ENTITY_NULL;
+    }
+    obj -> STEPfile_id = fileid;
+    if(!cmtStr.empty()) {
+        obj->AddP21Comment(cmtStr);
+    }
+
+    _deferredReader->Defer(obj, in);
+    return obj;
+}
+
+/**
+ * Reads the complex and scoped records kept by CreateInstanceDeferred(), as
+ * ReadData2() would, once all the instances are created.
+ * \returns number of valid instances read
+ */
+int STEPfile::ReadDeferredRecords(bool useTechCor)
+{
+    int valid_insts = 0;
+    std::string cmtStr;
+    for(size_t i = 0; i < _wholeRecords.size(); ++i) {
+        std::istringstream in(_wholeRecords[i]);
+        SDAI_Application_instance *obj = ReadInstance(in, cout, cmtStr, useTechCor);
+        cmtStr.clear();
+        if(obj == ENTITY_NULL) {
+            ++_entsInvalid;
+            ++_errorCount;
+        } else if(obj->Error().severity() < SEVERITY_INCOMPLETE) {
+            ++_entsInvalid;
+            ++_errorCount;
+        } else if(obj->Error().severity() == SEVERITY_INCOMPLETE) {
+            ++_entsIncomplete;
+            ++_entsInvalid;
+        } else {
+            if(obj->Error().severity() == SEVERITY_USERMSG) {
+                ++_entsWarning;
+            } else {
+                ++valid_insts;
+            }
+        }
+        if(obj != ENTITY_NULL) {
+            obj->Error().ClearErrorMsg();
+        }
+    }
+    _wholeRecords.clear();
+    return valid_insts;
+}
+
+STEPfileDeferredReader::STEPfileDeferredReader(InstMgr &instances, const std::string &schema, int fileIdIncr,
+        bool useTechCor, bool strict) :
+    _instances(instances), _fileIdIncr(fileIdIncr), _useTechCor(useTechCor), _strict(strict), _schema(schema)
+{
+}
+
+void STEPfileDeferredReader::Defer(SDAI_Application_instance *inst, istream &in)
+{
+    DeferredRecord record;
+    record.reader = this;
+    record.instance = inst;
+    record.begin = _text.size();
+    CopyRecord(in, _text);
+    record.end = _text.size();
+    record.reading = false;
+    _records.push_back(record);
+    inst->attributes.Deferred(&_records.back());
+}
+
+/**
+ * Reads the attributes of record->instance from the kept text, as
+ * STEPfile::ReadInstance() would. The instance is made complete or incomplete;
+ * the errors stay in its Error(). References to other instances don't read
+ * them, but the STEPread of an attribute may use the attributes of the instance
+ * being read: the mutex is recursive and record->reading stops the recursion.
+ */
+void STEPfileDeferredReader::Read(DeferredRecord *record)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    SDAI_Application_instance *inst = record->instance;
+    if(record->reading || inst->attributes.Deferred() != record) {
+        return;
     }
+    record->reading = true;
 
-    ReadTokenSeparator(in);
-    c = in.peek(); // peek at the next character on the istream
+    Severity sev = ReadText(record);
 
-    //check for optional "&SCOPE" construct
-    if(c == '&') {   // TODO check this out
-        Severity s = CreateScopeInstances(in, &scopelist);
-        if(s < SEVERITY_WARNING) {
-            return ENTITY_NULL;
-        }
-        ReadTokenSeparator(in);
-        c = in.peek(); // peek at next char on istream again
+    MgrNode *node = _instances.FindFileId(inst->STEPfile_id);
+    if(node) {
+        node->ChangeState((sev >= SEVERITY_USERMSG) ? completeSE : incompleteSE);
     }
+    inst->attributes.Deferred(0);
+    record->reading = false;
+}
 
-    //check for subtype/supertype record
-    if(c == '(') {
-        //  TODO:  implement complex inheritance
+Severity STEPfileDeferredReader::ReadText(DeferredRecord *record)
+{
+    SDAI_Application_instance *inst = record->instance;
+    std::istringstream in(_text.substr(record->begin, record->end - record->begin));
+    std::string cmtStr;
+    ReadTokenSeparator(in, &cmtStr);
+    Severity sev = inst->STEPread(inst->STEPfile_id, _fileIdIncr, &_instances, in, _schema.c_str(),
+                                  _useTechCor, _strict);
+    // the values are those of the record; the generated functions that change them read it first
+    inst->Modified(false);
+    ReadTokenSeparator(in, &cmtStr);
+    if(!cmtStr.empty()) {
+        inst->AddP21Comment(cmtStr);
+    }
+    return sev;
+}
 
-        obj = CreateSubSuperInstance(in, fileid, result);
-        if(obj == ENTITY_NULL) {
-            SkipInstance(in, tmpbuf);
-            out << "ERROR: instance #" << fileid
-                << " Illegal complex entity.\n"
-                << result.UserMsg() << ".\n\n";
-            return ENTITY_NULL;
-        }
-    } else { // not a complex entity
-        // check for User Defined Entity
-        int userDefined = 0;
-        if(c == '!') {
-            userDefined = 1;
-            in.get(c);
-        }
+/**
+ * The instance is no longer deferred before its attributes are read, so that the
+ * STEPread of an attribute that uses them doesn't take the lock of Read().
+ */
+Severity STEPfileDeferredReader::ReadRecord(size_t i)
+{
+    DeferredRecord *record = &_records[i];
+    SDAI_Application_instance *inst = record->instance;
+    if(inst->attributes.Deferred() != record) {
+        return inst->Error().severity();
+    }
+    inst->attributes.Deferred(0);
+    return ReadText(record);
+}
 
-        ReadStdKeyword(in, objnm, 1);   // read the type name
-        if(!in.good()) {
-            out << "ERROR: instance #" << fileid
-                << " Unexpected file problem in "
-                << "STEPfile::CreateInstance.\n";
+void STEPfileDeferredReader::Discard()
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    for(size_t i = 0; i < _records.size(); ++i) {
+        if(_records[i].instance->attributes.Deferred() == &_records[i]) {
+            _records[i].instance->attributes.Deferred(0);
         }
+    }
+}
 
-        //create the instance using the Registry object
-        if(userDefined) {
-            SkipInstance(in, tmpbuf);
-            out << "WARNING: instance #" << fileid
-                << " User Defined Entity in DATA section ignored.\n"
-                << "\tData lost: \'!" << objnm << "\': " << tmpbuf
-                << endl;
-            return ENTITY_NULL;
-        } else {
-            schnm = schemaName();
-            obj = reg().ObjCreate(objnm.c_str(), schnm.c_str());
-            if(obj == ENTITY_NULL) {
-                // This will be the case if objnm does not exist in the reg.
-                result.UserMsg("Unknown ENTITY type");
-            } else if(obj->Error().severity() <= SEVERITY_WARNING) {
-                // Common causes of error is that obj is an abstract supertype
-                // or that it can only be instantiated using external mapping.
-                // If neither are the case, create a generic message.
-                if(!obj->Error().UserMsg().empty()) {
-                    result.UserMsg(obj->Error().UserMsg());
-                } else {
-                    result.UserMsg("Could not create ENTITY");
-                }
-                // Delete obj so that below we'll know that an error occur:
-                delete obj;
-                obj = ENTITY_NULL;
-            }
+size_t STEPfileDeferredReader::DeferredCount()
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    size_t count = 0;
+    for(size_t i = 0; i < _records.size(); ++i) {
+        if(_records[i].instance->attributes.Deferred() == &_records[i]) {
+            ++count;
         }
     }
+    return count;
+}
 
+/**
+ Creates an instance of the (simple) entity type objnm using the Registry.
+ Returns ENTITY_NULL, with the reason in result, if the type is unknown
+ or can't be instantiated.
+ */
+SDAI_Application_instance *STEPfile::CreateEntity(const std::string &objnm, const std::string &schnm,
+        ErrorDescriptor &result)
+{
+    SDAI_Application_instance *obj = reg().ObjCreate(objnm.c_str(), schnm.c_str());
     if(obj == ENTITY_NULL) {
-        SkipInstance(in, tmpbuf);
-        out << "ERROR: instance #" << fileid << " \'" << objnm
-            << "\': " << result.UserMsg()
-            << ".\n\tData lost: " << tmpbuf << "\n\n";
-        return ENTITY_NULL;
+        // This will be the case if objnm does not exist in the reg.
+        result.UserMsg("Unknown ENTITY type");
+    } else if(obj->Error().severity() <= SEVERITY_WARNING) {
+        // Common causes of error is that obj is an abstract supertype
+        // or that it can only be instantiated using external mapping.
+        // If neither are the case, create a generic message.
+        if(!obj->Error().UserMsg().empty()) {
+            result.UserMsg(obj->Error().UserMsg());
+        } else {
+            result.UserMsg("Could not create ENTITY");
+        }
+        // Delete obj so that the caller knows that an error occurred:
+        delete obj;
+        obj = ENTITY_NULL;
     }
-    obj -> STEPfile_id = fileid;
-
-    //  scan values
-    SkipInstance(in, tmpbuf);
-
-    ReadTokenSeparator(in);
     return obj;
 }
 
-
 /**
  description:
     This function reads the SCOPE list for an entity instance,
@@ -931,7 +1671,7 @@ Severity STEPfile::CreateScopeInstances(istream &in, SDAI_Application_instance_p
     std::vector< SDAI_Application_instance_ptr > inscope;
     std::string keywd;
 
-    keywd = GetKeyword(in, " \n\t/\\#;", _error);
+    GetKeyword(in, " \n\t/\\#;", _error, keywd);
     if(strncmp(const_cast<char *>(keywd.c_str()), "&SCOPE", 6)) {
         //ERROR: "&SCOPE" expected
         //TODO: should attempt to recover by reading through ENDSCOPE
@@ -947,6 +1687,7 @@ Severity STEPfile::CreateScopeInstances(istream &in, SDAI_Application_instance_p
     in.get(c);
     while(c == '#') {
         se = CreateInstance(in, cout);
+        ReadTokenSeparator(in);
         if(se != ENTITY_NULL) {
             //TODO:  apply scope information to se
             //  Add se to scopelist
@@ -973,7 +1714,7 @@ Severity STEPfile::CreateScopeInstances(istream &in, SDAI_Application_instance_p
     }
 
     //check for "ENDSCOPE"
-    keywd = GetKeyword(in, " \t\n/\\#;", _error);
+    GetKeyword(in, " \t\n/\\#;", _error, keywd);
     if(strncmp(const_cast<char *>(keywd.c_str()), "ENDSCOPE", 8)) {
         //ERROR: "ENDSCOPE" expected
         SkipInstance(in, tmpbuf);
@@ -1091,7 +1832,7 @@ Severity STEPfile::ReadScopeInstances(istream &in)
     std::string keywd;
     std::string cmtStr;
 
-    keywd = GetKeyword(in, " \n\t/\\#;", _error);
+    GetKeyword(in, " \n\t/\\#;", _error, keywd);
     if(strncmp(const_cast<char *>(keywd.c_str()), "&SCOPE", 6)) {
         //ERROR: "&SCOPE" expected
         SkipInstance(in, tmpbuf);
@@ -1119,7 +1860,7 @@ Severity STEPfile::ReadScopeInstances(istream &in)
     in.putback(c);
 
     //check for "ENDSCOPE"
-    keywd = GetKeyword(in, " \t\n/\\#;", _error);
+    GetKeyword(in, " \t\n/\\#;", _error, keywd);
     if(strncmp(const_cast<char *>(keywd.c_str()), "ENDSCOPE", 8)) {
         //ERROR: "ENDSCOPE" expected
         SkipInstance(in, tmpbuf);
@@ -1171,8 +1912,6 @@ SDAI_Application_instance *STEPfile::ReadInstance(istream &in, ostream &out, std
     Severity sev = SEVERITY_NULL;
 
     std::string tmpbuf;
-    char errbuf[BUFSIZ];
-    errbuf[0] = '\0';
     std::string currSch;
     std::string objnm;
 
@@ -1313,8 +2052,28 @@ SDAI_Application_instance *STEPfile::ReadInstance(istream &in, ostream &out, std
         AppendEntityErrorMsg(&(obj->Error()));
     }
 
-    //set the node's state,
-    //and set the STEPfile:_error (based on the type of file being read)
+    SetInstanceState(node, obj, sev);
+
+    // check ErrorDesc severity and set the state for MgrNode *node
+    // according to completeSE or incompleteSE
+    // watch how you set it based on whether you are reading an
+    // exchange or working file.
+
+    return obj;
+
+}
+
+
+
+/**
+ Sets the state of the node of an instance that has been read with severity sev,
+ and sets the STEPfile:_error (based on the type of file being read).
+ */
+void STEPfile::SetInstanceState(MgrNode *node, SDAI_Application_instance *obj, Severity sev)
+{
+    char errbuf[BUFSIZ];
+    errbuf[0] = '\0';
+
     switch(sev) {
         case SEVERITY_NULL:
         case SEVERITY_USERMSG:
@@ -1336,7 +2095,7 @@ SDAI_Application_instance *STEPfile::ReadInstance(istream &in, ostream &out, std
                 }
             } else {
                 if(node->CurrState() == completeSE) {
-                    sprintf(errbuf, "WARNING in WORKING FILE: changing instance #%d state from completeSE to incompleteSE.\n", fileid);
+                    sprintf(errbuf, "WARNING in WORKING FILE: changing instance #%d state from completeSE to incompleteSE.\n", obj->STEPfile_id);
                     _error.AppendToUserMsg(errbuf);
                     if(_fileType != WORKING_SESSION) {
                         node->ChangeState(incompleteSE);
@@ -1356,18 +2115,8 @@ SDAI_Application_instance *STEPfile::ReadInstance(istream &in, ostream &out, std
         default:
             break;
     }
-
-    // check ErrorDesc severity and set the state for MgrNode *node
-    // according to completeSE or incompleteSE
-    // watch how you set it based on whether you are reading an
-    // exchange or working file.
-
-    return obj;
-
 }
 
-
-
 /**
 This function uses the C library function system to issue
 a shell command which checks for the existence of the
@@ -1445,6 +2194,25 @@ Severity STEPfile::WriteExchangeFile(const std::string filename, int validate, i
         }
     }
 
+    // a file written over is first renamed, to copy the unchanged records from it
+    std::string name = filename.empty() ? FileName() : DirObj::Normalize(filename);
+    if(!_sourceRecords.empty() && (name == _sourceName)) {
+        std::string backup = _sourceName + ".bak";
+        long long size = -1, time = 0;
+        if(SourceUnchanged()) {
+            std::remove(backup.c_str());
+            if(std::rename(_sourceName.c_str(), backup.c_str()) == 0) {
+                FileStamp(backup, size, time);
+            }
+        }
+        if(size == _sourceSize) {
+            _sourceName = backup;
+            _sourceTime = time;
+        } else {
+            _sourceRecords.clear();
+        }
+    }
+
     ostream *out =  OpenOutputFile(filename);
     if(_error.severity() < SEVERITY_WARNING) {
         return _error.severity();
@@ -1613,18 +2381,126 @@ void STEPfile::WriteHeaderInstanceFileSchema(ostream &out)
 void STEPfile::WriteData(ostream &out, int writeComments)
 {
     _oFileInstsWritten = 0;
+    _oFileRecordsCopied = 0;
     std::string currSch = schemaName();
     out << "DATA;\n";
 
+    // the records of the unchanged instances are copied from the file they were read from
+    std::ifstream source;
+    std::streamoff position = 0;
+    if(SourceUnchanged()) {
+        source.open(_sourceName.c_str(), std::ios::in | std::ios::binary);
+    }
+
+    std::string record;
     int n = instances().InstanceCount();
     for(int i = 0; i < n; ++i) {
-        instances().GetMgrNode(i)->GetApplication_instance()->STEPwrite(out, currSch.c_str(), writeComments);
+        SDAI_Application_instance *obj = instances().GetMgrNode(i)->GetApplication_instance();
+        if(source.is_open() && !(record = CopiableRecord(obj, source, position)).empty()) {
+            if(writeComments && !obj->p21Comment.empty()) {
+                out << obj->p21Comment;
+            }
+            out << record << "\n";
+            _oFileRecordsCopied++;
+        } else {
+            obj->STEPwrite(out, currSch.c_str(), writeComments);
+        }
         _oFileInstsWritten++;
     }
 
     out << "ENDSEC;\n";
 }
 
+/// notes that the record of obj, just read, is from begin to end in the file
+void STEPfile::NoteSourceRecord(SDAI_Application_instance *obj, std::streamoff begin, std::streamoff end)
+{
+    STEPfileSourceRecord record;
+    record.instance = obj;
+    record.fileId = obj->STEPfile_id;
+    record.begin = begin;
+    record.end = end;
+    // the ids are usually in increasing order in a file
+    if(_sourceRecords.empty() || _sourceRecords.back().fileId < record.fileId) {
+        _sourceRecords.push_back(record);
+    } else {
+        _sourceRecords.insert(std::lower_bound(_sourceRecords.begin(), _sourceRecords.end(), record,
+                                               SourceRecordLess), record);
+    }
+}
+
+/// true if there are noted records, and the file they are in hasn't changed since it was read
+bool STEPfile::SourceUnchanged() const
+{
+    long long size, time;
+    return !_sourceRecords.empty() && FileStamp(_sourceName, size, time) &&
+           (size == _sourceSize) && (time == _sourceTime);
+}
+
+const STEPfileSourceRecord *STEPfile::SourceRecord(int fileId) const
+{
+    STEPfileSourceRecord key;
+    key.fileId = fileId;
+    std::vector<STEPfileSourceRecord>::const_iterator it =
+        std::lower_bound(_sourceRecords.begin(), _sourceRecords.end(), key, SourceRecordLess);
+    if(it == _sourceRecords.end() || it->fileId != fileId) {
+        return 0;
+    }
+    return &(*it);
+}
+
+/**
+ * Reads the record of obj from source, the file it was read from. The record can
+ * be copied if obj isn't Modified() and has the id it was read with, and if each
+ * instance it refers to is still in the InstMgr with the id it was read with.
+ * \param position the position in source, kept by the caller so that the short
+ * gaps between records are skipped rather than sought over
+ * \returns the record without carriage returns, or an empty string if it can't be copied
+ */
+std::string STEPfile::CopiableRecord(const SDAI_Application_instance *obj, istream &source, std::streamoff &position)
+{
+    const STEPfileSourceRecord *record = SourceRecord(obj->STEPfile_id);
+    if(obj->Modified() || !record || record->instance != obj) {
+        return std::string();
+    }
+
+    if((record->begin >= position) && (record->begin - position < BUFSIZ)) {
+        source.ignore(record->begin - position);
+    } else {
+        source.clear();
+        source.seekg(record->begin);
+    }
+    std::string text(record->end - record->begin, '\0');
+    source.read(&text[0], text.size());
+    if(source.gcount() != (std::streamsize) text.size()) {
+        source.clear();
+        position = -1;
+        return std::string();
+    }
+    position = record->end;
+
+    // each reference, after the id of the instance, must be to the instance read with that id
+    bool inString = false;
+    for(size_t i = 1; (i = text.find_first_of("'#", i)) != std::string::npos; ++i) {
+        if(text[i] == '\'') {
+            inString = !inString;
+            continue;
+        }
+        if(inString) {
+            continue;
+        }
+        int id = atoi(text.c_str() + i + 1);
+        const STEPfileSourceRecord *referred = SourceRecord(id);
+        MgrNode *node = instances().FindFileId(id);
+        if(!referred || !node || (node->GetApplication_instance() != referred->instance) ||
+                (referred->instance->STEPfile_id != id)) {
+            return std::string();
+        }
+    }
+
+    text.erase(std::remove(text.begin(), text.end(), '\r'), text.end());
+    return text;
+}
+
 void STEPfile::WriteValuePairsData(ostream &out, int writeComments, int mixedCase)
 {
     std::string currSch = schemaName();
@@ -1634,19 +2510,16 @@ void STEPfile::WriteValuePairsData(ostream &out, int writeComments, int mixedCas
     }
 }
 
-Severity STEPfile::AppendFile(istream *in, bool useTechCor)
+Severity STEPfile::ReadFileType(istream &in)
 {
-    Severity rval = SEVERITY_NULL;
     char errbuf[BUFSIZ];
 
-    SetFileIdIncrement();
-    int total_insts = 0,  valid_insts = 0;
-
-    ReadTokenSeparator(*in);
-    std::string keywd = GetKeyword(*in, "; #", _error);
+    ReadTokenSeparator(in);
+    std::string keywd;
+    GetKeyword(in, "; #", _error, keywd);
     // get the delimiter off the istream
     char c;
-    in->get(c);
+    in.get(c);
 
     if(!strncmp(const_cast<char *>(keywd.c_str()), "ISO-10303-21",
                 strlen(const_cast<char *>(keywd.c_str())))) {
@@ -1668,11 +2541,33 @@ Severity STEPfile::AppendFile(istream *in, bool useTechCor)
         _error.GreaterSeverity(SEVERITY_INPUT_ERROR);
         return SEVERITY_INPUT_ERROR;
     }
+    return SEVERITY_NULL;
+}
+
+Severity STEPfile::AppendFile(istream *in, bool useTechCor)
+{
+    Severity rval = SEVERITY_NULL;
+    char errbuf[BUFSIZ];
+
+    SetFileIdIncrement();
+    int total_insts = 0,  valid_insts = 0;
+
+    // only the records of a read into an empty InstMgr are noted
+    _noteRecords = false;
+    if(FileIdIncr() == 0) {
+        _sourceRecords.clear();
+    }
+
+    if(ReadFileType(*in) == SEVERITY_INPUT_ERROR) {
+        return SEVERITY_INPUT_ERROR;
+    }
 
     cout << "Reading Data from " << ((FileName().compare("-") == 0) ? "standard input" : FileName().c_str()) << "...\n";
 
     //  Read header
+    NotifyPhaseBegin("header", *in);
     rval = ReadHeader(*in);
+    NotifyPhaseEnd("header", *in);
     cout << "\nHEADER read:";
     if(rval < SEVERITY_WARNING) {
         sprintf(errbuf,
@@ -1694,9 +2589,85 @@ Severity STEPfile::AppendFile(istream *in, bool useTechCor)
         return SEVERITY_INPUT_ERROR;
     }
 
+    if(_keepSourceRecords && (FileIdIncr() == 0) && (_fileType != WORKING_SESSION) &&
+            FileStamp(FileName(), _sourceSize, _sourceTime)) {
+        _sourceName = FileName();
+        _noteRecords = true;
+    }
+
+    if(_deferredRead && (_fileType != WORKING_SESSION)) {
+        _deferredReader = new STEPfileDeferredReader(instances(), schemaName(), FileIdIncr(),
+                useTechCor, _strict);
+        instances().AdoptDeferredReader(_deferredReader);
+        NotifyPhaseBegin("data", *in);
+        total_insts = ReadData1(*in);
+        _deferredReader = 0;
+        if(_cancelRead) {
+            _wholeRecords.clear();
+            return SEVERITY_EXIT;
+        }
+        // the instances whose read is deferred are counted as valid
+        _entsInvalid = 0;
+        _entsIncomplete = 0;
+        _entsWarning = 0;
+        valid_insts = total_insts - static_cast<int>(_wholeRecords.size());
+        valid_insts += ReadDeferredRecords(useTechCor);
+        NotifyPhaseEnd("data", *in);
+        return ReadEndOfFile(*in, total_insts, valid_insts, "\nDEFERRED READ complete:  ");
+    }
+
+    if((_parallelRead > 1) && (_fileType != WORKING_SESSION)) {
+        // every record is read by the second pass, so the reader only lives for the read
+        STEPfileDeferredReader reader(instances(), schemaName(), FileIdIncr(), useTechCor, _strict);
+        _errorCount = 0;
+        long begin = in->good() ? (long) in->tellg() : -1;
+        _deferredReader = &reader;
+        NotifyPhaseBegin("pass1", begin);
+        total_insts = ReadData1(*in);
+        NotifyPhaseEnd("pass1", *in);
+        _deferredReader = 0;
+        if(_cancelRead) {
+            reader.Discard();
+            _wholeRecords.clear();
+            return SEVERITY_EXIT;
+        }
+
+        cout << "\nFIRST PASS complete:  " << total_insts
+             << " instances created.\n";
+        sprintf(errbuf,
+                "  %d  ERRORS\t  %d  WARNINGS\n\n",
+                _errorCount, _warningCount);
+        cout << errbuf;
+
+        long end = in->good() ? (long) in->tellg() : -1;
+        NotifyPhaseBegin("pass2", begin);
+        valid_insts = ReadData2Parallel(reader, begin, end, useTechCor);
+        NotifyPhaseEnd("pass2", end);
+        if(_cancelRead) {
+            return SEVERITY_EXIT;
+        }
+        return ReadEndOfFile(*in, total_insts, valid_insts, "\nSECOND PASS complete:  ");
+    }
+
+    if(_onePass && (_fileType != WORKING_SESSION)) {
+        _errorCount = 0;
+        NotifyPhaseBegin("data", *in);
+        valid_insts = ReadDataOnePass(*in, total_insts, useTechCor);
+        NotifyPhaseEnd("data", *in);
+        if(_cancelRead) {
+            return SEVERITY_EXIT;
+        }
+        return ReadEndOfFile(*in, total_insts, valid_insts, "\nONE PASS complete:  ");
+    }
+
     //  PASS 1
     _errorCount = 0;
+    NotifyPhaseBegin("pass1", *in);
     total_insts = ReadData1(*in);
+    NotifyPhaseEnd("pass1", *in);
+    if(_cancelRead) {
+        return SEVERITY_EXIT;
+    }
 
     cout << "\nFIRST PASS complete:  " << total_insts
          << " instances created.\n";
@@ -1733,7 +2704,13 @@ Severity STEPfile::AppendFile(istream *in, bool useTechCor)
         case VERSION_CURRENT:
         case VERSION_UNKNOWN:
         case WORKING_SESSION:
+            NotifyPhaseBegin("pass2", *in2);
             valid_insts = ReadData2(*in2, useTechCor);
+            NotifyPhaseEnd("pass2", *in2);
+            if(_cancelRead) {
+                CloseInputFile(in2);
+                return SEVERITY_EXIT;
+            }
             break;
         default:
             _error.AppendToUserMsg("STEPfile::AppendFile: STEP file version set to unrecognized value.\n");
@@ -1741,17 +2718,81 @@ Severity STEPfile::AppendFile(istream *in, bool useTechCor)
             return  SEVERITY_BUG;
     }
 
+    rval = ReadEndOfFile(*in2, total_insts, valid_insts, "\nSECOND PASS complete:  ");
+    CloseInputFile(in2);
+    return rval;
+}
+
+/**
+ * Called by the read loops after each instance: notifies the read observer of the
+ * progress every READ_PROGRESS_INTERVAL instances, and stops the read if CancelRead()
+ * was called.
+ * \returns true if the read must stop
+ */
+bool STEPfile::ReadInterrupted(const char *phase, int count)
+{
+    if(_cancelRead) {
+        _error.AppendToUserMsg("Read cancelled.\n");
+        _error.GreaterSeverity(SEVERITY_EXIT);
+        return true;
+    }
+    if(_readObserver && (count % READ_PROGRESS_INTERVAL == 0)) {
+        _readObserver->PhaseProgress(phase, (long) _iFileCurrentPosition);
+    }
+    return false;
+}
+
+void STEPfile::NotifyPhaseBegin(const char *phase, istream &in)
+{
+    NotifyPhaseBegin(phase, in.good() ? (long) in.tellg() : -1);
+}
+
+void STEPfile::NotifyPhaseEnd(const char *phase, istream &in)
+{
+    NotifyPhaseEnd(phase, in.good() ? (long) in.tellg() : -1);
+}
+
+void STEPfile::NotifyPhaseBegin(const char *phase, long position)
+{
+    if(_readObserver) {
+        _readObserver->PhaseBegin(phase, position);
+    }
+}
+
+void STEPfile::NotifyPhaseEnd(const char *phase, long position)
+{
+    if(_readObserver) {
+        _readObserver->PhaseEnd(phase, position);
+    }
+}
+
+/**
+ * Reads what follows the DATA section once it has been read, and reports the number
+ * of invalid instances. Shared by the one-pass and two-pass reads of AppendFile().
+ * \param pass prefix of the message reporting the valid instances
+ */
+Severity STEPfile::ReadEndOfFile(istream &in, int total_insts, int valid_insts, const char *pass)
+{
+    char errbuf[BUFSIZ];
+    std::string keywd;
+
+    // reading set the attributes Changed(), but the instances read are not modified
+    if(_noteRecords) {
+        for(size_t i = 0; i < _sourceRecords.size(); i++) {
+            _sourceRecords[i].instance->Modified(false);
+        }
+    }
+
     //check for "ENDSEC;"
-    ReadTokenSeparator(*in2);
+    ReadTokenSeparator(in);
     if(total_insts != valid_insts) {
         sprintf(errbuf, "%d invalid instances in file: %s\n",
                 total_insts - valid_insts, ((FileName().compare("-") == 0) ? "standard input" : FileName().c_str()));
         _error.AppendToUserMsg(errbuf);
-        CloseInputFile(in2);
         return _error.GreaterSeverity(SEVERITY_WARNING);
     }
 
-    cout << "\nSECOND PASS complete:  " << valid_insts
+    cout << pass << valid_insts
          << " instances valid.\n";
     sprintf(errbuf,
             "  %d  ERRORS\t  %d  WARNINGS\n\n",
@@ -1762,25 +2803,23 @@ Severity STEPfile::AppendFile(istream *in, bool useTechCor)
 
     //check for "ENDSTEP;" || "END-ISO-10303-21;"
 
-    if(in2 -> good()) {
-        ReadTokenSeparator(*in2);
-        keywd = GetKeyword(*in2, ";", _error);
+    if(in.good()) {
+        ReadTokenSeparator(in);
+        GetKeyword(in, ";", _error, keywd);
         //yank the ";" from the istream
-        //if (';' == in2->peek()) in2->get();
+        //if (';' == in.peek()) in.get();
         char ch;
-        in2->get(ch);
+        in.get(ch);
         if(ch != ';') {
-            std::cerr << __FILE__ << ":" << __LINE__ << " - Expected ';' at Part 21 EOF, found '" << c << "'." << std::endl;
+            std::cerr << __FILE__ << ":" << __LINE__ << " - Expected ';' at Part 21 EOF, found '" << ch << "'." << std::endl;
         }
     }
 
-    if((!keywd.compare(0, keywd.size(), END_FILE_DELIM)) || !(in2 -> good())) {
+    if((!keywd.compare(0, keywd.size(), END_FILE_DELIM)) || !(in.good())) {
         _error.AppendToUserMsg(END_FILE_DELIM);
         _error.AppendToUserMsg(" missing at end of file.\n");
-        CloseInputFile(in2);
         return _error.GreaterSeverity(SEVERITY_WARNING);
     }
-    CloseInputFile(in2);
     cout << "Finished reading file.\n\n";
     return SEVERITY_NULL;
 }
@@ -21,6 +21,10 @@
 #include <dirobj.h>
 #include <errordesc.h>
 #include <time.h>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <vector>
 
 #include <read_func.h>
 
@@ -28,6 +32,12 @@
 #define READ_COMPLETE    10
 #define READ_INCOMPLETE  20
 
+/// number of instances read between two calls to STEPfileReadObserver::PhaseProgress()
+#define READ_PROGRESS_INTERVAL 1024
+
+/// number of records a thread of a parallel read takes at a time \sa STEPfile::ParallelRead()
+#define PARALLEL_READ_RANGE 256
+
 enum  FileTypeCode {
     VERSION_OLD     = -1,
     VERSION_UNKNOWN =  0,
@@ -35,6 +45,89 @@ enum  FileTypeCode {
     WORKING_SESSION =  2
 };
 
+/** Notified by STEPfile::AppendFile() when it starts and finishes each part of a read:
+ * "header", then "pass1" and "pass2", or "data" for a one-pass or deferred read.
+ * \param position input stream position, -1 when it is not available (e.g. at end of file)
+ * \sa STEPfile::ReadObserver()
+ */
+class SC_EDITOR_EXPORT STEPfileReadObserver
+{
+    public:
+        virtual ~STEPfileReadObserver() {}
+        virtual void PhaseBegin(const char *phase, long position) = 0;
+        virtual void PhaseEnd(const char *phase, long position) = 0;
+        /// called during "pass1", "pass2" and "data", every READ_PROGRESS_INTERVAL instances
+        virtual void PhaseProgress(const char *phase, long position)
+        {
+            (void) phase;
+            (void) position;
+        }
+};
+
+/** The DeferredReader of a file read with STEPfile::DeferredRead(). It keeps the
+ * attribute values of the simple records of the DATA section, and reads those of
+ * an instance into it the first time they are used.
+ */
+class SC_EDITOR_EXPORT STEPfileDeferredReader : public DeferredReader
+{
+    protected:
+        InstMgr &_instances;
+        int _fileIdIncr;
+        bool _useTechCor;
+        bool _strict;
+#ifdef _MSC_VER
+#pragma warning( push )
+#pragma warning( disable: 4251 )
+#endif
+        std::string _schema;
+        std::string _text;                      ///< attribute values of all the deferred records
+        std::deque<DeferredRecord> _records;
+        std::recursive_mutex _mutex;            ///< reading an instance may read those it refers to
+#ifdef _MSC_VER
+#pragma warning( pop )
+#endif
+
+        /// reads the attributes of record->instance from the kept text
+        Severity ReadText(DeferredRecord *record);
+
+    public:
+        STEPfileDeferredReader(InstMgr &instances, const std::string &schema, int fileIdIncr,
+                               bool useTechCor, bool strict);
+
+        /// keep the rest of the record of inst, read from in up to and including the semicolon
+        void Defer(SDAI_Application_instance *inst, istream &in);
+        virtual void Read(DeferredRecord *record);
+
+        /// number of instances whose attributes haven't been read yet
+        size_t DeferredCount();
+
+        /// number of records kept by Defer(), in the order of the file
+        size_t RecordCount() const
+        {
+            return _records.size();
+        }
+        SDAI_Application_instance *RecordInstance(size_t i) const
+        {
+            return _records[i].instance;
+        }
+        /** reads the attributes of the i-th record as Read() does, but without the lock and
+         * without changing the state of the instance's MgrNode. Threads may read different
+         * records at once, as long as nothing else uses their instances meanwhile.
+         * \returns the severity of the read, also kept in the Error() of the instance
+         */
+        Severity ReadRecord(size_t i);
+        /// leaves the instances that haven't been read yet as they are, no longer deferred
+        void Discard();
+};
+
+/// where the record of an instance is in the file it was read from \sa STEPfile::KeepSourceRecords()
+struct STEPfileSourceRecord {
+    SDAI_Application_instance *instance;
+    int fileId;                 ///< the id of the instance when it was read
+    std::streamoff begin;       ///< of the '#'
+    std::streamoff end;         ///< after the ';'
+};
+
 class SC_EDITOR_EXPORT STEPfile
 {
     protected:
@@ -55,7 +148,7 @@ class SC_EDITOR_EXPORT STEPfile
 
 //header information
         InstMgr *_headerInstances;
-        Registry *_headerRegistry;
+        Registry *_headerRegistry; ///< not owned, see SharedRegistry()
 
         int _headerId;     ///< STEPfile_id given to SDAI_Application_instance from header section
 
@@ -70,11 +163,22 @@ class SC_EDITOR_EXPORT STEPfile
         //the following are used to compute read/write progress
         std::ifstream::pos_type _iFileSize; ///< input file size
         std::ifstream::pos_type _iFileCurrentPosition; ///< input file position (from ifstream::tellg())
+        std::atomic<bool> _cancelRead; ///< set by CancelRead(), checked after each instance
+        std::vector<std::string> _wholeRecords; ///< complex and scoped records of a deferred read, see ReadDeferredRecords()
+
+        //the following are used to copy unchanged records, see KeepSourceRecords()
+        std::string _sourceName;    ///< file the records were read from
+        long long _sourceSize;      ///< of _sourceName when it was read
+        long long _sourceTime;      ///< modification time of _sourceName when it was read
+        std::vector<STEPfileSourceRecord> _sourceRecords; ///< sorted by fileId
 #ifdef _MSC_VER
 #pragma warning( pop )
 #endif
         bool _iFileStage1Done; ///< set immediately before ReadData1() returns
         int _oFileInstsWritten; ///< number of instances that have been written
+        int _oFileRecordsCopied; ///< number of instances whose record was copied by the last write
+        bool _keepSourceRecords; ///< Defaults to false; see KeepSourceRecords()
+        bool _noteRecords;  ///< set during a read whose records are noted by NoteSourceRecord()
 
 //error information
         ErrorDescriptor _error;
@@ -96,6 +200,11 @@ class SC_EDITOR_EXPORT STEPfile
 
         bool _strict;       ///< If false, "missing and required" attributes are replaced with a generic value when file is read
         bool _verbose;      ///< Defaults to false; if true, info is always printed to stdout.
+        bool _onePass;      ///< Defaults to false; if true, exchange files are read in one pass, see ReadDataOnePass()
+        bool _deferredRead; ///< Defaults to false; if true, the attributes of exchange files are read on first use
+        unsigned int _parallelRead; ///< Defaults to 0; if more than 1, the threads of the second pass, see ParallelRead()
+        STEPfileDeferredReader *_deferredReader; ///< set during a deferred or parallel read; owned by the InstMgr, or by AppendFile()
+        STEPfileReadObserver *_readObserver; ///< not owned, may be null
 
     protected:
 
@@ -173,8 +282,97 @@ class SC_EDITOR_EXPORT STEPfile
         Severity ReadWorkingFile(const std::string filename = "", bool useTechCor = 1);
         Severity AppendWorkingFile(const std::string filename = "", bool useTechCor = 1);
 
+        /** reads only the HEADER section of a file into HeaderInstances(); the reading stops at the
+         * end of the section, so the time doesn't depend on the size of the file. The instances and
+         * the registry of the schema are left alone.
+         */
+        Severity ReadExchangeHeader(const std::string filename = "");
+
         Severity AppendFile(istream *in, bool useTechCor = 1) ;
 
+        /// if true, exchange files are read in a single pass; working session files always take two
+        void OnePassRead(bool onePass)
+        {
+            _onePass = onePass;
+        }
+        bool OnePassRead() const
+        {
+            return _onePass;
+        }
+
+        /** if true, exchange files are read in a single pass that creates the instances and keeps
+         * the text of their records; the attributes of an instance are read the first time they are
+         * used, through the generated access functions or STEPattributeList. Complex and scoped
+         * instances are read at the end of the pass. Errors in the attribute values are then
+         * reported by the Error() of the instance, not by the read. Takes precedence over OnePassRead().
+         */
+        void DeferredRead(bool deferred)
+        {
+            _deferredRead = deferred;
+        }
+        bool DeferredRead() const
+        {
+            return _deferredRead;
+        }
+
+        /** if threads > 1, exchange files are read in two passes, the second on that many threads.
+         * The first pass creates the instances and keeps the text of their records, as a deferred
+         * read does. The second reads the attributes of the simple records: each thread takes the
+         * next PARALLEL_READ_RANGE records, and references are looked up in the instances created
+         * by the first pass. The errors are then reported and counted in the order of the file, as
+         * ReadData2() would; complex and scoped records are read last, on the calling thread. Each
+         * record is read from its own text, so a damaged record can't make the next one fail.
+         * DeferredRead() takes precedence; this takes precedence over OnePassRead().
+         */
+        void ParallelRead(unsigned int threads)
+        {
+            _parallelRead = threads;
+        }
+        unsigned int ParallelRead() const
+        {
+            return _parallelRead;
+        }
+
+        /** if true, the reads of exchange files note where the record of each instance is in the
+         * file. WriteExchangeFile() then copies the record of each instance that isn't Modified()
+         * from the file, if the file is unchanged (same size and modification time, which is to the
+         * nanosecond where stat() gives it), instead of writing its values. A record that
+         * refers to an instance whose id changed, or that is no longer in the InstMgr, is written
+         * from its values. Writing over the file renames it first with the suffix ".bak", and the
+         * records are copied from there. Only the reads into an empty InstMgr note the records.
+         */
+        void KeepSourceRecords(bool keep)
+        {
+            _keepSourceRecords = keep;
+        }
+        bool KeepSourceRecords() const
+        {
+            return _keepSourceRecords;
+        }
+        /// number of instances whose record was copied from the file by the last write
+        int RecordsCopied() const
+        {
+            return _oFileRecordsCopied;
+        }
+
+        /** stop a read in progress at the next instance boundary; the read returns SEVERITY_EXIT.
+         * May be called from another thread. The request stays until CancelRead(false).
+         */
+        void CancelRead(bool cancel = true)
+        {
+            _cancelRead = cancel;
+        }
+        bool ReadCancelled() const
+        {
+            return _cancelRead;
+        }
+
+        /// set an observer of the phases of AppendFile(), or null; the observer isn't owned
+        void ReadObserver(STEPfileReadObserver *observer)
+        {
+            _readObserver = observer;
+        }
+
         Severity WriteExchangeFile(ostream &out, int validate = 1,
                                    int clearError = 1, int writeComments = 1);
         Severity WriteExchangeFile(const std::string filename = "", int validate = 1,
@@ -203,6 +401,8 @@ class SC_EDITOR_EXPORT STEPfile
         istream *OpenInputFile(const std::string filename = "");
         void CloseInputFile(istream *in);
 
+        /// reads the keyword that starts the file, and sets the FileType() from it
+        Severity ReadFileType(istream &in);
         Severity ReadHeader(istream &in);
 
         Severity HeaderVerifyInstances(InstMgr *im);
@@ -211,8 +411,21 @@ class SC_EDITOR_EXPORT STEPfile
         int HeaderId(int increment = 1);
         int HeaderId(const char *nm = "\0");
 
+        bool ReadInterrupted(const char *phase, int count);
+        void NotifyPhaseBegin(const char *phase, istream &in);
+        void NotifyPhaseEnd(const char *phase, istream &in);
+        void NotifyPhaseBegin(const char *phase, long position);
+        void NotifyPhaseEnd(const char *phase, long position);
+
         int ReadData1(istream &in);    /**< First pass, to create instances */
         int ReadData2(istream &in, bool useTechCor = true);    /**< Second pass, to read instances */
+        /// Second pass of ParallelRead(), from the records kept by ReadData1(); begin and end delimit the DATA section
+        int ReadData2Parallel(STEPfileDeferredReader &reader, long begin, long end, bool useTechCor = true);
+
+        /// Single pass, to create and read instances; references are resolved by ResolveForwardRefs()
+        int ReadDataOnePass(istream &in, int &total, bool useTechCor = true);
+        void ResolveForwardRefs();
+        Severity ReadEndOfFile(istream &in, int total_insts, int valid_insts, const char *pass);
 
 // obsolete
         int ReadWorkingData1(istream &in);
@@ -220,8 +433,22 @@ class SC_EDITOR_EXPORT STEPfile
 
         void ReadRestOfFile(istream &in);
 
+        void NoteSourceRecord(SDAI_Application_instance *obj, std::streamoff begin, std::streamoff end);
+        bool SourceUnchanged() const;
+        const STEPfileSourceRecord *SourceRecord(int fileId) const;
+        /// the record of obj if it can be copied as it is from the file it was read from, else empty
+        std::string CopiableRecord(const SDAI_Application_instance *obj, istream &source, std::streamoff &position);
+
         /// create instance - used by ReadData1()
         SDAI_Application_instance    *CreateInstance(istream &in, ostream &out);
+        /// create instance and defer the read of its attributes - used by ReadData1() for a deferred read
+        SDAI_Application_instance    *CreateInstanceDeferred(istream &in, ostream &out, std::string &cmtStr,
+                const std::string &currSch);
+        /// read the records kept whole by CreateInstanceDeferred()
+        int ReadDeferredRecords(bool useTechCor);
+        /// create instance of a simple type - used by CreateInstance() and ReadInstanceOnePass()
+        SDAI_Application_instance    *CreateEntity(const std::string &objnm, const std::string &schnm,
+                ErrorDescriptor &result);
         /// create complex instance - used by CreateInstance()
         SDAI_Application_instance   *CreateSubSuperInstance(istream &in, int fileid,
                 ErrorDescriptor &);
@@ -229,6 +456,11 @@ class SC_EDITOR_EXPORT STEPfile
         // read the instance - used by ReadData2()
         SDAI_Application_instance   *ReadInstance(istream &in, ostream &out,
                 std::string &cmtStr, bool useTechCor = true);
+        /// create and read the instance - used by ReadDataOnePass()
+        SDAI_Application_instance   *ReadInstanceOnePass(istream &in, ostream &out, std::string &cmtStr,
+                const std::string &currSch, bool useTechCor = true);
+        /// sets the MgrNode state from the severity of a read instance
+        void SetInstanceState(MgrNode *node, SDAI_Application_instance *obj, Severity sev);
 
         ///  reading scopes are still incomplete, CreateScopeInstances and ReadScopeInstances are stubs
         Severity CreateScopeInstances(istream &in, SDAI_Application_instance_ptr   **scopelist);
@@ -13,13 +13,13 @@
 
 #include <STEPfile.h>
 #include <SdaiHeaderSchema.h>
+#include <SdaiSchemaInit.h>
 #include <STEPaggregate.h>
 #include <cmath>
 
 #include <cstring>
 #include "sc_memmgr.h"
 
-extern void HeaderSchemaInit(Registry &reg);
 
 //To Be inline functions
 
@@ -27,14 +27,18 @@ extern void HeaderSchemaInit(Registry &reg);
 
 STEPfile::STEPfile(Registry &r, InstMgr &i, const std::string filename, bool strict) :
     _instances(i), _reg(r), _fileIdIncr(0), _headerId(0), _iFileSize(0),
-    _iFileCurrentPosition(0), _iFileStage1Done(false), _oFileInstsWritten(0),
+    _iFileCurrentPosition(0), _cancelRead(false), _sourceSize(0), _sourceTime(0),
+    _iFileStage1Done(false), _oFileInstsWritten(0),
+    _oFileRecordsCopied(0), _keepSourceRecords(false), _noteRecords(false),
     _entsNotCreated(0), _entsInvalid(0), _entsIncomplete(0), _entsWarning(0),
-    _errorCount(0), _warningCount(0), _maxErrorCount(100000), _strict(strict)
+    _errorCount(0), _warningCount(0), _maxErrorCount(100000), _strict(strict),
+    _verbose(false), _onePass(false), _deferredRead(false), _parallelRead(0),
+    _deferredReader(0), _readObserver(0)
 {
     SetFileType(VERSION_CURRENT);
     SetFileIdIncrement();
-    _currentDir = new DirObj("");
-    _headerRegistry = new Registry(HeaderSchemaInit);
+    _currentDir = 0;    // the directory is listed by the first OpenOutputFile()
+    _headerRegistry = SharedRegistry(HeaderSchemaInit);
     _headerInstances = new InstMgr;
     if(!filename.empty()) {
         ReadExchangeFile(filename);
@@ -45,8 +49,6 @@ STEPfile::~STEPfile()
 {
     delete _currentDir;
 
-    delete _headerRegistry;
-
     _headerInstances->DeleteInstances();
     delete _headerInstances;
 }
@@ -124,6 +126,30 @@ Severity STEPfile::ReadExchangeFile(const std::string filename, bool useTechCor)
     return rval;
 }
 
+Severity STEPfile::ReadExchangeHeader(const std::string filename)
+{
+    _error.ClearErrorMsg();
+    _errorCount = 0;
+    istream *in = OpenInputFile(filename);
+    if(_error.severity() < SEVERITY_WARNING) {
+        CloseInputFile(in);
+        return _error.severity();
+    }
+
+    if(_headerInstances) {
+        _headerInstances->ClearInstances();
+    }
+    _headerId = 5;
+    Severity rval = ReadFileType(*in);
+    if(rval != SEVERITY_INPUT_ERROR) {
+        NotifyPhaseBegin("header", *in);
+        rval = ReadHeader(*in);
+        NotifyPhaseEnd("header", *in);
+    }
+    CloseInputFile(in);
+    return rval;
+}
+
 Severity STEPfile::AppendExchangeFile(const std::string filename, bool useTechCor)
 {
     _error.ClearErrorMsg();
@@ -249,6 +275,9 @@ ofstream *STEPfile::OpenOutputFile(std::string filename)
         }
     }
 
+    if(!_currentDir) {
+        _currentDir = new DirObj("");
+    }
     if(_currentDir->FileExists(TruncFileName(filename))) {
         MakeBackupFile();
     }
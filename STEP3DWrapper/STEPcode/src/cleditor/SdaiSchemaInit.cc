@@ -5,6 +5,8 @@
 // regenerate it.
 
 #include <SdaiSchemaInit.h>
+#include <map>
+#include <mutex>
 #include "sc_memmgr.h"
 
 void HeaderSchemaInit(Registry &reg)
@@ -14,4 +16,17 @@ void HeaderSchemaInit(Registry &reg)
     reg.SetCompCollect(0);
 }
 
+Registry *SharedRegistry(CF_init initFunct)
+{
+    static std::mutex sharedMutex;
+    static std::map<CF_init, Registry *> shared;
+
+    std::lock_guard<std::mutex> lock(sharedMutex);
+    Registry *&reg = shared[initFunct];
+    if(!reg) {
+        reg = new Registry(initFunct);
+    }
+    return reg;
+}
+
 #endif
@@ -24,4 +24,11 @@ SC_EDITOR_EXPORT void HeaderSchemaInit(Registry &);
 SC_EDITOR_EXPORT void HeaderInitSchemasAndEnts(Registry &);
 SC_EDITOR_EXPORT void SdaiHEADER_SECTION_SCHEMAInit(Registry &r);
 
+/// Registry built by initFunct on first use and shared by the whole process.
+/// Building another registry of the same schema reassigns the global
+/// descriptors the shared one relies on, and deleting it leaves them dangling,
+/// so code reading with a shared registry should get all its registries here.
+/// The readers get the header section registry as SharedRegistry(HeaderSchemaInit).
+SC_EDITOR_EXPORT Registry *SharedRegistry(CF_init initFunct);
+
 #endif
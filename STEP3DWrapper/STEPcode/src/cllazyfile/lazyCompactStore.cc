@@ -0,0 +1,307 @@
+#include <algorithm>
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lazyCompactStore.h"
+#include "lazyInstMgr.h"
+#include "Str.h"
+
+size_t compactTable::find(instanceID id) const
+{
+    std::vector< instanceID >::const_iterator it = std::lower_bound(_ids.begin(), _ids.end(), id);
+    if(it == _ids.end() || *it != id) {
+        return npos;
+    }
+    return it - _ids.begin();
+}
+
+size_t compactTable::skipValue(size_t pos) const
+{
+    if(_kinds[pos] == compactTyped) {
+        pos++;
+    }
+    if(_kinds[pos] == compactListBegin) {
+        int depth = 0;
+        do {
+            if(_kinds[pos] == compactListBegin) {
+                depth++;
+            } else if(_kinds[pos] == compactListEnd) {
+                depth--;
+            }
+            pos++;
+        } while(depth > 0);
+        return pos;
+    }
+    return pos + 1;
+}
+
+size_t compactTable::attribute(size_t row, unsigned int attr) const
+{
+    size_t pos = _rowStart[row], end = _rowStart[row + 1];
+    for(unsigned int n = 0; pos < end; n++) {
+        if(n == attr) {
+            return pos;
+        }
+        pos = skipValue(pos);
+    }
+    return npos;
+}
+
+unsigned int compactTable::attributeCount(size_t row) const
+{
+    size_t pos = _rowStart[row], end = _rowStart[row + 1];
+    unsigned int n = 0;
+    for(; pos < end; n++) {
+        pos = skipValue(pos);
+    }
+    return n;
+}
+
+unsigned int compactTable::coordinates(size_t row, double *coords, unsigned int max) const
+{
+    size_t pos = _rowStart[row], end = _rowStart[row + 1];
+    while(pos < end && _kinds[pos] != compactListBegin) {
+        pos++;
+    }
+    unsigned int n = 0;
+    for(pos++; pos < end && (_kinds[pos] == compactReal || _kinds[pos] == compactInteger); pos++, n++) {
+        if(n < max) {
+            coords[n] = real(pos);
+        }
+    }
+    return n;
+}
+
+void compactTable::references(size_t row, instanceRefs &refs) const
+{
+    for(size_t pos = _rowStart[row]; pos < _rowStart[row + 1]; pos++) {
+        if(_kinds[pos] == compactReference) {
+            refs.push_back(reference(pos));
+        }
+    }
+}
+
+size_t compactTable::memoryUsage() const
+{
+    size_t bytes = sizeof(*this) + _ids.capacity() * sizeof(instanceID) + _rowStart.capacity() * sizeof(unsigned int)
+                   + _kinds.capacity() + _values.capacity() * sizeof(compactValue) + _strings.capacity() * sizeof(std::string);
+    std::vector< std::string >::const_iterator it;
+    for(it = _strings.begin(); it != _strings.end(); ++it) {
+        bytes += it->capacity();
+    }
+    return bytes;
+}
+
+bool compactTable::addRow(instanceID id, const std::string &params, std::map< std::string, size_t > &strings)
+{
+    size_t values = _kinds.size(), i = 1, end = params.size() - 1, stringEnd;
+    int depth = 0;
+    bool valid = (params.size() >= 2 && params[0] == '(' && params[end] == ')');
+    const char *text = params.c_str();
+    char *next;
+    compactValue v;
+    while(valid && i < end) {
+        char c = text[i];
+        unsigned char kind = compactUnset;
+        v.integer = 0;
+        if(isspace(c) || c == ',') {
+            i++;
+            continue;
+        }
+        switch(c) {
+            case '(':
+                kind = compactListBegin;
+                depth++;
+                i++;
+                break;
+            case ')':
+                kind = compactListEnd;
+                valid = (depth-- > 0);
+                i++;
+                break;
+            case '#':
+                kind = compactReference;
+                v.integer = strtoll(text + i + 1, &next, 10);
+                valid = (next != text + i + 1);
+                i = next - text;
+                break;
+            case '$':
+                kind = compactUnset;
+                i++;
+                break;
+            case '*':
+                kind = compactDerived;
+                i++;
+                break;
+            case '\'':
+            case '"':
+            case '.':
+                // the text up to the closing delimiter; quotes in a string are doubled
+                stringEnd = i + 1;
+                while(stringEnd < end && (text[stringEnd] != c || (c == '\'' && text[stringEnd + 1] == '\''))) {
+                    stringEnd += (text[stringEnd] == c) ? 2 : 1;
+                }
+                valid = (stringEnd < end);
+                if(c == '.' && stringEnd == i + 2 && strchr("FTU", text[i + 1])) {
+                    kind = compactLogical;
+                    v.integer = (text[i + 1] == 'F') ? 0 : ((text[i + 1] == 'T') ? 1 : 2);
+                } else {
+                    kind = (c == '.') ? compactEnumeration : compactString;
+                    std::map< std::string, size_t >::iterator it;
+                    it = strings.insert(std::make_pair(params.substr(i + 1, stringEnd - i - 1), _strings.size())).first;
+                    if(it->second == _strings.size()) {
+                        _strings.push_back(it->first);
+                    }
+                    v.integer = it->second;
+                }
+                i = stringEnd + 1;
+                break;
+            default:
+                if(isdigit(c) || c == '-' || c == '+') {
+                    v.integer = strtoll(text + i, &next, 10);
+                    kind = compactInteger;
+                    if(*next == '.' || *next == 'E' || *next == 'e') {
+                        v.real = StrToReal(text + i, &next);
+                        kind = compactReal;
+                    }
+                    valid = (next != text + i);
+                    i = next - text;
+                } else if(isupper(c) || c == '_') {
+                    stringEnd = i;
+                    while(isupper(text[stringEnd]) || isdigit(text[stringEnd]) || text[stringEnd] == '_' || text[stringEnd] == '-') {
+                        stringEnd++;
+                    }
+                    kind = compactTyped;
+                    std::map< std::string, size_t >::iterator it;
+                    it = strings.insert(std::make_pair(params.substr(i, stringEnd - i), _strings.size())).first;
+                    if(it->second == _strings.size()) {
+                        _strings.push_back(it->first);
+                    }
+                    v.integer = it->second;
+                    i = stringEnd;
+                } else {
+                    valid = false;
+                }
+                break;
+        }
+        if(valid) {
+            _kinds.push_back(kind);
+            _values.push_back(v);
+        }
+    }
+    if(!valid || depth != 0) {
+        _kinds.resize(values);
+        _values.resize(values);
+        return false;
+    }
+    _ids.push_back(id);
+    _rowStart.push_back((unsigned int) _kinds.size());
+    return true;
+}
+
+lazyCompactStore::lazyCompactStore(lazyInstMgr *mgr): _mgr(mgr), _skipped(0)
+{
+}
+
+lazyCompactStore::~lazyCompactStore()
+{
+    std::vector< compactTable * >::iterator it;
+    for(it = _tables.begin(); it != _tables.end(); ++it) {
+        delete *it;
+    }
+}
+
+size_t lazyCompactStore::addType(const std::string &type)
+{
+    std::string name(type);
+    std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+    const compactTable *existing = table(name);
+    if(existing) {
+        return existing->size();
+    }
+    compactTable *t = new compactTable(name);
+    _tables.push_back(t);
+
+    instanceTypes_t::cvector *v = _mgr->getInstances(name, true);
+    if(!v) {
+        return 0;
+    }
+    std::vector< instanceID > ids(v->begin(), v->end());
+    std::sort(ids.begin(), ids.end());
+    t->_ids.reserve(ids.size());
+    t->_rowStart.reserve(ids.size() + 1);
+
+    std::map< std::string, size_t > strings;
+    std::string params;
+    std::vector< instanceID >::const_iterator it;
+    for(it = ids.begin(); it != ids.end(); ++it) {
+        if(!_mgr->parametersFromFile(*it, params) || !t->addRow(*it, params, strings)) {
+            _skipped++;
+        }
+    }
+    return t->size();
+}
+
+size_t lazyCompactStore::addGeometricTypes()
+{
+    static const char *types[] = {
+        "CARTESIAN_POINT", "DIRECTION", "VECTOR", "EDGE_CURVE", "ORIENTED_EDGE",
+        "FACE_BOUND", "FACE_OUTER_BOUND", "B_SPLINE_SURFACE_WITH_KNOTS", 0
+    };
+    size_t rows = 0;
+    for(int i = 0; types[i]; i++) {
+        rows += addType(types[i]);
+    }
+    return rows;
+}
+
+const compactTable *lazyCompactStore::table(const std::string &type) const
+{
+    std::string name(type);
+    std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+    std::vector< compactTable * >::const_iterator it;
+    for(it = _tables.begin(); it != _tables.end(); ++it) {
+        if((*it)->type() == name) {
+            return *it;
+        }
+    }
+    return 0;
+}
+
+const compactTable *lazyCompactStore::find(instanceID id, size_t &row) const
+{
+    std::vector< compactTable * >::const_iterator it;
+    for(it = _tables.begin(); it != _tables.end(); ++it) {
+        row = (*it)->find(id);
+        if(row != compactTable::npos) {
+            return *it;
+        }
+    }
+    return 0;
+}
+
+SDAI_Application_instance *lazyCompactStore::instance(instanceID id)
+{
+    return _mgr->loadInstance(id);
+}
+
+size_t lazyCompactStore::rowCount() const
+{
+    size_t rows = 0;
+    std::vector< compactTable * >::const_iterator it;
+    for(it = _tables.begin(); it != _tables.end(); ++it) {
+        rows += (*it)->size();
+    }
+    return rows;
+}
+
+size_t lazyCompactStore::memoryUsage() const
+{
+    size_t bytes = sizeof(*this) + _tables.capacity() * sizeof(compactTable *);
+    std::vector< compactTable * >::const_iterator it;
+    for(it = _tables.begin(); it != _tables.end(); ++it) {
+        bytes += (*it)->memoryUsage();
+    }
+    return bytes;
+}
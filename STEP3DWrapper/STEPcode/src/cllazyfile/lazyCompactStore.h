@@ -0,0 +1,200 @@
+#ifndef LAZYCOMPACTSTORE_H
+#define LAZYCOMPACTSTORE_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "lazyTypes.h"
+#include "sc_export.h"
+
+class lazyInstMgr;
+class SDAI_Application_instance;
+
+/// the kind of a value of a compactTable
+enum compactKind {
+    compactListBegin,   ///< '(' - the values up to the matching compactListEnd are the items of a list
+    compactListEnd,     ///< ')'
+    compactReference,   ///< '#123', see compactTable::reference()
+    compactInteger,     ///< see compactTable::integer()
+    compactReal,        ///< see compactTable::real()
+    compactString,      ///< 'text' or "binary", without the delimiters; see compactTable::string()
+    compactEnumeration, ///< '.NAME.', without the dots; see compactTable::string()
+    compactLogical,     ///< '.F.', '.T.' or '.U.' as 0, 1 or 2; see compactTable::integer()
+    compactTyped,       ///< the type of a typed parameter, e.g. LENGTH_MEASURE in LENGTH_MEASURE(1.); a list follows
+    compactUnset,       ///< '$'
+    compactDerived      ///< '*'
+};
+
+/** The instances of one entity type, as packed columns decoded from the file: the instance ids, and the
+ * values of their attributes in file order. Lists are flattened, and delimited by compactListBegin and
+ * compactListEnd values, so the coordinates of a point or the control points of a surface are contiguous.
+ * Strings and enumerations are stored once per table.
+ *
+ * A value is addressed by its position; attribute() gives the position of an attribute of a row.
+ */
+class SC_LAZYFILE_EXPORT compactTable
+{
+    public:
+        static const size_t npos = (size_t) -1;
+
+        /// the type of the instances, as written in the file
+        const std::string &type() const
+        {
+            return _type;
+        }
+
+        /// get the number of instances of the table
+        size_t size() const
+        {
+            return _ids.size();
+        }
+
+        instanceID id(size_t row) const
+        {
+            return _ids[row];
+        }
+
+        /// get the row of an instance, npos if it is not in the table
+        size_t find(instanceID id) const;
+
+        /// get the position of an attribute of a row (counting from 0), npos if the row has fewer attributes
+        size_t attribute(size_t row, unsigned int attr) const;
+
+        /// get the number of attributes of a row
+        unsigned int attributeCount(size_t row) const;
+
+        compactKind kind(size_t pos) const
+        {
+            return (compactKind) _kinds[pos];
+        }
+
+        /// the value of a compactReal, compactInteger or compactLogical
+        double real(size_t pos) const
+        {
+            return (_kinds[pos] == compactReal) ? _values[pos].real : (double) _values[pos].integer;
+        }
+
+        /// the value of a compactInteger or compactLogical
+        long long integer(size_t pos) const
+        {
+            return _values[pos].integer;
+        }
+
+        /// the instance referred to by a compactReference
+        instanceID reference(size_t pos) const
+        {
+            return (instanceID) _values[pos].integer;
+        }
+
+        /// the text of a compactString, compactEnumeration or compactTyped
+        const std::string &string(size_t pos) const
+        {
+            return _strings[(size_t) _values[pos].integer];
+        }
+
+        /** copies the numbers of the first list of a row, i.e. the coordinates of a CARTESIAN_POINT or the
+         * direction ratios of a DIRECTION
+         * \returns the number of coordinates, which may be more than max
+         */
+        unsigned int coordinates(size_t row, double *coords, unsigned int max = 3) const;
+
+        /// appends the instances referred to by a row, in file order
+        void references(size_t row, instanceRefs &refs) const;
+
+        /// get the number of bytes allocated by the table
+        size_t memoryUsage() const;
+
+    protected:
+        friend class lazyCompactStore;
+
+        union compactValue {
+            double real;
+            long long integer;
+        };
+
+#ifdef _MSC_VER
+#pragma warning( push )
+#pragma warning( disable: 4251 )
+#endif
+        std::string _type;
+        std::vector< instanceID > _ids;           ///< ascending
+        std::vector< unsigned int > _rowStart;    ///< position of the first value of each row, and the end of the last row
+        std::vector< unsigned char > _kinds;      ///< a compactKind per value
+        std::vector< compactValue > _values;
+        std::vector< std::string > _strings;
+#ifdef _MSC_VER
+#pragma warning( pop )
+#endif
+
+        compactTable(const std::string &type): _type(type), _rowStart(1, 0) {}
+
+        /// get the position following a value; a list or a typed parameter is skipped as a whole
+        size_t skipValue(size_t pos) const;
+
+        /** decodes the parameter list of an instance into a new row
+         * \param strings the position of each text in _strings
+         * \returns false if the parameters are malformed; the table is left unchanged
+         */
+        bool addRow(instanceID id, const std::string &params, std::map< std::string, size_t > &strings);
+};
+
+/** An optional store for the instances of a lazyInstMgr that are by far the most numerous in B-rep models:
+ * points, directions, edges, loops and surfaces. Instead of loading them as SDAI objects, their attributes
+ * are decoded straight from the file into a compactTable per type, at a small fraction of the memory.
+ *
+ * A caller that needs the SDAI interface of one of them gets it from instance(), which loads it through
+ * the lazyInstMgr; with lazyInstMgr::setInstanceBudget() such instances are only kept while in use.
+ * Complex instances are not stored, since their type is not known before they are loaded.
+ */
+class SC_LAZYFILE_EXPORT lazyCompactStore
+{
+    public:
+        lazyCompactStore(lazyInstMgr *mgr);
+        ~lazyCompactStore();
+
+        /** decodes the instances of a type (ignoring case) into a table. Does nothing if the type is already stored.
+         * \returns the number of instances in the table
+         */
+        size_t addType(const std::string &type);
+
+        /// adds CARTESIAN_POINT, DIRECTION, VECTOR, EDGE_CURVE, ORIENTED_EDGE, FACE_BOUND, FACE_OUTER_BOUND and B_SPLINE_SURFACE_WITH_KNOTS
+        size_t addGeometricTypes();
+
+        /// get the table of a type, ignoring case; 0 if it is not stored
+        const compactTable *table(const std::string &type) const;
+
+        /** find the table and row of an instance
+         * \returns 0 if the instance is not stored
+         */
+        const compactTable *find(instanceID id, size_t &row) const;
+
+        /// loads an instance through the lazyInstMgr, for callers that need its SDAI interface
+        SDAI_Application_instance *instance(instanceID id);
+
+        /// get the number of instances stored
+        size_t rowCount() const;
+
+        /// get the number of instances of the stored types that could not be decoded
+        size_t skippedCount() const
+        {
+            return _skipped;
+        }
+
+        /// get the number of bytes allocated by the tables
+        size_t memoryUsage() const;
+
+    protected:
+        lazyInstMgr *_mgr;
+#ifdef _MSC_VER
+#pragma warning( push )
+#pragma warning( disable: 4251 )
+#endif
+        std::vector< compactTable * > _tables;
+#ifdef _MSC_VER
+#pragma warning( pop )
+#endif
+        size_t _skipped;
+};
+
+#endif //LAZYCOMPACTSTORE_H
@@ -10,10 +10,16 @@
 
 lazyInstMgr::lazyInstMgr()
 {
-    _headerRegistry = new Registry(HeaderSchemaInit);
+    _headerRegistry = SharedRegistry(HeaderSchemaInit);
     _instanceTypes = new instanceTypes_t(255);   //NOTE arbitrary max of 255 chars for a type name
     _lazyInstanceCount = 0;
     _loadedInstanceCount = 0;
+    _instanceBudget = 0;
+    _cacheHits = 0;
+    _cacheMisses = 0;
+    _evictedInstanceCount = 0;
+    _loadDepth = 0;
+    _clockHand = 0;
     _longestTypeNameLen = 0;
     _mainRegistry = 0;
     _errors = new ErrorDescriptor();
@@ -22,7 +28,6 @@ lazyInstMgr::lazyInstMgr()
 
 lazyInstMgr::~lazyInstMgr()
 {
-    delete _headerRegistry;
     delete _errors;
     delete _ima;
     //loop over files, sections, instances; delete header instances
@@ -35,6 +40,7 @@ lazyInstMgr::~lazyInstMgr()
         delete *sit;
     }
     _instancesLoaded.clear();
+    _instanceSlots.clear();
     _instanceStreamPos.clear();
 }
 
@@ -76,9 +82,9 @@ void lazyInstMgr::addLazyInstance(namedLazyInstance inst)
                 //reverse refs
                 _revInstanceRefs.insert(*it, inst.loc.instance);
             }
-        } else {
-            delete inst.refs;
         }
+        // the refs have been copied into the arrays
+        delete inst.refs;
     }
 }
 
@@ -117,11 +123,19 @@ SDAI_Application_instance *lazyInstMgr::loadInstance(instanceID id, bool reSeek)
     assert(_mainRegistry && "Main registry has not been initialized. Do so with initRegistry() or setRegistry().");
     std::streampos oldPos;
     positionAndSection ps;
-    sectionID sid;
+    sectionID sid = 0;
+    bool seeked = false;
     SDAI_Application_instance *inst = _instancesLoaded.find(id);
     if(inst) {
+        _cacheHits++;
+        loadedInstanceSlot *slot = slotOf(id);
+        if(slot) {
+            slot->referenced = true;
+        }
         return inst;
     }
+    _cacheMisses++;
+    _loadDepth++;
     instanceStreamPos_t::cvector *cv;
     if(0 != (cv = _instanceStreamPos.find(id))) {
         switch(cv->size()) {
@@ -136,30 +150,241 @@ SDAI_Application_instance *lazyInstMgr::loadInstance(instanceID id, bool reSeek)
                 assert(_dataSections.size() > sid);
                 if(reSeek) {
                     oldPos = _dataSections[sid]->tellg();
+                    seeked = true;
                 }
                 inst = _dataSections[sid]->getRealInstance(_mainRegistry, off, id);
-                if(reSeek) {
-                    _dataSections[sid]->seekg(oldPos);
-                }
                 break;
             default:
                 std::cerr << "Instance #" << id << " exists in multiple sections. This is not yet supported." << std::endl;
                 break;
         }
         if(!isNilSTEPentity(inst)) {
+            // a reference cycle can load the instance again while it is being read; the last copy is kept
+            if(!slotOf(id)) {
+                loadedInstanceSlot ls = { id, 0, true, false };
+                loadedInstanceSlot *slot;
+                if(_freeSlots.empty()) {
+                    _loadedSlots.push_back(ls);
+                    slot = &_loadedSlots.back();
+                } else {
+                    slot = _freeSlots.back();
+                    _freeSlots.pop_back();
+                    *slot = ls;
+                }
+                _instanceSlots.insert(id, slot);
+                _loadedInstanceCount++;
+            }
             _instancesLoaded.insert(id, inst);
-            _loadedInstanceCount++;
             lazyRefs lr(this, inst);
             lazyRefs::referentInstances_t insts = lr.result();
+            _readInstances.push_back(id);
         } else {
             std::cerr << "Error loading instance #" << id << "." << std::endl;
         }
+        // lazyRefs reads instances too: the position is only restored once it is done
+        if(seeked) {
+            _dataSections[sid]->seekg(oldPos);
+        }
     } else {
         std::cerr << "Instance #" << id << " not found in any section." << std::endl;
     }
+    _loadDepth--;
+    if(_loadDepth == 0) {
+        // an instance read again after an eviction goes back into the inverse attributes
+        for(size_t i = 0; i < _readInstances.size(); i++) {
+            SDAI_Application_instance *read = _instancesLoaded.find(_readInstances[i]);
+            if(read) {
+                linkInverseAttrs(_readInstances[i], read, true);
+            }
+        }
+        _readInstances.clear();
+        if(_instanceBudget && _loadedInstanceCount > _instanceBudget) {
+            evictInstances(id);
+        }
+    }
     return inst;
 }
 
+loadedInstanceSlot *lazyInstMgr::slotOf(instanceID id)
+{
+    return _instanceSlots.find(id);
+}
+
+bool lazyInstMgr::isEvictable(const loadedInstanceSlot &slot)
+{
+    if(slot.pins || slot.modified) {
+        return false;
+    }
+    instanceRefs_t::cvector *refs = _revInstanceRefs.find(slot.instance);
+    if(refs) {
+        instanceRefs_t::cvector::const_iterator it;
+        for(it = refs->begin(); it != refs->end(); ++it) {
+            if(*it != slot.instance && isLoaded(*it)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/// true if the attribute of `referrer` described by `ad` holds `inst`
+static bool attrHolds(SDAI_Application_instance *referrer, const AttrDescriptor *ad, SDAI_Application_instance *inst)
+{
+    for(int i = 0; i < referrer->attributes.list_length(); i++) {
+        STEPattribute &attr = referrer->attributes[i];
+        if(attr.getADesc() != ad || attr.BaseType() != ENTITY_TYPE) {
+            continue;
+        }
+        if(!ad->IsAggrType()) {
+            return attr.Entity() == inst;
+        }
+        EntityAggregate *aggr = dynamic_cast< EntityAggregate * >(attr.Aggregate());
+        EntityNode *en = (EntityNode *)(aggr ? aggr->GetHead() : 0);
+        for(; en; en = (EntityNode *) en->NextNode()) {
+            if(en->node == inst) {
+                return true;
+            }
+        }
+        return false;
+    }
+    return false;
+}
+
+void lazyInstMgr::linkInverseAttrs(instanceID id, SDAI_Application_instance *inst, bool link)
+{
+    instanceRefs_t::cvector *refs = _fwdInstanceRefs.find(id);
+    if(!refs) {
+        return;
+    }
+    instanceRefs_t::cvector::const_iterator it;
+    for(it = refs->begin(); it != refs->end(); ++it) {
+        SDAI_Application_instance *ref = _instancesLoaded.find(*it);
+        if(!ref || ref == inst) {
+            continue;
+        }
+        const SDAI_Application_instance::iAMap_t &iam = ref->getInvAttrs();
+        SDAI_Application_instance::iAMap_t::const_iterator iai;
+        for(iai = iam.begin(); iai != iam.end(); ++iai) {
+            // as in lazyRefs, the inverted attribute tells whether the inverse one is an aggregate
+            const AttrDescriptor *inverted = iai->first->inverted_attr_();
+            if(!inverted || (link && !attrHolds(inst, inverted, ref))) {
+                continue;
+            }
+            iAstruct ias = iai->second;
+            if(!inverted->IsAggrType()) {
+                if(link || ias.i == inst) {
+                    ias.i = link ? inst : 0;
+                    ref->setInvAttr(iai->first, ias);
+                }
+                continue;
+            }
+            // earlier copies of the instance (read again in a reference cycle) are replaced
+            bool found = false;
+            EntityNode *en = (EntityNode *)(ias.a ? ias.a->GetHead() : 0);
+            while(en) {
+                EntityNode *next = (EntityNode *) en->NextNode();
+                if(en->node == inst || en->node->GetFileId() == (int) id) {
+                    if(!link || found) {
+                        ias.a->DeleteNode(en);
+                    } else {
+                        en->node = inst;
+                        found = true;
+                    }
+                }
+                en = next;
+            }
+            if(link && !found) {
+                if(!ias.a) {
+                    ias.a = new EntityAggregate;
+                    ref->setInvAttr(iai->first, ias);
+                }
+                ias.a->AddNode(new EntityNode(inst));
+            }
+        }
+    }
+}
+
+void lazyInstMgr::evictInstance(loadedInstanceSlot &slot, SDAI_Application_instance *inst)
+{
+    // the loaded instances that this one refers to must not keep it in an inverse attribute
+    linkInverseAttrs(slot.instance, inst, false);
+
+    // the aggregates of inverse attributes are created by lazyRefs
+    const SDAI_Application_instance::iAMap_t &iam = inst->getInvAttrs();
+    SDAI_Application_instance::iAMap_t::const_iterator iai;
+    for(iai = iam.begin(); iai != iam.end(); ++iai) {
+        const AttrDescriptor *inverted = iai->first->inverted_attr_();
+        if(inverted && inverted->IsAggrType()) {
+            delete iai->second.a;
+        }
+    }
+    instanceID id = slot.instance;
+    delete inst;
+    _instancesLoaded.removeEntry(id);
+    _instanceSlots.removeEntry(id);
+    _freeSlots.push_back(&slot);
+    slot.instance = 0;
+    _loadedInstanceCount--;
+    _evictedInstanceCount++;
+}
+
+void lazyInstMgr::evictInstances(instanceID keep)
+{
+    const size_t n = _loadedSlots.size();
+    // give up after two turns without an eviction: the rest is pinned, modified or referenced
+    size_t scanned = 0;
+    while(_loadedInstanceCount > _instanceBudget && scanned < 2 * n) {
+        loadedInstanceSlot &slot = _loadedSlots[_clockHand];
+        _clockHand = (_clockHand + 1) % n;
+        scanned++;
+        if(slot.instance == 0 || slot.instance == keep) {
+            continue;
+        }
+        if(slot.referenced) {
+            slot.referenced = false;
+            continue;
+        }
+        if(isEvictable(slot)) {
+            evictInstance(slot, _instancesLoaded.find(slot.instance));
+            scanned = 0;
+        }
+    }
+}
+
+void lazyInstMgr::setInstanceBudget(unsigned long maxLoaded)
+{
+    _instanceBudget = maxLoaded;
+    if(_loadDepth == 0 && _instanceBudget && _loadedInstanceCount > _instanceBudget) {
+        evictInstances();
+    }
+}
+
+SDAI_Application_instance *lazyInstMgr::pinInstance(instanceID id)
+{
+    SDAI_Application_instance *inst = loadInstance(id);
+    loadedInstanceSlot *slot = slotOf(id);
+    if(slot) {
+        slot->pins++;
+    }
+    return inst;
+}
+
+void lazyInstMgr::unpinInstance(instanceID id)
+{
+    loadedInstanceSlot *slot = slotOf(id);
+    if(slot && slot->pins) {
+        slot->pins--;
+    }
+}
+
+void lazyInstMgr::setModified(instanceID id, bool modified)
+{
+    loadedInstanceSlot *slot = slotOf(id);
+    if(slot) {
+        slot->modified = modified;
+    }
+}
+
 
 instanceSet *lazyInstMgr::instanceDependencies(instanceID id)
 {
@@ -51,11 +51,19 @@ class SC_LAZYFILE_EXPORT lazyInstMgr
          */
         instancesLoaded_t _instancesLoaded;
 
+        /** the clock of loaded instances. When more than _instanceBudget are loaded, the hand sweeps
+         * it and evicts instances that were not looked up since its last pass.
+         * \sa instanceSlots_t evictInstances()
+         */
+        loadedInstanceSlots_t _loadedSlots;
+        instanceSlots_t _instanceSlots;
+        std::vector< loadedInstanceSlot * > _freeSlots;
+        size_t _clockHand;
+        /// instances read from the file by the current outermost loadInstance() \sa linkInverseAttrs()
+        instanceRefs _readInstances;
+
         /** map from instance number to beginning and end positions and the data section
          * \sa instanceStreamPos_pair
-         *
-         * FIXME to save memory, modify judyL2Array to not use a vector until there are several
-         * instances with the same instanceID. This will help elsewhere as well.
          */
         instanceStreamPos_t _instanceStreamPos;
 
@@ -67,6 +75,9 @@ class SC_LAZYFILE_EXPORT lazyInstMgr
         ErrorDescriptor *_errors;
 
         unsigned long _lazyInstanceCount, _loadedInstanceCount;
+        unsigned long _instanceBudget; ///< 0 for no limit \sa setInstanceBudget()
+        unsigned long _cacheHits, _cacheMisses, _evictedInstanceCount;
+        int _loadDepth; ///< nesting of loadInstance(); eviction only happens at the outermost level
         int _longestTypeNameLen;
         std::string _longestTypeName;
 
@@ -76,6 +87,26 @@ class SC_LAZYFILE_EXPORT lazyInstMgr
 #pragma warning( pop )
 #endif
 
+        /// the slot of a loaded instance, 0 if it has none
+        loadedInstanceSlot *slotOf(instanceID id);
+
+        /// true if no other loaded instance refers to the instance of `slot`, and it is not pinned or modified
+        bool isEvictable(const loadedInstanceSlot &slot);
+
+        /** adds `inst` to, or removes it from, the inverse attributes of the loaded instances it refers to.
+         * Adding is done once lazyRefs is done with all the instances of the outermost load, and replaces
+         * a copy of `inst` that was read in a reference cycle.
+         */
+        void linkInverseAttrs(instanceID id, SDAI_Application_instance *inst, bool link);
+
+        /// deletes a loaded instance, unlinked from inverse attributes; it will be read again from the file if needed
+        void evictInstance(loadedInstanceSlot &slot, SDAI_Application_instance *inst);
+
+        /** run the clock until no more than _instanceBudget instances are loaded, or nothing else can be evicted
+         * \param keep an instance that must stay loaded, i.e. the one being returned by loadInstance()
+         */
+        void evictInstances(instanceID keep = 0);
+
     public:
         lazyInstMgr();
         ~lazyInstMgr();
@@ -133,6 +164,51 @@ class SC_LAZYFILE_EXPORT lazyInstMgr
             return _loadedInstanceCount;
         }
 
+        /** limit the number of loaded instances. Instances that were not used recently are deleted
+         * by loadInstance() when it goes over the limit, and read again from the file when needed.
+         * A pointer returned by loadInstance() may thus become invalid at the next call; use
+         * pinInstance() to keep an instance loaded.
+         *
+         * The limit is a soft target. Only instances that no other loaded instance refers to are evicted,
+         * so everything a pinned or loaded instance refers to, directly or not, stays loaded whatever the
+         * limit. An evicted instance is removed from the inverse attributes of the instances it refers to,
+         * and put back when it is read again; an inverse attribute thus only holds the loaded instances.
+         * Finding an instance already loaded doesn't evict anything; only reading one from the file does.
+         * \param maxLoaded the maximum number of loaded instances, 0 (the default) for no limit
+         */
+        void setInstanceBudget(unsigned long maxLoaded);
+
+        unsigned long getInstanceBudget() const
+        {
+            return _instanceBudget;
+        }
+
+        /// load an instance and keep it loaded until unpinInstance() is called as many times
+        SDAI_Application_instance *pinInstance(instanceID id);
+
+        void unpinInstance(instanceID id);
+
+        /// an instance that was changed is never evicted, since reading it again would lose the change
+        void setModified(instanceID id, bool modified = true);
+
+        /// get the number of loadInstance() calls that found the instance already loaded
+        unsigned long cacheHits() const
+        {
+            return _cacheHits;
+        }
+
+        /// get the number of loadInstance() calls that read the instance from the file
+        unsigned long cacheMisses() const
+        {
+            return _cacheMisses;
+        }
+
+        /// get the number of instances that were evicted to stay within the budget
+        unsigned long evictedInstanceCount() const
+        {
+            return _evictedInstanceCount;
+        }
+
         /// get the number of data sections that have been identified
         unsigned int countDataSections()
         {
@@ -189,8 +265,8 @@ class SC_LAZYFILE_EXPORT lazyInstMgr
         instanceSet *instanceDependencies(instanceID id);
         bool isLoaded(instanceID id)
         {
-            _instancesLoaded.find(id);
-            return _instancesLoaded.success();
+            // an evicted instance can leave its key behind, with no value
+            return _instancesLoaded.find(id) != 0;
         }
 
         const char *typeFromFile(instanceID id)
@@ -212,6 +288,38 @@ class SC_LAZYFILE_EXPORT lazyInstMgr
             return 0;
         }
 
+        /** returns the offset of an instance in the file, as recorded while indexing. The offset is the
+         * result of tellg() before reading the instanceID, so it may point at whitespace or comments.
+         * \returns -1 if the instance is unknown or exists in more than one section
+         */
+        long int streamPosFromFile(instanceID id)
+        {
+            instanceStreamPos_t::cvector *cv;
+            cv = _instanceStreamPos.find(id);
+            if(!cv || cv->size() != 1) {
+                return -1;
+            }
+            positionAndSection ps = cv->at(0);
+            return (long int)(ps & 0xFFFFFFFFFFFFULL);
+        }
+
+        /** copies the parameter list of an instance from the file without loading it
+         * \sa sectionReader::getParameters()
+         * \returns false if the instance is unknown, exists in more than one section, or is not a simple instance
+         */
+        bool parametersFromFile(instanceID id, std::string &params)
+        {
+            instanceStreamPos_t::cvector *cv;
+            cv = _instanceStreamPos.find(id);
+            if(!cv || cv->size() != 1) {
+                return false;
+            }
+            positionAndSection ps = cv->at(0);
+            long int off = ps & 0xFFFFFFFFFFFFULL;
+            sectionID sid = ps >> 48;
+            return _dataSections[sid]->getParameters(off, params);
+        }
+
         // TODO implement these
 
         // add another schema to registry
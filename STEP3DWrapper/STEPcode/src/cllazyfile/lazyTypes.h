@@ -5,6 +5,7 @@
 
 #include <iostream>
 #include <vector>
+#include <deque>
 #include <set>
 
 #ifdef HAVE_STDINT_H
@@ -82,6 +83,20 @@ typedef judyLArray< instanceID, SDAI_Application_instance * > instancesLoaded_t;
 // there could be multiple instances with the same ID, but in different files (or different sections of the same file?)
 typedef judyL2Array< instanceID, positionAndSection > instanceStreamPos_t;
 
+/// the eviction state of a loaded instance \sa lazyInstMgr::_loadedSlots
+typedef struct {
+    instanceID instance; ///< 0 if the slot is free
+    unsigned int pins;   ///< pinInstance() calls not yet matched by unpinInstance()
+    bool referenced;     ///< looked up since the clock hand last passed the slot
+    bool modified;       ///< set by lazyInstMgr::setModified(); never evicted
+} loadedInstanceSlot;
+
+// loadedInstanceSlots - the clock of loaded instances; slots are reused once evicted. A deque keeps the slots in place as it grows
+typedef std::deque< loadedInstanceSlot > loadedInstanceSlots_t;
+
+// instanceSlots - map instance id to its slot in loadedInstanceSlots_t
+typedef judyLArray< instanceID, loadedInstanceSlot * > instanceSlots_t;
+
 
 // data sections
 typedef std::vector< lazyDataSectionReader * > dataSectionReaderVec_t;
@@ -16,7 +16,7 @@ void p21HeaderSectionReader::findSectionStart()
 
 p21HeaderSectionReader::p21HeaderSectionReader(lazyFileReader *parent, std::ifstream &file,
         std::streampos start, sectionID sid):
-    headerSectionReader(parent, file, start, sid)
+    headerSectionReader(parent, file, start, sid), _nextFreeInstance(4) // 1-3 are reserved per 10303-21
 {
     findSectionStart();
     findSectionEnd();
@@ -34,7 +34,6 @@ p21HeaderSectionReader::p21HeaderSectionReader(lazyFileReader *parent, std::ifst
 const namedLazyInstance p21HeaderSectionReader::nextInstance()
 {
     namedLazyInstance i;
-    static instanceID nextFreeInstance = 4; // 1-3 are reserved per 10303-21
 
     i.loc.begin = _file.tellg();
     i.loc.section = _sectionID;
@@ -51,7 +50,7 @@ const namedLazyInstance p21HeaderSectionReader::nextInstance()
         } else if(0 == strcmp("FILE_SCHEMA", i.name)) {
             i.loc.instance = 3;
         } else {
-            i.loc.instance = nextFreeInstance++;
+            i.loc.instance = _nextFreeInstance++;
         }
 
         assert(strlen(i.name) > 0);
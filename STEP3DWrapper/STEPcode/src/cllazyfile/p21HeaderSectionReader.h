@@ -15,6 +15,8 @@ class SC_LAZYFILE_EXPORT p21HeaderSectionReader: public headerSectionReader
          * \sa lazyP21DataSectionReader::nextInstance()
          */
         const namedLazyInstance nextInstance();
+    protected:
+        instanceID _nextFreeInstance; ///< next id for header instances other than the 3 reserved ones
 };
 
 #endif //P21HEADERSECTIONREADER_H
@@ -83,19 +83,17 @@ std::streampos sectionReader::findNormalString(const std::string &str, bool semi
 
 
 //NOTE different behavior than const char * GetKeyword( istream & in, const char * delims, ErrorDescriptor & err ) in read_func.cc
-// returns pointer to the contents of a static std::string
+// returns pointer to the contents of _keyword, so readers on other threads do not interfere
 const char *sectionReader::getDelimitedKeyword(const char *delimiters)
 {
-    static std::string str;
     char c;
-    str.clear();
-    str.reserve(100);
+    _keyword.clear();
     skipWS();
     while(c = _file.get(), _file.good()) {
         if(c == '-' || c == '_' || isupper(c) || isdigit(c) ||
-                (c == '!' && str.length() == 0)) {
-            str.append(1, c);
-        } else if((c == '/') && (_file.peek() == '*') && (str.length() == 0)) {
+                (c == '!' && _keyword.length() == 0)) {
+            _keyword.append(1, c);
+        } else if((c == '/') && (_file.peek() == '*') && (_keyword.length() == 0)) {
             //push past comment
             findNormalString("*/");
             skipWS();
@@ -107,10 +105,10 @@ const char *sectionReader::getDelimitedKeyword(const char *delimiters)
     }
     c = _file.peek();
     if(!strchr(delimiters, c)) {
-        std::cerr << SC_CURRENT_FUNCTION << ": missing delimiter. Found " << c << ", expected one of " << delimiters << " at end of keyword " << str << ". File offset: " << _file.tellg() << std::endl;
+        std::cerr << SC_CURRENT_FUNCTION << ": missing delimiter. Found " << c << ", expected one of " << delimiters << " at end of keyword " << _keyword << ". File offset: " << _file.tellg() << std::endl;
         abort();
     }
-    return str.c_str();
+    return _keyword.c_str();
 }
 
 /// search forward in the file for the end of the instance. Start position should
@@ -172,6 +170,62 @@ std::streampos sectionReader::seekInstanceEnd(instanceRefs **refs)
     // new memory: 673340kb; User CPU time: 29890ms; System CPU time: 11650ms
 }
 
+bool sectionReader::getParameters(long int begin, std::string &params)
+{
+    char c;
+    int parenDepth = 0;
+    params.clear();
+    if(begin <= 0) {
+        return false;
+    }
+    _file.seekg(begin);
+    readInstanceNumber();
+    skipWS();
+    const char *type = getDelimitedKeyword(";( /\\");
+    if(type[0] == '\0' || type[0] == '!') {
+        return false;
+    }
+    skipWS();
+    while(c = _file.get(), _file.good()) {
+        switch(c) {
+            case '/':
+                if(_file.peek() == '*') {
+                    findNormalString("*/");
+                    continue;
+                }
+                break;
+            case '\'':
+                // copy the string, with its doubled quotes
+                params.append(1, c);
+                while(c = _file.get(), _file.good()) {
+                    params.append(1, c);
+                    if(c == '\'') {
+                        if(_file.peek() != '\'') {
+                            break;
+                        }
+                        params.append(1, (char) _file.get());
+                    }
+                }
+                continue;
+            case '(':
+                parenDepth++;
+                break;
+            case ')':
+                if(--parenDepth == 0) {
+                    params.append(1, c);
+                    return true;
+                }
+                break;
+            case ';':
+                return false;
+            default:
+                break;
+        }
+        params.append(1, c);
+    }
+    return false;
+}
+
 void sectionReader::locateAllInstances()
 {
     namedLazyInstance inst;
@@ -282,6 +336,8 @@ SDAI_Application_instance *sectionReader::getRealInstance(const Registry *reg, l
         }
     }
 
+    // reading the last instance of the file can leave the stream at its end
+    _file.clear();
     _file.seekg(begin);
     skipWS();
     ReadTokenSeparator(_file, &comment);
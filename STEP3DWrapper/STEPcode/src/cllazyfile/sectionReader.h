@@ -27,6 +27,7 @@ class SC_LAZYFILE_EXPORT sectionReader
 
         std::streampos _sectionStart,  ///< the start of this section as reported by tellg()
             _sectionEnd;               ///< the end of this section as reported by tellg()
+        std::string _keyword;          ///< buffer returned by getDelimitedKeyword()
 #ifdef _MSC_VER
 #pragma warning( pop )
 #endif
@@ -48,6 +49,7 @@ class SC_LAZYFILE_EXPORT sectionReader
         std::streampos findNormalString(const std::string &str, bool semicolon = false);
 
         /** Get a keyword ending with one of delimiters.
+         * \returns a pointer into a buffer of this reader, valid until the next call
          */
         const char *getDelimitedKeyword(const char *delimiters);
 
@@ -108,6 +110,11 @@ class SC_LAZYFILE_EXPORT sectionReader
             return getDelimitedKeyword(";( /\\");
         }
 
+        /** copies the parameter list of a simple instance from the file, parentheses included. Comments are left out.
+         * \returns false for a complex or user-defined instance, or if the record is not terminated
+         */
+        bool getParameters(long int begin, std::string &params);
+
         instanceID readInstanceNumber();
 
         void seekg(std::streampos pos)
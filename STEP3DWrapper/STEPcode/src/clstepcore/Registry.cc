@@ -89,12 +89,12 @@ const EntityDescriptor *Registry::FindEntity(const char *e, const char *schNm, i
         entd = (EntityDescriptor *)SC_HASHfind(primordialSwamp, (char *)e);
     } else {
         entd = (EntityDescriptor *)SC_HASHfind(primordialSwamp,
-                                               (char *)PrettyTmpName(e));
+                                               (char *)PrettyTmpName(e, altName));
     }
     if(entd && schNm) {
         // We've now found an entity.  If schNm has a value, we must ensure we
         // have a valid name.
-        strcpy(schformat, PrettyTmpName(schNm));
+        PrettyTmpName(schNm, schformat);
         if(((altlist = entd->AltNameList()) != 0)
                 && (altlist->rename(schformat, altName))) {
             // If entd has other name choices, and entd is referred to with a
@@ -122,21 +122,23 @@ const EntityDescriptor *Registry::FindEntity(const char *e, const char *schNm, i
 
 const Schema *Registry::FindSchema(const char *n, int check_case) const
 {
+    char pretty[BUFSIZ];
     if(check_case) {
         return (const Schema *) SC_HASHfind(active_schemas, (char *) n);
     }
 
     return (const Schema *) SC_HASHfind(active_schemas,
-                                        (char *)PrettyTmpName(n));
+                                        (char *)PrettyTmpName(n, pretty));
 }
 
 const TypeDescriptor *Registry::FindType(const char *n, int check_case) const
 {
+    char pretty[BUFSIZ];
     if(check_case) {
         return (const TypeDescriptor *) SC_HASHfind(active_types, (char *) n);
     }
     return (const TypeDescriptor *) SC_HASHfind(active_types,
-            (char *)PrettyTmpName(n));
+            (char *)PrettyTmpName(n, pretty));
 }
 
 void Registry::ResetTypes()
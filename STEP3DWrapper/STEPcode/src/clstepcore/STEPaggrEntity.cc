@@ -1,5 +1,6 @@
 #include "STEPaggrEntity.h"
 #include "STEPattribute.h"
+#include "instmgr.h"
 #include "typeDescriptor.h"
 #include <sstream>
 
@@ -86,10 +87,12 @@ Severity EntityAggregate::ReadValue(istream &in, ErrorDescriptor *err,
             item->StrToVal(in, &errdesc, elem_type, insts, addFileId);
         }
 
-        elem_type->AttrTypeName(buf);
         // read up to the next delimiter and set errors if garbage is
         // found before specified delims (i.e. comma and quote)
-        CheckRemainingInput(in, &errdesc, buf, ",)");
+        if(!RemainingInputIsClean(in, ",)")) {
+            elem_type->AttrTypeName(buf);
+            CheckRemainingInput(in, &errdesc, buf, ",)");
+        }
 
         if(errdesc.severity() < SEVERITY_INCOMPLETE) {
             sprintf(errmsg, "  index:  %d\n", value_cnt);
@@ -204,8 +207,10 @@ Severity EntityNode::STEPread(istream &in, ErrorDescriptor *err,
                               const TypeDescriptor *elem_type,
                               InstMgrBase *insts, int addFileId)
 {
+    ForwardRef fwd(&node, elem_type);
+    bool deferred;
     SDAI_Application_instance *se = ReadEntityRef(in, err, ",)", insts,
-                                    addFileId);
+                                    addFileId, &fwd, deferred);
     if(se != S_ENTITY_NULL) {
         ErrorDescriptor error;
         if(EntityValidLevel(se, elem_type, &error) == SEVERITY_NULL) {
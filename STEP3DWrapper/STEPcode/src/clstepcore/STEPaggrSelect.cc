@@ -84,10 +84,12 @@ Severity SelectAggregate::ReadValue(istream &in, ErrorDescriptor *err,
             item->StrToVal(in, &errdesc, elem_type, insts, addFileId, currSch);
         }
 
-        elem_type->AttrTypeName(buf);
         // read up to the next delimiter and set errors if garbage is
         // found before specified delims (i.e. comma and quote)
-        CheckRemainingInput(in, &errdesc, buf, ",)");
+        if(!RemainingInputIsClean(in, ",)")) {
+            elem_type->AttrTypeName(buf);
+            CheckRemainingInput(in, &errdesc, buf, ",)");
+        }
 
         if(errdesc.severity() < SEVERITY_INCOMPLETE) {
             sprintf(errmsg, "  index:  %d\n", value_cnt);
@@ -74,8 +74,10 @@ Severity STEPaggregate::AggrValidLevel(const char *value, ErrorDescriptor *err,
     istringstream in((char *)value);     // sz defaults to length of s
 
     ReadValue(in, err, elem_type, insts, addFileId, 0, 0);
-    elem_type->AttrTypeName(buf);
-    CheckRemainingInput(in, err, buf, tokenList);
+    if(!RemainingInputIsClean(in, tokenList)) {
+        elem_type->AttrTypeName(buf);
+        CheckRemainingInput(in, err, buf, tokenList);
+    }
     if(optional && (err->severity() == SEVERITY_INCOMPLETE)) {
         err->severity(SEVERITY_NULL);
     }
@@ -94,8 +96,10 @@ Severity STEPaggregate::AggrValidLevel(istream &in, ErrorDescriptor *err,
     }
 
     ReadValue(in, err, elem_type, insts, addFileId, 0, 1);
-    elem_type->AttrTypeName(buf);
-    CheckRemainingInput(in, err, buf, tokenList);
+    if(!RemainingInputIsClean(in, tokenList)) {
+        elem_type->AttrTypeName(buf);
+        CheckRemainingInput(in, err, buf, tokenList);
+    }
     if(optional && (err->severity() == SEVERITY_INCOMPLETE)) {
         err->severity(SEVERITY_NULL);
     }
@@ -177,8 +181,10 @@ Severity STEPaggregate::ReadValue(istream &in, ErrorDescriptor *err,
 
         // read up to the next delimiter and set errors if garbage is
         // found before specified delims (i.e. comma and quote)
-        elem_type->AttrTypeName(buf);
-        CheckRemainingInput(in, &errdesc, buf, ",)");
+        if(!RemainingInputIsClean(in, ",)")) {
+            elem_type->AttrTypeName(buf);
+            CheckRemainingInput(in, &errdesc, buf, ",)");
+        }
 
         if(errdesc.severity() < SEVERITY_INCOMPLETE) {
             sprintf(errmsg, "  index:  %d\n", value_cnt);
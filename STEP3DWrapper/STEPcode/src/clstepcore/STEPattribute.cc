@@ -41,12 +41,21 @@ const int Real_Num_Precision = REAL_NUM_PRECISION;
 /// the value of the attribute is assigned from the supplied string
 Severity STEPattribute::StrToVal(const char *s, InstMgrBase *instances, int addFileId)
 {
+    _changed = true;
     if(_redefAttr)  {
         return _redefAttr->StrToVal(s, instances, addFileId);
     }
 
-    _error.ClearErrorMsg(); // also sets Severity to SEVERITY_NULL
+    ClearErrorMsg();
+    ErrorDescriptor err;
+    Severity sev = StrToValue(s, &err, instances, addFileId);
+    KeepError(err);
+    return sev;
+}
 
+/// StrToVal() without the redefinition check, recording errors in err
+Severity STEPattribute::StrToValue(const char *s, ErrorDescriptor *err, InstMgrBase *instances, int addFileId)
+{
     //  set the value to be null (reinitialize the attribute value)
     set_null();
 
@@ -57,7 +66,7 @@ Severity STEPattribute::StrToVal(const char *s, InstMgrBase *instances, int addF
         if(nullable || IsDerived()) {   // if it is derived it doesn't
             return SEVERITY_NULL;    // matter if it is null DAS
         } else {
-            _error.severity(SEVERITY_INCOMPLETE);
+            err->severity(SEVERITY_INCOMPLETE);
             return SEVERITY_INCOMPLETE;
         }
     }
@@ -70,7 +79,7 @@ Severity STEPattribute::StrToVal(const char *s, InstMgrBase *instances, int addF
         if(nullable || IsDerived()) {   // if it is derived it doesn't
             return SEVERITY_NULL;    // matter if it is null DAS
         } else  {
-            _error.severity(SEVERITY_INCOMPLETE);
+            err->severity(SEVERITY_INCOMPLETE);
             return SEVERITY_INCOMPLETE;
         }
     }
@@ -90,9 +99,9 @@ Severity STEPattribute::StrToVal(const char *s, InstMgrBase *instances, int addF
                 return SEVERITY_NULL;
             }
         }
-        _error.AppendToDetailMsg(
+        err->AppendToDetailMsg(
             "Derived attribute must have \'*\' for its value.\n");
-        return _error.severity(SEVERITY_INPUT_ERROR);
+        return err->severity(SEVERITY_INPUT_ERROR);
     }
 
     istringstream in((char *)s);     // sz defaults to length of s
@@ -100,23 +109,23 @@ Severity STEPattribute::StrToVal(const char *s, InstMgrBase *instances, int addF
     // read in value for attribute
     switch(NonRefType()) {
         case INTEGER_TYPE: {
-            ReadInteger(*(ptr.i), s, &_error, 0);
+            ReadInteger(*(ptr.i), s, err, 0);
             break;
         }
         case REAL_TYPE: {
-            ReadReal(*(ptr.r), s, &_error, 0);
+            ReadReal(*(ptr.r), s, err, 0);
             break;
         }
         case NUMBER_TYPE: {
-            ReadNumber(*(ptr.r), s, &_error, 0);
+            ReadNumber(*(ptr.r), s, err, 0);
             break;
         }
 
         case ENTITY_TYPE: {
-            STEPentity *se = ReadEntityRef(s, &_error, 0, instances, addFileId);
+            STEPentity *se = ReadEntityRef(s, err, 0, instances, addFileId);
             if(se != S_ENTITY_NULL) {
                 if(EntityValidLevel(se, aDesc->NonRefTypeDescriptor(),
-                                    &_error)
+                                    err)
                         == SEVERITY_NULL) {
                     *(ptr.c) = se;
                 } else {
@@ -129,7 +138,7 @@ Severity STEPattribute::StrToVal(const char *s, InstMgrBase *instances, int addF
         }
 
         case BINARY_TYPE: {
-            ptr.b->StrToVal(s, &_error);   // call class SDAI_Binary::StrToVal()
+            ptr.b->StrToVal(s, err);   // call class SDAI_Binary::StrToVal()
             break;
         }
         case STRING_TYPE: {
@@ -140,7 +149,7 @@ Severity STEPattribute::StrToVal(const char *s, InstMgrBase *instances, int addF
         case BOOLEAN_TYPE:
         case LOGICAL_TYPE:
         case ENUM_TYPE: {
-            ptr.e->StrToVal(s, &_error, nullable);
+            ptr.e->StrToVal(s, err, nullable);
             break;
         }
 
@@ -149,15 +158,15 @@ Severity STEPattribute::StrToVal(const char *s, InstMgrBase *instances, int addF
         case BAG_TYPE:        // DAS
         case SET_TYPE:        // DAS
         case LIST_TYPE:       // DAS
-            ptr.a -> StrToVal(s, &_error,
+            ptr.a -> StrToVal(s, err,
                               aDesc -> AggrElemTypeDescriptor(),
                               instances, addFileId);
             break;
 
         case SELECT_TYPE:
-            if(_error.severity(ptr.sh->STEPread(in, &_error, instances, 0))
+            if(err->severity(ptr.sh->STEPread(in, err, instances, 0))
                     != SEVERITY_NULL) {
-                _error.AppendToDetailMsg(ptr.sh ->Error());
+                err->AppendToDetailMsg(ptr.sh ->Error());
             }
             break;
 
@@ -167,7 +176,7 @@ Severity STEPattribute::StrToVal(const char *s, InstMgrBase *instances, int addF
             // other cases are the same for StrToVal and file
             return STEPread(in, instances, addFileId);
     }
-    return _error.severity();
+    return err->severity();
 }
 
 
@@ -191,6 +200,7 @@ Severity STEPattribute::StrToVal(const char *s, InstMgrBase *instances, int addF
 Severity STEPattribute::STEPread(istream &in, InstMgrBase *instances, int addFileId,
                                  const char *currSch, bool strict)
 {
+    _changed = true;
 
     // The attribute has been redefined by the attribute pointed
     // to by _redefAttr so write the redefined value.
@@ -198,10 +208,35 @@ Severity STEPattribute::STEPread(istream &in, InstMgrBase *instances, int addFil
         return _redefAttr->STEPread(in, instances, addFileId, currSch);
     }
 
-    _error.ClearErrorMsg(); // also sets Severity to SEVERITY_NULL
+    ClearErrorMsg();
+    ErrorDescriptor err;
+    Severity sev = STEPreadValue(NonRefType(), in, &err, instances, addFileId, currSch, strict);
+    KeepError(err);
+    return sev;
+}
+
+Severity STEPattribute::STEPread(PrimitiveType kind, istream &in, InstMgrBase *instances, int addFileId,
+                                 const char *currSch, bool strict)
+{
+    _changed = true;
+    if(_redefAttr)  {
+        return _redefAttr->STEPread(in, instances, addFileId, currSch);
+    }
+    assert(kind == NonRefType());
+
+    ClearErrorMsg();
+    ErrorDescriptor err;
+    Severity sev = STEPreadValue(kind, in, &err, instances, addFileId, currSch, strict);
+    KeepError(err);
+    return sev;
+}
 
+/// STEPread() without the redefinition check, for attrBaseType == NonRefType(), recording errors in err
+Severity STEPattribute::STEPreadValue(PrimitiveType attrBaseType, istream &in, ErrorDescriptor *err,
+                                      InstMgrBase *instances, int addFileId, const char *currSch, bool strict)
+{
     //  set the value to be null (reinitialize the attribute value)
-    set_null();
+    SetNull(attrBaseType);
 
     in >> ws; // skip whitespace
     char c = in.peek();
@@ -209,19 +244,20 @@ Severity STEPattribute::STEPread(istream &in, InstMgrBase *instances, int addFil
     if(IsDerived()) {
         if(c == '*') {
             in.get(c);   // take * off the istream
-            _error.severity(SEVERITY_NULL);
+            err->severity(SEVERITY_NULL);
         } else {
-            _error.severity(SEVERITY_WARNING);
-            _error.AppendToDetailMsg("  WARNING: attribute '");
-            _error.AppendToDetailMsg(aDesc->Name());
-            _error.AppendToDetailMsg("' of type '");
-            _error.AppendToDetailMsg(aDesc->TypeName());
-            _error.AppendToDetailMsg("' - missing asterisk for derived attribute.\n");
+            err->severity(SEVERITY_WARNING);
+            err->AppendToDetailMsg("  WARNING: attribute '");
+            err->AppendToDetailMsg(aDesc->Name());
+            err->AppendToDetailMsg("' of type '");
+            err->AppendToDetailMsg(aDesc->TypeName());
+            err->AppendToDetailMsg("' - missing asterisk for derived attribute.\n");
+        }
+        if(!RemainingInputIsClean(in, ",)")) {
+            CheckRemainingInput(in, err, aDesc->TypeName(), ",)");
         }
-        CheckRemainingInput(in, &_error, aDesc->TypeName(), ",)");
-        return _error.severity();
+        return err->severity();
     }
-    PrimitiveType attrBaseType = NonRefType();
 
     //  check for NULL or derived attribute value, return if either
     switch(c) {
@@ -230,28 +266,31 @@ Severity STEPattribute::STEPread(istream &in, InstMgrBase *instances, int addFil
         case ')':
             if(c == '$') {
                 in.ignore();
-                CheckRemainingInput(in, &_error, aDesc->TypeName(), ",)");
+                // TypeName() builds a string, so only ask for it on an error
+                if(!RemainingInputIsClean(in, ",)")) {
+                    CheckRemainingInput(in, err, aDesc->TypeName(), ",)");
+                }
             }
             if(Nullable())  {
-                _error.severity(SEVERITY_NULL);
+                err->severity(SEVERITY_NULL);
             } else if(!strict) {
                 std::string fillerValue;
                 // we aren't in strict mode, so find out the type of the missing attribute and insert a suitable value.
-                ErrorDescriptor err; //this will be discarded
+                ErrorDescriptor fillerErr; //this will be discarded
                 switch(attrBaseType) {
                     case INTEGER_TYPE: {
                         fillerValue = "'0',";
-                        ReadInteger(*(ptr.i), fillerValue.c_str(), &err, ",)");
+                        ReadInteger(*(ptr.i), fillerValue.c_str(), &fillerErr, ",)");
                         break;
                     }
                     case REAL_TYPE: {
                         fillerValue = "'0.0',";
-                        ReadReal(*(ptr.r), fillerValue.c_str(), &err, ",)");
+                        ReadReal(*(ptr.r), fillerValue.c_str(), &fillerErr, ",)");
                         break;
                     }
                     case NUMBER_TYPE: {
                         fillerValue = "'0',";
-                        ReadNumber(*(ptr.r), fillerValue.c_str(), &err, ",)");
+                        ReadNumber(*(ptr.r), fillerValue.c_str(), &fillerErr, ",)");
                         break;
                     }
                     case STRING_TYPE: {
@@ -260,92 +299,94 @@ Severity STEPattribute::STEPread(istream &in, InstMgrBase *instances, int addFil
                         break;
                     }
                     default: { //do not know what a good value would be for other types
-                        _error.severity(SEVERITY_INCOMPLETE);
-                        _error.AppendToDetailMsg(" missing and required\n");
-                        return _error.severity();
+                        err->severity(SEVERITY_INCOMPLETE);
+                        err->AppendToDetailMsg(" missing and required\n");
+                        return err->severity();
                     }
                 }
-                if(err.severity() <= SEVERITY_INCOMPLETE) {
-                    _error.severity(SEVERITY_BUG);
-                    _error.AppendToDetailMsg(" Error in STEPattribute::STEPread()\n");
-                    return _error.severity();
+                if(fillerErr.severity() <= SEVERITY_INCOMPLETE) {
+                    err->severity(SEVERITY_BUG);
+                    err->AppendToDetailMsg(" Error in STEPattribute::STEPread()\n");
+                    return err->severity();
                 }
                 //create a warning. SEVERITY_WARNING makes more sense to me, but is considered more severe than SEVERITY_INCOMPLETE
-                _error.severity(SEVERITY_USERMSG);
-                _error.AppendToDetailMsg(" missing and required. For compatibility, replacing with ");
-                _error.AppendToDetailMsg(fillerValue.substr(0, fillerValue.length() - 1));
-                _error.AppendToDetailMsg(".\n");
+                err->severity(SEVERITY_USERMSG);
+                err->AppendToDetailMsg(" missing and required. For compatibility, replacing with ");
+                err->AppendToDetailMsg(fillerValue.substr(0, fillerValue.length() - 1));
+                err->AppendToDetailMsg(".\n");
             } else {
-                _error.severity(SEVERITY_INCOMPLETE);
-                _error.AppendToDetailMsg(" missing and required\n");
+                err->severity(SEVERITY_INCOMPLETE);
+                err->AppendToDetailMsg(" missing and required\n");
             }
-            return _error.severity();
+            return err->severity();
     }
 
     switch(attrBaseType) {
         case INTEGER_TYPE: {
-            ReadInteger(*(ptr.i), in, &_error, ",)");
-            return _error.severity();
+            ReadInteger(*(ptr.i), in, err, ",)");
+            return err->severity();
         }
         case REAL_TYPE: {
-            ReadReal(*(ptr.r), in, &_error, ",)");
-            return _error.severity();
+            ReadReal(*(ptr.r), in, err, ",)");
+            return err->severity();
         }
         case NUMBER_TYPE: {
-            ReadNumber(*(ptr.r), in, &_error, ",)");
-            return _error.severity();
+            ReadNumber(*(ptr.r), in, err, ",)");
+            return err->severity();
         }
         case STRING_TYPE: {
-            ptr.S->STEPread(in, &_error);
-            CheckRemainingInput(in, &_error, "string", ",)");
-            return _error.severity();
+            ptr.S->STEPread(in, err);
+            CheckRemainingInput(in, err, "string", ",)");
+            return err->severity();
         }
         case BINARY_TYPE: {
             // call class SDAI_Binary::STEPread()
-            ptr.b->STEPread(in, &_error);
-            CheckRemainingInput(in, &_error, "binary", ",)");
-            return _error.severity();
+            ptr.b->STEPread(in, err);
+            CheckRemainingInput(in, err, "binary", ",)");
+            return err->severity();
         }
         case BOOLEAN_TYPE: {
-            ptr.e->STEPread(in, &_error,  Nullable());
-            CheckRemainingInput(in, &_error, "boolean", ",)");
-            return _error.severity();
+            ptr.e->STEPread(in, err,  Nullable());
+            CheckRemainingInput(in, err, "boolean", ",)");
+            return err->severity();
         }
         case LOGICAL_TYPE: {
-            ptr.e->STEPread(in, &_error,  Nullable());
-            CheckRemainingInput(in, &_error, "logical", ",)");
-            return _error.severity();
+            ptr.e->STEPread(in, err,  Nullable());
+            CheckRemainingInput(in, err, "logical", ",)");
+            return err->severity();
         }
         case ENUM_TYPE: {
-            ptr.e->STEPread(in, &_error,  Nullable());
-            CheckRemainingInput(in, &_error, "enumeration", ",)");
-            return _error.severity();
+            ptr.e->STEPread(in, err,  Nullable());
+            CheckRemainingInput(in, err, "enumeration", ",)");
+            return err->severity();
         }
         case AGGREGATE_TYPE:
         case ARRAY_TYPE:      // DAS
         case BAG_TYPE:        // DAS
         case SET_TYPE:        // DAS
         case LIST_TYPE: {     // DAS
-            ptr.a->STEPread(in, &_error,
+            ptr.a->STEPread(in, err,
                             aDesc->AggrElemTypeDescriptor(),
                             instances, addFileId, currSch);
 
             // cannot recover so give up and let STEPentity recover
-            if(_error.severity() < SEVERITY_WARNING) {
-                return _error.severity();
+            if(err->severity() < SEVERITY_WARNING) {
+                return err->severity();
             }
 
             // check for garbage following the aggregate
-            CheckRemainingInput(in, &_error, "aggregate", ",)");
-            return _error.severity();
+            CheckRemainingInput(in, err, "aggregate", ",)");
+            return err->severity();
         }
         case ENTITY_TYPE: {
-            STEPentity *se = ReadEntityRef(in, &_error, ",)", instances,
-                                           addFileId);
+            ForwardRef fwd(ptr.c, aDesc->NonRefTypeDescriptor());
+            bool deferred;
+            STEPentity *se = ReadEntityRef(in, err, ",)", instances,
+                                           addFileId, &fwd, deferred);
             if(se != S_ENTITY_NULL) {
                 if(EntityValidLevel(se,
                                     aDesc->NonRefTypeDescriptor(),
-                                    &_error) == SEVERITY_NULL) {
+                                    err) == SEVERITY_NULL) {
                     *(ptr.c) = se;
                 } else {
                     *(ptr.c) = S_ENTITY_NULL;
@@ -353,23 +394,23 @@ Severity STEPattribute::STEPread(istream &in, InstMgrBase *instances, int addFil
             } else {
                 *(ptr.c) = S_ENTITY_NULL;
             }
-            return _error.severity();
+            return err->severity();
 
         }
         case SELECT_TYPE:
-            if(_error.severity(ptr.sh->STEPread(in, &_error, instances, 0,
+            if(err->severity(ptr.sh->STEPread(in, err, instances, 0,
                                                 addFileId, currSch))
                     != SEVERITY_NULL) {
-                _error.AppendToDetailMsg(ptr.sh ->Error());
+                err->AppendToDetailMsg(ptr.sh ->Error());
             }
-            CheckRemainingInput(in, &_error, "select", ",)");
-            return _error.severity();
+            CheckRemainingInput(in, err, "select", ",)");
+            return err->severity();
 
         case GENERIC_TYPE: {
             cerr << "Internal error:  " << __FILE__ <<  __LINE__
                  << "\n" << _POC_ "\n";
-            _error.GreaterSeverity(SEVERITY_BUG);
-            return _error.severity();
+            err->GreaterSeverity(SEVERITY_BUG);
+            return err->severity();
         }
 
         case UNKNOWN_TYPE:
@@ -378,12 +419,20 @@ Severity STEPattribute::STEPread(istream &in, InstMgrBase *instances, int addFil
             // bug
             cerr << "Internal error:  " << __FILE__ <<  __LINE__
                  << "\n" << _POC_ "\n";
-            _error.GreaterSeverity(SEVERITY_BUG);
-            return _error.severity();
+            err->GreaterSeverity(SEVERITY_BUG);
+            return err->severity();
         }
     }
 }
 
+/// copy err into the attribute error, allocating it only if err holds something
+void STEPattribute::KeepError(ErrorDescriptor &err)
+{
+    if(err.severity() != SEVERITY_NULL || !err.DetailMsg().empty() || !err.UserMsg().empty()) {
+        Error().AppendFromErrorArg(&err);
+    }
+}
+
 /*****************************************************************//**
  ** \fn asStr
  ** \param currSch - used for select type writes.  See commenting in SDAI_Select::STEPwrite().
@@ -580,11 +629,11 @@ void STEPattribute::STEPwriteError(ostream &out, unsigned int line, const char *
     out << "$";
     cerr << "Internal error:  " << __FILE__ << ":" << line << "\n" << _POC_ "\n";
 
-    _error.GreaterSeverity(SEVERITY_BUG);
+    Error().GreaterSeverity(SEVERITY_BUG);
     std::stringstream ss;
     ss << " Warning: attribute '" << Name() << " : " << TypeName() << "' " << desc << std::endl;
-    _error.AppendToUserMsg(ss.str());
-    _error.AppendToDetailMsg(ss.str());
+    Error().AppendToUserMsg(ss.str());
+    Error().AppendToDetailMsg(ss.str());
 }
 
 /**
@@ -680,7 +729,7 @@ void STEPattribute::STEPwrite(ostream &out, const char *currSch)
         case REFERENCE_TYPE:
         case GENERIC_TYPE:
             cerr << "Internal error:  " << __FILE__ << ":" <<  __LINE__ << "\n" << _POC_ "\n";
-            _error.GreaterSeverity(SEVERITY_BUG);
+            Error().GreaterSeverity(SEVERITY_BUG);
             return;
 
         case UNKNOWN_TYPE:
@@ -694,6 +743,7 @@ void STEPattribute::STEPwrite(ostream &out, const char *currSch)
 
 void STEPattribute::ShallowCopy(const STEPattribute *sa)
 {
+    _changed = true;
     _mustDeletePtr = false;
     aDesc = sa->aDesc;
     refCount = 0;
@@ -796,10 +846,17 @@ void STEPattribute::ShallowCopy(const STEPattribute *sa)
  */
 Severity STEPattribute::set_null()
 {
+    _changed = true;
     if(_redefAttr)  {
         return _redefAttr->set_null();
     }
-    switch(NonRefType()) {
+    return SetNull(NonRefType());
+}
+
+/// set_null() without the redefinition check, for attrBaseType == NonRefType()
+Severity STEPattribute::SetNull(PrimitiveType attrBaseType)
+{
+    switch(attrBaseType) {
         case INTEGER_TYPE:
             *(ptr.i) = S_INT_NULL;
             break;
@@ -854,8 +911,8 @@ Severity STEPattribute::set_null()
             std::stringstream err;
             err << " Warning: attribute '" << Name() << " : " << TypeName() << " : ";
             err << Type() << "' - " << "Don't know how to make attribute NULL" << std::endl;
-            _error.AppendToDetailMsg(err.str());
-            _error.GreaterSeverity(SEVERITY_WARNING);
+            Error().AppendToDetailMsg(err.str());
+            Error().GreaterSeverity(SEVERITY_WARNING);
             return SEVERITY_WARNING;
     }
     if(Nullable()) {
@@ -929,6 +986,7 @@ bool STEPattribute::is_null()  const
 
 SDAI_Integer *STEPattribute::Integer()
 {
+    _changed = true;
     if(NonRefType() == INTEGER_TYPE) {
         return ptr.i;
     }
@@ -937,6 +995,7 @@ SDAI_Integer *STEPattribute::Integer()
 
 SDAI_Real *STEPattribute::Number()
 {
+    _changed = true;
     if(NonRefType() == NUMBER_TYPE) {
         return ptr.r;
     }
@@ -945,6 +1004,7 @@ SDAI_Real *STEPattribute::Number()
 
 SDAI_Real *STEPattribute::Real()
 {
+    _changed = true;
     if(NonRefType() == REAL_TYPE) {
         return ptr.r;
     }
@@ -961,6 +1021,7 @@ SDAI_Application_instance *STEPattribute::Entity()
 
 SDAI_String *STEPattribute::String()
 {
+    _changed = true;
     if(NonRefType() == STRING_TYPE) {
         return ptr.S;
     }
@@ -969,6 +1030,7 @@ SDAI_String *STEPattribute::String()
 
 SDAI_Binary *STEPattribute::Binary()
 {
+    _changed = true;
     if(NonRefType() == BINARY_TYPE) {
         return ptr.b;
     }
@@ -977,6 +1039,7 @@ SDAI_Binary *STEPattribute::Binary()
 
 STEPaggregate *STEPattribute::Aggregate()
 {
+    _changed = true;
     if((NonRefType() == AGGREGATE_TYPE) || (NonRefType() == ARRAY_TYPE) || (NonRefType() == BAG_TYPE)
             || (NonRefType() == SET_TYPE) || (NonRefType() == LIST_TYPE)) {
         return ptr.a;
@@ -986,6 +1049,7 @@ STEPaggregate *STEPattribute::Aggregate()
 
 SDAI_BOOLEAN *STEPattribute::Boolean()
 {
+    _changed = true;
     if(NonRefType() == BOOLEAN_TYPE) {
         return (SDAI_BOOLEAN *) ptr.e;
     }
@@ -994,6 +1058,7 @@ SDAI_BOOLEAN *STEPattribute::Boolean()
 
 SDAI_LOGICAL *STEPattribute::Logical()
 {
+    _changed = true;
     if(NonRefType() == LOGICAL_TYPE) {
         return (SDAI_LOGICAL *) ptr.e;
     }
@@ -1002,6 +1067,7 @@ SDAI_LOGICAL *STEPattribute::Logical()
 
 SDAI_Enum *STEPattribute::Enum()
 {
+    _changed = true;
     if(NonRefType() == ENUM_TYPE) {
         return ptr.e;
     }
@@ -1010,6 +1076,7 @@ SDAI_Enum *STEPattribute::Enum()
 
 SDAI_Select *STEPattribute::Select()
 {
+    _changed = true;
     if(NonRefType() == SELECT_TYPE) {
         return ptr.sh;
     }
@@ -1018,6 +1085,7 @@ SDAI_Select *STEPattribute::Select()
 
 SCLundefined *STEPattribute::Undefined()
 {
+    _changed = true;
     if((NonRefType() != REFERENCE_TYPE) && (NonRefType() != GENERIC_TYPE)) {
         return ptr.u;
     }
@@ -1028,6 +1096,7 @@ SCLundefined *STEPattribute::Undefined()
 
 void STEPattribute::Integer(SDAI_Integer *n)
 {
+    _changed = true;
     assert(NonRefType() == INTEGER_TYPE);
     if(ptr.i) {
         *(ptr.i) = * n;
@@ -1038,6 +1107,7 @@ void STEPattribute::Integer(SDAI_Integer *n)
 
 void STEPattribute::Real(SDAI_Real *n)
 {
+    _changed = true;
     assert(NonRefType() == REAL_TYPE);
     if(ptr.r) {
         *(ptr.r) = * n;
@@ -1048,6 +1118,7 @@ void STEPattribute::Real(SDAI_Real *n)
 
 void STEPattribute::Number(SDAI_Real *n)
 {
+    _changed = true;
     assert(NonRefType() == NUMBER_TYPE);
     if(ptr.r) {
         *(ptr.r) = * n;
@@ -1058,6 +1129,7 @@ void STEPattribute::Number(SDAI_Real *n)
 
 void STEPattribute::String(SDAI_String *str)
 {
+    _changed = true;
     assert(NonRefType() == STRING_TYPE);
     if(ptr.S) {
         *(ptr.S) = * str;
@@ -1068,6 +1140,7 @@ void STEPattribute::String(SDAI_String *str)
 
 void STEPattribute::Binary(SDAI_Binary *bin)
 {
+    _changed = true;
     assert(NonRefType() == BINARY_TYPE);
     if(ptr.b) {
         *(ptr.b) = * bin;
@@ -1078,6 +1151,7 @@ void STEPattribute::Binary(SDAI_Binary *bin)
 
 void STEPattribute::Entity(SDAI_Application_instance *ent)
 {
+    _changed = true;
     assert(NonRefType() == ENTITY_TYPE);
     if(ptr.c) {
         delete ptr.c;
@@ -1088,6 +1162,7 @@ void STEPattribute::Entity(SDAI_Application_instance *ent)
 
 void STEPattribute::Aggregate(STEPaggregate *aggr)
 {
+    _changed = true;
     assert((NonRefType() == AGGREGATE_TYPE) || (NonRefType() == ARRAY_TYPE) || (NonRefType() == BAG_TYPE)
            || (NonRefType() == SET_TYPE) || (NonRefType() == LIST_TYPE));
     if(ptr.a) {
@@ -1099,6 +1174,7 @@ void STEPattribute::Aggregate(STEPaggregate *aggr)
 
 void STEPattribute::Enum(SDAI_Enum *enu)
 {
+    _changed = true;
     assert(NonRefType() == ENUM_TYPE);
     if(ptr.e) {
         ptr.e->set_null();
@@ -1110,6 +1186,7 @@ void STEPattribute::Enum(SDAI_Enum *enu)
 
 void STEPattribute::Logical(SDAI_LOGICAL *log)
 {
+    _changed = true;
     assert(NonRefType() == LOGICAL_TYPE);
     if(ptr.e) {
         ptr.e->set_null();
@@ -1121,6 +1198,7 @@ void STEPattribute::Logical(SDAI_LOGICAL *log)
 
 void STEPattribute::Boolean(SDAI_BOOLEAN *boo)
 {
+    _changed = true;
     assert(NonRefType() == BOOLEAN_TYPE);
     if(ptr.e) {
         ptr.e->set_null();
@@ -1132,6 +1210,7 @@ void STEPattribute::Boolean(SDAI_BOOLEAN *boo)
 
 void STEPattribute::Select(SDAI_Select *sel)
 {
+    _changed = true;
     assert(NonRefType() == SELECT_TYPE);
     if(ptr.sh) {
         ptr.sh->set_null();
@@ -1143,6 +1222,7 @@ void STEPattribute::Select(SDAI_Select *sel)
 
 void STEPattribute::Undefined(SCLundefined *undef)
 {
+    _changed = true;
     //FIXME is this right, or is the Undefined() above right?
     assert(NonRefType() == REFERENCE_TYPE || NonRefType() == UNKNOWN_TYPE);
     if(ptr.u) {
@@ -1234,8 +1314,8 @@ Severity STEPattribute::ValidLevel(const char *attrValue, ErrorDescriptor *error
         if(!strcmp(attrValue, "*")) {
             return SEVERITY_NULL;
         } else {
-            _error.AppendToDetailMsg("attr is derived - value not permitted\n");
-            return _error.severity(SEVERITY_INPUT_ERROR);
+            Error().AppendToDetailMsg("attr is derived - value not permitted\n");
+            return Error().severity(SEVERITY_INPUT_ERROR);
         }
     }
 
@@ -1258,7 +1338,7 @@ Severity STEPattribute::ValidLevel(const char *attrValue, ErrorDescriptor *error
                                     aDesc->NonRefTypeDescriptor(),
                                     error, im, 0);
         case BINARY_TYPE:
-            return ptr.b->BinaryValidLevel(attrValue, &_error, optional, 0);
+            return ptr.b->BinaryValidLevel(attrValue, &Error(), optional, 0);
 
         case AGGREGATE_TYPE:
         case ARRAY_TYPE:      // DAS
@@ -1304,19 +1384,22 @@ void STEPattribute::AddErrorInfo()
 {
     char errStr[BUFSIZ];
     errStr[0] = '\0';
-    if(SEVERITY_INPUT_ERROR < _error.severity() &&
-            _error.severity() < SEVERITY_NULL) {
+    if(!_error) {
+        return;
+    }
+    if(SEVERITY_INPUT_ERROR < _error->severity() &&
+            _error->severity() < SEVERITY_NULL) {
         sprintf(errStr, " Warning: ATTRIBUTE '%s : %s : %d' - ",
                 Name(), TypeName(), Type());
-        _error.PrependToDetailMsg(errStr);
-    } else if(_error.severity() == SEVERITY_INPUT_ERROR) {
+        _error->PrependToDetailMsg(errStr);
+    } else if(_error->severity() == SEVERITY_INPUT_ERROR) {
         sprintf(errStr, " Error: ATTRIBUTE '%s : %s : %d' - ",
                 Name(), TypeName(), Type());
-        _error.PrependToDetailMsg(errStr);
-    } else if(_error.severity() <= SEVERITY_BUG) {
+        _error->PrependToDetailMsg(errStr);
+    } else if(_error->severity() <= SEVERITY_BUG) {
         sprintf(errStr, " BUG: ATTRIBUTE '%s : %s : %d' - ",
                 Name(), TypeName(), Type());
-        _error.PrependToDetailMsg(errStr);
+        _error->PrependToDetailMsg(errStr);
     }
 }
 
@@ -1336,21 +1419,21 @@ char STEPattribute::SkipBadAttr(istream &in, char *StopChars)
     char errStr[BUFSIZ];
     errStr[0] = '\0';
 
-    _error.GreaterSeverity(SEVERITY_WARNING);
+    Error().GreaterSeverity(SEVERITY_WARNING);
     in >> c;
     while(!in.eof() && !(foundCh = strchr(StopChars, c))) {
         in >> c;
     }
     if(in.eof()) {
-        _error.GreaterSeverity(SEVERITY_INPUT_ERROR);
+        Error().GreaterSeverity(SEVERITY_INPUT_ERROR);
         sprintf(errStr, " Error: attribute '%s : %s : %d' - %s.\n",
                 Name(), TypeName(), Type(),
                 "Unexpected EOF when skipping bad attr value");
-        _error.AppendToDetailMsg(errStr);
+        Error().AppendToDetailMsg(errStr);
     } else {
         sprintf(errStr, " Error: attribute '%s : %s : %d' - %s.\n",
                 Name(), TypeName(), Type(), "Invalid value");
-        _error.AppendToDetailMsg(errStr);
+        Error().AppendToDetailMsg(errStr);
     }
     in.putback(c);
     in.flags(flbuf);   // set skip whitespace to its original state
@@ -1374,8 +1457,8 @@ char STEPattribute::SkipBadAttr(istream &in, char *StopChars)
 /// This is needed so that STEPattribute's can be passed as references to inline functions
 /// NOTE this code only does shallow copies. It may be necessary to do more, in which case
 /// the destructor and assignment operator will also need examined.
-STEPattribute::STEPattribute(const STEPattribute &a) : _derive(a._derive), _mustDeletePtr(false),
-    _redefAttr(a._redefAttr), aDesc(a.aDesc), refCount(a.refCount)
+STEPattribute::STEPattribute(const STEPattribute &a) : _derive(a._derive), _mustDeletePtr(false), _changed(false),
+    refCount(a.refCount), _error(0), _redefAttr(a._redefAttr), aDesc(a.aDesc)
 {
     ShallowCopy(& a);
 
@@ -1408,7 +1491,7 @@ STEPattribute::STEPattribute(const STEPattribute &a) : _derive(a._derive), _must
 
 ///  INTEGER
 STEPattribute::STEPattribute(const class AttrDescriptor &d, SDAI_Integer *p): _derive(false),
-    _mustDeletePtr(false), _redefAttr(0), aDesc(&d), refCount(0)
+    _mustDeletePtr(false), _changed(false), refCount(0), _error(0), _redefAttr(0), aDesc(&d)
 {
     ptr.i = p;
     assert(&d);   //ensure that the AttrDescriptor is not a null pointer
@@ -1416,7 +1499,7 @@ STEPattribute::STEPattribute(const class AttrDescriptor &d, SDAI_Integer *p): _d
 
 ///  BINARY
 STEPattribute::STEPattribute(const class AttrDescriptor &d, SDAI_Binary *p): _derive(false),
-    _mustDeletePtr(false), _redefAttr(0), aDesc(&d), refCount(0)
+    _mustDeletePtr(false), _changed(false), refCount(0), _error(0), _redefAttr(0), aDesc(&d)
 {
     ptr.b = p;
     assert(&d);   //ensure that the AttrDescriptor is not a null pointer
@@ -1424,7 +1507,7 @@ STEPattribute::STEPattribute(const class AttrDescriptor &d, SDAI_Binary *p): _de
 
 ///  STRING
 STEPattribute::STEPattribute(const class AttrDescriptor &d, SDAI_String *p): _derive(false),
-    _mustDeletePtr(false), _redefAttr(0), aDesc(&d), refCount(0)
+    _mustDeletePtr(false), _changed(false), refCount(0), _error(0), _redefAttr(0), aDesc(&d)
 {
     ptr.S = p;
     assert(&d);   //ensure that the AttrDescriptor is not a null pointer
@@ -1432,7 +1515,7 @@ STEPattribute::STEPattribute(const class AttrDescriptor &d, SDAI_String *p): _de
 
 ///  REAL & NUMBER
 STEPattribute::STEPattribute(const class AttrDescriptor &d, SDAI_Real *p): _derive(false),
-    _mustDeletePtr(false), _redefAttr(0), aDesc(&d), refCount(0)
+    _mustDeletePtr(false), _changed(false), refCount(0), _error(0), _redefAttr(0), aDesc(&d)
 {
     ptr.r = p;
     assert(&d);   //ensure that the AttrDescriptor is not a null pointer
@@ -1440,7 +1523,7 @@ STEPattribute::STEPattribute(const class AttrDescriptor &d, SDAI_Real *p): _deri
 
 ///  ENTITY
 STEPattribute::STEPattribute(const class AttrDescriptor &d, SDAI_Application_instance * *p):
-    _derive(false), _mustDeletePtr(false), _redefAttr(0), aDesc(&d), refCount(0)
+    _derive(false), _mustDeletePtr(false), _changed(false), refCount(0), _error(0), _redefAttr(0), aDesc(&d)
 {
     ptr.c = p;
     assert(&d);   //ensure that the AttrDescriptor is not a null pointer
@@ -1448,7 +1531,7 @@ STEPattribute::STEPattribute(const class AttrDescriptor &d, SDAI_Application_ins
 
 ///  AGGREGATE
 STEPattribute::STEPattribute(const class AttrDescriptor &d, STEPaggregate *p): _derive(false),
-    _mustDeletePtr(false), _redefAttr(0), aDesc(&d), refCount(0)
+    _mustDeletePtr(false), _changed(false), refCount(0), _error(0), _redefAttr(0), aDesc(&d)
 {
     ptr.a =  p;
     assert(&d);   //ensure that the AttrDescriptor is not a null pointer
@@ -1456,7 +1539,7 @@ STEPattribute::STEPattribute(const class AttrDescriptor &d, STEPaggregate *p): _
 
 ///  ENUMERATION  and Logical
 STEPattribute::STEPattribute(const class AttrDescriptor &d, SDAI_Enum *p): _derive(false),
-    _mustDeletePtr(false), _redefAttr(0), aDesc(&d), refCount(0)
+    _mustDeletePtr(false), _changed(false), refCount(0), _error(0), _redefAttr(0), aDesc(&d)
 {
     ptr.e = p;
     assert(&d);   //ensure that the AttrDescriptor is not a null pointer
@@ -1464,7 +1547,7 @@ STEPattribute::STEPattribute(const class AttrDescriptor &d, SDAI_Enum *p): _deri
 
 ///  SELECT
 STEPattribute::STEPattribute(const class AttrDescriptor &d, class SDAI_Select *p): _derive(false),
-    _mustDeletePtr(false), _redefAttr(0), aDesc(&d), refCount(0)
+    _mustDeletePtr(false), _changed(false), refCount(0), _error(0), _redefAttr(0), aDesc(&d)
 {
     ptr.sh = p;
     assert(&d);   //ensure that the AttrDescriptor is not a null pointer
@@ -1472,15 +1555,37 @@ STEPattribute::STEPattribute(const class AttrDescriptor &d, class SDAI_Select *p
 
 ///  UNDEFINED
 STEPattribute::STEPattribute(const class AttrDescriptor &d, SCLundefined *p): _derive(false),
-    _mustDeletePtr(false), _redefAttr(0), aDesc(&d), refCount(0)
+    _mustDeletePtr(false), _changed(false), refCount(0), _error(0), _redefAttr(0), aDesc(&d)
 {
     ptr.u = p;
     assert(&d);   //ensure that the AttrDescriptor is not a null pointer
 }
 
+/// member-wise assignment; the error is copied, not shared
+STEPattribute &STEPattribute::operator= (const STEPattribute &a)
+{
+    if(this == &a) {
+        return *this;
+    }
+    ptr = a.ptr;
+    _derive = a._derive;
+    _mustDeletePtr = a._mustDeletePtr;
+    _changed = true;
+    refCount = a.refCount;
+    _redefAttr = a._redefAttr;
+    aDesc = a.aDesc;
+    if(a._error) {
+        Error() = *a._error;
+    } else {
+        ClearErrorMsg();
+    }
+    return *this;
+}
+
 /// the destructor conditionally deletes the object in ptr
 STEPattribute::~STEPattribute()
 {
+    delete _error;
     if(_mustDeletePtr) {
         switch(NonRefType()) {
             case AGGREGATE_TYPE:
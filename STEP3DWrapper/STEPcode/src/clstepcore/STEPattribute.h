@@ -27,6 +27,7 @@
 #define REAL_NUM_PRECISION 15
 
 class InstMgrBase;
+struct ForwardRef;
 class SDAI_Application_instance;
 class STEPaggregate;
 class SCLundefined;
@@ -42,6 +43,13 @@ extern SC_CORE_EXPORT int SetErrOnNull(const char *attrValue, ErrorDescriptor *e
 extern SC_CORE_EXPORT SDAI_Application_instance *ReadEntityRef(istream &in, ErrorDescriptor *err, const char *tokenList,
         InstMgrBase *instances, int addFileId);
 
+/** as above; when the instance does not exist yet and instances collects forward references
+ * (InstMgr::CollectForwardRefs()), the reference is recorded for *fwd instead of being an error.
+ * \param deferred set to true if the reference was recorded; S_ENTITY_NULL is then returned
+ */
+extern SC_CORE_EXPORT SDAI_Application_instance *ReadEntityRef(istream &in, ErrorDescriptor *err, const char *tokenList,
+        InstMgrBase *instances, int addFileId, const ForwardRef *fwd, bool &deferred);
+
 extern SC_CORE_EXPORT SDAI_Application_instance *ReadEntityRef(const char *s, ErrorDescriptor *err, const char *tokenList,
         InstMgrBase *instances, int addFileId);
 
@@ -102,18 +110,25 @@ class SC_CORE_EXPORT STEPattribute
     protected:
         bool _derive;
         bool _mustDeletePtr; ///if a member uses new to create an object in ptr
-        ErrorDescriptor _error;
+        bool _changed; ///< set by the functions that set the value or give access to it
+        int refCount;
+        /// allocated by Error() on the first error; most attributes never have one
+        ErrorDescriptor *_error;
         STEPattribute *_redefAttr;
     public:
         const AttrDescriptor *aDesc;
 
     protected:
-        int refCount;
-
         char SkipBadAttr(istream &in, char *StopChars);
         void AddErrorInfo();
         void STEPwriteError(ostream &out, unsigned int line, const char *desc);
 
+        Severity StrToValue(const char *s, ErrorDescriptor *err, InstMgrBase *instances, int addFileId);
+        Severity STEPreadValue(PrimitiveType attrBaseType, istream &in, ErrorDescriptor *err,
+                               InstMgrBase *instances, int addFileId, const char *currSch, bool strict);
+        Severity SetNull(PrimitiveType attrBaseType);
+        void KeepError(ErrorDescriptor &err);
+
     public:
         void incrRefCount()
         {
@@ -140,6 +155,20 @@ class SC_CORE_EXPORT STEPattribute
         {
             _redefAttr = a;
         }
+        /**
+         * true if the value may have changed since Changed(false): StrToVal(), STEPread(),
+         * set_null(), ShallowCopy(), the assignment, the functions that set the value and
+         * those that return a pointer to it all set it. Read by
+         * SDAI_Application_instance::Modified().
+         */
+        bool Changed() const
+        {
+            return _changed;
+        }
+        void Changed(bool changed)
+        {
+            _changed = changed;
+        }
 
 ///////////// Read, Write, Assign attr value
 
@@ -147,6 +176,13 @@ class SC_CORE_EXPORT STEPattribute
                           int addFileId = 0);
         Severity STEPread(istream &in = cin, InstMgrBase *instances = 0,
                           int addFileId = 0, const char *currSch = NULL, bool strict = true);
+        /**
+         * STEPread() for an attribute whose NonRefType() is known to be \p kind,
+         * as in the attribute readers of exp2cxx -u, which saves looking the
+         * type up. A redefined attribute is read as by STEPread().
+         */
+        Severity STEPread(PrimitiveType kind, istream &in, InstMgrBase *instances,
+                          int addFileId, const char *currSch, bool strict);
 
         /// return the attr value as a string
         string asStr(const char *currSch = 0) const;
@@ -226,11 +262,21 @@ class SC_CORE_EXPORT STEPattribute
 
         ErrorDescriptor &Error()
         {
-            return _error;
+            if(!_error) {
+                _error = new ErrorDescriptor;
+            }
+            return *_error;
+        }
+        /// severity of the recorded error, without allocating one
+        Severity ErrorSeverity() const
+        {
+            return _error ? _error->severity() : SEVERITY_NULL;
         }
         void ClearErrorMsg()
         {
-            _error.ClearErrorMsg();
+            if(_error) {
+                _error->ClearErrorMsg();
+            }
         }
 
         Severity ValidLevel(const char *attrValue, ErrorDescriptor *error, InstMgrBase *im, bool clearError = true);
@@ -238,11 +284,12 @@ class SC_CORE_EXPORT STEPattribute
 ////////////////// Constructors
 
         STEPattribute(const STEPattribute &a);
-        STEPattribute(): _derive(false), _mustDeletePtr(false),
-            _redefAttr(0), aDesc(0), refCount(0)
+        STEPattribute(): _derive(false), _mustDeletePtr(false), _changed(false), refCount(0),
+            _error(0), _redefAttr(0), aDesc(0)
         {
             memset(& ptr, 0, sizeof(ptr));
         }
+        STEPattribute &operator= (const STEPattribute &a);
         ~STEPattribute();
         //  INTEGER
         STEPattribute(const class AttrDescriptor &d, SDAI_Integer *p);
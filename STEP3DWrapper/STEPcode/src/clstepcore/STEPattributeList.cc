@@ -24,16 +24,48 @@ AttrListNode::~AttrListNode()
 }
 
 
-STEPattributeList::STEPattributeList()
+/// an attribute of STEPattributeList::pushBlock() with its node
+struct AttrListBlock {
+    STEPattribute attr;
+    AttrListNode node;
+};
+
+STEPattributeList::STEPattributeList() : _block(0), _blockCount(0), _deferred(0)
 {
 }
 
 STEPattributeList::~STEPattributeList()
 {
+    if(!_block) {
+        return;
+    }
+    // unlink the nodes of the block, ~SingleLinkList() deletes the others
+    SingleLinkNode *node = head;
+    head = tail = 0;
+    while(node) {
+        SingleLinkNode *next = node->next;
+        if(!ownsAttr(((AttrListNode *)node)->attr)) {
+            node->next = 0;
+            if(tail) {
+                tail->next = node;
+            } else {
+                head = node;
+            }
+            tail = node;
+        }
+        node = next;
+    }
+    delete [] _block;
 }
 
 STEPattribute &STEPattributeList::operator [](int n)
 {
+    return const_cast<STEPattribute &>(static_cast<const STEPattributeList &>(*this)[n]);
+}
+
+const STEPattribute &STEPattributeList::operator [](int n) const
+{
+    ReadDeferred();
     int x = 0;
     AttrListNode *a = (AttrListNode *)head;
     int cnt =  EntryCount();
@@ -53,7 +85,7 @@ STEPattribute &STEPattributeList::operator [](int n)
     return *(STEPattribute *) 0;
 }
 
-int STEPattributeList::list_length()
+int STEPattributeList::list_length() const
 {
     return EntryCount();
 }
@@ -73,3 +105,50 @@ void STEPattributeList::push(STEPattribute *a)
     AttrListNode *saln = new AttrListNode(a);
     AppendNode(saln);
 }
+
+bool STEPattributeList::pushBlock(int n)
+{
+    if(_block || n < 1) {
+        return false;
+    }
+    _block = new AttrListBlock[n];
+    _blockCount = n;
+    for(int i = 0; i < n; i++) {
+        _block[i].attr.incrRefCount();
+        _block[i].node.attr = &_block[i].attr;
+        AppendNode(&_block[i].node);
+    }
+    return true;
+}
+
+STEPattribute *STEPattributeList::blockAttr(int i) const
+{
+    return &_block[i].attr;
+}
+
+bool STEPattributeList::onlyBlock() const
+{
+    return _block && head == &_block[0].node && tail == &_block[_blockCount - 1].node;
+}
+
+bool STEPattributeList::ownsAttr(const STEPattribute *a) const
+{
+    return _block && a >= &_block[0].attr && a <= &_block[_blockCount - 1].attr;
+}
+
+bool STEPattributeList::Changed() const
+{
+    for(const AttrListNode *a = (const AttrListNode *)head; a; a = (const AttrListNode *)(a->next)) {
+        if(a->attr->Changed()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void STEPattributeList::Changed(bool changed)
+{
+    for(AttrListNode *a = (AttrListNode *)head; a; a = (AttrListNode *)(a->next)) {
+        a->attr->Changed(changed);
+    }
+}
@@ -14,11 +14,39 @@
 */
 
 class STEPattribute;
+class SDAI_Application_instance;
 
 #include <sc_export.h>
 #include <SingleLinkList.h>
+#include <atomic>
+#include <stddef.h>
 
 class STEPattributeList;
+struct AttrListBlock;
+class DeferredReader;
+
+/// an instance created without reading its attributes \sa DeferredReader
+struct DeferredRecord {
+    DeferredReader *reader;
+    SDAI_Application_instance *instance;
+    size_t begin, end;  ///< the attribute values, in the text kept by the reader
+    bool reading;       ///< set while the reader reads the instance
+};
+
+/**
+ * Reads the attributes of instances on first use, for a file read with
+ * STEPfile::DeferredRead(). The list of attributes of such an instance
+ * points at its DeferredRecord until it is read.
+ */
+class SC_CORE_EXPORT DeferredReader
+{
+    public:
+        virtual ~DeferredReader() {}
+        /** read the attributes of record->instance, unless already done; then
+         * record->instance->attributes is no longer deferred. Thread safe.
+         */
+        virtual void Read(DeferredRecord *record) = 0;
+};
 
 class SC_CORE_EXPORT AttrListNode :  public SingleLinkNode
 {
@@ -28,20 +56,89 @@ class SC_CORE_EXPORT AttrListNode :  public SingleLinkNode
         STEPattribute *attr;
 
     public:
-        AttrListNode(STEPattribute *a);
+        AttrListNode(STEPattribute *a = 0);
         virtual ~AttrListNode();
 
+        STEPattribute *Attr() const
+        {
+            return attr;
+        }
 };
 
 class SC_CORE_EXPORT STEPattributeList : public SingleLinkList
 {
+    protected:
+        /// attributes and their nodes appended by pushBlock()
+        AttrListBlock *_block;
+        int _blockCount;
+
     public:
         STEPattributeList();
         virtual ~STEPattributeList();
 
+        /// the list owns the nodes and the block of pushBlock(): a copy would
+        /// delete them again. Bind a reference to the list of the instance.
+        STEPattributeList(const STEPattributeList &) = delete;
+        STEPattributeList &operator=(const STEPattributeList &) = delete;
+
         STEPattribute &operator [](int n);
-        int list_length();
+        const STEPattribute &operator [](int n) const;
+        int list_length() const;
         void push(STEPattribute *a);
+
+        /**
+         * Appends n default constructed attributes held, with their nodes, in
+         * one allocation owned by the list. Unlike push() there is no duplicate
+         * check. The caller fills in the attributes through blockAttr(); they
+         * must not be pushed on another list. Only one block per list.
+         * \returns false if n < 1 or there already is a block
+         */
+        bool pushBlock(int n);
+        /// attribute i of the block of pushBlock()
+        STEPattribute *blockAttr(int i) const;
+        /// the number of attributes of the block of pushBlock(), 0 if none
+        int blockCount() const
+        {
+            return _blockCount;
+        }
+        /// true if the list holds the attributes of the block and no other
+        bool onlyBlock() const;
+        /// true if a was made by pushBlock(), so the list will destroy it
+        bool ownsAttr(const STEPattribute *a) const;
+
+        /// true if an attribute is Changed(); a deferred read isn't done for it
+        bool Changed() const;
+        /// sets Changed() of each attribute
+        void Changed(bool changed);
+
+        /// read the values of the attributes now, if the read of the instance was
+        /// deferred; const, so that the const access of the list reads them too
+        void ReadDeferred() const
+        {
+            DeferredRecord *record = _deferred.load(std::memory_order_acquire);
+            if(record) {
+                record->reader->Read(record);
+            }
+        }
+        /// set by the DeferredReader, which clears it once the attributes are read
+        void Deferred(DeferredRecord *record)
+        {
+            _deferred.store(record, std::memory_order_release);
+        }
+        DeferredRecord *Deferred() const
+        {
+            return _deferred.load(std::memory_order_acquire);
+        }
+
+    protected:
+#ifdef _MSC_VER
+#pragma warning( push )
+#pragma warning( disable: 4251 )
+#endif
+        std::atomic<DeferredRecord *> _deferred;
+#ifdef _MSC_VER
+#pragma warning( pop )
+#endif
 };
 
 /*****************************************************************
@@ -332,6 +332,23 @@ void STEPcomplex::AppendEntity(STEPcomplex *stepc)
     }
 }
 
+bool STEPcomplex::Modified() const
+{
+    for(const STEPcomplex *part = head; part; part = part->sc) {
+        if(part->SDAI_Application_instance::Modified()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void STEPcomplex::Modified(bool modified)
+{
+    for(STEPcomplex *part = head; part; part = part->sc) {
+        part->SDAI_Application_instance::Modified(modified);
+    }
+}
+
 // READ
 Severity STEPcomplex::STEPread(int id, int addFileId, class InstMgrBase *instance_set,
                                istream &in, const char *currSch, bool /*useTechCor*/, bool /*strict*/)
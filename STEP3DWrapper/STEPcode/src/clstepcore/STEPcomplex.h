@@ -88,6 +88,11 @@ class SC_CORE_EXPORT STEPcomplex : public SDAI_Application_instance
                                                 const char *currSch = NULL);
         virtual void AppendEntity(STEPcomplex *stepc);
 
+        /// Modified() of any part; each part has the attributes of its entity
+        virtual bool Modified() const;
+        /// Modified() of every part
+        virtual void Modified(bool modified);
+
     protected:
         virtual void CopyAs(SDAI_Application_instance *se);
         void BuildAttrs(const char *s);
@@ -101,6 +101,7 @@ bool ComplexCollect::supports(EntNode *ents) const
     ComplexList *clist = clists, *cl = NULL, *current;
     bool retval;
     EntList *elist, *next;
+    std::lock_guard<std::mutex> guard(matchMutex);
 
     // Loop through the nodes of ents.  If 1+ of them have >1 supertype, build
     // a combo-CList to handle it.
@@ -17,6 +17,7 @@
 #include <sc_export.h>
 #include <iostream>
 #include <fstream>
+#include <mutex>
 using namespace std;
 #include "Str.h"
 
@@ -468,6 +469,16 @@ class SC_CORE_EXPORT ComplexCollect
 
     private:
         int count;  ///< # of clist children
+#ifdef _MSC_VER
+#pragma warning( push )
+#pragma warning( disable: 4251 )
+#endif
+        /// supports() marks the shared EntLists while matching, so STEPfiles
+        /// read on several threads with one Registry take turns here
+        mutable std::mutex matchMutex;
+#ifdef _MSC_VER
+#pragma warning( pop )
+#endif
 };
 
 #endif
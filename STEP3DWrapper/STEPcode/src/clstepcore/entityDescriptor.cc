@@ -8,6 +8,7 @@
 
 EntityDescriptor::EntityDescriptor()
     : _abstractEntity(LUnknown), _extMapping(LUnknown),
+      _typeId(-1), _lastSubclassId(-1), _supertypeIds(0), _supertypeWords(0),
       _uniqueness_rules((Uniqueness_rule__set_var)0), NewSTEPentity(0)
 {
 }
@@ -20,6 +21,7 @@ EntityDescriptor::EntityDescriptor(const char *name,   // i.e. char *
                                   )
     : TypeDescriptor(name, ENTITY_TYPE, origSchema, name),
       _abstractEntity(abstractEntity), _extMapping(extMapping),
+      _typeId(-1), _lastSubclassId(-1), _supertypeIds(0), _supertypeWords(0),
       _uniqueness_rules((Uniqueness_rule__set_var)0), NewSTEPentity(f)
 {
 }
@@ -249,11 +251,41 @@ const TypeDescriptor *EntityDescriptor::IsA(const TypeDescriptor *td) const
     }
 }
 
+void EntityDescriptor::TypeIds(int id, int lastSubclassId, const unsigned int *supertypes, int words)
+{
+    _typeId = id;
+    _lastSubclassId = lastSubclassId;
+    _supertypeIds = supertypes;
+    _supertypeWords = words;
+}
+
+bool EntityDescriptor::DerivesFrom(const EntityDescriptor *ed) const
+{
+    if(_typeId >= 0 && ed->_typeId >= 0 && _originatingSchema == ed->_originatingSchema) {
+        return ed->_typeId <= _typeId && _typeId <= ed->_lastSubclassId;
+    }
+    // without ids, the generated class derives from the first supertype
+    const EntityDescriptor *e = this;
+    while(e && e != ed) {
+        const EntityDescLinkNode *link = (const EntityDescLinkNode *) e->GetSupertypes().GetHead();
+        e = link ? link->EntityDesc() : 0;
+    }
+    return e != 0;
+}
+
 const EntityDescriptor *EntityDescriptor::IsA(const EntityDescriptor *other)  const
 {
     const EntityDescriptor *found = 0;
     const EntityDescLinkNode *link = (const EntityDescLinkNode *)(GetSupertypes().GetHead());
 
+    // the ids of a schema only tell about the supertypes in the same schema
+    if(_supertypeIds && other->_typeId >= 0 && _originatingSchema == other->_originatingSchema) {
+        int word = other->_typeId / 32;
+        if(word < _supertypeWords && (_supertypeIds[word] & (1u << (other->_typeId % 32)))) {
+            return other;
+        }
+        return 0;
+    }
     if(this == other) {
         return other;
     } else {
@@ -42,6 +42,11 @@ class SC_CORE_EXPORT EntityDescriptor  :    public TypeDescriptor
 #ifdef _MSC_VER
 #pragma warning( pop )
 #endif
+
+        int _typeId;                        ///< -1 if the schema was generated without ids
+        int _lastSubclassId;                ///< the classes deriving from ours have the ids up to this one
+        const unsigned int *_supertypeIds;  ///< bitset of the ids of this entity and of all its supertypes
+        int _supertypeWords;                ///< size of _supertypeIds
     public:
         Uniqueness_rule__set_var _uniqueness_rules; // initially a null pointer
 
@@ -118,6 +123,31 @@ class SC_CORE_EXPORT EntityDescriptor  :    public TypeDescriptor
             return _inverseAttr;
         }
 
+        /// dense id of the entity in its schema, given by exp2cxx; -1 if none
+        int TypeId() const
+        {
+            return _typeId;
+        }
+
+        /**
+         * Called by the schema initialisation with the ids exp2cxx computed.
+         * The entities are numbered in preorder of the generated class
+         * hierarchy, so the classes deriving from this one have the ids from
+         * \p id to \p lastSubclassId. \p supertypes is a static bitset of
+         * \p words words with the bits of \p id and of all the supertypes of
+         * the schema set. IsA() and DerivesFrom() then take constant time.
+         */
+        void TypeIds(int id, int lastSubclassId, const unsigned int *supertypes, int words);
+
+        /**
+         * true if the generated class of this entity is the class of \p ed or
+         * derives from it, so an instance of this entity that is not complex
+         * can be static_cast to the class of \p ed.
+         * Unlike IsA(), only the first supertype of an entity with several is
+         * a base class.
+         */
+        bool DerivesFrom(const EntityDescriptor *ed) const;
+
         virtual const EntityDescriptor *IsA(const EntityDescriptor *) const;
         virtual const TypeDescriptor *IsA(const TypeDescriptor *td) const;
         virtual const TypeDescriptor *IsA(const char *n) const
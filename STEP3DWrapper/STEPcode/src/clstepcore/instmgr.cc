@@ -48,7 +48,7 @@ InstMgr::PrintSortedFileIds()
 }
 
 InstMgr::InstMgr(int ownsInstances)
-    : maxFileId(-1), _ownsInstances(ownsInstances)
+    : maxFileId(-1), _ownsInstances(ownsInstances), _stringPool(0), _forwardRefOwner(0)
 {
     master = new MgrNodeArray();
     sortedMaster = new std::map<int, MgrNode *>;
@@ -66,6 +66,34 @@ InstMgr::~InstMgr()
 
     delete master;
     delete sortedMaster;
+    delete _stringPool;
+    DeleteDeferredReaders();
+}
+
+bool InstMgr::AddForwardRef(int fileId, const ForwardRef &ref)
+{
+    if(!_forwardRefOwner) {
+        return false;
+    }
+    _forwardRefs.push_back(ref);
+    _forwardRefs.back().fileId = fileId;
+    _forwardRefs.back().owner = _forwardRefOwner;
+    return true;
+}
+
+void InstMgr::ClearForwardRefs()
+{
+    std::vector<ForwardRef>().swap(_forwardRefs);
+}
+
+void InstMgr::UseStringPool(bool use)
+{
+    if(use && !_stringPool) {
+        _stringPool = new SDAI_String_Pool;
+    } else if(!use) {
+        delete _stringPool;
+        _stringPool = 0;
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -82,6 +110,16 @@ void InstMgr::DeleteInstances()
     master->DeleteEntries();
     sortedMaster->clear();
     maxFileId = -1;
+    DeleteDeferredReaders();
+}
+
+void InstMgr::DeleteDeferredReaders()
+{
+    std::vector<DeferredReader *>::iterator it;
+    for(it = _deferredReaders.begin(); it != _deferredReaders.end(); ++it) {
+        delete *it;
+    }
+    _deferredReaders.clear();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -138,6 +176,8 @@ InstMgr::VerifyInstances(ErrorDescriptor &err) {
             cerr << "In VerifyInstances:  "
                  << "new MgrNode for " << mn->GetFileId() << " with state "
                  << mn->CurrState() << endl;
+        // a deferred instance is read first, which gives it its state
+        mn->GetApplication_instance()->ReadDeferred();
         if(!mn->MgrNodeListMember(completeSE)) {
             se = mn->GetApplication_instance();
             if(se->ValidLevel(&err, this, 0) < SEVERITY_USERMSG) {
@@ -325,7 +365,8 @@ InstMgr::EntityKeywordCount(const char *name)
     MgrNode *node;
     SDAI_Application_instance *se;
     int n = InstanceCount();
-    const char *pretty_name = PrettyTmpName(name);
+    char pretty_name[BUFSIZ];
+    PrettyTmpName(name, pretty_name);
     for(int j = 0; j < n; ++j) {
         node = GetMgrNode(j);
         se = node->GetApplication_instance();
@@ -377,7 +418,8 @@ InstMgr::GetApplication_instance(const char *entityKeyword, int starting_index)
 {
     MgrNode *node;
     SDAI_Application_instance *se;
-    const char *pretty_name = PrettyTmpName(entityKeyword);
+    char pretty_name[BUFSIZ];
+    PrettyTmpName(entityKeyword, pretty_name);
 
     int count = InstanceCount();
     for(int j = starting_index; j < count; ++j) {
@@ -395,7 +437,8 @@ InstMgr::GetSTEPentity(const char *entityKeyword, int starting_index)
 {
     MgrNode *node;
     SDAI_Application_instance *se;
-    const char *pretty_name = PrettyTmpName(entityKeyword);
+    char pretty_name[BUFSIZ];
+    PrettyTmpName(entityKeyword, pretty_name);
 
     int count = InstanceCount();
     for(int j = starting_index; j < count; ++j) {
@@ -23,6 +23,7 @@
 #include <sc_export.h>
 
 #include <map>
+#include <vector>
 
 // IT IS VERY IMPORTANT THAT THE ORDER OF THE FOLLOWING INCLUDE FILES
 // BE PRESERVED
@@ -39,10 +40,42 @@
 
 #include <mgrnodearray.h>
 
+class SDAI_String_Pool;
+class SDAI_Select;
+class TypeDescriptor;
+class DeferredReader;
+
+/** A reference read before the instance it refers to exists, to be stored once all instances are created.
+ * The destination is either slot (an entity attribute or aggregate element, whose value must be an
+ * instance of type) or select.
+ * \sa InstMgrBase::AddForwardRef()
+ */
+struct ForwardRef {
+    int fileId;                         ///< the instance referred to
+    SDAI_Application_instance *owner;   ///< the instance being read, which gets the error if the reference is invalid
+    SDAI_Application_instance **slot;   ///< null for a select
+    union {
+        const TypeDescriptor *type;
+        SDAI_Select *select;
+    };
+
+    ForwardRef(SDAI_Application_instance **s, const TypeDescriptor *t): fileId(0), owner(0), slot(s), type(t) {}
+    ForwardRef(SDAI_Select *s): fileId(0), owner(0), slot(0), select(s) {}
+};
+
 class SC_CORE_EXPORT InstMgrBase
 {
     public:
         virtual MgrNodeBase *FindFileId(int fileId) = 0;
+        /** record a reference to instance fileId, which does not exist yet.
+         * \returns false if forward references are not collected; the reference is then an error
+         */
+        virtual bool AddForwardRef(int fileId, const ForwardRef &ref)
+        {
+            (void) fileId;
+            (void) ref;
+            return false;
+        }
         virtual ~InstMgrBase() {};
 };
 
@@ -56,6 +89,17 @@ class SC_CORE_EXPORT InstMgr : public InstMgrBase
         // complete, incomplete, new, delete MgrNodes lists
         // this corresponds to the display list object by index
         std::map<int, MgrNode *> *sortedMaster;  // master array sorted by fileId
+        SDAI_String_Pool *_stringPool; // shared copies of string values, owned; null if not used
+#ifdef _MSC_VER
+#pragma warning( push )
+#pragma warning( disable: 4251 )
+#endif
+        std::vector<ForwardRef> _forwardRefs;
+        std::vector<DeferredReader *> _deferredReaders; // owned, see AdoptDeferredReader()
+#ifdef _MSC_VER
+#pragma warning( pop )
+#endif
+        SDAI_Application_instance *_forwardRefOwner; // instance being read while collecting forward references
 //    StateList *master; // this will be an sorted array of ptrs to MgrNodes
 
     public:
@@ -77,8 +121,43 @@ class SC_CORE_EXPORT InstMgr : public InstMgrBase
             _ownsInstances = ownsInstances;
         }
 
+        /** enable or disable the string pool of this InstMgr, where code that copies
+         * string values out of its instances can share them (see SDAI_String_Pool).
+         * Disabling deletes the pool, so it must only be done when no handle to it is in use.
+         */
+        void UseStringPool(bool use);
+        SDAI_String_Pool *GetStringPool()
+        {
+            return _stringPool;
+        }
+
+        /** collect the references to instances that do not exist yet, made while reading owner.
+         * Used for one-pass reading (see STEPfile::OnePassRead()); a null owner stops collecting.
+         */
+        void CollectForwardRefs(SDAI_Application_instance *owner)
+        {
+            _forwardRefOwner = owner;
+        }
+        bool AddForwardRef(int fileId, const ForwardRef &ref);
+        /// the references collected so far, in reading order
+        std::vector<ForwardRef> &ForwardRefs()
+        {
+            return _forwardRefs;
+        }
+        void ClearForwardRefs();
+
+        /** take ownership of the reader of instances whose attributes are read on first use
+         * (see STEPfile::DeferredRead()). It is deleted with the instances, by DeleteInstances() or
+         * the destructor, so it must outlive every use of them.
+         */
+        void AdoptDeferredReader(DeferredReader *reader)
+        {
+            _deferredReaders.push_back(reader);
+        }
+
         void ClearInstances(); //clears instance lists but doesn't delete instances
         void DeleteInstances(); // deletes the instances (ignores _ownsInstances)
+        void DeleteDeferredReaders();
 
         Severity VerifyInstances(ErrorDescriptor &e);
 
@@ -1,6 +1,9 @@
 
 #include <errordesc.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <cmath>
 #include <sdai.h>
 #include <read_func.h>
 #include <STEPattribute.h>
@@ -297,15 +300,19 @@ int ReadReal(SDAI_Real &val, istream &in, ErrorDescriptor *err,
     }
     buf[i] = '\0';
 
-    istringstream in2((char *)buf);
-
-    // now that we have the real the stream will be able to salvage reading
-    // whatever kind of format was used to represent the real.
-    in2 >> d;
+    // now that we have the real strtod will be able to salvage reading
+    // whatever kind of format was used to represent the real. buf only holds
+    // a sign, digits, '.' and 'E', so this does not need a stream per value.
+    // Like the stream, the whole of buf must convert (e.g. "1.E" does not),
+    // and like the stream's classic locale StrToReal() ignores LC_NUMERIC.
+    char *end;
+    errno = 0;
+    d = StrToReal(buf, &end);
+    bool failed = (end == buf) || (*end != '\0') || (errno == ERANGE && std::isinf(d));
 
     int valAssigned = 0;
 
-    if(!in2.fail()) {
+    if(!failed) {
         valAssigned = 1;
         val = d;
         err->GreaterSeverity(e.severity());
@@ -696,21 +703,20 @@ characters read from the istream up to, but not including
 the first character found in the set of delimiters, or the
 whitespace character. It leaves the delimiter on the istream.
 
-The string is returned in a static buffer, so it will change
-the next time the function is called.
+The keyword is read into buf, supplied by the caller, and the
+returned pointer is buf.c_str().
 
 Keywords are special strings of characters indicating the instance
 of an entity of a specific type. They shall consist of uppercase letters,
 digits, underscore characters, and possibly an exclamation mark.
 The "!" shall appear only once, and only as the first character.
 ***************************/
-const char *GetKeyword(istream &in, const char *delims, ErrorDescriptor &err)
+const char *GetKeyword(istream &in, const char *delims, ErrorDescriptor &err, std::string &buf)
 {
     char c;
     int sz = 1;
-    static std::string str;
 
-    str = "";
+    buf.clear();
     in.get(c);
     while(!((isspace(c)) || (strchr(delims, c)))) {
         //check to see if the char is valid
@@ -720,20 +726,28 @@ const char *GetKeyword(istream &in, const char *delims, ErrorDescriptor &err)
                 (c == '-')   ||    //for reading 'ISO-10303-21'
                 ((c == '!') && (sz == 1)))) {
             cerr << "Error: Invalid character \'" << c <<
-                 "\' in GetKeyword.\nkeyword was: " << str << "\n";
+                 "\' in GetKeyword.\nkeyword was: " << buf << "\n";
             err.GreaterSeverity(SEVERITY_WARNING);
             in.putback(c);
-            return const_cast<char *>(str.c_str());
+            return buf.c_str();
         }
         if(!in.good()) {
             break;    //BUG: should do something on eof()
         }
-        str += c;
+        buf += c;
         ++sz;
         in.get(c);
     }
     in.putback(c);
-    return const_cast<char *>(str.c_str());
+    return buf.c_str();
+}
+
+/// same as above, but the keyword is returned in a thread local buffer that
+/// changes the next time the function is called on the same thread.
+const char *GetKeyword(istream &in, const char *delims, ErrorDescriptor &err)
+{
+    static thread_local std::string str;
+    return GetKeyword(in, delims, err, str);
 }
 
 /**
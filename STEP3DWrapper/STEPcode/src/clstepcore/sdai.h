@@ -32,6 +32,7 @@ extern const char *SCLversion;
 #include "baseType.h"
 #include "Str.h"
 #include "errordesc.h"
+#include "decodingTable.h"
 
 typedef std::string Express_id;
 
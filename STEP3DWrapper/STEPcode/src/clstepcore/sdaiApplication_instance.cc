@@ -22,6 +22,9 @@
 
 SDAI_Application_instance NilSTEPentity;
 
+/// \sa SDAI_Application_instance::UseAttrReaders()
+static bool useAttrReaders = true;
+
 bool isNilSTEPentity(const SDAI_Application_instance *ai)
 {
     if(ai && ai == &NilSTEPentity) {
@@ -45,6 +48,7 @@ SDAI_Application_instance::SDAI_Application_instance()
     :  _cur(0),
        eDesc(NULL),
        _complex(false),
+       _modified(false),
        STEPfile_id(0),
        p21Comment(std::string("")),
        headMiEntity(0),
@@ -56,6 +60,7 @@ SDAI_Application_instance::SDAI_Application_instance(int fileid, int complex)
     :  _cur(0),
        eDesc(NULL),
        _complex(complex),
+       _modified(false),
        STEPfile_id(fileid),
        p21Comment(std::string("")),
        headMiEntity(0),
@@ -65,18 +70,15 @@ SDAI_Application_instance::SDAI_Application_instance(int fileid, int complex)
 
 SDAI_Application_instance::~SDAI_Application_instance()
 {
-    STEPattribute *attr;
-
-    ResetAttributes();
-    do {
-        attr = NextAttribute();
-        if(attr) {
-            attr->refCount --;
-            if(attr->refCount <= 0) {
-                delete attr;
-            }
+    AttrListNode *node = (AttrListNode *) attributes.GetHead();
+    for(; node; node = (AttrListNode *) node->NextNode()) {
+        STEPattribute *attr = node->Attr();
+        attr->refCount --;
+        // the attributes of InitAttributes() go with the list
+        if(attr->refCount <= 0 && !attributes.ownsAttr(attr)) {
+            delete attr;
         }
-    } while(attr);
+    }
 
 
     if(MultipleInheritance()) {
@@ -106,6 +108,21 @@ void SDAI_Application_instance::InitIAttrs()
     }
 }
 
+bool SDAI_Application_instance::Modified() const
+{
+    const SDAI_Application_instance *head = headMiEntity ? headMiEntity : this;
+    return head->_modified || head->attributes.Changed();
+}
+
+void SDAI_Application_instance::Modified(bool modified)
+{
+    SDAI_Application_instance *head = headMiEntity ? headMiEntity : this;
+    head->_modified = modified;
+    if(!modified) {
+        head->attributes.Changed(false);
+    }
+}
+
 SDAI_Application_instance *SDAI_Application_instance::Replicate()
 {
     char errStr[BUFSIZ];
@@ -261,6 +278,32 @@ STEPattribute *SDAI_Application_instance::MakeDerived(const char *nm, const char
     return a;
 }
 
+void SDAI_Application_instance::InitAttributes(const AttrLayout *layout, int count, void *object)
+{
+    if(!attributes.pushBlock(count)) {
+        return;
+    }
+
+    for(int i = 0; i < count; i++) {
+        STEPattribute *a = attributes.blockAttr(i);
+        void *member = (char *) object + layout[i].offset;
+        a->aDesc = *layout[i].desc;
+        if(layout[i].flags & AttrLayout_Aggregate) {
+            a->ptr.a = *(STEPaggregate **) member;
+        } else {
+            // enum and select members derive singly from SDAI_Enum and SDAI_Select
+            a->ptr.p = member;
+        }
+        a->set_null();
+        if(layout[i].flags & AttrLayout_Derived) {
+            a->Derive();
+        }
+        if(layout[i].redefines) {
+            attributes.blockAttr(layout[i].redefines - 1)->RedefiningAttr(a);
+        }
+    }
+}
+
 void SDAI_Application_instance::CopyAs(SDAI_Application_instance *other)
 {
     int numAttrs = AttributeCount();
@@ -321,9 +364,11 @@ Severity SDAI_Application_instance::ValidLevel(ErrorDescriptor *error, InstMgrBa
  */
 void SDAI_Application_instance::ClearAttrError()
 {
-    int n = attributes.list_length();
-    for(int i = 0 ; i < n; i++) {
-        attributes[i].Error().ClearErrorMsg();
+    // as indexing the list did, which counts from the head for each attribute
+    attributes.ReadDeferred();
+    AttrListNode *node = (AttrListNode *) attributes.GetHead();
+    for(; node; node = (AttrListNode *) node->NextNode()) {
+        node->Attr()->ClearErrorMsg();
     }
 }
 
@@ -543,7 +588,6 @@ Severity SDAI_Application_instance::STEPread(int id,  int idIncr,
     char c = '\0';
     char errStr[BUFSIZ];
     errStr[0] = '\0';
-    Severity severe;
     int i = 0;
 
     ClearError(1);
@@ -558,105 +602,33 @@ Severity SDAI_Application_instance::STEPread(int id,  int idIncr,
     }
     ReadTokenSeparator(in, &p21Comment);
 
-    int n = attributes.list_length();
-    if(n == 0) {   // no attributes
-        in >> c; // look for the close paren
-        if(c == ')') {
-            return _error.severity();
-        }
-    }
-
-    for(i = 0 ; i < n; i++) {
-        ReadTokenSeparator(in, &p21Comment);
-        if(attributes[i].aDesc->AttrType() == AttrType_Redefining) {
-            in >> ws;
-            c = in.peek();
-            if(!useTechCor) {   // i.e. use pre-technical corrigendum encoding
-                in >> c; // read what should be the '*'
-                in >> ws;
-                if(c == '*') {
-                    in >> c; // read the delimiter i.e. ',' or ')'
-                } else {
-                    severe = SEVERITY_INCOMPLETE;
-                    PrependEntityErrMsg(); // adds entity info if necessary
-
-                    // set the severity for this entity
-                    _error.GreaterSeverity(severe);
-                    sprintf(errStr, "  %s :  ", attributes[i].Name());
-                    _error.AppendToDetailMsg(errStr);   // add attr name
-                    _error.AppendToDetailMsg(
-                        "Since using pre-technical corrigendum... missing asterisk for redefined attr.\n");
-                    _error.AppendToUserMsg(
-                        "Since using pre-technical corrigendum... missing asterisk for redefined attr. ");
-                }
-            } else { // using technical corrigendum
-                // should be nothing to do except loop again unless...
-                // if at end need to have read the closing paren.
-                if(c == ')') {   // assume you are at the end so read last char
-                    in >> c;
-                }
-                cout << "Entity #" << STEPfile_id
-                     << " skipping redefined attribute "
-                     << attributes[i].aDesc->Name() << endl << endl << flush;
-            }
-            // increment counter to read following attr since these attrs
-            // aren't written or read => there won't be a delimiter either
-        } else {
-            attributes[i].STEPread(in, instance_set, idIncr, currSch, strict);
-            in >> c; // read the , or ) following the attr read
-
-            severe = attributes[i].Error().severity();
-
-            if(severe <= SEVERITY_USERMSG) {
-                // if there is some type of error
-                PrependEntityErrMsg();
-
-                // set the severity for this entity
-                _error.GreaterSeverity(severe);
-                sprintf(errStr, "  %s :  ", attributes[i].Name());
-                _error.AppendToDetailMsg(errStr);   // add attr name
-                _error.AppendToDetailMsg(attributes[i].Error().DetailMsg());    // add attr error
-                _error.AppendToUserMsg(attributes[i].Error().UserMsg());
+    int n;
+    AttrReadContext cx = { in, instance_set, idIncr, currSch, useTechCor, strict, c };
+    int read = useAttrReaders ? STEPreadAttrs(cx) : -1;
+    if(read == 0) {
+        return _error.severity();
+    } else if(read > 0) {
+        n = attributes.blockCount();
+    } else {
+        n = attributes.list_length();
+        if(n == 0) {   // no attributes
+            in >> cx.c; // look for the close paren
+            if(cx.c == ')') {
+                return _error.severity();
             }
         }
 
-        // if technical corrigendum redefined, input is at next attribute value
-        // if pre-technical corrigendum redefined, don't process
-        if((!(attributes[i].aDesc->AttrType() == AttrType_Redefining) ||
-                !useTechCor) &&
-                !((c == ',') || (c == ')'))) {        //  input is not a delimiter
-            PrependEntityErrMsg();
-
-            _error.AppendToDetailMsg(
-                "Delimiter expected after attribute value.\n");
-            if(!useTechCor) {
-                _error.AppendToDetailMsg(
-                    "I.e. since using pre-technical corrigendum, redefined ");
-                _error.AppendToDetailMsg(
-                    "attribute is mapped as an asterisk so needs delimiter.\n");
-            }
-            CheckRemainingInput(in, &_error, "ENTITY", ",)");
-            if(!in.good()) {
-                return _error.severity();
-            }
-            if(_error.severity() <= SEVERITY_INPUT_ERROR) {
+        // walk the nodes rather than index the list, which counts from the head
+        AttrListNode *node = (AttrListNode *) attributes.GetHead();
+        for(i = 0 ; i < n; i++, node = (AttrListNode *) node->NextNode()) {
+            if(!STEPreadAttr(*node->Attr(), UNKNOWN_TYPE, i, n, cx)) {
                 return _error.severity();
             }
-        } else if(c == ')') {
-            while(i < n - 1) {
-                i++; // check if following attributes are redefined
-                if(!(attributes[i].aDesc->AttrType() == AttrType_Redefining)) {
-                    PrependEntityErrMsg();
-                    _error.AppendToDetailMsg("Missing attribute value[s].\n");
-                    // recoverable error
-                    _error.GreaterSeverity(SEVERITY_WARNING);
-                    return _error.severity();
-                }
-                i++;
-            }
-            return _error.severity();
         }
     }
+    // all n attributes were read, but no ')' closed them
+    c = cx.c;
+    i = n;
     STEPread_error(c, i, in, currSch);
 //  code fragment imported from STEPread_error
 //  for some currently unknown reason it was commented out of STEPread_error
@@ -689,10 +661,140 @@ Severity SDAI_Application_instance::STEPread(int id,  int idIncr,
     return _error.severity();
 }
 
+void SDAI_Application_instance::UseAttrReaders(bool use)
+{
+    useAttrReaders = use;
+}
+
+bool SDAI_Application_instance::UseAttrReaders()
+{
+    return useAttrReaders;
+}
+
+int SDAI_Application_instance::STEPreadAttrs(AttrReadContext &cx)
+{
+    (void) cx;
+    return -1;
+}
+
+bool SDAI_Application_instance::STEPreadAttr(STEPattribute &attr, PrimitiveType kind, int i, int n,
+        AttrReadContext &cx)
+{
+    istream &in = cx.in;
+    char &c = cx.c;
+    char errStr[BUFSIZ];
+    Severity severe;
+    // the readers of exp2cxx -u give the kind of the attributes that are not redefining
+    bool redefining = (kind == UNKNOWN_TYPE) && (attr.aDesc->AttrType() == AttrType_Redefining);
+
+    ReadTokenSeparator(in, &p21Comment);
+    if(redefining) {
+        in >> ws;
+        c = in.peek();
+        if(!cx.useTechCor) {   // i.e. use pre-technical corrigendum encoding
+            in >> c; // read what should be the '*'
+            in >> ws;
+            if(c == '*') {
+                in >> c; // read the delimiter i.e. ',' or ')'
+            } else {
+                severe = SEVERITY_INCOMPLETE;
+                PrependEntityErrMsg(); // adds entity info if necessary
+
+                // set the severity for this entity
+                _error.GreaterSeverity(severe);
+                sprintf(errStr, "  %s :  ", attr.Name());
+                _error.AppendToDetailMsg(errStr);   // add attr name
+                _error.AppendToDetailMsg(
+                    "Since using pre-technical corrigendum... missing asterisk for redefined attr.\n");
+                _error.AppendToUserMsg(
+                    "Since using pre-technical corrigendum... missing asterisk for redefined attr. ");
+            }
+        } else { // using technical corrigendum
+            // should be nothing to do except loop again unless...
+            // if at end need to have read the closing paren.
+            if(c == ')') {   // assume you are at the end so read last char
+                in >> c;
+            }
+            cout << "Entity #" << STEPfile_id
+                 << " skipping redefined attribute "
+                 << attr.aDesc->Name() << endl << endl << flush;
+        }
+        // increment counter to read following attr since these attrs
+        // aren't written or read => there won't be a delimiter either
+    } else {
+        if(kind == UNKNOWN_TYPE) {
+            attr.STEPread(in, cx.instances, cx.addFileId, cx.currSch, cx.strict);
+        } else {
+            attr.STEPread(kind, in, cx.instances, cx.addFileId, cx.currSch, cx.strict);
+        }
+        in >> c; // read the , or ) following the attr read
+
+        severe = attr.ErrorSeverity();
+
+        if(severe <= SEVERITY_USERMSG) {
+            // if there is some type of error
+            PrependEntityErrMsg();
+
+            // set the severity for this entity
+            _error.GreaterSeverity(severe);
+            sprintf(errStr, "  %s :  ", attr.Name());
+            _error.AppendToDetailMsg(errStr);   // add attr name
+            _error.AppendToDetailMsg(attr.Error().DetailMsg());    // add attr error
+            _error.AppendToUserMsg(attr.Error().UserMsg());
+        }
+    }
+
+    // if technical corrigendum redefined, input is at next attribute value
+    // if pre-technical corrigendum redefined, don't process
+    if((!redefining || !cx.useTechCor) &&
+            !((c == ',') || (c == ')'))) {        //  input is not a delimiter
+        PrependEntityErrMsg();
+
+        _error.AppendToDetailMsg(
+            "Delimiter expected after attribute value.\n");
+        if(!cx.useTechCor) {
+            _error.AppendToDetailMsg(
+                "I.e. since using pre-technical corrigendum, redefined ");
+            _error.AppendToDetailMsg(
+                "attribute is mapped as an asterisk so needs delimiter.\n");
+        }
+        CheckRemainingInput(in, &_error, "ENTITY", ",)");
+        if(!in.good()) {
+            return false;
+        }
+        if(_error.severity() <= SEVERITY_INPUT_ERROR) {
+            return false;
+        }
+    } else if(c == ')') {
+        while(i < n - 1) {
+            i++; // check if following attributes are redefined
+            if(!(attributes[i].aDesc->AttrType() == AttrType_Redefining)) {
+                PrependEntityErrMsg();
+                _error.AppendToDetailMsg("Missing attribute value[s].\n");
+                // recoverable error
+                _error.GreaterSeverity(SEVERITY_WARNING);
+                return false;
+            }
+            i++;
+        }
+        return false;
+    }
+    return true;
+}
+
 /// read an entity reference and return a pointer to the SDAI_Application_instance
 SDAI_Application_instance *ReadEntityRef(istream &in, ErrorDescriptor *err, const char *tokenList,
         InstMgrBase *instances, int addFileId)
 {
+    bool deferred;
+    return ReadEntityRef(in, err, tokenList, instances, addFileId, 0, deferred);
+}
+
+/// read an entity reference, recording it in instances if it refers forward (see InstMgrBase::AddForwardRef())
+SDAI_Application_instance *ReadEntityRef(istream &in, ErrorDescriptor *err, const char *tokenList,
+        InstMgrBase *instances, int addFileId, const ForwardRef *fwd, bool &deferred)
+{
+    deferred = false;
     char c;
     char errStr[BUFSIZ];
     errStr[0] = '\0';
@@ -754,6 +856,10 @@ SDAI_Application_instance *ReadEntityRef(istream &in, ErrorDescriptor *err, cons
                         err->GreaterSeverity(SEVERITY_BUG);
                         return S_ENTITY_NULL;
                     }
+                } else if(fwd && instances->AddForwardRef(id, *fwd)) {
+                    // the instance may be further in the file, the reader stores the reference when all instances exist
+                    deferred = true;
+                    return S_ENTITY_NULL;
                 } else {
                     sprintf(errStr, "Reference to non-existent ENTITY #%d.\n",
                             id);
@@ -14,12 +14,14 @@
 
 #include <map>
 #include <iostream>
+#include <cstddef>
 
 #include <sc_export.h>
 #include <sdaiDaObject.h>
 
 class EntityAggregate;
 class Inverse_attribute;
+class AttrDescriptor;
 typedef struct {
     union {
         EntityAggregate *a;
@@ -27,6 +29,46 @@ typedef struct {
     };
 } iAstruct;
 
+/// what an AttrLayout entry describes, as flags
+enum AttrLayoutFlags {
+    AttrLayout_Member = 0,      ///< attribute on the data member at offset
+    AttrLayout_Aggregate = 1,   ///< attribute on the aggregate the data member at offset points to
+    AttrLayout_Derived = 2      ///< the attribute is derived by a subtype, as MakeDerived()
+};
+
+/**
+ * One entry of the attribute layout table exp2cxx -t emits for each entity
+ * built by single inheritance. The table lists the attributes of the entity
+ * and of its supertypes in the order the constructors would push them, so
+ * SDAI_Application_instance::InitAttributes() can make all of them at once.
+ * exp2cxx resolves the redefined and derived attributes to the entries, so an
+ * entry is 16 bytes with one relocation.
+ */
+struct AttrLayout {
+    AttrDescriptor *const *desc;    ///< schema variable holding the descriptor
+    unsigned int offset;            ///< of the data member in the entity class
+    unsigned short flags;           ///< AttrLayoutFlags
+    unsigned short redefines;       ///< 1 + the index of the attribute redefined by this one, or 0
+};
+
+/// selects the constructor of a generated entity that makes the data members
+/// but no attribute, called by the constructor of its subtype
+struct AttrLayoutTag {
+};
+
+class InstMgrBase;
+
+/// what SDAI_Application_instance::STEPread() reads with, for its STEPreadAttr()
+struct AttrReadContext {
+    std::istream &in;
+    InstMgrBase *instances;
+    int addFileId;
+    const char *currSch;
+    bool useTechCor;
+    bool strict;
+    char c;     ///< the delimiter read after the last attribute
+};
+
 /** @class
  * this used to be STEPentity
  */
@@ -48,6 +90,7 @@ class SC_CORE_EXPORT SDAI_Application_instance  : public SDAI_DAObject_SDAI
 #pragma warning( pop )
 #endif
         bool _complex;
+        bool _modified;
 
     public: //TODO make these private?
         STEPattributeList attributes;
@@ -88,6 +131,19 @@ class SC_CORE_EXPORT SDAI_Application_instance  : public SDAI_DAObject_SDAI
         {
             return _complex;
         }
+        /// read the attributes now if the read of this instance was deferred; called by the generated accessors
+        void ReadDeferred() const
+        {
+            const SDAI_Application_instance *head = headMiEntity ? headMiEntity : this;
+            const_cast<SDAI_Application_instance *>(head)->attributes.ReadDeferred();
+        }
+        /** true if the values may have changed since the instance was read: set by the generated
+         * functions that set an attribute or give access to an aggregate or select, and by
+         * the STEPattribute functions that set a value or give access to it (STEPattribute::Changed()).
+         * Modified(false) clears both.
+         */
+        virtual bool Modified() const;
+        virtual void Modified(bool modified);
         /// initialize inverse attribute list
         void InitIAttrs();
 
@@ -152,6 +208,10 @@ class SC_CORE_EXPORT SDAI_Application_instance  : public SDAI_DAObject_SDAI
                                   std::istream &in = std::cin, const char *currSch = NULL,
                                   bool useTechCor = true, bool strict = true);
         virtual void STEPread_error(char c, int i, std::istream &in, const char *schnm);
+        /// true (the default) to let STEPread() use the attribute readers of
+        /// exp2cxx -u, false to read every instance by the loop, as to compare them
+        static void UseAttrReaders(bool use);
+        static bool UseAttrReaders();
 
 // WRITE
         virtual void STEPwrite(std::ostream &out = std::cout, const char *currSch = NULL,
@@ -194,6 +254,29 @@ class SC_CORE_EXPORT SDAI_Application_instance  : public SDAI_DAObject_SDAI
         STEPattribute *MakeDerived(const char *nm, const char *entity = NULL);
         STEPattribute *MakeRedefined(STEPattribute *redefiningAttr,
                                      const char *nm);
+        /**
+         * Makes the \p count attributes listed by a table of exp2cxx -t in one
+         * block and sets them null. \p object is the entity (this, as the
+         * generated class) the offsets of the table are relative to. Call once,
+         * on an instance without attributes.
+         */
+        void InitAttributes(const AttrLayout *layout, int count, void *object);
+        /**
+         * Reads attribute \p i of the \p n of the instance and the delimiter
+         * after it, as one turn of the loop of STEPread(). \p kind is the
+         * NonRefType() of \p attr, or UNKNOWN_TYPE to look it up.
+         * \returns false if STEPread() is to return _error.severity()
+         */
+        bool STEPreadAttr(STEPattribute &attr, PrimitiveType kind, int i, int n, AttrReadContext &cx);
+        /**
+         * Reads the attributes made by InitAttributes() for STEPread(), by one
+         * STEPreadAttr() each. exp2cxx -u overrides it for an entity with a
+         * reader that knows their order and types; any other instance is read
+         * by the loop of STEPread().
+         * \returns -1 if the attributes were not read, 0 if STEPread() is to
+         * return _error.severity(), 1 if all of them were read
+         */
+        virtual int STEPreadAttrs(AttrReadContext &cx);
 
         virtual void CopyAs(SDAI_Application_instance *);
         void PrependEntityErrMsg();
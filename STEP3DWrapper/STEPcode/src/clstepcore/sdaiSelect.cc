@@ -16,6 +16,7 @@
 #include <string>
 #include <sdai.h>
 #include <STEPattribute.h>
+#include <instmgr.h>
 
 #ifdef  SC_LOGGING
 #include <fstream.h>
@@ -515,8 +516,14 @@ Severity SDAI_Select::STEPread(istream &in, ErrorDescriptor *err,
         if(base_type == ENTITY_TYPE) {
             // you don't know if this is an ENTITY or a SELECT
             // have to do this here - not in STEPread_content
+            ForwardRef fwd(this);
+            bool deferred;
             STEPentity *temp =
-                ReadEntityRef(in, err, ",)", instances, addFileId);
+                ReadEntityRef(in, err, ",)", instances, addFileId, &fwd, deferred);
+            if(deferred) {
+                // assigned by AssignForwardRef() once the instance exists
+                return SEVERITY_NULL;
+            }
             if(temp && (temp != ENTITY_NULL) && AssignEntity(temp)) {
 #ifdef SC_LOGGING
 //    *logStream << "DAVE ERR Exiting SDAI_Select::STEPread for " << _type->Name() << endl;
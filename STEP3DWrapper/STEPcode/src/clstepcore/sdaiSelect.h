@@ -65,6 +65,12 @@ class SC_CORE_EXPORT SDAI_Select
         Severity SelectValidLevel(const char *attrValue, ErrorDescriptor *err,
                                   InstMgrBase *im);
 
+        /// assign the instance of a forward reference (see InstMgrBase::AddForwardRef()); false if se is not a valid choice
+        bool AssignForwardRef(SDAI_Application_instance *se)
+        {
+            return AssignEntity(se) != 0;
+        }
+
         // reading and writing
         const char *STEPwrite(std::string &s, const char *currSch = 0) const;
         void STEPwrite(ostream &out = cout, const char *currSch = 0) const;
@@ -1,4 +1,5 @@
 #include "selectTypeDescriptor.h"
+#include <string.h>
 
 ///////////////////////////////////////////////////////////////////////////////
 // SelectTypeDescriptor functions
@@ -13,6 +14,19 @@ SDAI_Select *SelectTypeDescriptor::CreateSelect()
     }
 }
 
+void SelectTypeDescriptor::SetDecodingTable(const DecodingTable *decoding, const short *choices)
+{
+    TypeDescItr elements(GetElements()) ;
+    const TypeDescriptor *td;
+
+    _decodingElements.clear();
+    while((td = elements.NextTypeDesc())) {
+        _decodingElements.push_back(td);
+    }
+    _decoding = decoding;
+    _decodingChoices = choices;
+}
+
 const TypeDescriptor *SelectTypeDescriptor::IsA(const TypeDescriptor *other) const
 {
     return TypeDescriptor::IsA(other);
@@ -85,19 +99,36 @@ const TypeDescriptor *SelectTypeDescriptor::CanBe(const char *other) const
  */
 const TypeDescriptor *SelectTypeDescriptor::CanBeSet(const char *other, const char *schNm) const
 {
+    // The names written by exp2cxx give the only element which can match,
+    // unless the current schema renames one of the choices.
+    if(_decoding) {
+        int n = _decoding->find(other, strlen(other));
+        if(n >= 0) {
+            const TypeDescriptor *td = _decodingElements[_decodingChoices[n]];
+            if(CanBeSetTo(td, other, schNm)) {
+                return td;
+            }
+        }
+    }
+
     TypeDescItr elements(GetElements()) ;
     const TypeDescriptor *td = elements.NextTypeDesc();
 
     while(td) {
-        if(td->Type() == REFERENCE_TYPE && td->NonRefType() == sdaiSELECT) {
-            // Just look at this level, don't look at my items (see intro).
-            if(td->CurrName(other, schNm)) {
-                return td;
-            }
-        } else if(td->CanBeSet(other, schNm)) {
+        if(CanBeSetTo(td, other, schNm)) {
             return td;
         }
         td = elements.NextTypeDesc();
     }
     return 0;
 }
+
+/// true if other, read as the type of a select value, names the element td
+bool SelectTypeDescriptor::CanBeSetTo(const TypeDescriptor *td, const char *other, const char *schNm) const
+{
+    if(td->Type() == REFERENCE_TYPE && td->NonRefType() == sdaiSELECT) {
+        // Just look at this level, don't look at my items (see intro).
+        return td->CurrName(other, schNm);
+    }
+    return (td->CanBeSet(other, schNm) != 0);
+}
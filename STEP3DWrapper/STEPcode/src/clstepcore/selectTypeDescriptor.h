@@ -1,7 +1,10 @@
 #ifndef SELECTTYPEDESCRIPTOR_H
 #define SELECTTYPEDESCRIPTOR_H
 
+#include <vector>
+
 #include "typeDescriptor.h"
+#include "decodingTable.h"
 
 typedef SDAI_Select *(* SelectCreator)();
 
@@ -12,6 +15,13 @@ class SC_CORE_EXPORT SelectTypeDescriptor  :    public TypeDescriptor
         TypeDescriptorList _elements;    //  of  TYPE_DESCRIPTOR
         int _unique_elements;
 
+        /// names of the choices written by exp2cxx, see SetDecodingTable()
+        const DecodingTable *_decoding;
+        const short *_decodingChoices;
+        std::vector<const TypeDescriptor *> _decodingElements;
+
+        bool CanBeSetTo(const TypeDescriptor *td, const char *other, const char *schNm) const;
+
     public:
 
         SelectCreator CreateNewSelect;
@@ -27,7 +37,8 @@ class SC_CORE_EXPORT SelectTypeDescriptor  :    public TypeDescriptor
                              Schema *origSchema,
                              const char *d, SelectCreator f = 0)
             : TypeDescriptor(nm, ft, origSchema, d),
-              _unique_elements(b), CreateNewSelect(f)
+              _unique_elements(b), _decoding(0), _decodingChoices(0),
+              CreateNewSelect(f)
         { }
         virtual ~SelectTypeDescriptor() { }
 
@@ -39,6 +50,14 @@ class SC_CORE_EXPORT SelectTypeDescriptor  :    public TypeDescriptor
         {
             return _elements;
         }
+        /** lookup of the choices by name, used by CanBeSet()
+         * \param decoding the names of the choices; an element which is a select, unless
+         *        it's a renamed select, is found by the names of its own choices
+         * \param choices index in Elements() of each name of decoding
+         * must be called once all the elements have been added
+         */
+        void SetDecodingTable(const DecodingTable *decoding, const short *choices);
+
         int UniqueElements() const
         {
             return _unique_elements;
@@ -0,0 +1,60 @@
+///test that reals are read with a '.' whatever the LC_NUMERIC of the process
+
+#include <read_func.h>
+#include <errordesc.h>
+#include <sdai.h>
+#include <locale.h>
+#include <string.h>
+#include <sstream>
+
+/// exit code that ctest reports as skipped, see SKIP_RETURN_CODE in CMakeLists.txt
+#define SKIP_TEST 77
+
+/// sets LC_NUMERIC to a locale whose decimal point is a comma; false if none is installed
+bool setCommaLocale(const char *requested)
+{
+    const char *names[] = { requested, "de_DE.UTF-8", "de_DE.utf8", "de_DE", "fr_FR.UTF-8", "fr_FR.utf8", "fr_FR",
+                            "German_Germany.1252", "French_France.1252", 0
+                          };
+    for(int i = (requested ? 0 : 1); names[i]; i++) {
+        if(setlocale(LC_NUMERIC, names[i]) && !strcmp(localeconv()->decimal_point, ",")) {
+            std::cout << "LC_NUMERIC is " << names[i] << std::endl;
+            return true;
+        }
+    }
+    return false;
+}
+
+/// reads text and compares the value with expected; returns true on success
+/// the value must be the same double, so it is compared bit for bit
+bool testRead(const char *text, double expected)
+{
+    SDAI_Real val = 0.0;
+    ErrorDescriptor err;
+    std::istringstream in(text);
+    if(!ReadReal(val, in, &err, ",)") || memcmp(&val, &expected, sizeof val) || err.severity() < SEVERITY_WARNING) {
+        std::cerr << "reading " << text << " gave " << val << " instead of " << expected << ", "
+                  << err.DetailMsg() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    if(!setCommaLocale(argc > 1 ? argv[1] : 0)) {
+        std::cout << "no locale with a decimal comma is installed, test skipped" << std::endl;
+        exit(SKIP_TEST);
+    }
+
+    bool pass = true;
+    pass &= testRead("1.5", 1.5);
+    pass &= testRead("-2.25E3,", -2250.0);
+    pass &= testRead("3.)", 3.0);
+    pass &= testRead("1.0E-2", 0.01);
+
+    if(pass) {
+        exit(EXIT_SUCCESS);
+    }
+    exit(EXIT_FAILURE);
+}
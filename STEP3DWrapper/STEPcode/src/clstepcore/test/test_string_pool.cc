@@ -0,0 +1,82 @@
+///test the InstMgr string pool, and that string attributes keep their own copy
+
+#include <ExpDict.h>
+#include <STEPattribute.h>
+#include <instmgr.h>
+#include <sdaiString.h>
+#include <sstream>
+
+int main()
+{
+    bool pass = true;
+
+    // a string attribute costs no more than its std::string
+    if(sizeof(SDAI_String) != sizeof(std::string)) {
+        std::cerr << "SDAI_String is " << sizeof(SDAI_String) << " bytes, std::string " << sizeof(std::string) << std::endl;
+        pass = false;
+    }
+
+    InstMgr im;
+    im.UseStringPool(true);
+    SDAI_String_Pool *pool = im.GetStringPool();
+
+    std::string long1("'a description longer than the buffer'"), long2("'another long description string'");
+    SDAI_String_Pool::Handle h1 = pool->Intern(long1);
+    SDAI_String_Pool::Handle h2 = pool->Intern(std::string(long1));
+    SDAI_String_Pool::Handle h3 = pool->Intern(long2);
+    if(!h1 || h1 != h2 || *h1 != long1) {
+        std::cerr << "equal strings do not share one copy" << std::endl;
+        pass = false;
+    }
+    if(!h3 || h3 == h1) {
+        std::cerr << "different strings share one copy" << std::endl;
+        pass = false;
+    }
+    if(pool->Intern("'short'")) {
+        std::cerr << "short string should be copied" << std::endl;
+        pass = false;
+    }
+    if(pool->InternCount() != 3 || pool->UniqueCount() != 2) {
+        std::cerr << "unexpected pool counts " << pool->InternCount() << " / " << pool->UniqueCount() << std::endl;
+        pass = false;
+    }
+    // one repeated string does not pay for the pool entries
+    if(pool->BytesSaved() >= 0) {
+        std::cerr << "unexpected bytes saved " << pool->BytesSaved() << std::endl;
+        pass = false;
+    }
+    for(int i = 0; i < 10; i++) {
+        pool->Intern(long1);
+    }
+    if(pool->BytesSaved() <= 0) {
+        std::cerr << "repeated strings save nothing: " << pool->BytesSaved() << std::endl;
+        pass = false;
+    }
+
+    // reading a string attribute does not use the pool
+    Schema *sch = new Schema("Ap242");
+    TypeDescriptor *td = new TypeDescriptor("Label", sdaiSTRING, sch, "STRING");
+    EntityDescriptor *ed = new EntityDescriptor("Product_definition", sch, LFalse, LFalse);
+    AttrDescriptor *ad = new AttrDescriptor("description", td, LFalse, LFalse, AttrType_Explicit, *ed);
+    ed->AddExplicitAttr(ad);
+
+    SDAI_String s1, s2;
+    STEPattribute a1(*ad, &s1), a2(*ad, &s2);
+    std::istringstream in1(long1), in2(long1);
+    a1.STEPread(in1, &im);
+    a2.STEPread(in2, &im);
+    // the value keeps its quotes, as written in the file
+    if(!(s1 == s2) || !(s1 == long1.c_str()) || s1.c_str() == s2.c_str() || pool->InternCount() != 13) {
+        std::cerr << "string attributes are not read as separate copies" << std::endl;
+        pass = false;
+    }
+
+    delete ed;
+    delete td;
+    delete sch;
+
+    if(pass) {
+        exit(EXIT_SUCCESS);
+    }
+    exit(EXIT_FAILURE);
+}
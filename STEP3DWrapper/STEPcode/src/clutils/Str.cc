@@ -12,6 +12,11 @@
 #include "Str.h"
 #include <sstream>
 #include <string>
+#include <locale>
+#include <locale.h>
+#ifdef __APPLE__
+#  include <xlocale.h>
+#endif
 
 /******************************************************************
  ** Procedure:  string functions
@@ -139,6 +144,33 @@ bool StrEndsWith(const std::string &s, const char *suf)
     return false;
 }
 
+/**
+ * The numbers of a STEP file always use '.', but strtod() follows the
+ * LC_NUMERIC of the process, which the application may have set to a locale
+ * with a decimal comma.
+ */
+double StrToReal(const char *s, char **end)
+{
+#if defined(_WIN32)
+    static _locale_t cLocale = _create_locale(LC_NUMERIC, "C");
+    return _strtod_l(s, end, cLocale);
+#elif defined(__GLIBC__) || defined(__APPLE__) || defined(__FreeBSD__)
+    static locale_t cLocale = newlocale(LC_NUMERIC_MASK, "C", (locale_t) 0);
+    return strtod_l(s, end, cLocale);
+#else
+    std::istringstream in(s);
+    in.imbue(std::locale::classic());
+    double d = 0.0;
+    in >> d;
+    if(in.fail()) {
+        *end = (char *) s;
+        return 0.0;
+    }
+    *end = (char *) s + (in.eof() ? strlen(s) : (size_t) in.tellg());
+    return d;
+#endif
+}
+
 /**
  *  Extract the next delimited string from the istream.
  */
@@ -181,17 +213,17 @@ std::string GetLiteralStr(istream &in, ErrorDescriptor *err)
 }
 
 /**************************************************************//**
- ** \fn  PrettyTmpName (char * oldname)
- ** \returns  a new capitalized name in a static buffer
+ ** \fn  PrettyTmpName (const char * oldname, char * newname)
+ ** \returns  newname, the capitalized name
  ** Capitalizes first char of word, rest is lowercase. Removes '_'.
- ** Status:   OK  7-Oct-1992 kcm
+ ** newname is supplied by the caller and must hold BUFSIZ chars, so this
+ ** can be used by several threads at once.
  ******************************************************************/
-const char *PrettyTmpName(const char *oldname)
+const char *PrettyTmpName(const char *oldname, char *newname)
 {
     int i = 0;
-    static char newname [BUFSIZ];
     newname [0] = '\0';
-    while((oldname [i] != '\0') && (i < BUFSIZ)) {
+    while((oldname [i] != '\0') && (i < BUFSIZ - 2)) {
         newname [i] = ToLower(oldname [i]);
         if(oldname [i] == '_') {   /*  character is '_'   */
             ++i;
@@ -206,6 +238,19 @@ const char *PrettyTmpName(const char *oldname)
     return newname;
 }
 
+/**************************************************************//**
+ ** \fn  PrettyTmpName (char * oldname)
+ ** \returns  a new capitalized name in a thread local buffer
+ ** Capitalizes first char of word, rest is lowercase. Removes '_'.
+ ** The buffer is overwritten by the next call on the same thread.
+ ** Status:   OK  7-Oct-1992 kcm
+ ******************************************************************/
+const char *PrettyTmpName(const char *oldname)
+{
+    static thread_local char newname [BUFSIZ];
+    return PrettyTmpName(oldname, newname);
+}
+
 /**************************************************************//**
  ** \fn  PrettyNewName (char * oldname)
  ** \returns  a new capitalized name
@@ -220,6 +265,29 @@ char *PrettyNewName(const char *oldname)
     return name;
 }
 
+/**************************************************************//**
+ ** \fn  RemainingInputIsClean (istream & in, const char * delimiterList)
+ ** \returns  true if CheckRemainingInput() would not report an error
+ ** Clears the fail bit and skips white space like CheckRemainingInput(),
+ ** so callers can skip building the type name of the error message when
+ ** the value was followed by EOF or by one of the delimiters.
+ ******************************************************************/
+bool RemainingInputIsClean(istream &in, const char *delimiterList)
+{
+    if(in.eof()) {
+        return true;
+    }
+    if(in.bad()) {
+        return false;
+    }
+    in.clear();
+    in >> ws;
+    if(in.eof()) {
+        return true;
+    }
+    return delimiterList != NULL && strchr(delimiterList, (char)in.peek()) != NULL;
+}
+
 /**
 *** This function is used to check an input stream following a read.  It writes
 *** error messages in the 'ErrorDescriptor &err' argument as appropriate.
@@ -260,78 +328,67 @@ Severity CheckRemainingInput(istream &in, ErrorDescriptor *err,
                              const char *typeName,  // used in error message
                              const char *delimiterList)     // e.g. ",)"
 {
+    if(RemainingInputIsClean(in, delimiterList)) {
+        // no error
+        return err->severity();
+    }
+
+    // only the error paths below build messages
     string skipBuf;
     ostringstream errMsg;
 
-    if(in.eof()) {
-        // no error
-        return err->severity();
-    } else if(in.bad()) {
+    if(in.bad()) {
         // Bad bit must have been set during read. Recovery is impossible.
         err->GreaterSeverity(SEVERITY_INPUT_ERROR);
         errMsg << "Invalid " << typeName << " value.\n";
         err->AppendToUserMsg(errMsg.str().c_str());
         err->AppendToDetailMsg(errMsg.str().c_str());
-    } else {
-        // At most the fail bit is set, so stream can still be read.
-        // Clear errors and skip whitespace.
-        in.clear();
-        in >> ws;
-
-        if(in.eof()) {
-            // no error
-            return err->severity();
+    } else if(delimiterList != NULL) {
+        // RemainingInputIsClean() cleared the fail bit and skipped white
+        // space. Extra input is more than just a delimiter and is now
+        // considered invalid. We'll try to recover by skipping to the next
+        // delimiter.
+        char c;
+        for(in.get(c); in && !strchr(delimiterList, c); in.get(c)) {
+            skipBuf += c;
         }
 
-        if(delimiterList != NULL) {
-            // If the next char is a delimiter then there's no error.
-            char c = in.peek();
-            if(strchr(delimiterList, c) == NULL) {
-                // Error. Extra input is more than just a delimiter and is
-                // now considered invalid. We'll try to recover by skipping
-                // to the next delimiter.
-                for(in.get(c); in && !strchr(delimiterList, c); in.get(c)) {
-                    skipBuf += c;
-                }
-
-                if(strchr(delimiterList, c) != NULL) {
-                    // Delimiter found. Recovery succeeded.
-                    in.putback(c);
-
-                    errMsg << "\tFound invalid " << typeName << " value...\n";
-                    err->AppendToUserMsg(errMsg.str().c_str());
-                    err->AppendToDetailMsg(errMsg.str().c_str());
-                    err->AppendToDetailMsg("\tdata lost looking for end of "
-                                           "attribute: ");
-                    err->AppendToDetailMsg(skipBuf.c_str());
-                    err->AppendToDetailMsg("\n");
-
-                    err->GreaterSeverity(SEVERITY_WARNING);
-                } else {
-                    // No delimiter found. Recovery failed.
-                    errMsg << "Unable to recover from input error while "
-                           << "reading " << typeName << " value.\n";
-                    err->AppendToUserMsg(errMsg.str().c_str());
-                    err->AppendToDetailMsg(errMsg.str().c_str());
-
-                    err->GreaterSeverity(SEVERITY_INPUT_ERROR);
-                }
-            }
-        } else if(in.good()) {
-            // Error. Have more input, but lack of delimiter list means we
-            // don't know where we can safely resume. Recovery is impossible.
-            err->GreaterSeverity(SEVERITY_WARNING);
+        if(strchr(delimiterList, c) != NULL) {
+            // Delimiter found. Recovery succeeded.
+            in.putback(c);
 
-            errMsg << "Invalid " << typeName << " value.\n";
+            errMsg << "\tFound invalid " << typeName << " value...\n";
+            err->AppendToUserMsg(errMsg.str().c_str());
+            err->AppendToDetailMsg(errMsg.str().c_str());
+            err->AppendToDetailMsg("\tdata lost looking for end of "
+                                   "attribute: ");
+            err->AppendToDetailMsg(skipBuf.c_str());
+            err->AppendToDetailMsg("\n");
 
+            err->GreaterSeverity(SEVERITY_WARNING);
+        } else {
+            // No delimiter found. Recovery failed.
+            errMsg << "Unable to recover from input error while "
+                   << "reading " << typeName << " value.\n";
             err->AppendToUserMsg(errMsg.str().c_str());
             err->AppendToDetailMsg(errMsg.str().c_str());
+
+            err->GreaterSeverity(SEVERITY_INPUT_ERROR);
         }
+    } else {
+        // Error. Have more input, but lack of delimiter list means we
+        // don't know where we can safely resume. Recovery is impossible.
+        err->GreaterSeverity(SEVERITY_WARNING);
+
+        errMsg << "Invalid " << typeName << " value.\n";
+
+        err->AppendToUserMsg(errMsg.str().c_str());
+        err->AppendToDetailMsg(errMsg.str().c_str());
     }
     return err->severity();
 }
 
-Severity CheckRemainingInput(std::istream &in, ErrorDescriptor *err, const std::string typeName, const char *tokenList)
+Severity CheckRemainingInput(std::istream &in, ErrorDescriptor *err, const std::string &typeName, const char *tokenList)
 {
     return CheckRemainingInput(in, err, typeName.c_str(), tokenList);
 }
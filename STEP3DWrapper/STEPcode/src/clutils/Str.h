@@ -33,15 +33,19 @@ SC_UTILS_EXPORT const char *StrToUpper(const char *word, std::string &s);
 SC_UTILS_EXPORT const char *StrToConstant(const char *word, std::string &s);
 SC_UTILS_EXPORT int          StrCmpIns(const char *str1, const char *str2);
 SC_UTILS_EXPORT const char *PrettyTmpName(const char *oldname);
+SC_UTILS_EXPORT const char *PrettyTmpName(const char *oldname, char *newname);
 SC_UTILS_EXPORT char        *PrettyNewName(const char *oldname);
 SC_UTILS_EXPORT char        *EntityClassName(char *oldname);
 
 SC_UTILS_EXPORT bool StrEndsWith(const std::string &s, const char *suffix);
+/// strtod() in the "C" locale: the decimal point is '.' whatever the LC_NUMERIC of the process
+SC_UTILS_EXPORT double       StrToReal(const char *s, char **end);
 SC_UTILS_EXPORT std::string  GetLiteralStr(istream &in, ErrorDescriptor *err);
 
+extern SC_UTILS_EXPORT bool RemainingInputIsClean(std::istream &in, const char *tokenList);
 extern SC_UTILS_EXPORT Severity CheckRemainingInput(std::istream &in, ErrorDescriptor *err,
         const char *typeName,  // used in error message
         const char *tokenList);   // e.g. ",)"
-extern SC_UTILS_EXPORT Severity CheckRemainingInput(std::istream &in, ErrorDescriptor *err, const std::string typeName, const char *tokenList);
+extern SC_UTILS_EXPORT Severity CheckRemainingInput(std::istream &in, ErrorDescriptor *err, const std::string &typeName, const char *tokenList);
 
 #endif
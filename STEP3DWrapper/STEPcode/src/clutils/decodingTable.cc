@@ -0,0 +1,49 @@
+/** \file decodingTable.cc
+ * Lookup in the tables written by exp2cxx, see decodingTable.h
+ */
+
+#include <decodingTable.h>
+
+/// ASCII only, the names of a schema are never localized
+static inline unsigned char upperChar(char c)
+{
+    return (c >= 'a' && c <= 'z') ? (unsigned char)(c - 'a' + 'A') : (unsigned char) c;
+}
+
+unsigned int DecodingTable::hash(const char *token, size_t len)
+{
+    unsigned int h = 2166136261u;
+    for(size_t i = 0; i < len; i++) {
+        h = (h ^ upperChar(token[i])) * 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    return h;
+}
+
+unsigned int DecodingTable::displace(unsigned int h, unsigned int d)
+{
+    h += d * 0x9e3779b9u;
+    h ^= h >> 15;
+    h *= 0x2c1b3c6du;
+    h ^= h >> 12;
+    return h;
+}
+
+int DecodingTable::find(const char *token, size_t len) const
+{
+    unsigned int h = hash(token, len);
+    int i = slots[displace(h, displacements[h & bucketMask]) & slotMask];
+    if(i < 0) {
+        return -1;
+    }
+
+    const char *name = names[i];
+    for(size_t k = 0; k < len; k++) {
+        if(name[k] != (char) upperChar(token[k])) {
+            return -1;
+        }
+    }
+    return (name[len] == '\0') ? i : -1;
+}
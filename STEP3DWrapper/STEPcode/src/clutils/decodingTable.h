@@ -0,0 +1,41 @@
+#ifndef DECODINGTABLE_H
+#define DECODINGTABLE_H
+
+/** \file decodingTable.h
+ * Constant time lookup of the name of an enumeration item or of a select
+ * choice, as read from a STEP file.
+ *
+ * exp2cxx writes one table per enumeration and per select type, a
+ * perfect hash of its names: the hash of a name selects a bucket, and the
+ * displacement of the bucket, chosen by exp2cxx, moves each name of the
+ * bucket to a slot of its own. A lookup is one hash and one comparison,
+ * without allocation.
+ *
+ * hash() and displace() must compute the same values as DECODINGhash() and
+ * DECODINGdisplace() in src/exp2cxx/decoding_tables.c.
+ */
+
+#include <sc_export.h>
+#include <stddef.h>
+
+struct SC_UTILS_EXPORT DecodingTable {
+    const char * const *names;              ///< upper case names
+    const short *slots;                     ///< index in names of each slot, -1 for an empty slot
+    const unsigned short *displacements;    ///< displacement of each bucket
+    unsigned int slotMask;                  ///< number of slots - 1, a power of 2
+    unsigned int bucketMask;                ///< number of buckets - 1, a power of 2
+
+    /** \returns the index in names of token, compared without case, or -1
+     * \param token the name, not necessarily null terminated
+     * \param len the length of the name
+     */
+    int find(const char *token, size_t len) const;
+
+    /// 32 bit FNV-1a hash of the upper case token, with a final mix
+    static unsigned int hash(const char *token, size_t len);
+
+    /// slot of a hash in a bucket with displacement d, before the mask
+    static unsigned int displace(unsigned int h, unsigned int d);
+};
+
+#endif /* DECODINGTABLE_H */
@@ -21,11 +21,11 @@ void
 ErrorDescriptor::PrintContents(ostream &out) const
 {
     out << "Severity: " << severityString() << endl;
-    if(!_userMsg.empty()) {
+    if(_msgs && !_msgs->userMsg.empty()) {
         out << "User message in parens:" << endl << "(";
         out << UserMsg() << ")" << endl;
     }
-    if(!_detailMsg.empty()) {
+    if(_msgs && !_msgs->detailMsg.empty()) {
         out << "Detailed message in parens:" << endl << "(";
         out << DetailMsg() << ")" << endl;
     }
@@ -116,53 +116,90 @@ ErrorDescriptor::GetCorrSeverity(const char *s)
     return SEVERITY_BUG;
 }
 
-ErrorDescriptor::ErrorDescriptor(Severity s,  DebugLevel d) : _severity(s)
+ErrorDescriptor::ErrorDescriptor(Severity s,  DebugLevel d) : _msgs(0), _severity(s)
 {
     if(d  != DEBUG_OFF) {
         _debug_level = d;
     }
 }
 
+ErrorDescriptor::ErrorDescriptor(const ErrorDescriptor &e) : _msgs(0), _severity(e._severity)
+{
+    if(e._msgs) {
+        _msgs = new Messages(*e._msgs);
+    }
+}
+
+ErrorDescriptor &ErrorDescriptor::operator=(const ErrorDescriptor &e)
+{
+    if(this != &e) {
+        _severity = e._severity;
+        if(e._msgs) {
+            Msgs() = *e._msgs;
+        } else {
+            delete _msgs;
+            _msgs = 0;
+        }
+    }
+    return *this;
+}
+
 ErrorDescriptor::~ErrorDescriptor(void)
 {
+    delete _msgs;
 }
 
+// The message setters do not allocate for an empty message, which is
+// what the readers pass on their error free path
+
 void ErrorDescriptor::UserMsg(const char *msg)
 {
-    _userMsg.assign(msg);
+    if(_msgs || *msg) {
+        Msgs().userMsg.assign(msg);
+    }
 }
 
 void ErrorDescriptor::PrependToUserMsg(const char *msg)
 {
-    _userMsg.insert(0, msg);
+    if(*msg) {
+        Msgs().userMsg.insert(0, msg);
+    }
 }
 
 void ErrorDescriptor::AppendToUserMsg(const char c)
 {
-    _userMsg.push_back(c);
+    Msgs().userMsg.push_back(c);
 }
 
 void ErrorDescriptor::AppendToUserMsg(const char *msg)
 {
-    _userMsg.append(msg);
+    if(*msg) {
+        Msgs().userMsg.append(msg);
+    }
 }
 
 void ErrorDescriptor::DetailMsg(const char *msg)
 {
-    _detailMsg.assign(msg);
+    if(_msgs || *msg) {
+        Msgs().detailMsg.assign(msg);
+    }
 }
 
 void ErrorDescriptor::PrependToDetailMsg(const char *msg)
 {
-    _detailMsg.insert(0, msg);
+    if(*msg) {
+        Msgs().detailMsg.insert(0, msg);
+    }
 }
 
 void ErrorDescriptor::AppendToDetailMsg(const char c)
 {
-    _detailMsg.push_back(c);
+    Msgs().detailMsg.push_back(c);
 }
 
 void ErrorDescriptor::AppendToDetailMsg(const char *msg)
 {
-    _detailMsg.append(msg);
+    if(*msg) {
+        Msgs().detailMsg.append(msg);
+    }
 }
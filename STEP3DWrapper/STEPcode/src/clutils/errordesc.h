@@ -48,6 +48,8 @@ typedef int DebugLevel;
  **    also keeps a user message separately
  **    detailed message gets sent to ostream
  **    uses std::string class to keep the user messages
+ **    the messages are allocated on the first non-empty one, so a
+ **      descriptor without error is only a severity and a pointer
  **    keeps severity of error
  **    created with or without error
  ** Status:
@@ -56,14 +58,19 @@ typedef int DebugLevel;
 class SC_UTILS_EXPORT ErrorDescriptor
 {
     private:
-#ifdef _MSC_VER
-#pragma warning( push )
-#pragma warning( disable: 4251 )
-#endif
-        std::string _userMsg, _detailMsg;
-#ifdef _MSC_VER
-#pragma warning( pop )
-#endif
+        struct Messages {
+            std::string userMsg, detailMsg;
+        };
+        /// null until a message is set; most descriptors never have one
+        Messages *_msgs;
+
+        Messages &Msgs()
+        {
+            if(!_msgs) {
+                _msgs = new Messages;
+            }
+            return *_msgs;
+        }
     protected:
         Severity    _severity;
 
@@ -72,6 +79,8 @@ class SC_UTILS_EXPORT ErrorDescriptor
     public:
         ErrorDescriptor(Severity s    = SEVERITY_NULL,
                         DebugLevel d  = DEBUG_OFF);
+        ErrorDescriptor(const ErrorDescriptor &e);
+        ErrorDescriptor &operator=(const ErrorDescriptor &e);
         ~ErrorDescriptor(void);
 
         void PrintContents(ostream &out = cout) const;
@@ -79,8 +88,8 @@ class SC_UTILS_EXPORT ErrorDescriptor
         void ClearErrorMsg()
         {
             _severity = SEVERITY_NULL;
-            _userMsg.clear();
-            _detailMsg.clear();
+            delete _msgs;
+            _msgs = 0;
         }
 
         // return the enum value of _severity
@@ -101,35 +110,43 @@ class SC_UTILS_EXPORT ErrorDescriptor
 
         std::string UserMsg() const
         {
-            return _userMsg;
+            return _msgs ? _msgs->userMsg : std::string();
         }
         void UserMsg(const char *msg);
         void UserMsg(const std::string msg)
         {
-            _userMsg.assign(msg);
+            if(_msgs || !msg.empty()) {
+                Msgs().userMsg.assign(msg);
+            }
         }
 
         void AppendToUserMsg(const char *msg);
         void AppendToUserMsg(const char c);
         void AppendToUserMsg(const std::string &msg)
         {
-            _userMsg.append(msg);
+            if(!msg.empty()) {
+                Msgs().userMsg.append(msg);
+            }
         }
         void PrependToUserMsg(const char *msg);
 
         std::string DetailMsg() const
         {
-            return _detailMsg;
+            return _msgs ? _msgs->detailMsg : std::string();
         }
         void DetailMsg(const std::string msg)
         {
-            _detailMsg.assign(msg);
+            if(_msgs || !msg.empty()) {
+                Msgs().detailMsg.assign(msg);
+            }
         }
         void DetailMsg(const char *msg);
         void AppendToDetailMsg(const char *msg);
         void AppendToDetailMsg(const std::string &msg)
         {
-            _detailMsg.append(msg);
+            if(!msg.empty()) {
+                Msgs().detailMsg.append(msg);
+            }
         }
         void PrependToDetailMsg(const char *msg);
         void AppendToDetailMsg(const char c);
@@ -137,8 +154,10 @@ class SC_UTILS_EXPORT ErrorDescriptor
         Severity AppendFromErrorArg(ErrorDescriptor *err)
         {
             GreaterSeverity(err->severity());
-            AppendToDetailMsg(err->DetailMsg());
-            AppendToUserMsg(err->UserMsg());
+            if(err->_msgs) {
+                AppendToDetailMsg(err->_msgs->detailMsg);
+                AppendToUserMsg(err->_msgs->userMsg);
+            }
             return severity();
         }
 
@@ -37,6 +37,8 @@ N350 ( August 31, 1993 ) of ISO 10303 TC184/SC4/WG7.
 int multiple_inheritance = 1;
 int print_logging = 0;
 int old_accessors = 0;
+int layout_tables = 0;
+int attr_readers = 0;
 
 /**
  * Turn the string into a new string that will be printed the same as the
@@ -221,6 +223,12 @@ int Handle_FedPlus_Args(int i, char *arg)
     if(((char)i == 'l') || ((char)i == 'L')) {
         print_logging = 1;
     }
+    if(((char)i == 't') || ((char)i == 'T')) {
+        layout_tables = 1;
+    }
+    if(((char)i == 'u') || ((char)i == 'U')) {
+        attr_readers = 1;
+    }
     return 0;
 }
 
@@ -256,3 +264,79 @@ void MODELprint_new(Entity entity, FILES *files)
     n = ENTITYget_classname(entity);
     fprintf(files->inc, "\n    %s__set_var %s_get_extents();\n", n, n);
 }
+
+/** print the enumeration of the entity ids of the schema in files->names
+ * \sa numberEntities()
+ */
+void ENTITYids_print(Linked_List list, FILE *file)
+{
+    int count = 0;
+
+    fprintf(file, "\n    // dense entity ids, in preorder of the class hierarchy. See EntityDescriptor::TypeIds()\n");
+    fprintf(file, "    enum entity_ids {\n");
+    LISTdo(list, e, Entity) {
+        fprintf(file, "        %s%s = %d,\n", ENT_ID_PREFIX, ENTITYget_name(e), ((EntityIds) ENTITYget_clientData(e))->id);
+        count++;
+    }
+    LISTod
+    fprintf(file, "        entity_id_count = %d\n    };\n\n", count);
+}
+
+/** the class the default Visit() of \p entity forwards to */
+static const char *VISITORbase_class(Entity entity, Schema schema)
+{
+    Entity base = ENTITYget_base_class(entity);
+    if(base && base->superscope == schema) {
+        return ENTITYget_classname(base);
+    }
+    return "SDAI_Application_instance";
+}
+
+/** declare the visitor of the entities of the schema in files->inc */
+void VISITORprint_new(Linked_List list, FILES *files, Schema schema)
+{
+    const char *schnm = SCHEMAget_name(schema);
+
+    fprintf(files->inc, "\n/** Visitor of the entities of the schema. Dispatch() switches on the type id\n");
+    fprintf(files->inc, " *  of an instance to the Visit() of its class. By default the Visit() of a class\n");
+    fprintf(files->inc, " *  calls the one of its base class, up to Visit( SDAI_Application_instance * ),\n");
+    fprintf(files->inc, " *  which does nothing.\n */\n");
+    fprintf(files->inc, "class SC_SCHEMA_EXPORT SdaiVisitor_%s {\n", schnm);
+    fprintf(files->inc, "  public:\n");
+    fprintf(files->inc, "    virtual ~SdaiVisitor_%s() {}\n\n", schnm);
+    fprintf(files->inc, "    /// false, without calling Visit(), for complex instances and the entities of other schemas\n");
+    fprintf(files->inc, "    bool Dispatch( SDAI_Application_instance * instance );\n\n");
+    fprintf(files->inc, "    virtual void Visit( SDAI_Application_instance * instance );\n");
+    LISTdo(list, e, Entity) {
+        fprintf(files->inc, "    virtual void Visit( %s * instance );\n", ENTITYget_classname(e));
+    }
+    LISTod
+    fprintf(files->inc, "};\n\n");
+}
+
+/** define the visitor of the entities of the schema in files->lib */
+void VISITORPrint(Linked_List list, FILES *files, Schema schema)
+{
+    const char *schnm = SCHEMAget_name(schema);
+
+    fprintf(files->lib, "\nbool SdaiVisitor_%s::Dispatch( SDAI_Application_instance * instance ) {\n", schnm);
+    fprintf(files->lib, "    const EntityDescriptor * ed = instance->eDesc;\n");
+    fprintf(files->lib, "    if( instance->IsComplex() || !ed || ed->OriginatingSchema() != %s::schema ) {\n", schnm);
+    fprintf(files->lib, "        return false;\n    }\n");
+    fprintf(files->lib, "    switch( ed->TypeId() ) {\n");
+    LISTdo(list, e, Entity) {
+        fprintf(files->lib, "        case %s::%s%s:\n", schnm, ENT_ID_PREFIX, ENTITYget_name(e));
+        fprintf(files->lib, "            Visit( static_cast< %s * >( instance ) );\n", ENTITYget_classname(e));
+        fprintf(files->lib, "            break;\n");
+    }
+    LISTod
+    fprintf(files->lib, "        default:\n            return false;\n    }\n    return true;\n}\n");
+
+    fprintf(files->lib, "\nvoid SdaiVisitor_%s::Visit( SDAI_Application_instance * instance ) {\n", schnm);
+    fprintf(files->lib, "    ( void ) instance;\n}\n");
+    LISTdo(list, e, Entity) {
+        fprintf(files->lib, "\nvoid SdaiVisitor_%s::Visit( %s * instance ) {\n", schnm, ENTITYget_classname(e));
+        fprintf(files->lib, "    Visit( static_cast< %s * >( instance ) );\n}\n", VISITORbase_class(e, schema));
+    }
+    LISTod
+}
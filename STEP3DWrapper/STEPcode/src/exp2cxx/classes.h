@@ -38,6 +38,7 @@ N350 ( August 31, 1993 ) of ISO 10303 TC184/SC4/WG7.
 #define TD_PREFIX            "t_"
 #define ATTR_PREFIX          "a_"
 #define ENT_PREFIX           "e_"
+#define ENT_ID_PREFIX        "id_"
 #define SCHEMA_PREFIX        "s_"
 
 #define TYPEprefix(t)        (TYPEis_entity (t) ? ENT_PREFIX : TD_PREFIX)
@@ -85,6 +86,13 @@ struct EntityTag_ {
     Entity        superclass;    /**< the entity being used as the supertype - with multiple inheritance only chose one */
 };
 
+/** dense ids of an entity in its schema, set in its clientData by numberEntities() */
+typedef struct EntityIds_ *EntityIds;
+struct EntityIds_ {
+    int id;                      /**< position in preorder of the class hierarchy of the schema */
+    int last;                    /**< the classes deriving from the entity's have the ids up to this one */
+};
+
 /** these fields are used so that SELECT types are processed in order */
 typedef struct SelectTag_ *SelectTag;
 struct SelectTag_ {
@@ -109,6 +117,9 @@ const char     *StrToConstant(const char *);
 void            MODELPrint(Entity, FILES *, Schema, int);
 void            MODELprint_new(Entity entity, FILES *files);
 void            MODELPrintConstructorBody(Entity, FILES *, Schema/*, int*/);
+void            ENTITYids_print(Linked_List list, FILE *file);
+void            VISITORprint_new(Linked_List list, FILES *files, Schema schema);
+void            VISITORPrint(Linked_List list, FILES *files, Schema schema);
 const char     *PrettyTmpName(const char *oldname);
 const char     *EnumName(const char *oldname);
 void            print_file(Express);
@@ -116,6 +127,7 @@ void            resolution_success(void);
 void            SCHEMAprint(Schema schema, FILES *files, void *complexCol, int suffix);
 const char     *FundamentalType(const Type t, int report_reftypes);
 void            numberAttributes(Scope scope);
+void            numberEntities(Scope scope);
 
 /*Variable*/
 #define VARis_simple_explicit(a)  (!VARis_type_shifter(a))
@@ -30,6 +30,14 @@ N350 ( August 31, 1993 ) of ISO 10303 TC184/SC4/WG7.
 extern int old_accessors;
 extern int print_logging;
 
+/** first statement of the access methods of an attribute: the attribute values of the
+ * instance may not have been read yet, see STEPfile::DeferredRead() */
+#define READ_DEFERRED "    ReadDeferred();\n"
+
+/** statement of the access methods that can change the values of the instance, so that
+ * STEPfile doesn't copy its record from the file it was read from */
+#define SET_MODIFIED "    Modified( true );\n"
+
 /**************************************************************//**
  ** Procedure:  generate_attribute_name
  ** Parameters:  Variable a, an Express attribute; char *out, the C++ name
@@ -266,13 +274,13 @@ void AGGRprint_access_methods(const char *entnm, Variable a, FILE *file,
                               char *ctype, char *attrnm)
 {
     ATTRprint_access_methods_get_head(entnm, a, file, false);
-    fprintf(file, "{\n    if( !_%s ) {\n        _%s = new %s;\n    }\n", attrnm, attrnm, TypeName(a->type));
+    fprintf(file, "{\n" READ_DEFERRED SET_MODIFIED "    if( !_%s ) {\n        _%s = new %s;\n    }\n", attrnm, attrnm, TypeName(a->type));
     fprintf(file, "    return ( %s ) %s_%s;\n}\n", ctype, ((a->type->u.type->body->base) ? "" : "& "), attrnm);
     ATTRprint_access_methods_get_head(entnm, a, file, true);
-    fprintf(file, "const {\n");
+    fprintf(file, "const {\n" READ_DEFERRED);
     fprintf(file, "    return ( %s ) %s_%s;\n}\n", ctype, ((a->type->u.type->body->base) ? "" : "& "), attrnm);
     ATTRprint_access_methods_put_head(entnm, a, file);
-    fprintf(file, "{\n    if( !_%s ) {\n        _%s = new %s;\n    }\n", attrnm, attrnm, TypeName(a->type));
+    fprintf(file, "{\n" READ_DEFERRED SET_MODIFIED "    if( !_%s ) {\n        _%s = new %s;\n    }\n", attrnm, attrnm, TypeName(a->type));
     fprintf(file, "    _%s%sShallowCopy( * x );\n}\n", attrnm, ((a->type->u.type->body->base) ? "->" : "."));
     return;
 }
@@ -307,18 +315,18 @@ void ATTRprint_access_methods_entity_logging(const char *entnm, const char *func
 void ATTRprint_access_methods_entity(const char *entnm, const char *attrnm, const char *funcnm, const char *nm,
                                      const char *ctype, Variable a, FILE *file)
 {
-    fprintf(file, "{\n");
+    fprintf(file, "{\n" READ_DEFERRED);
     ATTRprint_access_methods_entity_logging(entnm, funcnm, nm, attrnm, "returned", file);
     fprintf(file, "    if( !_%s ) {\n        _%s = new %s;\n    }\n", attrnm, attrnm, TypeName(a->type));
     fprintf(file, "    return (%s) _%s;\n}\n", ctype, attrnm);
 
     ATTRprint_access_methods_get_head(entnm, a, file, true);
-    fprintf(file, "const {\n");
+    fprintf(file, "const {\n" READ_DEFERRED);
     ATTRprint_access_methods_entity_logging(entnm, funcnm, nm, attrnm, "returned", file);
     fprintf(file, "    return (%s) _%s;\n}\n", ctype, attrnm);
 
     ATTRprint_access_methods_put_head(entnm, a, file);
-    fprintf(file, "{\n");
+    fprintf(file, "{\n" READ_DEFERRED SET_MODIFIED);
     ATTRprint_access_methods_entity_logging(entnm, funcnm, nm, 0, "assigned", file);
     fprintf(file, "    _%s = x;\n}\n", attrnm);
     return;
@@ -353,15 +361,15 @@ void ATTRprint_access_methods_str_bin_logging(const char *entnm, const char *att
 void ATTRprint_access_methods_str_bin(const char *entnm, const char *attrnm, const char *funcnm,
                                       const char *ctype, Variable a, FILE *file)
 {
-    fprintf(file, "{\n");
+    fprintf(file, "{\n" READ_DEFERRED);
     ATTRprint_access_methods_str_bin_logging(entnm, attrnm, funcnm, file, true);
     fprintf(file, "    return _%s;\n}\n", attrnm);
     ATTRprint_access_methods_get_head(entnm, a, file, true);
-    fprintf(file, "const {\n");
+    fprintf(file, "const {\n" READ_DEFERRED);
     ATTRprint_access_methods_str_bin_logging(entnm, attrnm, funcnm, file, true);
     fprintf(file, "    return (%s) _%s;\n}\n", ctype, attrnm);
     ATTRprint_access_methods_put_head(entnm, a, file);
-    fprintf(file, "{\n");
+    fprintf(file, "{\n" READ_DEFERRED SET_MODIFIED);
     ATTRprint_access_methods_str_bin_logging(entnm, attrnm, funcnm, file, false);
     fprintf(file, "    _%s = x;\n}\n", attrnm);
     return;
@@ -394,17 +402,17 @@ void ATTRprint_access_methods_enum_logging(const char *entnm, const char *attrnm
 void ATTRprint_access_methods_enum(const char *entnm, const char *attrnm, const char *funcnm,
                                    Variable a, Type t, FILE *file)
 {
-    fprintf(file, "{\n");
+    fprintf(file, "{\n" READ_DEFERRED);
     ATTRprint_access_methods_enum_logging(entnm, attrnm, funcnm, file, false);
     fprintf(file, "    return (%s) _%s;\n}\n", EnumName(TYPEget_name(t)), attrnm);
 
     ATTRprint_access_methods_get_head(entnm, a, file, true);
-    fprintf(file, "const {\n");
+    fprintf(file, "const {\n" READ_DEFERRED);
     ATTRprint_access_methods_enum_logging(entnm, attrnm, funcnm, file, false);
     fprintf(file, "    return (%s) _%s;\n}\n", EnumName(TYPEget_name(t)), attrnm);
 
     ATTRprint_access_methods_put_head(entnm, a, file);
-    fprintf(file, "{\n");
+    fprintf(file, "{\n" READ_DEFERRED SET_MODIFIED);
     ATTRprint_access_methods_enum_logging(entnm, attrnm, funcnm, file, true);
     fprintf(file, "    _%s.put( x );\n}\n", attrnm);
     return;
@@ -440,7 +448,7 @@ void ATTRprint_access_methods_log_bool_logging(const char *entnm, const char *at
 void ATTRprint_access_methods_log_bool(const char *entnm, const char *attrnm, const char *funcnm,
                                        const char *ctype, Variable a, FILE *file)
 {
-    fprintf(file, "const {\n");
+    fprintf(file, "const {\n" READ_DEFERRED);
     ATTRprint_access_methods_log_bool_logging(entnm, attrnm, funcnm, file, false);
     fprintf(file, "    return (%s) _%s;\n}\n", ctype, attrnm);
 
@@ -451,7 +459,7 @@ void ATTRprint_access_methods_log_bool(const char *entnm, const char *attrnm, co
      * fprintf( file, "    return (const %s) _%s;\n}\n", ctype, attrnm );
     */
     ATTRprint_access_methods_put_head(entnm, a, file);
-    fprintf(file, "{\n");
+    fprintf(file, "{\n" READ_DEFERRED SET_MODIFIED);
     ATTRprint_access_methods_log_bool_logging(entnm, attrnm, funcnm, file, true);
     fprintf(file, "    _%s.put (x);\n}\n", attrnm);
     return;
@@ -552,11 +560,11 @@ void ATTRprint_access_methods(const char *entnm, Variable a, FILE *file, Schema
     }
     /*    case TYPE_SELECT: */
     if(classType == select_)  {
-        fprintf(file, " {\n    return &_%s;\n}\n", attrnm);
+        fprintf(file, " {\n" READ_DEFERRED SET_MODIFIED "    return &_%s;\n}\n", attrnm);
         ATTRprint_access_methods_get_head(entnm, a, file, true);
-        fprintf(file, "const {\n    return (%s) &_%s;\n}\n",  ctype, attrnm);
+        fprintf(file, "const {\n" READ_DEFERRED "    return (%s) &_%s;\n}\n",  ctype, attrnm);
         ATTRprint_access_methods_put_head(entnm, a, file);
-        fprintf(file, " {\n    _%s = x;\n}\n", attrnm);
+        fprintf(file, " {\n" READ_DEFERRED SET_MODIFIED "    _%s = x;\n}\n", attrnm);
         return;
     }
     /*    case TYPE_AGGRETATES: */
@@ -570,7 +578,7 @@ void ATTRprint_access_methods(const char *entnm, Variable a, FILE *file, Schema
     }
     /*      case TYPE_INTEGER:  */
     if(classType == integer_) {
-        fprintf(file, "const {\n");
+        fprintf(file, "const {\n" READ_DEFERRED);
         if(print_logging) {
             fprintf(file, "#ifdef SC_LOGGING\n");
             fprintf(file, "    if(*logStream)\n    {\n");
@@ -590,7 +598,7 @@ void ATTRprint_access_methods(const char *entnm, Variable a, FILE *file, Schema
         /*  is the same type as the data member  */
         fprintf(file, "    return (%s) _%s;\n}\n", ctype, attrnm);
         ATTRprint_access_methods_put_head(entnm, a, file);
-        fprintf(file, "{\n");
+        fprintf(file, "{\n" READ_DEFERRED SET_MODIFIED);
         if(print_logging) {
             fprintf(file, "#ifdef SC_LOGGING\n");
             fprintf(file, "    if(*logStream)\n    {\n");
@@ -610,7 +618,7 @@ void ATTRprint_access_methods(const char *entnm, Variable a, FILE *file, Schema
     /*      case TYPE_REAL:
         case TYPE_NUMBER:   */
     if((classType == number_) || (classType == real_)) {
-        fprintf(file, "const {\n");
+        fprintf(file, "const {\n" READ_DEFERRED);
         if(print_logging) {
             fprintf(file, "#ifdef SC_LOGGING\n");
             fprintf(file, "    if(*logStream)\n    {\n");
@@ -624,7 +632,7 @@ void ATTRprint_access_methods(const char *entnm, Variable a, FILE *file, Schema
         }
         fprintf(file, "    return (%s) _%s;\n}\n", ctype, attrnm);
         ATTRprint_access_methods_put_head(entnm, a, file);
-        fprintf(file, "{\n");
+        fprintf(file, "{\n" READ_DEFERRED SET_MODIFIED);
         if(print_logging) {
             fprintf(file, "#ifdef SC_LOGGING\n");
             fprintf(file, "    if(*logStream)\n    {\n");
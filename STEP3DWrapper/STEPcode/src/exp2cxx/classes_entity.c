@@ -30,6 +30,11 @@ N350 ( August 31, 1993 ) of ISO 10303 TC184/SC4/WG7.
 
 extern int multiple_inheritance;
 extern int old_accessors;
+extern int layout_tables;
+extern int attr_readers;
+
+char *generate_dict_attr_name(Variable a, char *out);
+static void LIBreader_print(Entity entity, FILE *file, Schema schema);
 
 /* attribute numbering used to use a global variable attr_count.
  * it could be tricky keep the numbering consistent when making
@@ -91,6 +96,9 @@ void LIBmemberFunctionPrint(Entity entity, Linked_List neededAttr, FILE *file, S
 
     /*  1. put in member functions which belong to all entities */
     /*  the common function are still in the class definition 17-Feb-1992 */
+    if(ENTITYhas_reader(entity)) {
+        LIBreader_print(entity, file, schema);
+    }
 
     /*  2. print access functions for attributes    */
     attr_list = ENTITYget_attributes(entity);
@@ -225,6 +233,56 @@ void DataMemberInitializers(Entity entity, bool *first, Linked_List neededAttr,
     }
 }
 
+/** true if the default constructor of \p entity is printed from a layout table
+ * (option -t): the entity and its supertypes use single inheritance and come
+ * from the same schema
+ */
+bool ENTITYhas_layout(Entity entity)
+{
+    Linked_List supers = ENTITYget_supertypes(entity);
+    Entity parent;
+
+    if(!layout_tables || !multiple_inheritance) {
+        return false;
+    }
+    if(LISTempty(supers)) {
+        return true;
+    }
+    if(LISTget_length(supers) > 1) {
+        return false;
+    }
+    parent = (Entity) LISTpeek_first(supers);
+    return (parent->superscope == entity->superscope) && ENTITYhas_layout(parent);
+}
+
+/** the number of attributes in the layout table of \p entity
+ * \sa LIBlayout_entries_collect()
+ */
+static int ENTITYlayout_count(Entity entity)
+{
+    int count = 0;
+    Linked_List supers = ENTITYget_supertypes(entity);
+
+    if(!LISTempty(supers)) {
+        count = ENTITYlayout_count((Entity) LISTpeek_first(supers));
+    }
+    LISTdo(ENTITYget_attributes(entity), a, Variable) {
+        if(VARget_initializer(a) == EXPRESSION_NULL && !VARget_inverse(a) && !VARis_derived(a)) {
+            count++;
+        }
+    }
+    LISTod;
+    return count;
+}
+
+/** true if the class of \p entity overrides STEPreadAttrs() with a reader of
+ * the attributes of its layout table (option -u)
+ */
+bool ENTITYhas_reader(Entity entity)
+{
+    return attr_readers && ENTITYhas_layout(entity) && ENTITYlayout_count(entity) > 0;
+}
+
 /** prints out the data members for an entity's c++ class definition
  * \param entity entity being processed
  * \param file file being written to
@@ -261,10 +319,29 @@ void MemberFunctionSign(Entity entity, Linked_List neededAttr, FILE *file)
     Linked_List attr_list;
     static int entcode = 0;
     char entnm [BUFSIZ];
+    bool first;
 
     strncpy(entnm, ENTITYget_classname(entity), BUFSIZ);     /*  assign entnm  */
     entnm[BUFSIZ - 1] = '\0';
 
+    if(ENTITYhas_layout(entity)) {
+        /*  still protected: initializes the data members for the default
+         *  constructor of a subtype, which allocates the aggregates; inline,
+         *  so it adds no exported constructor to the schema library */
+        first = true;
+        if(LISTempty(ENTITYget_supertypes(entity))) {
+            fprintf(file, "        %s( const AttrLayoutTag & )", entnm);
+        } else {
+            fprintf(file, "        %s( const AttrLayoutTag & t ): %s( t )", entnm,
+                    ENTITYget_classname((Entity) LISTpeek_first(ENTITYget_supertypes(entity))));
+            first = false;
+        }
+        DataMemberInitializers(entity, &first, neededAttr, file);
+        fprintf(file, " {\n        }\n");
+    }
+    if(ENTITYhas_reader(entity)) {
+        fprintf(file, "        int STEPreadAttrs( AttrReadContext & cx );\n");
+    }
     fprintf(file, "    public: \n");
 
     /*  put in member functions which belong to all entities    */
@@ -333,6 +410,207 @@ void initializeAttrs(Entity e, FILE *file)
     orderedAttrsCleanup();
 }
 
+/** allocate the aggregates of the attributes of the entity and its supertypes */
+static void LIBlayout_aggregates_print(Entity entity, FILE *file)
+{
+    char attrnm [BUFSIZ];
+    Linked_List supers = ENTITYget_supertypes(entity);
+
+    if(!LISTempty(supers)) {
+        LIBlayout_aggregates_print((Entity) LISTpeek_first(supers), file);
+    }
+    LISTdo(ENTITYget_attributes(entity), a, Variable) {
+        if(VARget_initializer(a) == EXPRESSION_NULL && !VARget_inverse(a) && !VARis_derived(a)
+                && TYPEis_aggregate(VARget_type(a))) {
+            generate_attribute_name(a, attrnm);
+            fprintf(file, "    _%s = new %s;\n", attrnm, TYPEget_ctype(VARget_type(a)));
+        }
+    }
+    LISTod;
+}
+
+/** an attribute of the layout table of an entity, see LIBlayout_entries_collect() */
+typedef struct {
+    Variable attr;
+    Entity owner;       /* entity declaring attr, the owner of its descriptor */
+    int redefines;      /* 1 + the index of the attribute attr redefines, or 0 */
+    bool derived;       /* a MakeDerived() of the constructors would mark it */
+} LayoutEntry;
+
+/** the index of the first of the \p n entries whose descriptor is named \p nm,
+ * declared by the entity named \p owner if it is not null, as GetSTEPattribute()
+ * finds it among the attributes pushed so far; -1 if there is none
+ */
+static int LIBlayout_find(const LayoutEntry *entries, int n, const char *nm, const char *owner)
+{
+    char dictnm [BUFSIZ];
+    int i;
+
+    for(i = 0; i < n; i++) {
+        generate_dict_attr_name(entries[i].attr, dictnm);
+        if(!strcmp(dictnm, nm) && (!owner || !strcmp(ENTITYget_name(entries[i].owner), owner))) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/** add the attributes of \p entity to \p entries from *n on, those of its
+ * supertypes first, in the order LIBstructor_print() pushes them. The lookups
+ * of its RedefiningAttr() and MakeDerived() calls are resolved here, so the
+ * table only holds indices and no name.
+ */
+static void LIBlayout_entries_collect(Entity entity, LayoutEntry *entries, int *n)
+{
+    const orderedAttr *oa;
+    int i;
+    Linked_List supers = ENTITYget_supertypes(entity);
+
+    if(!LISTempty(supers)) {
+        LIBlayout_entries_collect((Entity) LISTpeek_first(supers), entries, n);
+    }
+
+    LISTdo(ENTITYget_attributes(entity), a, Variable) {
+        if(VARget_initializer(a) == EXPRESSION_NULL && !VARget_inverse(a) && !VARis_derived(a)) {
+            entries[*n].attr = a;
+            entries[*n].owner = entity;
+            entries[*n].redefines = 0;
+            entries[*n].derived = false;
+            (*n)++;
+            if(VARis_type_shifter(a)) {
+                entries[*n - 1].redefines = LIBlayout_find(entries, *n, VARget_simple_name(a), 0) + 1;
+            }
+        }
+    }
+    LISTod;
+
+    /* a derivation of an attribute that is not in the table does nothing */
+    orderedAttrsInit(entity);
+    while(0 != (oa = nextAttr())) {
+        if(oa->deriver) {
+            i = LIBlayout_find(entries, *n, oa->attr->name->symbol.name, oa->creator->symbol.name);
+            if(i >= 0) {
+                entries[i].derived = true;
+            }
+        }
+    }
+    orderedAttrsCleanup();
+}
+
+/** print the \p count entries of the layout table of \p entity for class \p classnm
+ * \sa LIBlayout_entries_collect()
+ */
+static void LIBlayout_entries_print(Entity entity, int count, const char *classnm, FILE *file, Schema schema)
+{
+    char attrnm [BUFSIZ];
+    LayoutEntry *entries = (LayoutEntry *) sc_malloc(count * sizeof(LayoutEntry));
+    Variable a;
+    int n = 0;
+    int i;
+
+    LIBlayout_entries_collect(entity, entries, &n);
+    assert(n == count);
+    for(i = 0; i < n; i++) {
+        a = entries[i].attr;
+        generate_attribute_name(a, attrnm);
+        fprintf(file, "        { &%s::%s%d%s%s, offsetof( %s, _%s ), %s%s, %d }%s\n",
+                SCHEMAget_name(schema), ATTR_PREFIX, a->idx, (VARis_type_shifter(a) ? "R" : ""), attrnm,
+                classnm, attrnm,
+                (TYPEis_aggregate(VARget_type(a)) ? "AttrLayout_Aggregate" : "AttrLayout_Member"),
+                (entries[i].derived ? " | AttrLayout_Derived" : ""),
+                entries[i].redefines, (i + 1 < n ? "," : ""));
+    }
+    sc_free(entries);
+}
+
+/** print the STEPreadAttr() calls reading the attributes of the layout table
+ * of \p entity, from number *i on, of the \p count of the table
+ * \sa LIBlayout_entries_collect()
+ */
+static void LIBreader_calls_print(Entity entity, int *i, int count, FILE *file)
+{
+    const char *kind;
+    Linked_List supers = ENTITYget_supertypes(entity);
+
+    if(!LISTempty(supers)) {
+        LIBreader_calls_print((Entity) LISTpeek_first(supers), i, count, file);
+    }
+
+    LISTdo(ENTITYget_attributes(entity), a, Variable) {
+        if(VARget_initializer(a) == EXPRESSION_NULL && !VARget_inverse(a) && !VARis_derived(a)) {
+            /* a redefining attribute is read as the loop of STEPread() does */
+            kind = FundamentalType(VARget_type(a), 0);
+            if(VARis_type_shifter(a) || !strcmp(kind, "GENERIC_TYPE")) {
+                kind = "UNKNOWN_TYPE";
+            }
+            fprintf(file, "%sSTEPreadAttr( *attributes.blockAttr( %d ), %s, %d, %d, cx )",
+                    (*i ? " &&\n             " : ""), *i, kind, *i, count);
+            (*i)++;
+        }
+    }
+    LISTod;
+}
+
+/** print the STEPreadAttrs() that reads the attributes of the entity in the
+ * order and with the types of its layout table, unless the instance is not
+ * one made from the table (such as a supertype of a subtype without reader)
+ * \sa ENTITYhas_reader()
+ */
+static void LIBreader_print(Entity entity, FILE *file, Schema schema)
+{
+    int count = ENTITYlayout_count(entity);
+    int i = 0;
+
+    fprintf(file, "int %s::STEPreadAttrs( AttrReadContext & cx ) {\n", ENTITYget_classname(entity));
+    fprintf(file, "    if( eDesc != %s::%s%s || attributes.blockCount() != %d || !attributes.onlyBlock() ) {\n",
+            SCHEMAget_name(schema), ENT_PREFIX, ENTITYget_name(entity), count);
+    fprintf(file, "        return -1;\n    }\n");
+    fprintf(file, "    return ( ");
+    LIBreader_calls_print(entity, &i, count, file);
+    fprintf(file, " ) ? 1 : 0;\n}\n\n");
+}
+
+/** print the default constructor that makes all the attributes of the entity
+ * and its supertypes from one layout table, and allocates their aggregates.
+ * The supertypes only initialize their data members, see MemberFunctionSign().
+ * \sa ENTITYhas_layout()
+ * \returns the supertype, or 0
+ */
+static Entity LIBlayout_structors_print(Entity entity, Linked_List neededAttr, FILE *file, Schema schema)
+{
+    char entnm [BUFSIZ];
+    Entity parent = 0;
+    bool first = true;
+    int count = ENTITYlayout_count(entity);
+
+    if(!LISTempty(ENTITYget_supertypes(entity))) {
+        parent = (Entity) LISTpeek_first(ENTITYget_supertypes(entity));
+    }
+    strncpy(entnm, ENTITYget_classname(entity), BUFSIZ);
+    entnm[BUFSIZ - 1] = '\0';
+
+    fprintf(file, "%s::%s()", entnm, entnm);
+    if(parent) {
+        fprintf(file, ": %s( AttrLayoutTag() )", ENTITYget_classname(parent));
+        first = false;
+    }
+    DataMemberInitializers(entity, &first, neededAttr, file);
+    fprintf(file, " {\n");
+    if(count > 0) {
+        fprintf(file, "    static const AttrLayout layout[] = {\n");
+        LIBlayout_entries_print(entity, count, entnm, file, schema);
+        fprintf(file, "    };\n\n");
+    }
+    fprintf(file, "    eDesc = %s::%s%s;\n", SCHEMAget_name(schema), ENT_PREFIX, ENTITYget_name(entity));
+    LIBlayout_aggregates_print(entity, file);
+    if(count > 0) {
+        fprintf(file, "    InitAttributes( layout, %d, this );\n", count);
+    }
+    fprintf(file, "}\n\n");
+
+    return parent;
+}
+
 /** prints the c++ code for entity class's constructor and destructor.  goes to .cc file
  * Side Effects:  generates codes segment in c++ .cc file
  *
@@ -357,114 +635,118 @@ void LIBstructor_print(Entity entity, Linked_List neededAttr, FILE *file, Schema
     const char *entnm = ENTITYget_classname(entity);
     bool first = true;
 
-    /*  constructor definition  */
-
-    /* parent class initializer (if any) and '{' printed below */
-    fprintf(file, "%s::%s()", entnm, entnm);
-
-    /* ////MULTIPLE INHERITANCE//////// */
-
-    if(multiple_inheritance) {
-        int super_cnt = 0;
-        list = ENTITYget_supertypes(entity);
-        if(! LISTempty(list)) {
-            LISTdo(list, e, Entity) {
-                /*  if there's no super class yet,
-                    or the super class doesn't have any attributes
-                */
+    if(ENTITYhas_layout(entity)) {
+        principalSuper = LIBlayout_structors_print(entity, neededAttr, file, schema);
+    } else {
+        /*  constructor definition  */
 
-                super_cnt++;
-                if(super_cnt == 1) {
-                    bool firstInitializer = false;
-                    /* ignore the 1st parent */
-                    const char *parent = ENTITYget_classname(e);
-
-                    /* parent class initializer */
-                    fprintf(file, ": %s()", parent);
-                    DataMemberInitializers(entity, &firstInitializer, neededAttr, file);
-                    fprintf(file, " {\n");
-                    fprintf(file, "        /*  parent: %s  */\n%s\n%s\n", parent,
-                            "        /* Ignore the first parent since it is */",
-                            "        /* part of the main inheritance hierarchy */");
-                    principalSuper = e; /* principal SUPERTYPE */
-                } else {
-                    fprintf(file, "        /*  parent: %s  */\n", ENTITYget_classname(e));
-                    fprintf(file, "    HeadEntity(this);\n");
-                    fprintf(file, "    AppendMultInstance(new %s(this));\n",
-                            ENTITYget_classname(e));
-
-                    if(super_cnt == 2) {
-                        printf("\nMULTIPLE INHERITANCE for entity: %s\n",
-                               ENTITYget_name(entity));
-                        printf("        SUPERTYPE 1: %s (principal supertype)\n",
-                               ENTITYget_name(principalSuper));
+        /* parent class initializer (if any) and '{' printed below */
+        fprintf(file, "%s::%s()", entnm, entnm);
+
+        /* ////MULTIPLE INHERITANCE//////// */
+
+        if(multiple_inheritance) {
+            int super_cnt = 0;
+            list = ENTITYget_supertypes(entity);
+            if(! LISTempty(list)) {
+                LISTdo(list, e, Entity) {
+                    /*  if there's no super class yet,
+                        or the super class doesn't have any attributes
+                    */
+
+                    super_cnt++;
+                    if(super_cnt == 1) {
+                        bool firstInitializer = false;
+                        /* ignore the 1st parent */
+                        const char *parent = ENTITYget_classname(e);
+
+                        /* parent class initializer */
+                        fprintf(file, ": %s()", parent);
+                        DataMemberInitializers(entity, &firstInitializer, neededAttr, file);
+                        fprintf(file, " {\n");
+                        fprintf(file, "        /*  parent: %s  */\n%s\n%s\n", parent,
+                                "        /* Ignore the first parent since it is */",
+                                "        /* part of the main inheritance hierarchy */");
+                        principalSuper = e; /* principal SUPERTYPE */
+                    } else {
+                        fprintf(file, "        /*  parent: %s  */\n", ENTITYget_classname(e));
+                        fprintf(file, "    HeadEntity(this);\n");
+                        fprintf(file, "    AppendMultInstance(new %s(this));\n",
+                                ENTITYget_classname(e));
+
+                        if(super_cnt == 2) {
+                            printf("\nMULTIPLE INHERITANCE for entity: %s\n",
+                                   ENTITYget_name(entity));
+                            printf("        SUPERTYPE 1: %s (principal supertype)\n",
+                                   ENTITYget_name(principalSuper));
+                        }
+                        printf("        SUPERTYPE %d: %s\n", super_cnt, ENTITYget_name(e));
                     }
-                    printf("        SUPERTYPE %d: %s\n", super_cnt, ENTITYget_name(e));
                 }
+                LISTod;
+
+            } else {    /*  if entity has no supertypes, it's at top of hierarchy  */
+                /*  no parent class constructor has been printed, so still need an opening brace */
+                bool firstInitializer = true;
+                DataMemberInitializers(entity, &firstInitializer, neededAttr, file);
+                fprintf(file, " {\n");
+                fprintf(file, "        /*  no SuperTypes */\n");
             }
-            LISTod;
-
-        } else {    /*  if entity has no supertypes, it's at top of hierarchy  */
-            /*  no parent class constructor has been printed, so still need an opening brace */
-            bool firstInitializer = true;
-            DataMemberInitializers(entity, &firstInitializer, neededAttr, file);
-            fprintf(file, " {\n");
-            fprintf(file, "        /*  no SuperTypes */\n");
         }
-    }
 
-    /* what if entity comes from other schema?
-     * It appears that entity.superscope.symbol.name is the schema name (but only if entity.superscope.type == 's'?)  --MAP 27Nov11
-     */
-    fprintf(file, "\n    eDesc = %s::%s%s;\n",
-            SCHEMAget_name(schema), ENT_PREFIX, ENTITYget_name(entity));
+        /* what if entity comes from other schema?
+         * It appears that entity.superscope.symbol.name is the schema name (but only if entity.superscope.type == 's'?)  --MAP 27Nov11
+         */
+        fprintf(file, "\n    eDesc = %s::%s%s;\n",
+                SCHEMAget_name(schema), ENT_PREFIX, ENTITYget_name(entity));
 
-    attr_list = ENTITYget_attributes(entity);
+        attr_list = ENTITYget_attributes(entity);
 
-    LISTdo(attr_list, a, Variable) {
-        if(VARget_initializer(a) == EXPRESSION_NULL) {
-            /*  include attribute if it is not derived  */
-            generate_attribute_name(a, attrnm);
-            t = VARget_type(a);
+        LISTdo(attr_list, a, Variable) {
+            if(VARget_initializer(a) == EXPRESSION_NULL) {
+                /*  include attribute if it is not derived  */
+                generate_attribute_name(a, attrnm);
+                t = VARget_type(a);
 
-            if(!VARget_inverse(a) && !VARis_derived(a)) {
-                /*  1. create a new STEPattribute */
+                if(!VARget_inverse(a) && !VARis_derived(a)) {
+                    /*  1. create a new STEPattribute */
 
-                /*  if type is aggregate, the variable is a pointer and needs initialized */
-                if(TYPEis_aggregate(t)) {
-                    fprintf(file, "    _%s = new %s;\n", attrnm, TYPEget_ctype(t));
-                }
-                fprintf(file, "    %sa = new STEPattribute( * %s::",
-                        (first ? "STEPattribute * " : ""),   /*   first time through, declare 'a' */
-                        SCHEMAget_name(schema));
-                fprintf(file, "%s%d%s%s", ATTR_PREFIX, a->idx, (VARis_type_shifter(a) ? "R" : ""), attrnm);
-                fprintf(file, ", %s%s_%s );\n",
-                        (TYPEis_entity(t) ? "( SDAI_Application_instance_ptr * ) " : ""),
-                        (TYPEis_aggregate(t) ? "" : "& "), attrnm);
-                if(first) {
-                    first = false;
-                }
-                /*  2. initialize everything to NULL (even if not optional)  */
+                    /*  if type is aggregate, the variable is a pointer and needs initialized */
+                    if(TYPEis_aggregate(t)) {
+                        fprintf(file, "    _%s = new %s;\n", attrnm, TYPEget_ctype(t));
+                    }
+                    fprintf(file, "    %sa = new STEPattribute( * %s::",
+                            (first ? "STEPattribute * " : ""),   /*   first time through, declare 'a' */
+                            SCHEMAget_name(schema));
+                    fprintf(file, "%s%d%s%s", ATTR_PREFIX, a->idx, (VARis_type_shifter(a) ? "R" : ""), attrnm);
+                    fprintf(file, ", %s%s_%s );\n",
+                            (TYPEis_entity(t) ? "( SDAI_Application_instance_ptr * ) " : ""),
+                            (TYPEis_aggregate(t) ? "" : "& "), attrnm);
+                    if(first) {
+                        first = false;
+                    }
+                    /*  2. initialize everything to NULL (even if not optional)  */
 
-                fprintf(file, "    a->set_null();\n");
+                    fprintf(file, "    a->set_null();\n");
 
-                /*  3.  put attribute on attributes list  */
-                fprintf(file, "    attributes.push( a );\n");
+                    /*  3.  put attribute on attributes list  */
+                    fprintf(file, "    attributes.push( a );\n");
 
-                /* if it is redefining another attribute make connection of
-                redefined attribute to redefining attribute */
-                if(VARis_type_shifter(a)) {
-                    fprintf(file, "    MakeRedefined( a, \"%s\" );\n",
-                            VARget_simple_name(a));
+                    /* if it is redefining another attribute make connection of
+                    redefined attribute to redefining attribute */
+                    if(VARis_type_shifter(a)) {
+                        fprintf(file, "    MakeRedefined( a, \"%s\" );\n",
+                                VARget_simple_name(a));
+                    }
                 }
             }
         }
-    }
-    LISTod;
+        LISTod;
 
-    initializeAttrs(entity, file);
+        initializeAttrs(entity, file);
 
-    fprintf(file, "}\n\n");
+        fprintf(file, "}\n\n");
+    }
 
     /*  copy constructor  */
     entnm = ENTITYget_classname(entity);
@@ -963,7 +1245,11 @@ void ENTITYincode_print(Entity entity, FILE *header, FILE *impl, Schema schema)
 
 void ENTITYPrint_h(const Entity entity, FILE *header, Linked_List neededAttr, Schema schema)
 {
-    const char *name = ENTITYget_classname(entity);
+    char name [BUFSIZ];
+
+    /* a copy: MemberFunctionSign() takes the class name of the supertype */
+    strncpy(name, ENTITYget_classname(entity), BUFSIZ);
+    name[BUFSIZ - 1] = '\0';
     DEBUG("Entering ENTITYPrint_h for %s\n", name);
 
     ENTITYhead_print(entity, header);
@@ -989,6 +1275,12 @@ void ENTITYPrint_cc(const Entity entity, FILE *createall, FILE *header, FILE *im
     fprintf(impl, "#include \"schema.h\"\n");
     fprintf(impl, "#include \"sc_memmgr.h\"\n");
     fprintf(impl, "#include \"entity/%s.h\"\n\n", name);
+    if(ENTITYhas_layout(entity)) {
+        /* the layout table takes offsetof() the entity class, which is not standard-layout */
+        fprintf(impl, "#if defined( __GNUC__ )\n");
+        fprintf(impl, "#  pragma GCC diagnostic ignored \"-Winvalid-offsetof\"\n");
+        fprintf(impl, "#endif\n\n");
+    }
 
     LIBdescribe_entity(entity, impl, schema);
     LIBstructor_print(entity, neededAttr, impl, schema);
@@ -1149,6 +1441,59 @@ void ENTITYPrint(Entity entity, FILES *files, Schema schema, bool externMap)
  * eDesc is printed into createall because it must be initialized before other entity init fn's are called
  * alternative is two init fn's per ent. call init1 for each ent, then repeat with init2
  */
+/** set the bits of the ids of \p entity and of its supertypes that belong to
+ * \p schema, or if \p bits is 0, raise \p max to the highest of these ids
+ */
+static void ENTITYsupertype_ids(Entity entity, Schema schema, unsigned int *bits, int *max)
+{
+    EntityIds ids = (EntityIds) ENTITYget_clientData(entity);
+
+    if(ids && entity->superscope == schema) {
+        if(bits) {
+            bits[ids->id / 32] |= 1u << (ids->id % 32);
+        } else if(ids->id > *max) {
+            *max = ids->id;
+        }
+    }
+    LISTdo(ENTITYget_supertypes(entity), super, Entity) {
+        ENTITYsupertype_ids(super, schema, bits, max);
+    }
+    LISTod
+}
+
+/** print the ids exp2cxx gave the entity, for EntityDescriptor::TypeIds()
+ * \sa numberEntities()
+ */
+static void ENTITYprint_ids(Entity entity, FILE *impl, Schema schema)
+{
+    EntityIds ids = (EntityIds) ENTITYget_clientData(entity);
+    unsigned int *bits;
+    int max = -1, words, i;
+
+    if(!ids) {
+        return;
+    }
+    ENTITYsupertype_ids(entity, schema, 0, &max);
+    words = max / 32 + 1;
+    bits = (unsigned int *) sc_calloc(words, sizeof(unsigned int));
+    ENTITYsupertype_ids(entity, schema, bits, &max);
+
+    fprintf(impl, "    static const unsigned int supertype_ids[] = {");
+    for(i = 0; i < words; i++) {
+        fprintf(impl, "%s", (i == 0 ? " " : ((i % 8 == 0) ? ",\n        " : ", ")));
+        if(bits[i]) {
+            fprintf(impl, "0x%08x", bits[i]);
+        } else {
+            fprintf(impl, "0");
+        }
+    }
+    fprintf(impl, " };\n");
+    fprintf(impl, "    %s::%s%s->TypeIds( %s::%s%s, %d, supertype_ids, %d );\n",
+            SCHEMAget_name(schema), ENT_PREFIX, ENTITYget_name(entity),
+            SCHEMAget_name(schema), ENT_ID_PREFIX, ENTITYget_name(entity), ids->last, words);
+    sc_free(bits);
+}
+
 void ENTITYprint_descriptors(Entity entity, FILE *createall, FILE *impl, Schema schema, bool externMap)
 {
     fprintf(createall, "    %s::%s%s = new EntityDescriptor( ", SCHEMAget_name(schema), ENT_PREFIX, ENTITYget_name(entity));
@@ -1156,6 +1501,7 @@ void ENTITYprint_descriptors(Entity entity, FILE *createall, FILE *impl, Schema
     fprintf(createall, "%s, (Creator) create_%s );\n", externMap ? "LTrue" : "LFalse", ENTITYget_classname(entity));
     /* add the entity to the Schema dictionary entry */
     fprintf(createall, "    %s::schema->AddEntity(%s::%s%s);\n", SCHEMAget_name(schema), SCHEMAget_name(schema), ENT_PREFIX, ENTITYget_name(entity));
+    ENTITYprint_ids(entity, impl, schema);
 
     WHEREprint(ENTITYget_name(entity), TYPEget_where(entity), impl, schema, true);
     UNIQUEprint(entity, impl, schema);
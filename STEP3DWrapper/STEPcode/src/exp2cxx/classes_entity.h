@@ -4,7 +4,10 @@
 const char *ENTITYget_classname(Entity);
 Entity ENTITYget_superclass(Entity entity);
 Entity ENTITYput_superclass(Entity entity);
+Entity ENTITYget_base_class(Entity entity);
 int ENTITYhas_explicit_attributes(Entity e);
+bool ENTITYhas_layout(Entity entity);
+bool ENTITYhas_reader(Entity entity);
 void ENTITYget_first_attribs(Entity entity, Linked_List result);
 void ENTITYPrint(Entity entity, FILES *files, Schema schema, bool externMap);
 void ENTITYprint_descriptors(Entity entity, FILE *createall, FILE *impl, Schema schema, bool externMap);
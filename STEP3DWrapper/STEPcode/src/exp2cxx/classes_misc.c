@@ -350,6 +350,20 @@ Entity ENTITYget_superclass(Entity entity)
     return (tag ? tag -> superclass : 0);
 }
 
+/** the supertype whose class the class of \p entity derives from, as
+ * ENTITYhead_print() chooses it, or 0
+ */
+Entity ENTITYget_base_class(Entity entity)
+{
+    if(LISTempty(ENTITYget_supertypes(entity))) {
+        return 0;
+    }
+    if(multiple_inheritance) {
+        return (Entity) LISTpeek_first(ENTITYget_supertypes(entity));
+    }
+    return ENTITYget_superclass(entity) ? ENTITYget_superclass(entity) : ENTITYput_superclass(entity);
+}
+
 void ENTITYget_first_attribs(Entity entity, Linked_List result)
 {
     Linked_List supers;
@@ -24,6 +24,7 @@ N350 ( August 31, 1993 ) of ISO 10303 TC184/SC4/WG7.
 #include "genCxxFilenames.h"
 #include <ordered_attrs.h>
 #include "rules.h"
+#include "decoding_tables.h"
 
 #include <sc_trace_fprintf.h>
 
@@ -213,6 +214,8 @@ void TYPEenum_inc_print(const Type type, FILE *inc)
     fprintf(inc, "        inline virtual int no_elements () const"
             "  {  return %d;  }\n", cnt);
     fprintf(inc, "        virtual const char * element_at (int n) const;\n");
+    fprintf(inc, "        virtual int element_index (const char * token, size_t len) const;\n");
+    fprintf(inc, "        virtual const char * element_literal (int n) const;\n");
 
     /*  end class definition  */
     fprintf(inc, "};\n");
@@ -252,6 +255,39 @@ void TYPEenum_inc_print(const Type type, FILE *inc)
     /* DAS brandnew above */
 }
 
+/** print the lookup of an enumeration item by its name, and the literals written to a file
+ * the items are listed in the order of the c++ enum, so that the index of a name is its value
+ */
+static void TYPEenum_decoding_print(const Type type, FILE *f)
+{
+    const char *n = TYPEget_ctype(type);
+    const char **names;
+    char prefix[BUFSIZ];
+    int cnt = 0, i;
+
+    names = (const char **) sc_malloc((LISTget_length(TYPEget_body(type)->list) + 1) * sizeof(char *));
+    LISTdo(TYPEget_body(type)->list, expr, Expression)
+    names[cnt++] = EXPget_name(expr);
+    LISTod
+
+    snprintf(prefix, BUFSIZ, "%s_items", n);
+    fprintf(f, "\n");
+    DECODINGprint(f, "", prefix, names, cnt);
+
+    fprintf(f, "static const char * const %s_literals[] = {", prefix);
+    for(i = 0; i < cnt; i++) {
+        fprintf(f, "%s\n    \".%s.\"", (i == 0 ? "" : ","), StrToUpper(names[i]));
+    }
+    fprintf(f, "%s };\n", (cnt == 0 ? " 0" : ""));
+
+    fprintf(f, "\nint\n%s::element_index (const char * token, size_t len) const  {\n", n);
+    fprintf(f, "  return %s_decoding.find (token, len);\n}\n", prefix);
+    fprintf(f, "\nconst char *\n%s::element_literal (int n) const  {\n", n);
+    fprintf(f, "  return (n >= 0 && n < %d) ? %s_literals[n] : 0;\n}\n", cnt, prefix);
+
+    sc_free((void *) names);
+}
+
 void TYPEenum_lib_print(const Type type, FILE *f)
 {
     DictionaryEntry de;
@@ -276,6 +312,8 @@ void TYPEenum_lib_print(const Type type, FILE *f)
     fprintf(f, "  case %s_unset        :\n", EnumName(TYPEget_name(type)));
     fprintf(f, "  default                :  return \"UNSET\";\n  }\n}\n");
 
+    TYPEenum_decoding_print(type, f);
+
     /*    constructors    */
     /*    construct with character string  */
     fprintf(f, "\n%s::%s (const char * n, EnumTypeDescriptor *et)\n"
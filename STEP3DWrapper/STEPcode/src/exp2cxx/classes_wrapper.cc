@@ -155,6 +155,38 @@ void numberAttributes(Scope scope)
     LISTod
 }
 
+/** give the ids of \p e and of the entities of \p list whose class derives from its class */
+static void numberSubclasses(Entity e, Linked_List list, int *count)
+{
+    EntityIds ids = (EntityIds) sc_malloc(sizeof(struct EntityIds_));
+    ids->id = (*count)++;
+    ENTITYput_clientData(e, (ClientData) ids);
+    LISTdo(list, sub, Entity) {
+        if(ENTITYget_base_class(sub) == e) {
+            numberSubclasses(sub, list, count);
+        }
+    }
+    LISTod
+    ids->last = *count - 1;
+}
+
+/* number the entities of the schema in preorder of the generated class
+ * hierarchy, so the classes deriving from one have consecutive ids.
+ * The ids go to the EntityDescriptors and to the visitor of the schema.
+ */
+void numberEntities(Scope scope)
+{
+    int count = 0;
+    Linked_List list = SCOPEget_entities_superclass_order(scope);
+    LISTdo(list, e, Entity) {
+        Entity base = ENTITYget_base_class(e);
+        if(!base || base->superscope != scope) {
+            numberSubclasses(e, list, &count);
+        }
+    }
+    LISTod
+}
+
 /******************************************************************
  **  SCHEMA SECTION                      **/
 
@@ -205,6 +237,8 @@ void SCOPEPrint(Scope scope, FILES *files, Schema schema, ComplexCollect *col, i
             ENTITYprint_classes(e, files->classes);
         }
         LISTod
+
+        ENTITYids_print(list, files->names);
     }
 
     /* fill in the values for the type descriptors and print the enumerations */
@@ -316,6 +350,9 @@ void SCOPEPrint(Scope scope, FILES *files, Schema schema, ComplexCollect *col, i
         fprintf(files->lib, "\nSDAI_Model_contents_ptr create_SdaiModel_contents_%s() {\n", SCHEMAget_name(schema));
         fprintf(files->lib, "    return new SdaiModel_contents_%s;\n}\n", SCHEMAget_name(schema));
 
+        VISITORprint_new(list, files, schema);
+        VISITORPrint(list, files, schema);
+
         fprintf(files->lib, "\nSdaiModel_contents_%s::SdaiModel_contents_%s() {\n", SCHEMAget_name(schema), SCHEMAget_name(schema));
         fprintf(files->lib, "    SDAI_Entity_extent_ptr eep = (SDAI_Entity_extent_ptr)0;\n\n");
         LISTdo(list, e, Entity) {
@@ -720,6 +757,7 @@ void EXPRESSPrint(Express express, ComplexCollect &col, FILES *files)
     DICTdo_type_init(express->symbol_table, &de, OBJ_SCHEMA);
     while((schema = (Scope)DICTdo(&de)) != 0) {
         numberAttributes(schema);
+        numberEntities(schema);
     }
 
     DICTdo_init(express->symbol_table, &de);
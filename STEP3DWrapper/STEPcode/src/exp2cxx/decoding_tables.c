@@ -0,0 +1,189 @@
+/** \file decoding_tables.c
+ * Construction of the perfect hash tables of names, see decoding_tables.h
+ *
+ * The names are spread over buckets by their hash. The buckets are then
+ * placed largest first: each one gets the smallest displacement moving all
+ * of its names to free slots. If a bucket can't be placed, the number of
+ * slots is doubled and everything is placed again.
+ */
+
+#include <sc_memmgr.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sc_stdbool.h>
+
+#include "decoding_tables.h"
+#include "class_strings.h"
+
+/** largest displacement tried for a bucket, the runtime stores them as unsigned short */
+#define MAX_DISPLACEMENT 0xFFFF
+
+static unsigned char upperChar(char c)
+{
+    return (c >= 'a' && c <= 'z') ? (unsigned char)(c - 'a' + 'A') : (unsigned char) c;
+}
+
+unsigned int DECODINGhash(const char *name, size_t len)
+{
+    unsigned int h = 2166136261u;
+    size_t i;
+    for(i = 0; i < len; i++) {
+        h = (h ^ upperChar(name[i])) * 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    return h;
+}
+
+unsigned int DECODINGdisplace(unsigned int h, unsigned int d)
+{
+    h += d * 0x9e3779b9u;
+    h ^= h >> 15;
+    h *= 0x2c1b3c6du;
+    h ^= h >> 12;
+    return h;
+}
+
+static unsigned int nextPowerOf2(unsigned int n)
+{
+    unsigned int p = 1;
+    while(p < n) {
+        p <<= 1;
+    }
+    return p;
+}
+
+/** state of one attempt, for the buckets ordering */
+static const int *bucketSizes;
+
+static int compareBucketSizes(const void *a, const void *b)
+{
+    int sa = bucketSizes[*(const int *)a];
+    int sb = bucketSizes[*(const int *)b];
+    if(sa != sb) {
+        return sb - sa;
+    }
+    return *(const int *)a - *(const int *)b;
+}
+
+/** place all the buckets in slotCount slots
+ * \returns false if a bucket has no valid displacement
+ */
+static bool placeBuckets(const unsigned int *hashes, int count, unsigned int slotCount, unsigned int bucketCount,
+                         short *slots, unsigned short *displacements)
+{
+    int *sizes = (int *) sc_calloc(bucketCount, sizeof(int));
+    int *order = (int *) sc_malloc(bucketCount * sizeof(int));
+    int *members = (int *) sc_malloc((count + 1) * sizeof(int));
+    unsigned int *taken = (unsigned int *) sc_malloc((count + 1) * sizeof(unsigned int));
+    bool placed = true;
+    unsigned int b;
+    int i;
+
+    for(i = 0; i < count; i++) {
+        sizes[hashes[i] & (bucketCount - 1)]++;
+    }
+    for(b = 0; b < bucketCount; b++) {
+        order[b] = (int) b;
+        displacements[b] = 0;
+    }
+    bucketSizes = sizes;
+    qsort(order, bucketCount, sizeof(int), compareBucketSizes);
+
+    for(b = 0; b < slotCount; b++) {
+        slots[b] = -1;
+    }
+
+    for(b = 0; placed && b < bucketCount && sizes[order[b]] > 0; b++) {
+        unsigned int bucket = (unsigned int) order[b];
+        unsigned int d;
+        int n = 0, k, j;
+
+        for(i = 0; i < count; i++) {
+            if((hashes[i] & (bucketCount - 1)) == bucket) {
+                members[n++] = i;
+            }
+        }
+
+        placed = false;
+        for(d = 0; !placed && d <= MAX_DISPLACEMENT; d++) {
+            placed = true;
+            for(k = 0; placed && k < n; k++) {
+                taken[k] = DECODINGdisplace(hashes[members[k]], d) & (slotCount - 1);
+                placed = (slots[taken[k]] < 0);
+                for(j = 0; placed && j < k; j++) {
+                    placed = (taken[j] != taken[k]);
+                }
+            }
+            if(placed) {
+                for(k = 0; k < n; k++) {
+                    slots[taken[k]] = (short) members[k];
+                }
+                displacements[bucket] = (unsigned short) d;
+            }
+        }
+    }
+
+    sc_free(sizes);
+    sc_free(order);
+    sc_free(members);
+    sc_free(taken);
+    return placed;
+}
+
+void DECODINGprint(FILE *f, const char *indent, const char *prefix, const char **names, int count)
+{
+    unsigned int *hashes = (unsigned int *) sc_malloc((count + 1) * sizeof(unsigned int));
+    unsigned int slotCount = nextPowerOf2(count > 0 ? (unsigned int) count : 1);
+    unsigned int bucketCount;
+    short *slots;
+    unsigned short *displacements;
+    unsigned int i;
+
+    for(i = 0; i < (unsigned int) count; i++) {
+        hashes[i] = DECODINGhash(names[i], strlen(names[i]));
+    }
+
+    for(;;) {
+        bucketCount = (slotCount > 1) ? slotCount / 2 : 1;
+        slots = (short *) sc_malloc(slotCount * sizeof(short));
+        displacements = (unsigned short *) sc_malloc(bucketCount * sizeof(unsigned short));
+        if(placeBuckets(hashes, count, slotCount, bucketCount, slots, displacements)) {
+            break;
+        }
+        sc_free(slots);
+        sc_free(displacements);
+        slotCount <<= 1;
+        if(slotCount > 0x8000) {
+            /* only happens with a repeated name */
+            fprintf(stderr, "%s:%d: can't build the decoding table %s\n", __FILE__, __LINE__, prefix);
+            abort();
+        }
+    }
+
+    fprintf(f, "%sstatic const char * const %s_names[] = {", indent, prefix);
+    for(i = 0; i < (unsigned int) count; i++) {
+        fprintf(f, "%s\n%s    \"%s\"", (i == 0 ? "" : ","), indent, StrToUpper(names[i]));
+    }
+    fprintf(f, "%s };\n", (count == 0 ? " 0" : ""));
+
+    fprintf(f, "%sstatic const short %s_slots[] = {", indent, prefix);
+    for(i = 0; i < slotCount; i++) {
+        fprintf(f, "%s%d", (i == 0 ? " " : ((i % 16 == 0) ? ",\n        " : ", ")), slots[i]);
+    }
+    fprintf(f, " };\n");
+
+    fprintf(f, "%sstatic const unsigned short %s_displacements[] = {", indent, prefix);
+    for(i = 0; i < bucketCount; i++) {
+        fprintf(f, "%s%u", (i == 0 ? " " : ((i % 16 == 0) ? ",\n        " : ", ")), displacements[i]);
+    }
+    fprintf(f, " };\n");
+
+    fprintf(f, "%sstatic const DecodingTable %s_decoding = { %s_names, %s_slots, %s_displacements, %uu, %uu };\n",
+            indent, prefix, prefix, prefix, prefix, slotCount - 1, bucketCount - 1);
+
+    sc_free(hashes);
+    sc_free(slots);
+    sc_free(displacements);
+}
@@ -0,0 +1,30 @@
+#ifndef DECODING_TABLES_H
+#define DECODING_TABLES_H
+
+/** \file decoding_tables.h
+ * Perfect hash tables of the names of enumeration items and select choices,
+ * read at run time by the DecodingTable class of src/clutils.
+ *
+ * Functions prototyped here are implemented in decoding_tables.c
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+
+/** hash of a name, same as DecodingTable::hash() */
+unsigned int DECODINGhash(const char *name, size_t len);
+
+/** slot of a hash in a bucket with displacement d, same as DecodingTable::displace() */
+unsigned int DECODINGdisplace(unsigned int h, unsigned int d);
+
+/** print the static arrays and the DecodingTable of a list of names
+ * \param f output file
+ * \param indent written at the beginning of each line
+ * \param prefix name of the variables: prefix_names, prefix_slots, prefix_displacements and prefix_decoding
+ * \param names the names, written in upper case; the index of a name is what DecodingTable::find() returns.
+ *              Names must not be repeated, even with another case
+ * \param count number of names
+ */
+void DECODINGprint(FILE *f, const char *indent, const char *prefix, const char **names, int count);
+
+#endif /* DECODING_TABLES_H */
@@ -85,16 +85,19 @@ extern void print_fedex_version(void);
 static void exp2cxx_usage(void)
 {
     char *warnings_help_msg = ERRORget_warnings_help("\t", "\n");
-    fprintf(stderr, "usage: %s [-s|-S] [-a|-A] [-L] [-v] [-d # | -d 9 -l nnn -u nnn] [-n] [-p <object_type>] {-w|-i <warning>} express_file\n", EXPRESSprogram_name);
+    fprintf(stderr, "usage: %s [-s|-S] [-a|-A] [-L] [-t|-T] [-u|-U] [-v] [-d #] [-n] [-p <object_type>] {-w|-i <warning>} [-C <cache_dir>] express_file\n", EXPRESSprogram_name);
     fprintf(stderr, "where\t-s or -S uses only single inheritance in the generated C++ classes\n");
     fprintf(stderr, "\t-a or -A generates the early bound access functions for entity classes the old way (without an underscore)\n");
     fprintf(stderr, "\t-L prints logging code in the generated C++ classes\n");
+    fprintf(stderr, "\t-t or -T makes the attributes of single inheritance entities from a layout table\n");
+    fprintf(stderr, "\t-u or -U with -t, writes for each of those entities a reader of its attributes, in their order and types\n");
     fprintf(stderr, "\t-v produces the version description below\n");
     fprintf(stderr, "\t-d turns on debugging (\"-d 0\" describes this further\n");
     fprintf(stderr, "\t-p turns on printing when processing certain objects (see below)\n");
     fprintf(stderr, "\t-n do not pause for internal errors (useful with delta script)\n");
     fprintf(stderr, "\t-w warning enable\n");
     fprintf(stderr, "\t-i warning ignore\n");
+    fprintf(stderr, "\t-C loads the resolved schema from a cache in <cache_dir> if it is up to date, writes it there otherwise\n");
     fprintf(stderr, "and <warning> is one of:\n");
     fprintf(stderr, "\tnone\n\tall\n");
     fprintf(stderr, "%s", warnings_help_msg);
@@ -134,7 +137,7 @@ void EXPRESSinit_init(void)
     EXPRESSsucceed = success;
     EXPRESSgetopt = Handle_FedPlus_Args;
     /* so the function getopt (see man 3 getopt) will not report an error */
-    strcat(EXPRESSgetopt_options, "sSlLaA");
+    strcat(EXPRESSgetopt_options, "sSlLaAtTuU");
     ERRORusage_function = exp2cxx_usage;
 }
 
@@ -79,6 +79,7 @@ void print_schemas_separate(Express express, void *complexCol, FILES *files)
     DICTdo_type_init(express->symbol_table, &de, OBJ_SCHEMA);
     while((schema = (Scope)DICTdo(&de)) != 0) {
         numberAttributes(schema);
+        numberEntities(schema);
     }
     while(!complete) {
         complete = true;
@@ -21,6 +21,8 @@ extern int multiple_inheritance;
 #include "classes.h"
 #include "classes_type.h"
 #include "classes_attribute.h"
+#include "class_strings.h"
+#include "decoding_tables.h"
 
 #include <sc_trace_fprintf.h>
 
@@ -1311,6 +1313,70 @@ void TYPEselect_lib_print_part_four(const Type type, FILE *f, Linked_List dups,
 }
 
 
+/** count the names which can be read as the type of a value of a select, see TYPEselect_decoding_names() */
+static int TYPEselect_decoding_count(const Type type)
+{
+    int cnt = 0;
+    LISTdo(SEL_TYPEget_items(type), t, Type)
+    if(TYPEis_select(t) && !TYPEget_head(t)) {
+        cnt += TYPEselect_decoding_count(t);
+    } else {
+        ++cnt;
+    }
+    LISTod;
+    return cnt;
+}
+
+/** collect the names which can be read as the type of a value of a select, as in
+ * SelectTypeDescriptor::CanBeSet(): an item which is a select is named by its own
+ * items, unless it's a renamed select. Each name is kept for the first item with it.
+ * \param choice the index of the item of the outermost select
+ */
+static int TYPEselect_decoding_names(const Type type, int choice, const char **names, short *choices, int cnt)
+{
+    int i, n = 0;
+    LISTdo(SEL_TYPEget_items(type), t, Type)
+    int c = (choice < 0) ? n : choice;
+    if(TYPEis_select(t) && !TYPEget_head(t)) {
+        cnt = TYPEselect_decoding_names(t, c, names, choices, cnt);
+    } else {
+        /* the scanner writes names in lower case */
+        for(i = 0; i < cnt && strcmp(names[i], TYPEget_name(t)) != 0; i++) {
+        }
+        if(i == cnt) {
+            names[cnt] = TYPEget_name(t);
+            choices[cnt++] = (short) c;
+        }
+    }
+    ++n;
+    LISTod;
+    return cnt;
+}
+
+/** print the lookup of the items of a select by name, used when a select value is read */
+static void TYPEselect_decoding_print(const Type type, FILE *f)
+{
+    int cnt = TYPEselect_decoding_count(type), i;
+    const char **names = (const char **) sc_malloc((cnt + 1) * sizeof(char *));
+    short *choices = (short *) sc_malloc((cnt + 1) * sizeof(short));
+    char prefix[BUFSIZ];
+
+    cnt = TYPEselect_decoding_names(type, -1, names, choices, 0);
+
+    snprintf(prefix, BUFSIZ, "%s_choices", SelectName(TYPEget_name(type)));
+    DECODINGprint(f, "    ", prefix, names, cnt);
+    fprintf(f, "    static const short %s_elements[] = {", prefix);
+    for(i = 0; i < cnt; i++) {
+        fprintf(f, "%s%d", (i == 0 ? " " : ((i % 16 == 0) ? ",\n        " : ", ")), choices[i]);
+    }
+    fprintf(f, "%s };\n", (cnt == 0 ? " 0" : ""));
+    fprintf(f, "    %s -> SetDecodingTable (&%s_decoding, %s_elements);\n",
+            TYPEtd_name(type), prefix, prefix);
+
+    sc_free((void *) names);
+    sc_free(choices);
+}
+
 /**
 * TYPEselect_init_print prints the types that belong to the select type
 */
@@ -1323,6 +1389,8 @@ void TYPEselect_init_print(const Type type, FILE *f)
     fprintf(f, " (%s);\n",
             TYPEtd_name(t));
     LISTod;
+
+    TYPEselect_decoding_print(type, f);
 }
 
 void TYPEselect_lib_part21(const Type type, FILE *f)
@@ -6,12 +6,13 @@
 static void exppp_usage(void)
 {
     char *warnings_help_msg = ERRORget_warnings_help("\t", "\n");
-    fprintf(stderr, "usage: %s [-v] [-d #] [-p <object_type>] {-w|-i <warning>} [-l <length>] [-c] [-o [file|--]] express_file\n", EXPRESSprogram_name);
+    fprintf(stderr, "usage: %s [-v] [-d #] [-p <object_type>] {-w|-i <warning>} [-l <length>] [-c] [-o [file|--]] [-C <cache_dir>] express_file\n", EXPRESSprogram_name);
     fprintf(stderr, "\t-v produces a version description\n");
     fprintf(stderr, "\t-l specifies line length hint for output\n");
     fprintf(stderr, "\t-t enable tail comment for declarations - i.e. END_TYPE; -- axis2_placement\n");
     fprintf(stderr, "\t-c for constants, print one item per line (YMMV!)\n");
     fprintf(stderr, "\t-o specifies the name of the output file (-- for stdout)\n");
+    fprintf(stderr, "\t-C loads the resolved schema from a cache in <cache_dir> if it is up to date, writes it there otherwise\n");
     fprintf(stderr, "\t-d turns on debugging (\"-d 0\" describes this further\n");
     fprintf(stderr, "\t-p turns on printing when processing certain objects (see below)\n");
     fprintf(stderr, "\t-w warning enable\n");
@@ -0,0 +1,30 @@
+cmake_minimum_required( VERSION 3.6.3 )
+
+# executable is ${EXPPP}, input file is ${INFILE}
+# the schema is printed three times: without a cache, while writing the cache, and from the cache
+
+set( cdir "cache_test" )
+file( REMOVE_RECURSE ${cdir} )
+
+execute_process( COMMAND ${EXPPP} -o cache_ref.exp ${INFILE}
+                RESULT_VARIABLE CMD_RESULT )
+if( NOT ${CMD_RESULT} EQUAL 0 )
+    message(FATAL_ERROR "Error running ${EXPPP} on ${INFILE}")
+endif( NOT ${CMD_RESULT} EQUAL 0 )
+
+foreach( ofile cache_write.exp cache_read.exp )
+    execute_process( COMMAND ${EXPPP} -C ${cdir} -o ${ofile} ${INFILE}
+                    RESULT_VARIABLE CMD_RESULT )
+    if( NOT ${CMD_RESULT} EQUAL 0 )
+        message(FATAL_ERROR "Error running ${EXPPP} -C ${cdir} on ${INFILE}")
+    endif( NOT ${CMD_RESULT} EQUAL 0 )
+    file( GLOB cfiles ${cdir}/*.expc )
+    if( NOT cfiles )
+        message( FATAL_ERROR "${EXPPP} did not write a cache file in ${cdir}" )
+    endif( NOT cfiles )
+    file( READ cache_ref.exp pretty_ref )
+    file( READ ${ofile} pretty_out )
+    if( NOT pretty_out STREQUAL pretty_ref )
+        message( FATAL_ERROR "Pretty printer output differs when using a cache (${ofile})." )
+    endif( NOT pretty_out STREQUAL pretty_ref )
+endforeach( ofile cache_write.exp cache_read.exp )
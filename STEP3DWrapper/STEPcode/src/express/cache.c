@@ -0,0 +1,1207 @@
+/** \file cache.c
+ * binary cache of resolved models
+ *
+ * The objects of a model are found by a breadth-first traversal that knows the type of each pointer
+ * field (CACHEvisit). Each object is then written as a copy of its memory, with its pointers set to
+ * 0 and only its non-zero words stored, followed by a list of fixups (object, offset, target) that
+ * the loader applies once all objects are allocated.
+ *
+ * A few pointers can't be typed by looking at the object that holds them:
+ * - Symbol pointers point either to a standalone Symbol or to the Symbol at the start of a Scope,
+ *   Expression, Statement or Case_Item. They are resolved once the traversal is complete, and only
+ *   pointers that are not the address of an object become standalone Symbols.
+ * - The union of an Expression. Its pointers are written as fixups if they are the address of an
+ *   object, and as plain values otherwise.
+ * - A function call without arguments has either u.funcall.function set and no list, or u.list set
+ *   to a list holding the function (see EXP_resolve). The function is always an object by the end of
+ *   the traversal, so anything else is the list.
+ *
+ * \sa cache.h
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sc_memmgr.h"
+#include "sc_mkdir.h"
+#include "express/cache.h"
+#include "express/resolve.h"
+
+#define CACHE_MAGIC     "EXPC"
+#define CACHE_VERSION   1
+#define CACHE_SUFFIX    ".expc"
+
+/** the kinds of objects in a cache file, followed by the other ways to handle a pointer field */
+enum cache_kind {
+    CK_NONE, CK_STRING, CK_SYMBOL, CK_SCOPE, CK_TYPEHEAD, CK_TYPEBODY, CK_VARIABLE, CK_PROCEDURE,
+    CK_FUNCTION, CK_RULE, CK_WHERE, CK_ENTITY, CK_SCHEMA, CK_EXPRESS, CK_RENAME, CK_CASE_ITEM,
+    CK_EXPRESSION, CK_QUERY, CK_STATEMENT, CK_ALIAS, CK_ASSIGNMENT, CK_CASE, CK_COMPOUND,
+    CK_CONDITIONAL, CK_LOOP, CK_INCREMENT, CK_PCALL, CK_RETURN, CK_LIST, CK_LINK, CK_HASH_TABLE,
+    CK_SEGMENT, CK_ELEMENT,
+    CK_OBJECT_KINDS,
+    CK_SYMBOL_REF = CK_OBJECT_KINDS, /**< a Symbol, possibly inside another object */
+    CK_MAYBE,                        /**< a pointer if it is the address of an object */
+    CK_ZERO,                         /**< not stored, e.g. clientData */
+    CK_UNIQUE,                       /**< a list of UNIQUE clause items */
+    CK_UNIQUE_ITEMS                  /**< a label Symbol followed by attribute expressions */
+};
+
+typedef struct Cache_Object_ {
+    void *ptr;
+    unsigned char kind;
+    unsigned char aux;      /**< the kind of the elements of a list or link */
+} Cache_Object;
+
+typedef struct Cache_Buffer_ {
+    char *data;
+    size_t length;
+    size_t size;
+} Cache_Buffer;
+
+typedef struct Cache_ {
+    Cache_Object *objects;
+    unsigned int count, size;
+    unsigned int visited;           /**< objects before this one have been traversed */
+    unsigned int externals;         /**< objects created by EXPRESSinitialize() */
+    unsigned int signature;         /**< hash of the kinds of the externals */
+    unsigned int *slots;            /**< hash table from address to object number (index + 1) */
+    unsigned int slotCount;
+    Cache_Buffer symbols;           /**< Symbol pointers to resolve after the traversal */
+    Cache_Buffer calls;             /**< function calls without arguments */
+
+    bool emit;                      /**< writing fixups rather than traversing */
+    bool failed;
+    char *record;                   /**< the copy of the object being written */
+    unsigned int current;
+    Cache_Buffer fixups;
+} Cache;
+
+static Cache cache;
+static bool cache_initialized = false;
+
+static void CACHEput(Cache_Buffer *b, const void *data, size_t length)
+{
+    if(b->length + length > b->size) {
+        b->size = 2 * b->size + length + 4096;
+        b->data = (char *)sc_realloc(b->data, b->size);
+    }
+    memcpy(b->data + b->length, data, length);
+    b->length += length;
+}
+
+static void CACHEput_uint(Cache_Buffer *b, unsigned int u)
+{
+    CACHEput(b, &u, sizeof(u));
+}
+
+/** write an object as a bitmap of its non-zero words followed by those words;
+ * most of a hash table or segment is null pointers
+ */
+static void CACHEput_words(Cache_Buffer *b, const char *record, size_t length)
+{
+    unsigned int words = (unsigned int)(length / sizeof(unsigned int)), i;
+    size_t bitmap = b->length;
+    unsigned int word;
+
+    for(i = 0; i < words; i += 8) {
+        CACHEput(b, "", 1);
+    }
+    for(i = 0; i < words; i++) {
+        memcpy(&word, record + i * sizeof(word), sizeof(word));
+        if(word) {
+            b->data[bitmap + i / 8] |= (char)(1 << (i % 8));
+            CACHEput(b, &word, sizeof(word));
+        }
+    }
+}
+
+static void CACHEput_string(Cache_Buffer *b, const char *s)
+{
+    CACHEput_uint(b, strlen(s));
+    CACHEput(b, s, strlen(s));
+}
+
+/** FNV-1a */
+static unsigned long long CACHEhash(const char *data, size_t length, unsigned long long h)
+{
+    size_t i;
+    for(i = 0; i < length; i++) {
+        h = (h ^ (unsigned char)data[i]) * 1099511628211ULL;
+    }
+    return h;
+}
+
+#define CACHE_HASH_INIT 14695981039346656037ULL
+
+/** size and hash of a source file
+ * \return false if it can't be read
+ */
+static bool CACHEhash_file(const char *filename, unsigned long long *size, unsigned long long *hash)
+{
+    char buf[65536];
+    size_t n;
+    FILE *fp = fopen(filename, "rb");
+    if(!fp) {
+        return false;
+    }
+    *size = 0;
+    *hash = CACHE_HASH_INIT;
+    while((n = fread(buf, 1, sizeof(buf), fp)) > 0) {
+        *size += n;
+        *hash = CACHEhash(buf, n, *hash);
+    }
+    fclose(fp);
+    return true;
+}
+
+/** size of the objects of a kind, 0 for strings */
+static size_t CACHEsize(int kind)
+{
+    switch(kind) {
+        case CK_SYMBOL:
+            return sizeof(struct Symbol_);
+        case CK_SCOPE:
+            return sizeof(struct Scope_);
+        case CK_TYPEHEAD:
+            return sizeof(struct TypeHead_);
+        case CK_TYPEBODY:
+            return sizeof(struct TypeBody_);
+        case CK_VARIABLE:
+            return sizeof(struct Variable_);
+        case CK_PROCEDURE:
+            return sizeof(struct Procedure_);
+        case CK_FUNCTION:
+            return sizeof(struct Function_);
+        case CK_RULE:
+            return sizeof(struct Rule_);
+        case CK_WHERE:
+            return sizeof(struct Where_);
+        case CK_ENTITY:
+            return sizeof(struct Entity_);
+        case CK_SCHEMA:
+            return sizeof(struct Schema_);
+        case CK_EXPRESS:
+            return sizeof(struct Express_);
+        case CK_RENAME:
+            return sizeof(struct Rename);
+        case CK_CASE_ITEM:
+            return sizeof(struct Case_Item_);
+        case CK_EXPRESSION:
+            return sizeof(struct Expression_);
+        case CK_QUERY:
+            return sizeof(struct Query_);
+        case CK_STATEMENT:
+            return sizeof(struct Statement_);
+        case CK_ALIAS:
+            return sizeof(struct Alias_);
+        case CK_ASSIGNMENT:
+            return sizeof(struct Assignment_);
+        case CK_CASE:
+            return sizeof(struct Case_Statement_);
+        case CK_COMPOUND:
+            return sizeof(struct Compound_Statement_);
+        case CK_CONDITIONAL:
+            return sizeof(struct Conditional_);
+        case CK_LOOP:
+            return sizeof(struct Loop_);
+        case CK_INCREMENT:
+            return sizeof(struct Increment_);
+        case CK_PCALL:
+            return sizeof(struct Procedure_Call_);
+        case CK_RETURN:
+            return sizeof(struct Return_Statement_);
+        case CK_LIST:
+            return sizeof(struct Linked_List_);
+        case CK_LINK:
+            return sizeof(struct Link_);
+        case CK_HASH_TABLE:
+            return sizeof(struct Hash_Table_);
+        case CK_SEGMENT:
+            return SEGMENT_SIZE * sizeof(Element);
+        case CK_ELEMENT:
+            return sizeof(struct Element_);
+        default:
+            return 0;
+    }
+}
+
+/** allocate an object the way the rest of the library does, so that it can be destroyed as usual */
+static void *CACHEnew(int kind, size_t size)
+{
+    switch(kind) {
+        case CK_STRING:
+            return sc_malloc(size);
+        case CK_SYMBOL:
+            return SYMBOL_new();
+        case CK_SCOPE:
+            return SCOPE_new();
+        case CK_TYPEHEAD:
+            return TYPEHEAD_new();
+        case CK_TYPEBODY:
+            return TYPEBODY_new();
+        case CK_VARIABLE:
+            return VAR_new();
+        case CK_PROCEDURE:
+            return PROC_new();
+        case CK_FUNCTION:
+            return FUNC_new();
+        case CK_RULE:
+            return RULE_new();
+        case CK_WHERE:
+            return WHERE_new();
+        case CK_ENTITY:
+            return ENTITY_new();
+        case CK_SCHEMA:
+            return SCHEMA_new();
+        case CK_EXPRESS:
+            return sc_calloc(1, size);
+        case CK_RENAME:
+            return REN_new();
+        case CK_CASE_ITEM:
+            return CASE_IT_new();
+        case CK_EXPRESSION:
+            return EXP_new();
+        case CK_QUERY:
+            return QUERY_new();
+        case CK_STATEMENT:
+            return STMT_new();
+        case CK_ALIAS:
+            return ALIAS_new();
+        case CK_ASSIGNMENT:
+            return ASSIGN_new();
+        case CK_CASE:
+            return CASE_new();
+        case CK_COMPOUND:
+            return COMP_STMT_new();
+        case CK_CONDITIONAL:
+            return COND_new();
+        case CK_LOOP:
+            return LOOP_new();
+        case CK_INCREMENT:
+            return INCR_new();
+        case CK_PCALL:
+            return PCALL_new();
+        case CK_RETURN:
+            return RET_new();
+        case CK_LIST:
+            return LIST_new();
+        case CK_LINK:
+            return LINK_new();
+        case CK_HASH_TABLE:
+            return HASH_Table_new();
+        case CK_SEGMENT:
+            /* like CALLOC in hash.c */
+            return calloc(SEGMENT_SIZE, sizeof(Element));
+        case CK_ELEMENT:
+            return HASH_Element_new();
+        default:
+            return 0;
+    }
+}
+
+/** the kind of the data of a dictionary entry or rename, from its OBJ_ type */
+static int CACHEdata_kind(char type)
+{
+    switch(type) {
+        case OBJ_VARIABLE:
+            return CK_VARIABLE;
+        case OBJ_EXPRESSION:
+        case OBJ_AMBIG_ENUM:
+            return CK_EXPRESSION;
+        case OBJ_RENAME:
+            return CK_RENAME;
+        case OBJ_WHERE:
+            return CK_WHERE;
+        case OBJ_ENTITY:
+        case OBJ_SCHEMA:
+        case OBJ_TYPE:
+        case OBJ_TAG:
+        case OBJ_FUNCTION:
+        case OBJ_PROCEDURE:
+        case OBJ_RULE:
+        case OBJ_EXPRESS:
+        case OBJ_ALIAS:
+        case OBJ_QUERY:
+        case OBJ_INCREMENT:
+            return CK_SCOPE;
+        default:
+            return CK_MAYBE;
+    }
+}
+
+/** hash table slot of an address: either the slot holding it, or the empty slot where it belongs */
+static unsigned int CACHEslot(Cache *c, void *p)
+{
+    unsigned int mask = c->slotCount - 1;
+    unsigned int i = (unsigned int)(((size_t)p >> 3) * 2654435761U) & mask;
+    while(c->slots[i] && c->objects[c->slots[i] - 1].ptr != p) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+/** \return the object number of an address, 0 if it isn't an object */
+static unsigned int CACHEfind(Cache *c, void *p)
+{
+    if(!p || !c->slotCount) {
+        return 0;
+    }
+    return c->slots[CACHEslot(c, p)];
+}
+
+static unsigned int CACHEadd(Cache *c, void *p, int kind, int aux)
+{
+    unsigned int i, n;
+    if(!p) {
+        return 0;
+    }
+    if(2 * (c->count + 1) > c->slotCount) {
+        unsigned int *old = c->slots;
+        c->slotCount = c->slotCount ? 2 * c->slotCount : 4096;
+        c->slots = (unsigned int *)sc_calloc(c->slotCount, sizeof(unsigned int));
+        for(n = 0; n < c->count; n++) {
+            c->slots[CACHEslot(c, c->objects[n].ptr)] = n + 1;
+        }
+        if(old) {
+            sc_free(old);
+        }
+    }
+    i = CACHEslot(c, p);
+    if(c->slots[i]) {
+        return c->slots[i];
+    }
+    if(c->count == c->size) {
+        c->size = c->size ? 2 * c->size : 4096;
+        c->objects = (Cache_Object *)sc_realloc(c->objects, c->size * sizeof(Cache_Object));
+    }
+    c->objects[c->count].ptr = p;
+    c->objects[c->count].kind = (unsigned char)kind;
+    c->objects[c->count].aux = (unsigned char)aux;
+    c->slots[i] = ++c->count;
+    return c->count;
+}
+
+/** handle one pointer field of an object
+ * while traversing, add the object it points to; while writing, clear it in the copy of the object
+ * and add a fixup
+ */
+static void CACHEfield(Cache *c, void *obj, void *field, int kind, int aux)
+{
+    void *p = *(void **)field;
+    unsigned int offset, target;
+
+    if(!c->emit) {
+        switch(kind) {
+            case CK_ZERO:
+            case CK_MAYBE:
+                break;
+            case CK_SYMBOL_REF:
+                if(p) {
+                    CACHEput(&c->symbols, &p, sizeof(p));
+                }
+                break;
+            case CK_UNIQUE:
+                CACHEadd(c, p, CK_LIST, CK_UNIQUE_ITEMS);
+                break;
+            default:
+                CACHEadd(c, p, kind, aux);
+                break;
+        }
+        return;
+    }
+
+    offset = (unsigned int)((char *)field - (char *)obj);
+    target = CACHEfind(c, p);
+    if(kind == CK_MAYBE && !target) {
+        /* not a pointer to an object, keep the value */
+        return;
+    }
+    memset(c->record + offset, 0, sizeof(void *));
+    if(kind == CK_ZERO || !p) {
+        return;
+    }
+    if(!target) {
+        c->failed = true;
+        return;
+    }
+    CACHEput_uint(&c->fixups, c->current);
+    CACHEput_uint(&c->fixups, offset);
+    CACHEput_uint(&c->fixups, target);
+}
+
+#define CACHE_FIELD(f, kind, aux) CACHEfield(c, obj, (void *)&(f), (kind), (aux))
+
+static void CACHEvisit_symbol(Cache *c, void *obj, Symbol *sym)
+{
+    CACHE_FIELD(sym->name, CK_STRING, 0);
+    CACHE_FIELD(sym->filename, CK_STRING, 0);
+}
+
+static void CACHEvisit_scope(Cache *c, Scope obj)
+{
+    int kind;
+    CACHEvisit_symbol(c, obj, &obj->symbol);
+    CACHE_FIELD(obj->clientData, CK_ZERO, 0);
+    CACHE_FIELD(obj->symbol_table, CK_HASH_TABLE, 0);
+    CACHE_FIELD(obj->enum_table, CK_HASH_TABLE, 0);
+    CACHE_FIELD(obj->superscope, CK_SCOPE, 0);
+    switch(obj->type) {
+        case OBJ_PROCEDURE:
+            kind = CK_PROCEDURE;
+            break;
+        case OBJ_FUNCTION:
+            kind = CK_FUNCTION;
+            break;
+        case OBJ_RULE:
+            kind = CK_RULE;
+            break;
+        case OBJ_ENTITY:
+            kind = CK_ENTITY;
+            break;
+        case OBJ_SCHEMA:
+            kind = CK_SCHEMA;
+            break;
+        case OBJ_EXPRESS:
+            kind = CK_EXPRESS;
+            break;
+        case OBJ_INCREMENT:
+            kind = CK_INCREMENT;
+            break;
+        case OBJ_TYPE:
+        case OBJ_TAG:
+            kind = CK_TYPEHEAD;
+            break;
+        default:
+            kind = CK_MAYBE;
+            break;
+    }
+    CACHE_FIELD(obj->u.type, kind, 0);
+    CACHE_FIELD(obj->where, CK_LIST, CK_WHERE);
+}
+
+static void CACHEvisit_expression(Cache *c, Expression obj)
+{
+    CACHEvisit_symbol(c, obj, &obj->symbol);
+    CACHE_FIELD(obj->type, CK_SCOPE, 0);
+    CACHE_FIELD(obj->return_type, CK_SCOPE, 0);
+    CACHE_FIELD(obj->e.op1, CK_EXPRESSION, 0);
+    CACHE_FIELD(obj->e.op2, CK_EXPRESSION, 0);
+    CACHE_FIELD(obj->e.op3, CK_EXPRESSION, 0);
+    if(!c->emit) {
+        if(obj->type == Type_Query) {
+            CACHE_FIELD(obj->u.query, CK_QUERY, 0);
+        } else if(obj->type == Type_Funcall) {
+            CACHE_FIELD(obj->u.funcall.list, CK_LIST, CK_EXPRESSION);
+            if(obj->u.funcall.list) {
+                CACHE_FIELD(obj->u.funcall.function, CK_SCOPE, 0);
+            } else if(obj->u.funcall.function) {
+                CACHEput(&c->calls, &obj, sizeof(obj));
+            }
+        } else if(obj->type == Type_Aggregate || obj->type == Type_Oneof) {
+            CACHE_FIELD(obj->u.list, CK_LIST, CK_EXPRESSION);
+        }
+    }
+    /* the union is as large as u.funcall */
+    CACHE_FIELD(obj->u.funcall.function, CK_MAYBE, 0);
+    CACHE_FIELD(obj->u.funcall.list, CK_MAYBE, 0);
+}
+
+static void CACHEvisit_statement(Cache *c, Statement obj)
+{
+    int kind;
+    CACHEvisit_symbol(c, obj, &obj->symbol);
+    switch(obj->type) {
+        case STMT_ALIAS:
+            kind = CK_ALIAS;
+            break;
+        case STMT_ASSIGN:
+            kind = CK_ASSIGNMENT;
+            break;
+        case STMT_CASE:
+            kind = CK_CASE;
+            break;
+        case STMT_COMPOUND:
+            kind = CK_COMPOUND;
+            break;
+        case STMT_COND:
+            kind = CK_CONDITIONAL;
+            break;
+        case STMT_LOOP:
+            kind = CK_LOOP;
+            break;
+        case STMT_PCALL:
+            kind = CK_PCALL;
+            break;
+        case STMT_RETURN:
+            kind = CK_RETURN;
+            break;
+        default:
+            kind = CK_MAYBE;
+            break;
+    }
+    CACHE_FIELD(obj->u.alias, kind, 0);
+}
+
+static void CACHEvisit_list(Cache *c, Linked_List obj, int aux)
+{
+    Link link;
+    int kind;
+    CACHE_FIELD(obj->mark, CK_LINK, (aux == CK_UNIQUE_ITEMS) ? CK_EXPRESSION : aux);
+    if(c->emit) {
+        return;
+    }
+    /* the first item of a UNIQUE clause is its label */
+    kind = (aux == CK_UNIQUE_ITEMS) ? CK_SYMBOL_REF : aux;
+    for(link = obj->mark->next; link != obj->mark; link = link->next) {
+        CACHEadd(c, link, CK_LINK, kind);
+        if(aux == CK_UNIQUE_ITEMS) {
+            kind = CK_EXPRESSION;
+        }
+    }
+}
+
+static void CACHEvisit(Cache *c, Cache_Object *o)
+{
+    void *obj = o->ptr;
+    unsigned int i;
+
+    switch(o->kind) {
+        case CK_SYMBOL:
+            CACHEvisit_symbol(c, obj, (Symbol *)obj);
+            break;
+        case CK_SCOPE:
+            CACHEvisit_scope(c, (Scope)obj);
+            break;
+        case CK_TYPEHEAD: {
+            TypeHead th = (TypeHead)obj;
+            CACHE_FIELD(th->head, CK_SCOPE, 0);
+            CACHE_FIELD(th->body, CK_TYPEBODY, 0);
+            break;
+        }
+        case CK_TYPEBODY: {
+            TypeBody tb = (TypeBody)obj;
+            CACHE_FIELD(tb->head, CK_TYPEHEAD, 0);
+            CACHE_FIELD(tb->base, CK_SCOPE, 0);
+            CACHE_FIELD(tb->tag, CK_SCOPE, 0);
+            CACHE_FIELD(tb->precision, CK_EXPRESSION, 0);
+            /* enumeration items, or the types of a select */
+            CACHE_FIELD(tb->list, CK_LIST, (tb->type == enumeration_) ? CK_EXPRESSION : CK_SCOPE);
+            CACHE_FIELD(tb->upper, CK_EXPRESSION, 0);
+            CACHE_FIELD(tb->lower, CK_EXPRESSION, 0);
+            CACHE_FIELD(tb->entity, CK_SCOPE, 0);
+            break;
+        }
+        case CK_VARIABLE: {
+            Variable v = (Variable)obj;
+            CACHE_FIELD(v->name, CK_EXPRESSION, 0);
+            CACHE_FIELD(v->type, CK_SCOPE, 0);
+            CACHE_FIELD(v->initializer, CK_EXPRESSION, 0);
+            CACHE_FIELD(v->inverse_symbol, CK_SYMBOL_REF, 0);
+            CACHE_FIELD(v->inverse_attribute, CK_VARIABLE, 0);
+            break;
+        }
+        case CK_PROCEDURE: {
+            struct Procedure_ *p = (struct Procedure_ *)obj;
+            CACHE_FIELD(p->parameters, CK_LIST, CK_VARIABLE);
+            CACHE_FIELD(p->body, CK_LIST, CK_STATEMENT);
+            CACHE_FIELD(p->text.filename, CK_STRING, 0);
+            break;
+        }
+        case CK_FUNCTION: {
+            struct Function_ *f = (struct Function_ *)obj;
+            CACHE_FIELD(f->parameters, CK_LIST, CK_VARIABLE);
+            CACHE_FIELD(f->body, CK_LIST, CK_STATEMENT);
+            CACHE_FIELD(f->return_type, CK_SCOPE, 0);
+            CACHE_FIELD(f->text.filename, CK_STRING, 0);
+            break;
+        }
+        case CK_RULE: {
+            struct Rule_ *r = (struct Rule_ *)obj;
+            CACHE_FIELD(r->parameters, CK_LIST, CK_VARIABLE);
+            CACHE_FIELD(r->body, CK_LIST, CK_STATEMENT);
+            CACHE_FIELD(r->text.filename, CK_STRING, 0);
+            break;
+        }
+        case CK_WHERE: {
+            Where w = (Where)obj;
+            CACHE_FIELD(w->label, CK_SYMBOL_REF, 0);
+            CACHE_FIELD(w->expr, CK_EXPRESSION, 0);
+            break;
+        }
+        case CK_ENTITY: {
+            struct Entity_ *e = (struct Entity_ *)obj;
+            CACHE_FIELD(e->supertype_symbols, CK_LIST, CK_SYMBOL_REF);
+            CACHE_FIELD(e->supertypes, CK_LIST, CK_SCOPE);
+            CACHE_FIELD(e->subtypes, CK_LIST, CK_SCOPE);
+            CACHE_FIELD(e->subtype_expression, CK_EXPRESSION, 0);
+            CACHE_FIELD(e->attributes, CK_LIST, CK_VARIABLE);
+            CACHE_FIELD(e->unique, CK_LIST, CK_UNIQUE);
+            CACHE_FIELD(e->instances, CK_ZERO, 0);
+            CACHE_FIELD(e->type, CK_SCOPE, 0);
+            break;
+        }
+        case CK_SCHEMA: {
+            struct Schema_ *s = (struct Schema_ *)obj;
+            CACHE_FIELD(s->rules, CK_LIST, CK_SCOPE);
+            CACHE_FIELD(s->reflist, CK_LIST, CK_RENAME);
+            CACHE_FIELD(s->uselist, CK_LIST, CK_RENAME);
+            CACHE_FIELD(s->refdict, CK_HASH_TABLE, 0);
+            CACHE_FIELD(s->usedict, CK_HASH_TABLE, 0);
+            CACHE_FIELD(s->use_schemas, CK_LIST, CK_SCOPE);
+            CACHE_FIELD(s->ref_schemas, CK_LIST, CK_SCOPE);
+            break;
+        }
+        case CK_EXPRESS: {
+            struct Express_ *x = (struct Express_ *)obj;
+            CACHE_FIELD(x->file, CK_ZERO, 0);
+            CACHE_FIELD(x->filename, CK_STRING, 0);
+            CACHE_FIELD(x->basename, CK_STRING, 0);
+            break;
+        }
+        case CK_RENAME: {
+            Rename *r = (Rename *)obj;
+            CACHE_FIELD(r->schema_sym, CK_SYMBOL_REF, 0);
+            CACHE_FIELD(r->schema, CK_SCOPE, 0);
+            CACHE_FIELD(r->old, CK_SYMBOL_REF, 0);
+            CACHE_FIELD(r->nnew, CK_SYMBOL_REF, 0);
+            CACHE_FIELD(r->object, CACHEdata_kind(r->type), 0);
+            break;
+        }
+        case CK_CASE_ITEM: {
+            Case_Item ci = (Case_Item)obj;
+            CACHEvisit_symbol(c, obj, &ci->symbol);
+            CACHE_FIELD(ci->labels, CK_LIST, CK_EXPRESSION);
+            CACHE_FIELD(ci->action, CK_STATEMENT, 0);
+            break;
+        }
+        case CK_EXPRESSION:
+            CACHEvisit_expression(c, (Expression)obj);
+            break;
+        case CK_QUERY: {
+            Query q = (Query)obj;
+            CACHE_FIELD(q->local, CK_VARIABLE, 0);
+            CACHE_FIELD(q->aggregate, CK_EXPRESSION, 0);
+            CACHE_FIELD(q->expression, CK_EXPRESSION, 0);
+            CACHE_FIELD(q->scope, CK_SCOPE, 0);
+            break;
+        }
+        case CK_STATEMENT:
+            CACHEvisit_statement(c, (Statement)obj);
+            break;
+        case CK_ALIAS: {
+            struct Alias_ *a = (struct Alias_ *)obj;
+            CACHE_FIELD(a->scope, CK_SCOPE, 0);
+            CACHE_FIELD(a->variable, CK_VARIABLE, 0);
+            CACHE_FIELD(a->statements, CK_LIST, CK_STATEMENT);
+            break;
+        }
+        case CK_ASSIGNMENT: {
+            struct Assignment_ *a = (struct Assignment_ *)obj;
+            CACHE_FIELD(a->lhs, CK_EXPRESSION, 0);
+            CACHE_FIELD(a->rhs, CK_EXPRESSION, 0);
+            break;
+        }
+        case CK_CASE: {
+            struct Case_Statement_ *cs = (struct Case_Statement_ *)obj;
+            CACHE_FIELD(cs->selector, CK_EXPRESSION, 0);
+            CACHE_FIELD(cs->cases, CK_LIST, CK_CASE_ITEM);
+            break;
+        }
+        case CK_COMPOUND: {
+            struct Compound_Statement_ *cs = (struct Compound_Statement_ *)obj;
+            CACHE_FIELD(cs->statements, CK_LIST, CK_STATEMENT);
+            break;
+        }
+        case CK_CONDITIONAL: {
+            struct Conditional_ *cond = (struct Conditional_ *)obj;
+            CACHE_FIELD(cond->test, CK_EXPRESSION, 0);
+            CACHE_FIELD(cond->code, CK_LIST, CK_STATEMENT);
+            CACHE_FIELD(cond->otherwise, CK_LIST, CK_STATEMENT);
+            break;
+        }
+        case CK_LOOP: {
+            struct Loop_ *l = (struct Loop_ *)obj;
+            CACHE_FIELD(l->scope, CK_SCOPE, 0);
+            CACHE_FIELD(l->while_expr, CK_EXPRESSION, 0);
+            CACHE_FIELD(l->until_expr, CK_EXPRESSION, 0);
+            CACHE_FIELD(l->statements, CK_LIST, CK_STATEMENT);
+            break;
+        }
+        case CK_INCREMENT: {
+            struct Increment_ *incr = (struct Increment_ *)obj;
+            CACHE_FIELD(incr->init, CK_EXPRESSION, 0);
+            CACHE_FIELD(incr->end, CK_EXPRESSION, 0);
+            CACHE_FIELD(incr->increment, CK_EXPRESSION, 0);
+            break;
+        }
+        case CK_PCALL: {
+            struct Procedure_Call_ *pc = (struct Procedure_Call_ *)obj;
+            CACHE_FIELD(pc->procedure, CK_SCOPE, 0);
+            CACHE_FIELD(pc->parameters, CK_LIST, CK_EXPRESSION);
+            break;
+        }
+        case CK_RETURN: {
+            struct Return_Statement_ *ret = (struct Return_Statement_ *)obj;
+            CACHE_FIELD(ret->value, CK_EXPRESSION, 0);
+            break;
+        }
+        case CK_LIST:
+            CACHEvisit_list(c, (Linked_List)obj, o->aux);
+            break;
+        case CK_LINK: {
+            Link link = (Link)obj;
+            CACHE_FIELD(link->next, CK_LINK, o->aux);
+            CACHE_FIELD(link->prev, CK_LINK, o->aux);
+            CACHE_FIELD(link->data, o->aux, 0);
+            break;
+        }
+        case CK_HASH_TABLE: {
+            Hash_Table t = (Hash_Table)obj;
+            for(i = 0; i < DIRECTORY_SIZE; i++) {
+                CACHE_FIELD(t->Directory[i], CK_SEGMENT, 0);
+            }
+            break;
+        }
+        case CK_SEGMENT: {
+            Segment s = (Segment)obj;
+            for(i = 0; i < SEGMENT_SIZE; i++) {
+                CACHE_FIELD(s[i], CK_ELEMENT, 0);
+            }
+            break;
+        }
+        case CK_ELEMENT: {
+            Element e = (Element)obj;
+            CACHE_FIELD(e->key, CK_STRING, 0);
+            CACHE_FIELD(e->data, CACHEdata_kind(e->type), 0);
+            CACHE_FIELD(e->next, CK_ELEMENT, 0);
+            CACHE_FIELD(e->symbol, CK_SYMBOL_REF, 0);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+/** traverse everything reachable from the objects added so far */
+static void CACHEclose(Cache *c)
+{
+    size_t i;
+    bool added = true;
+    while(added) {
+        while(c->visited < c->count) {
+            CACHEvisit(c, &c->objects[c->visited++]);
+        }
+        /* the function of a call without arguments has been found by now, if it is one */
+        for(i = 0; i < c->calls.length; i += sizeof(Expression)) {
+            Expression e = *(Expression *)(c->calls.data + i);
+            if(!CACHEfind(c, e->u.funcall.function)) {
+                CACHEadd(c, e->u.list, CK_LIST, CK_SCOPE);
+            }
+        }
+        c->calls.length = 0;
+        while(c->visited < c->count) {
+            CACHEvisit(c, &c->objects[c->visited++]);
+        }
+        for(i = 0; i < c->symbols.length; i += sizeof(Symbol *)) {
+            CACHEadd(c, *(Symbol **)(c->symbols.data + i), CK_SYMBOL, 0);
+        }
+        added = (c->symbols.length > 0);
+        c->symbols.length = 0;
+    }
+}
+
+/** number the objects created by EXPRESSinitialize() */
+static void CACHEinitialize(void)
+{
+    Type *types[] = {
+        &Type_Bad, &Type_Unknown, &Type_Dont_Care, &Type_Runtime, &Type_Binary, &Type_Boolean,
+        &Type_Enumeration, &Type_Expression, &Type_Aggregate, &Type_Repeat, &Type_Integer,
+        &Type_Number, &Type_Real, &Type_String, &Type_String_Encoded, &Type_Logical, &Type_Set,
+        &Type_Attribute, &Type_Entity, &Type_Funcall, &Type_Generic, &Type_Identifier, &Type_Oneof,
+        &Type_Query, &Type_Self, &Type_Set_Of_String, &Type_Set_Of_Generic, &Type_Bag_Of_Generic, 0
+    };
+    Expression *literals[] = { &LITERAL_E, &LITERAL_INFINITY, &LITERAL_PI, &LITERAL_ZERO, &LITERAL_ONE, 0 };
+    unsigned int i;
+
+    if(cache_initialized) {
+        return;
+    }
+    cache_initialized = true;
+    memset(&cache, 0, sizeof(cache));
+    for(i = 0; types[i]; i++) {
+        CACHEadd(&cache, *types[i], CK_SCOPE, 0);
+    }
+    for(i = 0; literals[i]; i++) {
+        CACHEadd(&cache, *literals[i], CK_EXPRESSION, 0);
+    }
+    CACHEadd(&cache, STATEMENT_ESCAPE, CK_STATEMENT, 0);
+    CACHEadd(&cache, STATEMENT_SKIP, CK_STATEMENT, 0);
+    CACHEadd(&cache, EXPRESSbuiltins, CK_HASH_TABLE, 0);
+    CACHEclose(&cache);
+
+    cache.externals = cache.count;
+    cache.signature = 2166136261U;
+    for(i = 0; i < cache.count; i++) {
+        cache.signature = (cache.signature ^ cache.objects[i].kind) * 16777619U;
+    }
+}
+
+/** a hash of the layout of the objects, of which the format of the cache depends */
+static unsigned int CACHElayout(void)
+{
+    unsigned int h = (unsigned int)sizeof(void *);
+    int kind;
+    for(kind = 0; kind < CK_OBJECT_KINDS; kind++) {
+        h = (h ^ (unsigned int)CACHEsize(kind)) * 16777619U;
+    }
+    return h;
+}
+
+static char *CACHEpath(const char *dir, const char *filename)
+{
+    const char *base = filename, *p;
+    char *path;
+    for(p = filename; *p; p++) {
+        if(*p == '/' || *p == '\\') {
+            base = p + 1;
+        }
+    }
+    path = (char *)sc_malloc(strlen(dir) + strlen(base) + strlen(CACHE_SUFFIX) + 2);
+    sprintf(path, "%s/%s%s", dir, base, CACHE_SUFFIX);
+    return path;
+}
+
+bool CACHEstore(const char *dir, const char *filename, Express model)
+{
+    Cache *c = &cache;
+    Cache_Buffer out = { 0, 0, 0 }, sources = { 0, 0, 0 }, names = { 0, 0, 0 }, record = { 0, 0, 0 };
+    unsigned int i, sourceCount = 0;
+    unsigned long long size, hash;
+    char *path, *tmp;
+    FILE *fp;
+    bool ok = false;
+
+    if(!cache_initialized || c->count != c->externals) {
+        return false;
+    }
+    CACHEadd(c, model, CK_SCOPE, 0);
+    /* visit the externals again, for objects that parsing attached to them */
+    c->visited = 0;
+    CACHEclose(c);
+
+    /* the source files are the file names of the symbols of the model */
+    for(i = c->externals; i < c->count; i++) {
+        Cache_Object *o = &c->objects[i];
+        const char *name;
+        size_t n;
+        bool seen = false;
+        if(o->kind != CK_SYMBOL && o->kind != CK_SCOPE && o->kind != CK_EXPRESSION
+                && o->kind != CK_STATEMENT && o->kind != CK_CASE_ITEM) {
+            continue;
+        }
+        name = ((Symbol *)o->ptr)->filename;
+        if(!name) {
+            continue;
+        }
+        for(n = 0; n < names.length && !seen; n += sizeof(char *)) {
+            seen = !strcmp(*(const char **)(names.data + n), name);
+        }
+        if(seen) {
+            continue;
+        }
+        if(!CACHEhash_file(name, &size, &hash)) {
+            goto done;
+        }
+        CACHEput(&names, &name, sizeof(name));
+        CACHEput_string(&sources, name);
+        CACHEput(&sources, &size, sizeof(size));
+        CACHEput(&sources, &hash, sizeof(hash));
+        sourceCount++;
+    }
+
+    CACHEput(&out, CACHE_MAGIC, 4);
+    CACHEput_uint(&out, CACHE_VERSION);
+    CACHEput_uint(&out, CACHElayout());
+    CACHEput_uint(&out, c->externals);
+    CACHEput_uint(&out, c->signature);
+    CACHEput_string(&out, filename);
+    CACHEput_uint(&out, sourceCount);
+    CACHEput(&out, sources.data, sources.length);
+    CACHEput(&out, &__SCOPE_search_id, sizeof(int));
+    CACHEput(&out, &ENTITY_MARK, sizeof(int));
+    CACHEput(&out, &EXPRESSpass, sizeof(int));
+
+    /* the objects of the model, preceded by the externals; parsing may have changed those too, e.g.
+     * the type of LITERAL_ZERO when it is the count of a repeated aggregate element */
+    CACHEput_uint(&out, c->count);
+    c->emit = true;
+    c->fixups.length = 0;
+    for(i = 0; i < c->count; i++) {
+        Cache_Object *o = &c->objects[i];
+        size_t length = CACHEsize(o->kind);
+        if(o->kind == CK_STRING) {
+            length = strlen((char *)o->ptr) + 1;
+        }
+        CACHEput(&out, &o->kind, 1);
+        CACHEput_uint(&out, (unsigned int)length);
+        if(o->kind == CK_STRING) {
+            CACHEput(&out, o->ptr, length);
+            continue;
+        }
+        /* copy the object, clear its pointers, then write what is left */
+        record.length = 0;
+        CACHEput(&record, o->ptr, length);
+        c->record = record.data;
+        c->current = i + 1;
+        CACHEvisit(c, o);
+        CACHEput_words(&out, record.data, length);
+    }
+    c->emit = false;
+    if(c->failed) {
+        goto done;
+    }
+    CACHEput_uint(&out, (unsigned int)(c->fixups.length / (3 * sizeof(unsigned int))));
+    CACHEput(&out, c->fixups.data, c->fixups.length);
+
+    mkDirIfNone(dir);
+    path = CACHEpath(dir, filename);
+    /* write to a temporary file, so that a concurrent CACHEload() never sees a partial file */
+    tmp = (char *)sc_malloc(strlen(path) + 5);
+    sprintf(tmp, "%s.tmp", path);
+    fp = fopen(tmp, "wb");
+    if(fp) {
+        ok = (fwrite(out.data, 1, out.length, fp) == out.length);
+        ok = (fclose(fp) == 0) && ok;
+        if(ok) {
+            remove(path);
+            ok = (rename(tmp, path) == 0);
+        } else {
+            remove(tmp);
+        }
+    }
+    sc_free(tmp);
+    sc_free(path);
+
+done:
+    sc_free(out.data);
+    sc_free(record.data);
+    sc_free(sources.data);
+    sc_free(names.data);
+    return ok;
+}
+
+/** reads from a cache file; `failed` is set if the end is reached */
+typedef struct Cache_Reader_ {
+    const char *data;
+    size_t length, pos;
+    bool failed;
+} Cache_Reader;
+
+static const char *CACHEget(Cache_Reader *r, size_t length)
+{
+    const char *p = r->data + r->pos;
+    if(r->failed || length > r->length - r->pos) {
+        r->failed = true;
+        return 0;
+    }
+    r->pos += length;
+    return p;
+}
+
+static unsigned int CACHEget_uint(Cache_Reader *r)
+{
+    unsigned int u = 0;
+    const char *p = CACHEget(r, sizeof(u));
+    if(p) {
+        memcpy(&u, p, sizeof(u));
+    }
+    return u;
+}
+
+static unsigned long long CACHEget_ulonglong(Cache_Reader *r)
+{
+    unsigned long long u = 0;
+    const char *p = CACHEget(r, sizeof(u));
+    if(p) {
+        memcpy(&u, p, sizeof(u));
+    }
+    return u;
+}
+
+/** read an object written by CACHEput_words() into `record`, which is `length` bytes */
+static bool CACHEget_words(Cache_Reader *r, char *record, size_t length)
+{
+    unsigned int words = (unsigned int)(length / sizeof(unsigned int)), i;
+    const char *bitmap = CACHEget(r, (words + 7) / 8);
+    const char *p;
+
+    if(!bitmap) {
+        return false;
+    }
+    memset(record, 0, length);
+    for(i = 0; i < words; i++) {
+        if(bitmap[i / 8] & (1 << (i % 8))) {
+            if(!(p = CACHEget(r, sizeof(unsigned int)))) {
+                return false;
+            }
+            memcpy(record + i * sizeof(unsigned int), p, sizeof(unsigned int));
+        }
+    }
+    return true;
+}
+
+/** \return true if the string at the read position equals `s` */
+static bool CACHEget_string(Cache_Reader *r, const char *s, char *copy, size_t size)
+{
+    unsigned int length = CACHEget_uint(r);
+    const char *p = CACHEget(r, length);
+    if(!p) {
+        return false;
+    }
+    if(copy) {
+        if(length >= size) {
+            return false;
+        }
+        memcpy(copy, p, length);
+        copy[length] = '\0';
+        return true;
+    }
+    return (strlen(s) == length && !memcmp(p, s, length));
+}
+
+Express CACHEload(const char *dir, const char *filename)
+{
+    Cache_Reader r = { 0, 0, 0, false };
+    char *path, *data = 0, name[4096];
+    const char *magic;
+    void **objects = 0;
+    unsigned int *sizes = 0;
+    unsigned int i, n, count, obj, offset, target;
+    unsigned long long size, hash, fileSize, fileHash;
+    int globals[3];
+    Express model = 0;
+    long length;
+    FILE *fp;
+
+    CACHEinitialize();
+
+    path = CACHEpath(dir, filename);
+    fp = fopen(path, "rb");
+    sc_free(path);
+    if(!fp) {
+        return 0;
+    }
+    if(fseek(fp, 0, SEEK_END) == 0 && (length = ftell(fp)) > 0 && fseek(fp, 0, SEEK_SET) == 0) {
+        data = (char *)sc_malloc(length);
+        if(fread(data, 1, length, fp) == (size_t)length) {
+            r.data = data;
+            r.length = length;
+        }
+    }
+    fclose(fp);
+    if(!r.data) {
+        goto done;
+    }
+
+    /* check that the cache was written by this build, from the same sources */
+    magic = CACHEget(&r, 4);
+    if(!magic || memcmp(magic, CACHE_MAGIC, 4) || CACHEget_uint(&r) != CACHE_VERSION
+            || CACHEget_uint(&r) != CACHElayout() || CACHEget_uint(&r) != cache.externals
+            || CACHEget_uint(&r) != cache.signature || !CACHEget_string(&r, filename, 0, 0)) {
+        goto done;
+    }
+    n = CACHEget_uint(&r);
+    for(i = 0; i < n; i++) {
+        if(!CACHEget_string(&r, 0, name, sizeof(name))) {
+            goto done;
+        }
+        size = CACHEget_ulonglong(&r);
+        hash = CACHEget_ulonglong(&r);
+        if(r.failed || !CACHEhash_file(name, &fileSize, &fileHash) || size != fileSize || hash != fileHash) {
+            goto done;
+        }
+    }
+    for(i = 0; i < 3; i++) {
+        globals[i] = (int)CACHEget_uint(&r);
+    }
+
+    count = CACHEget_uint(&r);
+    if(r.failed || count <= cache.externals || count > r.length) {
+        goto done;
+    }
+    objects = (void **)sc_calloc(count, sizeof(void *));
+    sizes = (unsigned int *)sc_calloc(count, sizeof(unsigned int));
+    for(i = 0; i < count; i++) {
+        const char *kind = CACHEget(&r, 1);
+        unsigned int objSize = CACHEget_uint(&r);
+        if(!kind || *kind <= CK_NONE || *kind >= CK_OBJECT_KINDS
+                || (*kind != CK_STRING && objSize != CACHEsize(*kind))) {
+            goto done;
+        }
+        if(i < cache.externals && *kind != cache.objects[i].kind) {
+            goto done;
+        }
+        if(*kind == CK_STRING) {
+            const char *p = CACHEget(&r, objSize);
+            if(!p || !objSize || p[objSize - 1]) {
+                goto done;
+            }
+            if(i < cache.externals) {
+                /* the strings of the externals don't change */
+                objects[i] = cache.objects[i].ptr;
+            } else {
+                objects[i] = CACHEnew(CK_STRING, objSize);
+                memcpy(objects[i], p, objSize);
+            }
+            continue;
+        }
+        /* an external is read into a copy, and overwritten once the whole file has been read */
+        objects[i] = (i < cache.externals) ? sc_malloc(objSize) : CACHEnew(*kind, objSize);
+        sizes[i] = objSize;
+        if(!CACHEget_words(&r, (char *)objects[i], objSize)) {
+            goto done;
+        }
+    }
+    n = CACHEget_uint(&r);
+    for(i = 0; i < n && !r.failed; i++) {
+        obj = CACHEget_uint(&r);
+        offset = CACHEget_uint(&r);
+        target = CACHEget_uint(&r);
+        if(obj == 0 || obj > count || target == 0 || target > count || offset + sizeof(void *) > sizes[obj - 1]) {
+            goto done;
+        }
+        /* a pointer to an external points to the object itself, not to its copy */
+        *(void **)((char *)objects[obj - 1] + offset) =
+            (target <= cache.externals) ? cache.objects[target - 1].ptr : objects[target - 1];
+    }
+    if(r.failed) {
+        goto done;
+    }
+
+    for(i = 0; i < cache.externals; i++) {
+        if(sizes[i]) {
+            memcpy(cache.objects[i].ptr, objects[i], sizes[i]);
+        }
+    }
+
+    __SCOPE_search_id = globals[0];
+    ENTITY_MARK = globals[1];
+    EXPRESSpass = globals[2];
+    model = (Express)objects[cache.externals];
+
+done:
+    if(objects) {
+        for(i = 0; i < cache.externals && i < count; i++) {
+            if(sizes[i]) {
+                sc_free(objects[i]);
+            }
+        }
+        sc_free(objects);
+        sc_free(sizes);
+    }
+    if(data) {
+        sc_free(data);
+    }
+    return model;
+}
@@ -82,12 +82,13 @@
 #include "express/express.h"
 #include "express/resolve.h"
 #include "express/info.h"
+#include "express/cache.h"
 
 #ifdef YYDEBUG
 extern int exp_yydebug;
 #endif /*YYDEBUG*/
 
-char EXPRESSgetopt_options[256] = "Bbd:e:i:w:p:rvz"; /* larger than the string because exp2cxx, exppp, etc may append their own options */
+char EXPRESSgetopt_options[256] = "BbC:d:e:i:w:p:rvz"; /* larger than the string because exp2cxx, exppp, etc may append their own options */
 static int no_need_to_work = 0; /* TRUE if we can exit gracefully without doing any work */
 
 void print_fedex_version(void)
@@ -106,7 +107,8 @@ int main(int argc, char **argv)
     int result;
 
     bool buffer_messages = false;
-    Express model;
+    char *cache_dir = 0;
+    Express model = 0;
 
     EXPRESSprogram_name = argv[0];
     ERRORusage_function = 0;
@@ -165,6 +167,9 @@ int main(int argc, char **argv)
             case 'b':
                 buffer_messages = false;
                 break;
+            case 'C':
+                cache_dir = sc_optarg;
+                break;
             case 'e':
                 input_filename = sc_optarg;
                 break;
@@ -227,30 +232,39 @@ int main(int argc, char **argv)
         (*EXPRESSinit_parse)();
     }
 
-    model = EXPRESScreate();
-    EXPRESSparse(model, (FILE *)0, input_filename);
-    if(ERRORoccurred) {
-        result = EXPRESS_fail(model);
-        EXPRESScleanup();
-        EXPRESSdestroy(model);
-        return result;
-    }
-
-#ifdef debugging
-    if(malloc_debug_resolve) {
-        malloc_verify();
-        malloc_debug(2);
+    /* a cached model is always resolved */
+    if(cache_dir && resolve) {
+        model = CACHEload(cache_dir, input_filename);
     }
-#endif /*debugging*/
-
-    if(resolve) {
-        EXPRESSresolve(model);
+    if(!model) {
+        model = EXPRESScreate();
+        EXPRESSparse(model, (FILE *)0, input_filename);
         if(ERRORoccurred) {
             result = EXPRESS_fail(model);
             EXPRESScleanup();
             EXPRESSdestroy(model);
             return result;
         }
+
+#ifdef debugging
+        if(malloc_debug_resolve) {
+            malloc_verify();
+            malloc_debug(2);
+        }
+#endif /*debugging*/
+
+        if(resolve) {
+            EXPRESSresolve(model);
+            if(ERRORoccurred) {
+                result = EXPRESS_fail(model);
+                EXPRESScleanup();
+                EXPRESSdestroy(model);
+                return result;
+            }
+            if(cache_dir && !CACHEstore(cache_dir, input_filename, model)) {
+                fprintf(stderr, "%s: could not write the cache for %s to %s\n", EXPRESSprogram_name, input_filename, cache_dir);
+            }
+        }
     }
 
     if(EXPRESSbackend) {
@@ -11,13 +11,14 @@ char *EXPRESSversion(void)
 
 void EXPRESSusage(int _exit)
 {
-    fprintf(stderr, "usage: %s [-v] [-d #] [-p <object_type>] {-w|-i <warning>} express_file\n", EXPRESSprogram_name);
+    fprintf(stderr, "usage: %s [-v] [-d #] [-p <object_type>] {-w|-i <warning>} [-C <cache_dir>] express_file\n", EXPRESSprogram_name);
     fprintf(stderr, "where\t-v produces the following version description:\n");
     fprintf(stderr, "Build info for %s: %s\nhttp://github.com/stepcode/stepcode\n", EXPRESSprogram_name, SC_VERSION);
     fprintf(stderr, "\t-d turns on debugging (\"-d 0\" describes this further\n");
     fprintf(stderr, "\t-p turns on printing when processing certain objects (see below)\n");
     fprintf(stderr, "\t-w warning enable\n");
     fprintf(stderr, "\t-i warning ignore\n");
+    fprintf(stderr, "\t-C loads the resolved schema from a cache in <cache_dir> if it is up to date, writes it there otherwise\n");
     fprintf(stderr, "and <warning> is one of:\n");
     fprintf(stderr, "\tnone\n\tall\n");
     fprintf(stderr, "%s", ERRORget_warnings_help("\t", "\n"));
@@ -0,0 +1,156 @@
+/** \file attr_layout.cc
+ * Checks the attributes the default constructors of exp2cxx -t make from
+ * their layout table with SDAI_Application_instance::InitAttributes().
+ * Every entity made from a table must have one block of the explicit
+ * attributes of its supertypes and itself, in order. For entities with
+ * redefined, derived and aggregate attributes, the attributes must also be
+ * those that their constructor for complex instances pushes one at a time,
+ * with the same members, derivations and redefinitions.
+ */
+#include <sdai.h>
+#include <ExpDict.h>
+#include <Registry.h>
+#include <iostream>
+#include <vector>
+
+#include "SdaiAUTOMOTIVE_DESIGN.h"
+
+/// the explicit attributes of entity and its supertypes, as the constructors push them
+void explicitAttrs(const EntityDescriptor *entity, std::vector<const AttrDescriptor *> &attrs)
+{
+    const EntityDescLinkNode *super = (const EntityDescLinkNode *) entity->GetSupertypes().GetHead();
+    if(super) {
+        explicitAttrs(super->EntityDesc(), attrs);
+    }
+    AttrDescItr it(entity->ExplicitAttr());
+    const AttrDescriptor *ad;
+    while((ad = it.NextAttrDesc())) {
+        // the list has the derived attributes too, which have no data member
+        if(ad->AttrType() != AttrType_Deriving) {
+            attrs.push_back(ad);
+        }
+    }
+}
+
+/// true if entity and its supertypes have at most one supertype each, as those exp2cxx -t makes a table for
+bool singleInheritance(const EntityDescriptor *entity)
+{
+    const EntityDescLinkNode *super = (const EntityDescLinkNode *) entity->GetSupertypes().GetHead();
+    if(!super) {
+        return true;
+    }
+    return !super->NextNode() && singleInheritance(super->EntityDesc());
+}
+
+/// checks the attributes of instance against the entity dictionary; false if they differ
+bool checkDescriptors(SDAI_Application_instance *instance)
+{
+    const STEPattributeList &attributes = instance->attributes;
+    std::vector<const AttrDescriptor *> expected;
+    explicitAttrs(instance->eDesc, expected);
+
+    // without attributes there is no table and no block
+    bool pass = (attributes.list_length() == (int) expected.size())
+                && (expected.empty() || (attributes.onlyBlock() && attributes.blockCount() == attributes.list_length()));
+    for(int i = 0; pass && i < attributes.list_length(); i++) {
+        pass = (attributes[i].aDesc == expected[i]);
+    }
+    if(!pass) {
+        cerr << "Error: the attributes of " << instance->EntityName() << " are not the "
+             << expected.size() << " explicit attributes of the entity." << endl;
+    }
+    return pass;
+}
+
+/// offset of the member an attribute points to, in the instance
+long memberOffset(const SDAI_Application_instance &instance, const STEPattribute &attr)
+{
+    return (const char *) attr.ptr.p - (const char *) &instance;
+}
+
+/// number of attr in attributes, -1 if it is null and -2 if it is not there
+int attrNumber(STEPattributeList &attributes, const STEPattribute *attr)
+{
+    if(!attr) {
+        return -1;
+    }
+    for(int i = 0; i < attributes.list_length(); i++) {
+        if(&attributes[i] == attr) {
+            return i;
+        }
+    }
+    return -2;
+}
+
+/**
+ * compares the attributes that the default constructor of T makes from its
+ * table with those its constructor for complex instances pushes, as all the
+ * constructors did before exp2cxx -t; false if they differ
+ */
+template<class T>
+bool samePushed()
+{
+    T made;
+    SDAI_Application_instance head;
+    T pushed(&head, false);
+    STEPattributeList &a = made.attributes;
+    STEPattributeList &b = pushed.attributes;
+    bool pass = checkDescriptors(&made) && a.list_length() == b.list_length();
+
+    for(int i = 0; pass && i < a.list_length(); i++) {
+        pass = a[i].aDesc == b[i].aDesc && a[i].IsDerived() == b[i].IsDerived() && a[i].is_null() && b[i].is_null();
+        if(a[i].Aggregate() || b[i].Aggregate()) {
+            // each instance allocates its own
+            pass = pass && a[i].Aggregate() && b[i].Aggregate() && a[i].Aggregate() != b[i].Aggregate();
+        } else {
+            pass = pass && memberOffset(made, a[i]) == memberOffset(pushed, b[i]);
+        }
+        pass = pass && attrNumber(a, a[i].RedefiningAttr()) == attrNumber(b, b[i].RedefiningAttr());
+        if(!pass) {
+            cerr << "Error: attribute " << i << " of " << made.EntityName() << " differs from the pushed one." << endl;
+        }
+    }
+    return pass;
+}
+
+int main()
+{
+    Registry registry(SchemaInit);
+
+    bool pass = true;
+    int entities = 0, tables = 0;
+    const EntityDescriptor *entity;
+    registry.ResetEntities();
+    while((entity = registry.NextEntity())) {
+        SDAI_Application_instance *instance = registry.ObjCreate(entity->Name());
+        if(instance == ENTITY_NULL) {
+            continue;
+        }
+        ++entities;
+        // an entity with several supertypes is made by their constructors
+        if(singleInheritance(entity)) {
+            tables += (instance->attributes.blockCount() > 0);
+            pass &= checkDescriptors(instance);
+        }
+        delete instance;
+    }
+    cout << tables << " of " << entities << " entities made from a layout table." << endl;
+    if(!tables) {
+        cerr << "Error: no layout table, is the schema generated with exp2cxx -t?" << endl;
+        pass = false;
+    }
+
+    // an aggregate and inherited members; a derivation of an attribute it does not have
+    pass &= samePushed<SdaiCartesian_point>();
+    // an explicit attribute of the supertype derived
+    pass &= samePushed<SdaiConversion_based_unit>();
+    // attributes of the supertype redefined and derived
+    pass &= samePushed<SdaiAnnotation_curve_occurrence>();
+    pass &= samePushed<SdaiCamera_image_2d_with_scale>();
+
+    if(!pass) {
+        exit(EXIT_FAILURE);
+    }
+    cout << "success." << endl;
+    exit(EXIT_SUCCESS);
+}
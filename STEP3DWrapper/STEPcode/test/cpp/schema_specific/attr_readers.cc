@@ -0,0 +1,130 @@
+/** \file attr_readers.cc
+ * Compares the attribute readers of exp2cxx -u with the loop of
+ * SDAI_Application_instance::STEPread(). A file is read with and without the
+ * readers, and every instance must be written and report its errors alike.
+ * Then one instance of each entity type is read again from damaged copies
+ * of its text (a missing, an extra and a null attribute, a bad delimiter),
+ * which must give the same values and messages both ways.
+ */
+#include <STEPfile.h>
+#include <sdai.h>
+#include <ExpDict.h>
+#include <Registry.h>
+#include <errordesc.h>
+#include <iostream>
+#include <sstream>
+#include <map>
+#include <set>
+#include <string>
+
+#include "SdaiAUTOMOTIVE_DESIGN.h"
+
+/// what the read of an instance gives: its text as written and its errors
+std::string readResult(SDAI_Application_instance *instance)
+{
+    std::string text;
+    instance->STEPwrite(text);
+    std::ostringstream result;
+    result << text << "severity " << instance->Error().severity() << "\n" << instance->Error().DetailMsg();
+    return result.str();
+}
+
+/// read the instances of a file and keep readResult() of each, by file id
+void readFile(Registry &registry, const char *name, bool readers, std::map<int, std::string> &results)
+{
+    SDAI_Application_instance::UseAttrReaders(readers);
+    InstMgr instance_list(1);
+    STEPfile sfile(registry, instance_list, "", false);
+    sfile.ReadExchangeFile(name);
+    int count = instance_list.InstanceCount();
+    for(int i = 0; i < count; i++) {
+        SDAI_Application_instance *instance = instance_list.GetApplication_instance(i);
+        results[instance->StepFileId()] = readResult(instance);
+    }
+    instance_list.DeleteInstances();
+}
+
+/// read the attributes in text into a new instance of type, and return readResult()
+std::string readText(Registry &registry, const char *type, const std::string &text, InstMgr *instances, bool readers)
+{
+    SDAI_Application_instance::UseAttrReaders(readers);
+    SDAI_Application_instance *instance = registry.ObjCreate(type);
+    std::istringstream in(text);
+    instance->STEPread(1, 0, instances, in, NULL, true, true);
+    std::string result = readResult(instance);
+    delete instance;
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    if(argc != 2) {
+        cerr << "Wrong number of args. Use: " << argv[0] << " file.stp" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    Registry registry(SchemaInit);
+
+    std::map<int, std::string> withReaders, withLoop;
+    readFile(registry, argv[1], true, withReaders);
+    readFile(registry, argv[1], false, withLoop);
+    if(withReaders.empty() || withReaders.size() != withLoop.size()) {
+        cerr << "Error: " << withReaders.size() << " instances read with the readers, " << withLoop.size() << " without." << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    int mismatches = 0, records = 0;
+    std::map<int, std::string>::const_iterator it;
+    for(it = withReaders.begin(); it != withReaders.end(); ++it) {
+        if(it->second != withLoop[it->first]) {
+            cerr << "Mismatch for #" << it->first << ":\n" << it->second << "\nread by the loop:\n" << withLoop[it->first] << endl;
+            ++mismatches;
+        }
+    }
+
+    // the instances stay in this list, for the references of the damaged copies
+    SDAI_Application_instance::UseAttrReaders(true);
+    InstMgr instance_list(1);
+    STEPfile sfile(registry, instance_list, "", false);
+    sfile.ReadExchangeFile(argv[1]);
+    std::set<std::string> types;
+    int count = instance_list.InstanceCount();
+    for(int i = 0; i < count; i++) {
+        SDAI_Application_instance *instance = instance_list.GetApplication_instance(i);
+        if(instance->IsComplex() || !types.insert(instance->EntityName()).second) {
+            continue;
+        }
+        std::string text;
+        instance->STEPwrite(text);
+        size_t open = text.find('('), close = text.rfind(')');
+        if(open == std::string::npos || close == std::string::npos) {
+            continue;
+        }
+        std::string attrs = text.substr(open, close + 1 - open);
+        size_t last = attrs.rfind(',');
+
+        std::string damaged[5];
+        damaged[0] = attrs + ";";
+        damaged[1] = attrs.substr(0, attrs.size() - 1) + ",$);";
+        damaged[2] = (last == std::string::npos) ? "();" : attrs.substr(0, last) + ");";
+        damaged[3] = (last == std::string::npos) ? "($);" : attrs.substr(0, last) + ",$);";
+        damaged[4] = (last == std::string::npos) ? "(#);" : attrs.substr(0, last) + " ? " + attrs.substr(last + 1) + ";";
+        for(int d = 0; d < 5; d++, records++) {
+            std::string byReader = readText(registry, instance->EntityName(), damaged[d], &instance_list, true);
+            std::string byLoop = readText(registry, instance->EntityName(), damaged[d], &instance_list, false);
+            if(byReader != byLoop) {
+                cerr << "Mismatch for " << instance->EntityName() << damaged[d] << ":\n" << byReader << "\nread by the loop:\n" << byLoop << endl;
+                ++mismatches;
+            }
+        }
+    }
+    SDAI_Application_instance::UseAttrReaders(true);
+    cout << withReaders.size() << " instances, " << types.size() << " entity types, " << records << " damaged records checked" << endl;
+
+    if(mismatches) {
+        cerr << mismatches << " mismatches." << endl;
+        exit(EXIT_FAILURE);
+    }
+    cout << "success." << endl;
+    exit(EXIT_SUCCESS);
+}
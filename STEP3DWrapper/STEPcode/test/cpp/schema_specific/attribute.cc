@@ -37,7 +37,7 @@ int main(int argc, char *argv[])
     const SdaiWindow *wind = dynamic_cast< SdaiWindow * >(instance_list.GetApplication_instance("window"));
     int i = 0;
     if(wind) {
-        STEPattributeList attrlist = wind->attributes;
+        const STEPattributeList &attrlist = wind->attributes;
         for(; i < attrlist.list_length(); i++) {
             cout << "attr " << i << ": " << attrlist[i].Name() << endl;
             if(0 == strcmp(attrname, attrlist[i].Name())) {
@@ -0,0 +1,138 @@
+/** \file entity_type_ids.cc
+ * Checks the type ids that exp2cxx gives to the entities of a schema. For
+ * every pair of entity descriptors, IsA() (a bit test on the generated
+ * supertype set) must agree with a walk of the supertypes, and DerivesFrom()
+ * (an interval test on the preorder ids) with a walk of the base classes.
+ * Then the instances of a file are dispatched to the generated visitor, which
+ * must reach the handler of representation_item for exactly the instances
+ * that are one.
+ */
+#include <STEPfile.h>
+#include <sdai.h>
+#include <STEPattribute.h>
+#include <ExpDict.h>
+#include <Registry.h>
+#include <errordesc.h>
+#include <iostream>
+#include <vector>
+
+#include "SdaiAUTOMOTIVE_DESIGN.h"
+
+/// reference for IsA(): any supertype, at any depth
+bool walkIsA(const EntityDescriptor *ed, const EntityDescriptor *other)
+{
+    if(ed == other) {
+        return true;
+    }
+    EntityDescItr supers(ed->Supertypes());
+    const EntityDescriptor *super;
+    while(0 != (super = supers.NextEntityDesc())) {
+        if(walkIsA(super, other)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// reference for DerivesFrom(): the generated class derives from the first supertype only
+bool walkDerivesFrom(const EntityDescriptor *ed, const EntityDescriptor *other)
+{
+    while(ed) {
+        if(ed == other) {
+            return true;
+        }
+        EntityDescItr supers(ed->Supertypes());
+        ed = supers.NextEntityDesc();
+    }
+    return false;
+}
+
+/// counts the instances that reach the representation_item handler
+class itemCounter : public SdaiVisitor_automotive_design
+{
+    public:
+        int items;
+
+        itemCounter() : items(0) {}
+
+        using SdaiVisitor_automotive_design::Visit;
+
+        virtual void Visit(SdaiRepresentation_item *instance)
+        {
+            (void) instance;
+            ++items;
+        }
+};
+
+int main(int argc, char *argv[])
+{
+    if(argc != 2) {
+        cerr << "Wrong number of args. Use: " << argv[0] << " file.stp" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    Registry registry(SchemaInit);
+
+    std::vector<const EntityDescriptor *> entities;
+    registry.ResetEntities();
+    const EntityDescriptor *ed;
+    while(0 != (ed = registry.NextEntity())) {
+        if(ed->TypeId() < 0) {
+            cerr << "Error: entity " << ed->Name() << " has no type id." << endl;
+            exit(EXIT_FAILURE);
+        }
+        entities.push_back(ed);
+    }
+
+    int mismatches = 0;
+    for(size_t i = 0; i < entities.size(); i++) {
+        for(size_t j = 0; j < entities.size(); j++) {
+            if((entities[i]->IsA(entities[j]) != 0) != walkIsA(entities[i], entities[j])) {
+                cerr << "IsA mismatch: " << entities[i]->Name() << ", " << entities[j]->Name() << endl;
+                ++mismatches;
+            }
+            if(entities[i]->DerivesFrom(entities[j]) != walkDerivesFrom(entities[i], entities[j])) {
+                cerr << "DerivesFrom mismatch: " << entities[i]->Name() << ", " << entities[j]->Name() << endl;
+                ++mismatches;
+            }
+        }
+    }
+    cout << entities.size() << " entities, " << entities.size() * entities.size() << " pairs checked" << endl;
+
+    InstMgr instance_list(1);
+    STEPfile sfile(registry, instance_list, "", false);
+    sfile.ReadExchangeFile(argv[1]);
+    int count = instance_list.InstanceCount();
+    if(count == 0) {
+        cerr << "Error: no instance read from " << argv[1] << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    itemCounter visitor;
+    int expected = 0;
+    int dispatched = 0;
+    for(int i = 0; i < count; i++) {
+        SDAI_Application_instance *instance = instance_list.GetApplication_instance(i);
+        if(!instance || instance->IsComplex()) {
+            continue;
+        }
+        if(instance->eDesc->IsA(automotive_design::e_representation_item)) {
+            ++expected;
+        }
+        if(visitor.Dispatch(instance)) {
+            ++dispatched;
+        }
+    }
+    cout << dispatched << " instances dispatched, " << visitor.items << " representation items" << endl;
+
+    if(visitor.items != expected) {
+        cerr << "Error: " << expected << " representation items expected." << endl;
+        ++mismatches;
+    }
+    if(mismatches) {
+        cerr << mismatches << " mismatches." << endl;
+        exit(EXIT_FAILURE);
+    }
+    cout << "success." << endl;
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,138 @@
+/** \file enum_select_decoding.cc
+ * Checks the decoding tables that exp2cxx writes for the enumerations and the
+ * selects of a schema. Every item of every enumeration must be found by its
+ * name, in upper or lower case, and written with its literal. Every name that
+ * a select accepts must give the same choice as a walk of its elements. Then
+ * a file is read and written again, which must keep every instance.
+ */
+#include <STEPfile.h>
+#include <sdai.h>
+#include <ExpDict.h>
+#include <Registry.h>
+#include <errordesc.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <string.h>
+#include <ctype.h>
+
+#include "SdaiAUTOMOTIVE_DESIGN.h"
+
+/// reference for SelectTypeDescriptor::CanBeSet(): the first element accepting name
+const TypeDescriptor *walkCanBeSet(const SelectTypeDescriptor *sel, const char *name)
+{
+    TypeDescItr elements(sel->GetElements());
+    const TypeDescriptor *td;
+    while(0 != (td = elements.NextTypeDesc())) {
+        const SelectTypeDescriptor *nested = dynamic_cast<const SelectTypeDescriptor *>(td);
+        if(nested && td->Type() != REFERENCE_TYPE) {
+            if(walkCanBeSet(nested, name)) {
+                return td;
+            }
+        } else if(td->CurrName(name, "")) {
+            return td;
+        }
+    }
+    return 0;
+}
+
+/// the names of the elements of a select and of its nested selects
+void collectNames(const SelectTypeDescriptor *sel, std::vector<std::string> &names)
+{
+    TypeDescItr elements(sel->GetElements());
+    const TypeDescriptor *td;
+    while(0 != (td = elements.NextTypeDesc())) {
+        names.push_back(td->Name());
+        const SelectTypeDescriptor *nested = dynamic_cast<const SelectTypeDescriptor *>(td);
+        if(nested && td->Type() != REFERENCE_TYPE) {
+            collectNames(nested, names);
+        }
+    }
+}
+
+std::string lower(const char *s)
+{
+    std::string l(s);
+    for(size_t i = 0; i < l.size(); i++) {
+        l[i] = (char) tolower(l[i]);
+    }
+    return l;
+}
+
+int main(int argc, char *argv[])
+{
+    if(argc != 2) {
+        cerr << "Wrong number of args. Use: " << argv[0] << " file.stp" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    Registry registry(SchemaInit);
+
+    int mismatches = 0, enums = 0, items = 0, selects = 0, names = 0;
+    registry.ResetTypes();
+    const TypeDescriptor *td;
+    while(0 != (td = registry.NextType())) {
+        const EnumTypeDescriptor *etd = dynamic_cast<const EnumTypeDescriptor *>(td);
+        if(etd && etd->CreateNewEnum) {
+            SDAI_Enum *e = etd->CreateNewEnum();
+            ++enums;
+            for(int n = 0; n < e->no_elements(); n++, items++) {
+                const char *name = e->element_at(n);
+                std::string literal = std::string(".") + name + ".";
+                if(e->element_index(name, strlen(name)) != n ||
+                        e->element_index(lower(name).c_str(), strlen(name)) != n ||
+                        literal != e->element_literal(n)) {
+                    cerr << "Enum mismatch: " << td->Name() << "." << name << endl;
+                    ++mismatches;
+                }
+            }
+            if(e->element_index("NOT AN ITEM", 11) != -1 || e->element_literal(e->no_elements()) != 0) {
+                cerr << "Enum mismatch: " << td->Name() << " accepts an unknown item" << endl;
+                ++mismatches;
+            }
+            delete e;
+        }
+
+        const SelectTypeDescriptor *sel = dynamic_cast<const SelectTypeDescriptor *>(td);
+        if(sel) {
+            std::vector<std::string> choices;
+            collectNames(sel, choices);
+            choices.push_back("NOT_A_CHOICE");
+            ++selects;
+            for(size_t i = 0; i < choices.size(); i++, names++) {
+                const char *name = choices[i].c_str();
+                if(sel->CanBeSet(name, "") != walkCanBeSet(sel, name) ||
+                        sel->CanBeSet(lower(name).c_str(), "") != walkCanBeSet(sel, name)) {
+                    cerr << "Select mismatch: " << td->Name() << ", " << name << endl;
+                    ++mismatches;
+                }
+            }
+        }
+    }
+    cout << enums << " enumerations, " << items << " items, " << selects << " selects, " << names << " names checked" << endl;
+
+    InstMgr instance_list(1);
+    STEPfile sfile(registry, instance_list, "", false);
+    sfile.ReadExchangeFile(argv[1]);
+    int count = instance_list.InstanceCount();
+    if(count == 0 || sfile.Error().severity() <= SEVERITY_INCOMPLETE) {
+        cerr << "Error reading " << argv[1] << endl;
+        exit(EXIT_FAILURE);
+    }
+    sfile.WriteExchangeFile("enum_select_decoding.stp");
+
+    InstMgr reread_list(1);
+    STEPfile reread(registry, reread_list, "", false);
+    reread.ReadExchangeFile("enum_select_decoding.stp");
+    if(reread_list.InstanceCount() != count || reread.Error().severity() <= SEVERITY_INCOMPLETE) {
+        cerr << "Error: " << reread_list.InstanceCount() << " instances read again, " << count << " expected." << endl;
+        ++mismatches;
+    }
+
+    if(mismatches) {
+        cerr << mismatches << " mismatches." << endl;
+        exit(EXIT_FAILURE);
+    }
+    cout << "success." << endl;
+    exit(EXIT_SUCCESS);
+}
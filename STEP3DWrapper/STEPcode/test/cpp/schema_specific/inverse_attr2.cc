@@ -47,7 +47,7 @@ bool findInverseAttrs2(InverseAItr iai, InstMgr &instList, Registry &reg)
                     if(i < l) {
                         break;
                     }
-                    STEPattributeList attrlist = inst->attributes;
+                    const STEPattributeList &attrlist = inst->attributes;
                     if(attrlist.list_length() < k + 1) {
                         return false;
                     }
@@ -0,0 +1,118 @@
+/** \file lazy_compact.cc
+ * Stores the geometric instances of a file in a lazyCompactStore, and compares
+ * each row with the instance loaded through the lazyInstMgr: the number of
+ * attributes, the references, and the coordinates of the points and directions
+ * must be the same.
+ */
+#include <sc_cf.h>
+#include <lazyInstMgr.h>
+#include <lazyCompactStore.h>
+#include <sdai.h>
+#include <STEPattribute.h>
+#include <STEPaggrReal.h>
+#include <ExpDict.h>
+#include <Registry.h>
+#include <errordesc.h>
+#include <math.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "schema.h"
+
+/// compares the first attribute holding a list of reals with the coordinates of a row
+int compareCoordinates(const compactTable &table, size_t row, SDAI_Application_instance *inst)
+{
+    double coords[3];
+    unsigned int n = table.coordinates(row, coords);
+    for(int i = 0; i < inst->attributes.list_length(); i++) {
+        STEPaggregate *aggr = inst->attributes[i].Aggregate();
+        if(!aggr) {
+            continue;
+        }
+        unsigned int j = 0;
+        RealNode *node = (RealNode *) aggr->GetHead();
+        for(; node; node = (RealNode *) node->NextNode(), j++) {
+            if(j >= n || fabs(node->value - coords[j]) > 1e-12 * (1. + fabs(node->value))) {
+                cerr << "Coordinate " << j << " of #" << table.id(row) << " differs" << endl;
+                return 1;
+            }
+        }
+        if(j != n) {
+            cerr << "#" << table.id(row) << " has " << j << " coordinates, " << n << " stored" << endl;
+            return 1;
+        }
+        return 0;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if(argc != 2) {
+        cerr << "Wrong number of args. Use: " << argv[0] << " file.stp" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    lazyInstMgr lim;
+    lim.initRegistry(SchemaInit);
+    lim.openFile(argv[1]);
+    lim.setInstanceBudget(50);
+
+    lazyCompactStore store(&lim);
+    size_t rows = store.addGeometricTypes();
+    const compactTable *points = store.table("cartesian_point");
+    if(rows == 0 || !points || points->size() != lim.countInstances("CARTESIAN_POINT")) {
+        cerr << "Error: the cartesian points of " << argv[1] << " were not stored." << endl;
+        exit(EXIT_FAILURE);
+    }
+    if(lim.loadedInstanceCount() != 0) {
+        cerr << "Error: " << lim.loadedInstanceCount() << " instances loaded by the store." << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    int mismatches = 0;
+    const char *types[] = { "CARTESIAN_POINT", "DIRECTION", "VECTOR", "EDGE_CURVE", "ORIENTED_EDGE",
+                            "FACE_BOUND", "FACE_OUTER_BOUND", "B_SPLINE_SURFACE_WITH_KNOTS", 0
+                          };
+    for(int t = 0; types[t]; t++) {
+        const compactTable *table = store.table(types[t]);
+        for(size_t row = 0; table && row < table->size(); row++) {
+            instanceID id = table->id(row);
+            size_t found;
+            if(store.find(id, found) != table || found != row) {
+                cerr << "Error: #" << id << " not found in its table." << endl;
+                ++mismatches;
+            }
+            instanceRefs refs;
+            table->references(row, refs);
+            instanceRefs_t::cvector *fwd = lim.getFwdRefs()->find(id);
+            if(refs != (fwd ? instanceRefs(fwd->begin(), fwd->end()) : instanceRefs())) {
+                cerr << "Error: the references of #" << id << " differ." << endl;
+                ++mismatches;
+            }
+            SDAI_Application_instance *inst = store.instance(id);
+            if(!inst) {
+                cerr << "Error: #" << id << " cannot be loaded." << endl;
+                ++mismatches;
+                continue;
+            }
+            if((int) table->attributeCount(row) != inst->attributes.list_length()) {
+                cerr << "Error: #" << id << " has " << inst->attributes.list_length() << " attributes, "
+                     << table->attributeCount(row) << " stored." << endl;
+                ++mismatches;
+            }
+            if(table == points || table == store.table("DIRECTION")) {
+                mismatches += compareCoordinates(*table, row, inst);
+            }
+        }
+    }
+
+    cout << store.rowCount() << " instances stored in " << store.memoryUsage() << " bytes, "
+         << store.skippedCount() << " skipped" << endl;
+    if(mismatches) {
+        cerr << mismatches << " mismatches." << endl;
+        exit(EXIT_FAILURE);
+    }
+    cout << "success." << endl;
+    exit(EXIT_SUCCESS);
+}
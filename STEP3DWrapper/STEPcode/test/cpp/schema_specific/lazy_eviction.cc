@@ -0,0 +1,166 @@
+/** \file lazy_eviction.cc
+ * Loads every instance of a file with a lazyInstMgr limited to a few loaded
+ * instances, then loads them all again in the opposite order. Instances that
+ * were evicted are read again from the file, and must be written out the same
+ * way as the first time. A pinned instance must stay loaded throughout.
+ * The budget is a soft target: after each load that reads an instance from
+ * the file and leaves more instances loaded than the budget, sweeping again
+ * must evict nothing, as the instances still loaded are those that loaded
+ * instances refer to. Inverse attributes must only hold loaded instances.
+ * With a third argument, no more than that many instances may be loaded at
+ * once; for a file where no instance refers to a large part of the others,
+ * it can be close to the budget.
+ */
+#include <sc_cf.h>
+#include <lazyInstMgr.h>
+#include <sdai.h>
+#include <STEPattribute.h>
+#include <ExpDict.h>
+#include <Registry.h>
+#include <errordesc.h>
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "schema.h"
+
+/**
+ * loads id, and reports a read from the file after which an instance over the budget could
+ * still be evicted: sweeping again, with id pinned as loadInstance() keeps it, must evict
+ * nothing. Finding an instance loaded doesn't sweep.
+ */
+SDAI_Application_instance *loadSwept(lazyInstMgr &lim, instanceID id, unsigned long budget, int &mismatches)
+{
+    unsigned long misses = lim.cacheMisses();
+    SDAI_Application_instance *inst = lim.loadInstance(id);
+    if(lim.cacheMisses() == misses || lim.loadedInstanceCount() <= budget) {
+        return inst;
+    }
+    unsigned long evicted = lim.evictedInstanceCount();
+    lim.pinInstance(id);
+    lim.setInstanceBudget(budget);
+    lim.unpinInstance(id);
+    if(lim.evictedInstanceCount() != evicted) {
+        cerr << "Error: " << lim.evictedInstanceCount() - evicted << " more instances evicted after #" << id
+             << " was loaded." << endl;
+        ++mismatches;
+    }
+    return inst;
+}
+
+/// counts the entries of inverse attributes that are not loaded instances
+int checkInverseAttrs(lazyInstMgr &lim, const std::vector<instanceID> &ids)
+{
+    std::set< SDAI_Application_instance * > loaded;
+    for(size_t i = 0; i < ids.size(); i++) {
+        if(lim.isLoaded(ids[i])) {
+            loaded.insert(lim.loadInstance(ids[i]));
+        }
+    }
+    int dangling = 0;
+    std::set< SDAI_Application_instance * >::iterator it;
+    for(it = loaded.begin(); it != loaded.end(); ++it) {
+        const SDAI_Application_instance::iAMap_t &iam = (*it)->getInvAttrs();
+        SDAI_Application_instance::iAMap_t::const_iterator iai;
+        for(iai = iam.begin(); iai != iam.end(); ++iai) {
+            const AttrDescriptor *inverted = iai->first->inverted_attr_();
+            if(inverted && !inverted->IsAggrType()) {
+                dangling += (iai->second.i && !loaded.count(iai->second.i));
+                continue;
+            }
+            EntityNode *en = (EntityNode *)(iai->second.a ? iai->second.a->GetHead() : 0);
+            for(; en; en = (EntityNode *) en->NextNode()) {
+                dangling += !loaded.count(en->node);
+            }
+        }
+    }
+    if(dangling) {
+        cerr << "Error: inverse attributes hold " << dangling << " instances that are not loaded." << endl;
+    }
+    return dangling;
+}
+
+int main(int argc, char *argv[])
+{
+    if(argc < 2 || argc > 4) {
+        cerr << "Wrong number of args. Use: " << argv[0] << " file.stp [budget [maxLoaded]]" << endl;
+        exit(EXIT_FAILURE);
+    }
+    unsigned long budget = (argc > 2) ? atol(argv[2]) : 50;
+    unsigned long maxAllowed = (argc > 3) ? atol(argv[3]) : 0;
+
+    lazyInstMgr lim;
+    lim.initRegistry(SchemaInit);
+    lim.openFile(argv[1]);
+
+    // the instance ids are not necessarily contiguous
+    std::vector<instanceID> ids;
+    unsigned long total = lim.totalInstanceCount();
+    for(instanceID id = 1; ids.size() < total && id < 100 * (total + 1); id++) {
+        if(lim.streamPosFromFile(id) >= 0) {
+            ids.push_back(id);
+        }
+    }
+    if(ids.empty()) {
+        cerr << "Error: no instance found in " << argv[1] << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    lim.setInstanceBudget(budget);
+    SDAI_Application_instance *pinned = lim.pinInstance(ids[0]);
+
+    int mismatches = 0;
+    std::map<instanceID, std::string> written;
+    unsigned long maxLoaded = 0;
+    for(size_t i = 0; i < ids.size(); i++) {
+        SDAI_Application_instance *inst = loadSwept(lim, ids[i], budget, mismatches);
+        if(inst) {
+            inst->STEPwrite(written[ids[i]]);
+        }
+        maxLoaded = std::max(maxLoaded, lim.loadedInstanceCount());
+    }
+    mismatches += checkInverseAttrs(lim, ids);
+
+    std::string buf;
+    unsigned long reloaded = 0;
+    std::vector<instanceID>::reverse_iterator it;
+    for(it = ids.rbegin(); it != ids.rend(); ++it) {
+        bool evicted = !lim.isLoaded(*it);
+        SDAI_Application_instance *inst = loadSwept(lim, *it, budget, mismatches);
+        if(!inst) {
+            continue;
+        }
+        reloaded += evicted;
+        inst->STEPwrite(buf);
+        if(written[*it] != buf) {
+            cerr << "Instance #" << *it << " differs after eviction:" << endl << written[*it] << endl << buf << endl;
+            ++mismatches;
+        }
+        maxLoaded = std::max(maxLoaded, lim.loadedInstanceCount());
+    }
+    mismatches += checkInverseAttrs(lim, ids);
+
+    cout << ids.size() << " instances, budget " << budget << ", at most " << maxLoaded << " loaded, "
+         << reloaded << " evicted ones read again" << endl;
+    cout << lim.cacheHits() << " hits, " << lim.cacheMisses() << " misses, " << lim.evictedInstanceCount() << " evictions" << endl;
+
+    if(!lim.isLoaded(ids[0]) || lim.loadInstance(ids[0]) != pinned) {
+        cerr << "Error: the pinned instance #" << ids[0] << " was evicted." << endl;
+        ++mismatches;
+    }
+    if(maxAllowed && maxLoaded > maxAllowed) {
+        cerr << "Error: " << maxLoaded << " instances were loaded at once, more than " << maxAllowed << "." << endl;
+        ++mismatches;
+    }
+    if(ids.size() > budget && (lim.evictedInstanceCount() == 0 || reloaded == 0)) {
+        cerr << "Error: nothing was evicted and read again." << endl;
+        ++mismatches;
+    }
+    if(mismatches) {
+        exit(EXIT_FAILURE);
+    }
+    cout << "success." << endl;
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,145 @@
+/** \file stepfile_deferred_read.cc
+ * Reads a file twice, once as usual and once with STEPfile::DeferredRead().
+ * After the deferred read the simple instances must not be read yet; the
+ * generated access functions and the attribute list, even a const one, read
+ * an instance on first use. Several threads
+ * then read all the instances at once, in different orders, and every
+ * instance must be written out as after the usual read.
+ */
+#include <STEPfile.h>
+#include <sdai.h>
+#include <STEPattribute.h>
+#include <ExpDict.h>
+#include <Registry.h>
+#include <errordesc.h>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifdef HAVE_STD_THREAD
+# include <thread>
+#else
+# error Need std::thread for this test!
+#endif
+
+#include "SdaiAUTOMOTIVE_DESIGN.h"
+
+// NOTE this test requires std::thread, part of C++11. It will fail to compile otherwise.
+
+/// reads the instances from the first-th, one in every step
+void readInstances(InstMgr *instance_list, int first, int step)
+{
+    int count = instance_list->InstanceCount();
+    for(int i = 0; i < count; i++) {
+        SDAI_Application_instance *instance = instance_list->GetApplication_instance((first + i * step) % count);
+        if(instance) {
+            instance->ReadDeferred();
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if(argc < 2 || argc > 3) {
+        cerr << "Wrong number of args. Use: " << argv[0] << " file.stp [threads]" << endl;
+        exit(EXIT_FAILURE);
+    }
+    int threads = (argc > 2) ? atoi(argv[2]) : 4;
+
+    Registry registry(SchemaInit);
+
+    InstMgr expected_list(1);
+    STEPfile expected_file(registry, expected_list, "", false);
+    expected_file.ReadExchangeFile(argv[1]);
+    int count = expected_list.InstanceCount();
+    if(count == 0) {
+        cerr << "Error: no instance read from " << argv[1] << endl;
+        exit(EXIT_FAILURE);
+    }
+    std::map<int, std::string> expected;
+    for(int i = 0; i < count; i++) {
+        SDAI_Application_instance *instance = expected_list.GetApplication_instance(i);
+        instance->STEPwrite(expected[instance->StepFileId()]);
+    }
+
+    InstMgr instance_list(1);
+    STEPfile sfile(registry, instance_list, "", false);
+    sfile.DeferredRead(true);
+    sfile.ReadExchangeFile(argv[1]);
+
+    int mismatches = 0;
+    if(instance_list.InstanceCount() != count) {
+        cerr << "Error: " << instance_list.InstanceCount() << " instances created, " << count << " expected." << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    int deferred = 0;
+    SdaiCartesian_point *point = 0;
+    for(int i = 0; i < count; i++) {
+        SDAI_Application_instance *instance = instance_list.GetApplication_instance(i);
+        if(instance->attributes.Deferred()) {
+            ++deferred;
+            if(!point && instance->eDesc == automotive_design::e_cartesian_point) {
+                point = (SdaiCartesian_point *) instance;
+            }
+        }
+    }
+    cout << count << " instances, " << deferred << " deferred" << endl;
+    if(deferred == 0 || !point) {
+        cerr << "Error: the read of the instances wasn't deferred." << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // an access function reads the instance
+    point->coordinates_();
+    if(point->attributes.Deferred()) {
+        cerr << "Error: #" << point->StepFileId() << " not read by its access function." << endl;
+        ++mismatches;
+    }
+
+    // as does an attribute of the list, also through a const reference
+    for(int i = 0; i < count; i++) {
+        SDAI_Application_instance *instance = instance_list.GetApplication_instance(i);
+        const STEPattributeList &attributes = instance->attributes;
+        if(attributes.Deferred() && attributes.list_length() > 0) {
+            attributes[0].is_null();
+            if(attributes.Deferred()) {
+                cerr << "Error: #" << instance->StepFileId() << " not read by its attribute list." << endl;
+                ++mismatches;
+            }
+            break;
+        }
+    }
+
+    std::vector<std::thread> readers;
+    for(int t = 0; t < threads; t++) {
+        readers.push_back(std::thread(readInstances, &instance_list, t * count / threads, (t % 2) ? count - 1 : 1));
+    }
+    for(size_t t = 0; t < readers.size(); t++) {
+        readers[t].join();
+    }
+
+    std::string buf;
+    for(int i = 0; i < count; i++) {
+        SDAI_Application_instance *instance = instance_list.GetApplication_instance(i);
+        if(instance->attributes.Deferred()) {
+            cerr << "Error: #" << instance->StepFileId() << " still deferred." << endl;
+            ++mismatches;
+            continue;
+        }
+        instance->STEPwrite(buf);
+        if(expected[instance->StepFileId()] != buf) {
+            cerr << "Instance #" << instance->StepFileId() << " differs:" << endl
+                 << expected[instance->StepFileId()] << endl << buf << endl;
+            ++mismatches;
+        }
+    }
+
+    if(mismatches) {
+        cerr << mismatches << " mismatches." << endl;
+        exit(EXIT_FAILURE);
+    }
+    cout << "success." << endl;
+    exit(EXIT_SUCCESS);
+}
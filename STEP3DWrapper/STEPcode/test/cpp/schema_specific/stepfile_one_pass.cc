@@ -0,0 +1,123 @@
+/** \file stepfile_one_pass.cc
+ * Reads a file twice, once as usual and once with STEPfile::OnePassRead(),
+ * which reads each record where it is and fixes the references to instances
+ * further on once they are read. Every instance must be written out alike and
+ * have the same state, and both reads must end with the same severity. The
+ * file must have references to instances further on, in attributes and in
+ * aggregates, and complex instances.
+ */
+#include <STEPfile.h>
+#include <sdai.h>
+#include <STEPattribute.h>
+#include <STEPaggrEntity.h>
+#include <ExpDict.h>
+#include <Registry.h>
+#include <errordesc.h>
+#include <iostream>
+#include <map>
+#include <string>
+
+#include "SdaiAUTOMOTIVE_DESIGN.h"
+
+/// the text of each instance of instance_list, followed by the state of its node, by file id
+void writeInstances(InstMgr &instance_list, std::map<int, std::string> &texts)
+{
+    std::string buf;
+    int count = instance_list.InstanceCount();
+    for(int i = 0; i < count; i++) {
+        MgrNode *node = instance_list.GetMgrNode(i);
+        SDAI_Application_instance *instance = node->GetApplication_instance();
+        instance->STEPwrite(buf);
+        texts[instance->StepFileId()] = buf + " state " + std::to_string((int) node->CurrState());
+    }
+}
+
+/// counts the references of instance to instances with a greater id, in attributes and in aggregates
+void countForward(SDAI_Application_instance *instance, int &attrRefs, int &aggrRefs)
+{
+    int id = instance->StepFileId();
+    STEPattributeList &attributes = instance->attributes;
+    for(int i = 0; i < attributes.list_length(); i++) {
+        STEPattribute &attr = attributes[i];
+        if(attr.is_null()) {
+            continue;
+        }
+        SDAI_Application_instance *ref = attr.Entity();
+        if(ref && ref != S_ENTITY_NULL && ref->StepFileId() > id) {
+            ++attrRefs;
+        }
+        EntityAggregate *aggr = dynamic_cast< EntityAggregate * >(attr.Aggregate());
+        for(EntityNode *n = aggr ? (EntityNode *) aggr->GetHead() : 0; n; n = (EntityNode *) n->NextNode()) {
+            if(n->node && n->node != S_ENTITY_NULL && n->node->StepFileId() > id) {
+                ++aggrRefs;
+            }
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if(argc != 2) {
+        cerr << "Wrong number of args. Use: " << argv[0] << " file.stp" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    Registry registry(SchemaInit);
+
+    InstMgr expected_list(1);
+    STEPfile expected_file(registry, expected_list, "", false);
+    Severity expected_sev = expected_file.ReadExchangeFile(argv[1]);
+    std::map<int, std::string> expected;
+    writeInstances(expected_list, expected);
+    if(expected.empty()) {
+        cerr << "Error: no instance read from " << argv[1] << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    InstMgr instance_list(1);
+    STEPfile sfile(registry, instance_list, "", false);
+    sfile.OnePassRead(true);
+    Severity sev = sfile.ReadExchangeFile(argv[1]);
+    std::map<int, std::string> texts;
+    writeInstances(instance_list, texts);
+
+    int mismatches = 0;
+    if(sev != expected_sev) {
+        cerr << "Error: read with severity " << sev << ", " << expected_sev << " expected." << endl;
+        ++mismatches;
+    }
+    if(texts.size() != expected.size()) {
+        cerr << "Error: " << texts.size() << " instances read, " << expected.size() << " expected." << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    std::map<int, std::string>::const_iterator it;
+    for(it = expected.begin(); it != expected.end(); ++it) {
+        if(texts[it->first] != it->second) {
+            cerr << "Instance #" << it->first << " differs:" << endl
+                 << it->second << endl << texts[it->first] << endl;
+            ++mismatches;
+        }
+    }
+
+    int attrRefs = 0, aggrRefs = 0, complexes = 0;
+    // counted on the usual read, whose references don't depend on the fixing
+    for(int i = 0; i < expected_list.InstanceCount(); i++) {
+        SDAI_Application_instance *instance = expected_list.GetApplication_instance(i);
+        countForward(instance, attrRefs, aggrRefs);
+        complexes += instance->IsComplex();
+    }
+    cout << texts.size() << " instances read in one pass; the file has " << attrRefs << " references to instances further on in attributes, "
+         << aggrRefs << " in aggregates, and " << complexes << " complex instances" << endl;
+    if(!attrRefs || !aggrRefs || !complexes) {
+        cerr << "Error: " << argv[1] << " doesn't test the forward references and the complex instances." << endl;
+        ++mismatches;
+    }
+
+    if(mismatches) {
+        cerr << mismatches << " mismatches." << endl;
+        exit(EXIT_FAILURE);
+    }
+    cout << "success." << endl;
+    exit(EXIT_SUCCESS);
+}
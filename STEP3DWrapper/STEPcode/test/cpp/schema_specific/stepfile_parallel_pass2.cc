@@ -0,0 +1,92 @@
+/** \file stepfile_parallel_pass2.cc
+ * Reads a file twice, once as usual and once with STEPfile::ParallelRead(),
+ * whose second pass reads the attributes on several threads. Every instance
+ * must be written out alike and have the same state, and both reads must end
+ * with the same severity.
+ */
+#include <STEPfile.h>
+#include <sdai.h>
+#include <ExpDict.h>
+#include <Registry.h>
+#include <errordesc.h>
+#include <iostream>
+#include <map>
+#include <string>
+
+#ifdef HAVE_STD_THREAD
+# include <thread>
+#else
+# error Need std::thread for this test!
+#endif
+
+#include "SdaiAUTOMOTIVE_DESIGN.h"
+
+// NOTE this test requires std::thread, part of C++11. It will fail to compile otherwise.
+
+/// the text of each instance of instance_list, followed by the state of its node, by file id
+void writeInstances(InstMgr &instance_list, std::map<int, std::string> &texts)
+{
+    std::string buf;
+    int count = instance_list.InstanceCount();
+    for(int i = 0; i < count; i++) {
+        MgrNode *node = instance_list.GetMgrNode(i);
+        SDAI_Application_instance *instance = node->GetApplication_instance();
+        instance->STEPwrite(buf);
+        texts[instance->StepFileId()] = buf + " state " + std::to_string((int) node->CurrState());
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if(argc < 2 || argc > 3) {
+        cerr << "Wrong number of args. Use: " << argv[0] << " file.stp [threads]" << endl;
+        exit(EXIT_FAILURE);
+    }
+    int threads = (argc > 2) ? atoi(argv[2]) : 4;
+
+    Registry registry(SchemaInit);
+
+    InstMgr expected_list(1);
+    STEPfile expected_file(registry, expected_list, "", false);
+    Severity expected_sev = expected_file.ReadExchangeFile(argv[1]);
+    std::map<int, std::string> expected;
+    writeInstances(expected_list, expected);
+    if(expected.empty()) {
+        cerr << "Error: no instance read from " << argv[1] << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    InstMgr instance_list(1);
+    STEPfile sfile(registry, instance_list, "", false);
+    sfile.ParallelRead(threads);
+    Severity sev = sfile.ReadExchangeFile(argv[1]);
+    std::map<int, std::string> texts;
+    writeInstances(instance_list, texts);
+
+    int mismatches = 0;
+    if(sev != expected_sev) {
+        cerr << "Error: read with severity " << sev << ", " << expected_sev << " expected." << endl;
+        ++mismatches;
+    }
+    if(texts.size() != expected.size()) {
+        cerr << "Error: " << texts.size() << " instances read, " << expected.size() << " expected." << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    std::map<int, std::string>::const_iterator it;
+    for(it = expected.begin(); it != expected.end(); ++it) {
+        if(texts[it->first] != it->second) {
+            cerr << "Instance #" << it->first << " differs:" << endl
+                 << it->second << endl << texts[it->first] << endl;
+            ++mismatches;
+        }
+    }
+    cout << texts.size() << " instances read on " << threads << " threads" << endl;
+
+    if(mismatches) {
+        cerr << mismatches << " mismatches." << endl;
+        exit(EXIT_FAILURE);
+    }
+    cout << "success." << endl;
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,127 @@
+/** \file stepfile_parallel_read.cc
+ * Reads the same file many times, first on one thread and then on several
+ * threads at once, each with its own InstMgr and STEPfile and all sharing one
+ * Registry. Every read must give the same instances, errors and warnings as a
+ * lone read. The throughput of both runs is printed to follow the scaling.
+ * Build with -fsanitize=thread to check the read path for data races.
+ */
+#include <STEPfile.h>
+#include <sdai.h>
+#include <STEPattribute.h>
+#include <ExpDict.h>
+#include <Registry.h>
+#include <errordesc.h>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef HAVE_STD_THREAD
+# include <thread>
+# include <chrono>
+#else
+# error Need std::thread for this test!
+#endif
+
+#include "SdaiAUTOMOTIVE_DESIGN.h"
+
+// NOTE this test requires std::thread, part of C++11. It will fail to compile otherwise.
+
+struct readResult {
+    int instances;
+    int errors;
+    int warnings;
+    Severity severity;
+
+    bool operator==(const readResult &r) const
+    {
+        return instances == r.instances && errors == r.errors &&
+               warnings == r.warnings && severity == r.severity;
+    }
+};
+
+readResult readOnce(Registry &registry, const char *fname)
+{
+    InstMgr instance_list(1);
+    STEPfile sfile(registry, instance_list, "", false);
+
+    readResult r;
+    r.severity = sfile.ReadExchangeFile(fname);
+    r.instances = instance_list.InstanceCount();
+    r.errors = sfile.ErrorCount();
+    r.warnings = sfile.WarningCount();
+    return r;
+}
+
+void readMany(Registry &registry, const char *fname, int count, const readResult &expected, int &failures)
+{
+    for(int i = 0; i < count; i++) {
+        if(!(readOnce(registry, fname) == expected)) {
+            ++failures;
+        }
+    }
+}
+
+double secondsSince(const std::chrono::steady_clock::time_point &start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[])
+{
+    if(argc < 2 || argc > 4) {
+        cerr << "Wrong number of args. Use: " << argv[0] << " file.stp [threads [reads per thread]]" << endl;
+        exit(EXIT_FAILURE);
+    }
+    const char *fname = argv[1];
+    int threads = (argc > 2) ? atoi(argv[2]) : (int) std::thread::hardware_concurrency();
+    int reads = (argc > 3) ? atoi(argv[3]) : 4;
+    threads = std::max(2, std::min(threads, 16));
+    reads = std::max(1, reads);
+
+    Registry registry(SchemaInit);
+
+    // reference read, also warms up the file cache
+    readResult expected = readOnce(registry, fname);
+    if(expected.instances == 0) {
+        cerr << "Error: no instance read from " << fname << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // serial
+    int serialFailures = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    readMany(registry, fname, reads, expected, serialFailures);
+    double serialSeconds = secondsSince(start);
+
+    // parallel
+    std::vector<int> failures(threads, 0);
+    std::vector<std::thread> workers;
+    start = std::chrono::steady_clock::now();
+    for(int t = 0; t < threads; t++) {
+        workers.push_back(std::thread(readMany, std::ref(registry), fname, reads, std::cref(expected), std::ref(failures[t])));
+    }
+    for(int t = 0; t < threads; t++) {
+        workers[t].join();
+    }
+    double parallelSeconds = secondsSince(start);
+
+    int parallelFailures = 0;
+    for(int t = 0; t < threads; t++) {
+        parallelFailures += failures[t];
+    }
+
+    double serialRate = reads / serialSeconds;
+    double parallelRate = threads * reads / parallelSeconds;
+    cout << expected.instances << " instances, " << expected.errors << " errors, " << expected.warnings << " warnings per read" << endl;
+    cout << "1 thread:  " << serialRate << " reads/s" << endl;
+    cout << threads << " threads: " << parallelRate << " reads/s, speedup " << parallelRate / serialRate
+         << " (hardware threads: " << std::thread::hardware_concurrency() << ")" << endl;
+
+    if(serialFailures || parallelFailures) {
+        cerr << "Error: " << serialFailures + parallelFailures << " reads differ from the reference read." << endl;
+        exit(EXIT_FAILURE);
+    }
+    cout << "All " << (threads + 1) * reads << " reads match - success." << endl;
+    exit(EXIT_SUCCESS);
+}
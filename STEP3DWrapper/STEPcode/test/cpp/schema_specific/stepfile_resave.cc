@@ -0,0 +1,225 @@
+/** \file stepfile_resave.cc
+ * Reads a copy of a file with STEPfile::KeepSourceRecords(), and writes it out
+ * again: all the records must be copied. Then changes an attribute of one
+ * instance and the id of another, and writes over the copy. The records of the
+ * changed instances and of those referring to the renumbered one must be
+ * written from their values, and reading the file back must give the instances
+ * in memory. The values changed through STEPattribute, rather than the access
+ * functions, must be written too, for a part of a complex instance as well.
+ * Last, a file whose value is changed without changing its size right after
+ * the read must not have its records copied.
+ */
+#include <sc_cf.h>
+#include <STEPfile.h>
+#include <sdai.h>
+#include <STEPattribute.h>
+#include <STEPcomplex.h>
+#include <ExpDict.h>
+#include <Registry.h>
+#include <errordesc.h>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+
+#include "SdaiAUTOMOTIVE_DESIGN.h"
+
+/// writes out each instance of a file read as usual, by id
+void readBack(Registry &registry, const char *fname, std::map<int, std::string> &written)
+{
+    InstMgr instance_list(1);
+    STEPfile sfile(registry, instance_list, "", false);
+    sfile.ReadExchangeFile(fname);
+    for(int i = 0; i < instance_list.InstanceCount(); i++) {
+        SDAI_Application_instance *instance = instance_list.GetApplication_instance(i);
+        instance->STEPwrite(written[instance->StepFileId()]);
+    }
+}
+
+/// compares the instances of a file with the instances in memory
+int compare(Registry &registry, const char *fname, InstMgr &instance_list)
+{
+    std::map<int, std::string> written;
+    readBack(registry, fname, written);
+    int mismatches = 0;
+    std::string buf;
+    for(int i = 0; i < instance_list.InstanceCount(); i++) {
+        SDAI_Application_instance *instance = instance_list.GetApplication_instance(i);
+        instance->STEPwrite(buf);
+        if(written[instance->StepFileId()] != buf) {
+            cerr << "Instance #" << instance->StepFileId() << " differs in " << fname << ":" << endl
+                 << written[instance->StepFileId()] << endl << buf << endl;
+            ++mismatches;
+        }
+    }
+    if((int) written.size() != instance_list.InstanceCount()) {
+        cerr << "Error: " << written.size() << " instances in " << fname << ", "
+             << instance_list.InstanceCount() << " expected." << endl;
+        ++mismatches;
+    }
+    return mismatches;
+}
+
+/// copies the file in to out; if from isn't empty, its first occurrence is replaced by to
+void copyFile(const char *in, const char *out, const std::string &from = "", const std::string &to = "")
+{
+    std::ifstream src(in, std::ios::binary);
+    std::stringstream text;
+    text << src.rdbuf();
+    std::string s = text.str();
+    size_t pos = from.empty() ? std::string::npos : s.find(from);
+    if(pos != std::string::npos) {
+        s.replace(pos, from.size(), to);
+    }
+    std::ofstream dst(out, std::ios::binary);
+    dst << s;
+}
+
+/// an optional attribute with a value, of a part of complex instance other than the first
+STEPattribute *complexOptional(InstMgr &instance_list, SDAI_Application_instance *&complex)
+{
+    for(int i = 0; i < instance_list.InstanceCount(); i++) {
+        complex = instance_list.GetApplication_instance(i);
+        if(!complex->IsComplex()) {
+            continue;
+        }
+        for(STEPcomplex *part = ((STEPcomplex *) complex)->head->sc; part; part = part->sc) {
+            for(int j = 0; j < part->attributes.list_length(); j++) {
+                STEPattribute &attr = part->attributes[j];
+                if(!attr.IsDerived() && attr.Nullable() && !attr.is_null()) {
+                    return &attr;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+/// reports an instance changed through STEPattribute that isn't Modified()
+int checkModified(SDAI_Application_instance *instance, const char *how)
+{
+    if(instance->Modified()) {
+        return 0;
+    }
+    cerr << "Error: #" << instance->StepFileId() << " not modified by " << how << "." << endl;
+    return 1;
+}
+
+/**
+ * reads a copy of fname keeping the records, then changes the copy without changing its
+ * size: the file is then written from the values, however soon after the read it changed
+ */
+int changedSource(Registry &registry, const char *fname)
+{
+    const char *source = "resave_stamp.stp";
+    copyFile(fname, source);
+    InstMgr instance_list(1);
+    STEPfile sfile(registry, instance_list, "", false);
+    sfile.KeepSourceRecords(true);
+    sfile.ReadExchangeFile(source);
+    copyFile(fname, source, ".MILLI.", ".MICRO.");
+
+    sfile.WriteExchangeFile("resave_stamp_copy.stp");
+    cout << sfile.RecordsCopied() << " records copied from a file changed after the read" << endl;
+    int mismatches = compare(registry, "resave_stamp_copy.stp", instance_list);
+    if(sfile.RecordsCopied() != 0) {
+        cerr << "Error: no record should be copied from a changed file." << endl;
+        ++mismatches;
+    }
+    return mismatches;
+}
+
+int main(int argc, char *argv[])
+{
+    if(argc != 2) {
+        cerr << "Wrong number of args. Use: " << argv[0] << " file.stp" << endl;
+        exit(EXIT_FAILURE);
+    }
+    const char *source = "resave.stp";
+    copyFile(argv[1], source);
+
+    Registry registry(SchemaInit);
+    InstMgr instance_list(1);
+    STEPfile sfile(registry, instance_list, "", false);
+    sfile.KeepSourceRecords(true);
+    sfile.ReadExchangeFile(source);
+    int count = instance_list.InstanceCount();
+    if(count == 0) {
+        cerr << "Error: no instance read from " << argv[1] << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    int mismatches = 0;
+    SdaiCartesian_point *point = 0;
+    SDAI_Application_instance *direction = 0, *renamed = 0, *reread = 0;
+    for(int i = 0; i < count; i++) {
+        SDAI_Application_instance *instance = instance_list.GetApplication_instance(i);
+        if(instance->Modified()) {
+            cerr << "Error: #" << instance->StepFileId() << " modified by the read." << endl;
+            ++mismatches;
+        }
+        if(instance->eDesc == automotive_design::e_cartesian_point) {
+            if(!point) {
+                point = (SdaiCartesian_point *) instance;
+            } else if(!renamed) {
+                renamed = instance;
+            } else if(!reread) {
+                reread = instance;
+            }
+        }
+        if(!direction && instance->eDesc == automotive_design::e_direction) {
+            direction = instance;
+        }
+    }
+    SDAI_Application_instance *complex = 0;
+    STEPattribute *optional = complexOptional(instance_list, complex);
+    if(!reread || !direction || !optional) {
+        cerr << "Error: not enough cartesian_points, no direction or no complex instance in " << argv[1] << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    sfile.WriteExchangeFile("resave_copy.stp");
+    cout << sfile.RecordsCopied() << " of " << count << " records copied" << endl;
+    if(sfile.RecordsCopied() != count) {
+        cerr << "Error: every record should have been copied." << endl;
+        ++mismatches;
+    }
+    mismatches += compare(registry, "resave_copy.stp", instance_list);
+
+    point->name_("'moved'");  // strings keep their quotes
+    if(!point->Modified()) {
+        cerr << "Error: #" << point->StepFileId() << " not modified by its access function." << endl;
+        ++mismatches;
+    }
+    direction->StepFileId(instance_list.MaxFileId() + 1);
+
+    // the name of a cartesian_point is its first attribute
+    renamed->attributes[0].StrToVal("'renamed'");
+    mismatches += checkModified(renamed, "StrToVal()");
+    std::istringstream text("'reread'");
+    reread->attributes[0].STEPread(text);
+    mismatches += checkModified(reread, "STEPread()");
+    optional->set_null();
+    mismatches += checkModified(complex, "set_null() of a part");
+
+    sfile.WriteExchangeFile(source);
+    cout << sfile.RecordsCopied() << " of " << count << " records copied after the changes" << endl;
+    if(sfile.RecordsCopied() > count - 6 || sfile.RecordsCopied() == 0) {
+        cerr << "Error: the changed records should have been written, and the others copied." << endl;
+        ++mismatches;
+    }
+    mismatches += compare(registry, source, instance_list);
+
+#ifdef HAVE_STAT_ST_MTIM
+    // with modification times in seconds, a change within the second of the read isn't seen
+    mismatches += changedSource(registry, argv[1]);
+#endif
+
+    if(mismatches) {
+        cerr << mismatches << " mismatches." << endl;
+        exit(EXIT_FAILURE);
+    }
+    cout << "success." << endl;
+    exit(EXIT_SUCCESS);
+}